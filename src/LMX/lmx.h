@@ -35,6 +35,7 @@
 //////////////////////////////////////////// Doxygen file documentation (end)
 
 #include "lmx_linsolvers.h"
+#include "lmx_mat_static.h"
 #include "cofe_fmc.h"
 #include "lmx_except.h"
 #include "lmx_base_stopwatch.h"
@@ -79,6 +79,16 @@ inline int setLinSolverType(int type)
   else return lin_solver_type = type;
 }
 
+  /** Function that changes the type of non-linear solver that will be used.
+   * 0 = Newton-Raphson, 1 = modified Newton, 2 = Broyden, 3 = L-BFGS,
+   * 4 = Jacobian-free Newton-Krylov.
+   */
+inline int setNLSolverType(int type)
+{ static int nl_solver_type = 0;
+  if (type<0) return nl_solver_type;
+  else return nl_solver_type = type;
+}
+
   /** Function reads the type of Matrix container that is used.
    */
 inline int getMatrixType(){ return setMatrixType(-1); }
@@ -91,6 +101,10 @@ inline int getVectorType(){ return setVectorType(-1); }
    */
 inline int getLinSolverType(){ return setLinSolverType(-1); }
 
+  /** Function reads the type of NLSolver that is used.
+   */
+inline int getNLSolverType(){ return setNLSolverType(-1); }
+
 } // namespace lmx 
 
 
@@ -56,17 +56,20 @@ template <class T> class Configuration
     lmx::Vector< T >* temp; /**< temporary pointer to vector for advance function */
     std::vector< double > time; /**< Time vector. Stores all the steps... */
     double lastStepSize;
+    double previousStepSize; /**< Step size before the last nextStep(), for rejectStep(). */
+    bool b_rejection; /**< 1 if the steps can be rejected. */
+    std::vector< lmx::Vector< T >* > backup; /**< Values overwritten by the last nextStep(), one per diff-order. */
 
   public:
 
     /** Empty constructor. */
-    Configuration() : vectorSize( 0 )
+    Configuration() : vectorSize( 0 ), lastStepSize( 0 ), b_rejection( 0 )
     { }
 
     /** Standard constructor.
      * \param t_o Time at first step.
      */
-    Configuration( double t_o ) : vectorSize( 0 )
+    Configuration( double t_o ) : vectorSize( 0 ), lastStepSize( 0 ), b_rejection( 0 )
     { time.push_back( t_o ); }
 
     /** Destructor. */
@@ -80,10 +83,29 @@ template <class T> class Configuration
 //         delete q[i];
       }
 //       q = 0;
+      for ( int i = 0; i < backup.size(); ++i ) delete backup[i];
     }
 
     void nextStep( double& stepSize );
 
+    /**
+     * Keeps a copy of the values overwritten by each nextStep() call, so the
+     * last step can be undone with rejectStep().
+     */
+    void enableStepRejection( )
+      { b_rejection = 1; }
+
+    void rejectStep( );
+
+    /**
+     * Configuration at the beginning of the last step. Only available if
+     * enableStepRejection() has been called.
+     * @param order Differential order of configuration.
+     * @return The configuration of the diff-order at the previous time.
+     */
+    const lmx::Vector<T>& getStepStart( int order )
+      { return (q[order].size() > 1) ? *(this->q[order][1]) : *(this->backup[order]); }
+
     /**
      * @param step Indicates the (actual - step) time step.
      * @return The time value of the step.
@@ -134,7 +156,17 @@ template <class T> class Configuration
      * @param values Values of configuration to be set.
      * @param time_step Indicates the (actual - step) time step
      */
-    void setConf( int diff_order, Vector<T> values, int time_step=0 )
+    void setConf( int diff_order, const Vector<T>& values, int time_step=0 )
+      { *q[diff_order][time_step] = values; }
+
+    /**
+     * Evaluates the expression directly into the configuration, without temporary vectors.
+     * @param diff_order Differential order of configuration.
+     * @param values Expression of the values of configuration to be set.
+     * @param time_step Indicates the (actual - step) time step
+     */
+    template <typename E>
+    void setConf( int diff_order, const VectorExpr<T,E>& values, int time_step=0 )
       { *q[diff_order][time_step] = values; }
 
     /**
@@ -224,6 +256,14 @@ template <class T>
 {
   unsigned int i,j;
 
+  if ( b_rejection ){
+    if ( backup.size() != q.size() )
+      for ( i=backup.size(); i<q.size(); ++i )
+        backup.push_back( new lmx::Vector<T>(vectorSize) );
+    for ( i=0; i<q.size(); ++i )
+      *backup[i] = *q[i].back();
+  }
+
 //   cout << "             Step number " << time.size() << " solved, time = " << time.back() << endl;
 //   cout << "--------------------------------------------------------" << endl;
 //   for ( i=0; i<q.size(); ++i)
@@ -239,6 +279,7 @@ template <class T>
   }
    *q[0][0] = *q[0][1]; // Optional, may improve accuracy
 
+  previousStepSize = lastStepSize;
   lastStepSize = step_size;
   time.push_back( time.back() + lastStepSize );
 
@@ -247,6 +288,35 @@ template <class T>
   cout << "--------------------------------------------------------" << endl;
 }
 
+/**
+ * Undoes the last nextStep() call, recovering the time, the step size and
+ * all the stored configurations. Needs enableStepRejection() before the step.
+ */
+template <class T>
+    void Configuration<T>::rejectStep( )
+{
+  if ( !b_rejection || backup.size() != q.size() || time.size() < 2 ){
+    std::stringstream message;
+    message << "ERROR : rejectStep() needs enableStepRejection() before the step is taken." << endl;
+    LMX_THROW(lmx::failure_error, message.str() );
+  }
+  unsigned int i,j;
+  for ( i=0; i<q.size(); ++i){
+    temp = q[i][0]; // Trial values are discarded.
+    for (j=0; j<q[i].size()-1; ++j){
+      q[i][j] = q[i][j+1]; // Move forward elements
+    }
+    q[i].back() = temp;
+    *q[i].back() = *backup[i];
+  }
+  time.pop_back();
+  lastStepSize = previousStepSize;
+
+  cout << "--------------------------------------------------------" << endl;
+  cout << "             Step rejected, back to time = " << time.back() << endl;
+  cout << "--------------------------------------------------------" << endl;
+}
+
 }; // namespace lmx
 
 #endif
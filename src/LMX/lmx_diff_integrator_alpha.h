@@ -0,0 +1,242 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LMXINTEGRATOR_ALPHA_H
+#define LMXINTEGRATOR_ALPHA_H
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_diff_integrator_alpha.h
+
+      \brief IntegratorGeneralizedAlpha class implementation
+
+      Implements the generalized-alpha and HHT-alpha integrators for second order dynamic systems.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+#include<cmath>
+
+#include"lmx_diff_integrator_base_implicit.h"
+#include"lmx_nlsolvers.h"
+
+namespace lmx {
+
+    /**
+  \class IntegratorGeneralizedAlpha
+  \brief Template class IntegratorGeneralizedAlpha.
+  Generalized-alpha integrator (Chung and Hulbert, 1993) for second order systems.
+
+  The equilibrium is imposed inside the step, evaluating the residue with
+  \f$ q_{n+1-\alpha_f} \f$, \f$ \dot{q}_{n+1-\alpha_f} \f$,
+  \f$ \ddot{q}_{n+1-\alpha_m} \f$ and \f$ t_{n+1-\alpha_f} \f$, while the
+  end of step values are updated with Newmark's formulas. So the usual
+  residue function is enough: DiffProblemSecond evaluates it at the
+  configuration given by getResidueConf().
+
+  The parameters are set from the spectral radius at infinite frequency,
+  \f$ \rho_\infty \in [0,1] \f$, which controls the numerical damping of the
+  high frequency modes while keeping second order accuracy. With the HHT
+  variant, \f$ \alpha_m = 0 \f$ and \f$ \rho_\infty \in [1/2,1] \f$.
+
+  The Newton increment is taken over the intermediate configuration, so the
+  partial derivatives are relative to \f$ q_{n+1-\alpha_f} \f$ and the
+  tangent built by the usual Jacobian function is the exact one.
+
+  @author Daniel Iglesias Ib��ez.
+     */
+  template <class T> class IntegratorGeneralizedAlpha : public IntegratorBaseImplicit<T>
+  {
+    public:
+
+      /** Empty constructor. */
+      IntegratorGeneralizedAlpha(){}
+
+      /** Standard constructor. */
+      IntegratorGeneralizedAlpha( double rho_inf, bool hht=0 );
+
+      /** Constructor with all the parameters. */
+      IntegratorGeneralizedAlpha( double alpha_m, double alpha_f, double beta, double gamma );
+
+      /** Destructor. */
+      ~IntegratorGeneralizedAlpha(){}
+
+      /** Initialize integration function. */
+      void initialize( Configuration<T>* );
+
+      /** Advance to next time-step function. */
+      void advance();
+
+      /** Actualize with delta in actual time-step. */
+      void actualize( lmx::Vector<T> delta );
+
+      /**
+       * No own error estimate, the generic one of DiffProblem is used. With
+       * \f$ \beta = 1/6 \f$ the scheme is the linear acceleration method,
+       * so that estimate is always null and the adaptive time step is refused.
+       * @return FALSE.
+       */
+      bool estimateError( double, double, double&, double& )
+      {
+        if ( std::abs( beta - 1./6. ) < 1E-12 ){
+          std::stringstream message;
+          message << "Error in IntegratorGeneralizedAlpha: the error estimate is null with beta = 1/6, "
+              << "the adaptive time step can not be used." << endl;
+          LMX_THROW(failure_error, message.str() );
+        }
+        return 0;
+      }
+
+      /** Calculates the factor \f$ \frac{\partial qdot_{n+1-\alpha_f}}{\partial q_{n+1-\alpha_f}} \f$. */
+      double getPartialQdot( )
+      {
+        return gamma / ( q->getLastStepSize()*beta );
+      }
+
+      /** Calculates the factor \f$ \frac{\partial qddot_{n+1-\alpha_m}}{\partial q_{n+1-\alpha_f}} \f$. */
+      double getPartialQddot( )
+      {
+        return (1.-alpha_m) / ( (1.-alpha_f) * std::pow( q->getLastStepSize(), 2. )*beta );
+      }
+
+      /** Configuration at the point of the step where the residue is evaluated. */
+      const lmx::Vector<T>* getResidueConf( int order )
+      { return &q_alpha[order]; }
+
+      /** Time where the residue is evaluated, \f$ t_{n+1-\alpha_f} \f$. */
+      double getResidueTime( )
+      { return q->getTime() - alpha_f * q->getLastStepSize(); }
+
+    private:
+      void interpolate( );
+
+      double alpha_m, alpha_f, beta, gamma;
+      lmx::Vector<T> q_alpha[3]; /**< Intermediate configuration. */
+      Configuration<T>* q;
+
+  };
+
+}; // namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+namespace lmx {
+
+  /**
+   * @param rho_inf Spectral radius at infinite frequency.
+   * @param hht Uses the HHT-alpha method if TRUE.
+   */
+  template <class T> IntegratorGeneralizedAlpha<T>::
+      IntegratorGeneralizedAlpha( double rho_inf, bool hht )
+  {
+    if ( rho_inf < (hht ? .5 : 0.) || rho_inf > 1. ){
+      std::stringstream message;
+      message << "Error in IntegratorGeneralizedAlpha: spectral radius " << rho_inf
+          << " out of range." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    if ( hht ){
+      alpha_m = 0.;
+      alpha_f = ( 1. - rho_inf ) / ( 1. + rho_inf );
+    }
+    else{
+      alpha_m = ( 2.*rho_inf - 1. ) / ( rho_inf + 1. );
+      alpha_f = rho_inf / ( rho_inf + 1. );
+    }
+    gamma = .5 - alpha_m + alpha_f;
+    beta = .25 * std::pow( 1. - alpha_m + alpha_f, 2 );
+  }
+
+  /**
+   * @param alpha_m_in Weight of the previous step in the acceleration.
+   * @param alpha_f_in Weight of the previous step in the rest of terms.
+   * @param beta_in Newmark's beta.
+   * @param gamma_in Newmark's gamma.
+   */
+  template <class T> IntegratorGeneralizedAlpha<T>::
+      IntegratorGeneralizedAlpha( double alpha_m_in, double alpha_f_in, double beta_in, double gamma_in )
+  : alpha_m(alpha_m_in), alpha_f(alpha_f_in), beta(beta_in), gamma(gamma_in)
+  {
+  }
+
+  template <class T>
+      void IntegratorGeneralizedAlpha<T>::initialize( Configuration<T>* configuration_in )
+  {
+    q = configuration_in;
+    if ( q->getDiffOrder() != 2 ){
+      std::stringstream message;
+      message << "Differential system must be a second order to apply this method." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    q->setStoredSteps( 2, 2, 2 );
+    for ( int i = 0; i < 3; ++i )
+      q_alpha[i].resize( q->getConf(0).size() );
+  }
+
+  /**
+   * Computes the intermediate configuration from the end of step values.
+   */
+  template <class T>
+      void IntegratorGeneralizedAlpha<T>::interpolate( )
+  {
+    for ( int i = 0; i < 2; ++i ){
+      q_alpha[i] = q->getConf( i, 0 ) * (T)(1. - alpha_f);
+      q_alpha[i].axpy( (T)alpha_f, q->getConf( i, 1 ) );
+    }
+    q_alpha[2] = q->getConf( 2, 0 ) * (T)(1. - alpha_m);
+    q_alpha[2].axpy( (T)alpha_m, q->getConf( 2, 1 ) );
+  }
+
+  template <class T>
+      void IntegratorGeneralizedAlpha<T>::advance( )
+  {
+    q->setConf( 1,
+                q->getConf( 1, 1 ) +
+                    (T)(1. - gamma) * q->getLastStepSize()
+                    * q->getConf( 2 , 1 ) );
+    q->setConf( 0,
+                q->getConf( 0, 1 ) +
+                    (T)q->getLastStepSize() * q->getConf( 1, 1 ) +
+                    (T)(0.5-beta) * std::pow( q->getLastStepSize(), 2 )
+                    * q->getConf( 2, 1 ) );
+    q->setConf( 2 ).fillIdentity( 0 );
+    interpolate( );
+  }
+
+  /**
+   * @param delta Increment of the intermediate configuration, \f$ q_{n+1-\alpha_f} \f$.
+   */
+  template <class T>
+      void IntegratorGeneralizedAlpha<T>::actualize( lmx::Vector<T> delta )
+  {
+    delta *= (T)( 1. / (1. - alpha_f) );
+    q->setConf( 0 ) += delta;
+    q->setConf( 1 ) += delta * ( gamma/(beta*q->getLastStepSize() ) );
+    q->setConf( 2 ) += delta * ( 1. / ( beta * std::pow(q->getLastStepSize(), 2 ) ) );
+    interpolate( );
+  }
+
+}; // namespace lmx
+
+
+#endif
@@ -46,6 +46,10 @@ namespace lmx {
     \class IntegratorAM
     \brief Template class IntegratorAM.
     Adams-Moulton integrator implementation for ODE systems.
+
+    The local error is estimated with Milne's device: the solution is
+    compared with the Adams-Bashforth predictor of the same order, computed
+    from the stored derivatives.
     
     @author Daniel Iglesias Ib��ez.
     */
@@ -54,6 +58,8 @@ template <class T> class IntegratorAM : public IntegratorBaseImplicit<T>
 private:
   int order;
   T b[5][5];  /**< Array (of arrays) of method's coefficients.*/
+  T bp[5][5];  /**< Coefficients of the Adams-Bashforth predictors.*/
+  T milne[5];  /**< Error constants ratio, C_AM / (C_AB - C_AM).*/
   Configuration<T>* q;
 
 public:
@@ -76,6 +82,8 @@ public:
   /** Actualize with delta in actual time-step. */
   void actualize( lmx::Vector<T> delta );
 
+  bool estimateError( double rel_tol, double abs_tol, double& error, double& factor );
+
   /** Calculates the factor \f$ \frac{\partial qdot_n}{\partial q_n} \f$. */
   double getPartialQdot( )
   { return (q->getTimeSize() > this->order-1) ?
@@ -121,13 +129,29 @@ namespace lmx {
           b[4][2] = (-264./720.); // b[2]
           b[4][3] = (106./720.); // b[3]
           b[4][4] = (-19./720.); // b[4]
+
+        // Predictors, Adams-Bashforth of the same order:
+          bp[0][0] = 1.;
+          bp[1][0] = 3./2.; bp[1][1] = -1./2.;
+          bp[2][0] = 23./12.; bp[2][1] = -16./12.; bp[2][2] = 5./12.;
+          bp[3][0] = 55./24.; bp[3][1] = -59./24.; bp[3][2] = 37./24.;
+          bp[3][3] = -9./24.;
+          bp[4][0] = 1901./720.; bp[4][1] = -2774./720.; bp[4][2] = 2616./720.;
+          bp[4][3] = -1274./720.; bp[4][4] = 251./720.;
+
+          milne[0] = -1./2.;
+          milne[1] = -1./6.;
+          milne[2] = -1./10.;
+          milne[3] = -19./270.;
+          milne[4] = -27./502.;
   }
 
   template <class T>
       void IntegratorAM<T>::initialize( Configuration<T>* configuration_in )
   {
     q = configuration_in;
-    q->setStoredSteps( 2, std::max(order,2), order );
+    // One more derivative is kept for the predictor of the error estimate:
+    q->setStoredSteps( 2, order+1, order+1 );
   }
 
 
@@ -182,6 +206,39 @@ namespace lmx {
     q->setConf( 0, q->getConf(0, 0) + delta );
   }
 
+  /**
+   * Milne's estimate of the local error of the last step, from the
+   * difference between the solution and the Adams-Bashforth predictor of
+   * the order used in the step: \f$ q_p = q_{n-1} + h \sum_j b^p_j \dot{q}_{n-j} \f$.
+   * @param rel_tol Relative tolerance.
+   * @param abs_tol Absolute tolerance.
+   * @param error Weighted RMS norm of the error of the last step.
+   * @param factor Proposed ratio between the next and the last step sizes.
+   * @return TRUE.
+   */
+  template <class T>
+      bool IntegratorAM<T>::estimateError( double rel_tol, double abs_tol, double& error, double& factor )
+  {
+    int k = std::min( order, q->getTimeSize()-1 );
+    double h = q->getLastStepSize();
+    const lmx::Vector<T>& q_n = q->getConf( 0, 0 );
+    const lmx::Vector<T>& q_o = q->getConf( 0, 1 );
+    size_type n = q_n.size();
+    double sum = 0., e, scale;
+    for ( size_type l = 0; l < n; ++l ){
+      e = q_n.readElement( l ) - q_o.readElement( l );
+      for ( int j = 0; j < k; ++j )
+        e -= h * bp[k-1][j] * q->getConf( 1, j+1 ).readElement( l );
+      e *= milne[k-1];
+      scale = abs_tol + rel_tol * std::max( std::abs( (double)q_n.readElement( l ) ),
+                                           std::abs( (double)q_o.readElement( l ) ) );
+      sum += ( e / scale ) * ( e / scale );
+    }
+    error = n ? std::sqrt( sum / n ) : 0.;
+    factor = ( error > 0. ) ? 0.9 * std::pow( 1. / error, 1. / ( k+1 ) ) : 5.;
+    return 1;
+  }
+
 }; // namespace lmx
 
 
@@ -38,6 +38,52 @@
 
 namespace lmx {
 
+    /**
+    \class StageEvaluator
+    \brief Template abstract class StageEvaluator.
+
+    Evaluation of the highest derivative of the system at any configuration,
+    needed by multi-stage integrators. DiffProblem implements it with the
+    user's evaluation function.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <class T> class StageEvaluator{
+
+public:
+
+  /** Destructor. */
+  virtual ~StageEvaluator( ){}
+
+  /**
+   * @param derivative Highest derivative, \f$ \dot{q} \f$ or \f$ \ddot{q} \f$.
+   * @param q Configuration.
+   * @param qdot First derivative (ignored in first order systems).
+   * @param time Time of the evaluation.
+   */
+  virtual void evaluateStage( lmx::Vector<T>& derivative,
+                              const lmx::Vector<T>& q,
+                              const lmx::Vector<T>& qdot,
+                              double time ) = 0;
+
+  /**
+   * Tangent of the residue \f$ \dot{q} - f(q,t) \f$, for linearly implicit
+   * integrators of first order systems. The arguments are the tangent
+   * matrix, the configuration, the factor
+   * \f$ \frac{\partial qdot}{\partial q} \f$ and the time of the
+   * evaluation. By default the tangent is not available.
+   */
+  virtual void evaluateTangent( lmx::Matrix<T>&,
+                                const lmx::Vector<T>&,
+                                double,
+                                double )
+  {
+    std::stringstream message;
+    message << "Error in StageEvaluator: tangent evaluation not available for this system." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+};
+
     /**
     \class IntegratorBase
     \brief Template abstract class IntegratorBase.
@@ -64,6 +110,24 @@ public:
 
   /** Actualization of the variables with non-actual configuration terms. */
   virtual void advance( ) = 0;
+
+  /**
+   * Local error estimate of the last step, for the adaptive time step.
+   * The arguments are the relative and absolute tolerances, and the
+   * returned weighted RMS norm of the error of the last step and proposed
+   * ratio between the next and the last step sizes.
+   * @return FALSE if the integrator does not estimate its error.
+   */
+  virtual bool estimateError( double, double, double&, double& )
+  { return 0; }
+
+  /** Sets the evaluation of the system for multi-stage integrators. */
+  virtual void setEvaluator( StageEvaluator<T>* )
+  { }
+
+  /** Returns 1 (TRUE) if advance() leaves the highest derivative evaluated at the end of the step. */
+  virtual bool evaluatesEnd( )
+  { return 0; }
 };
 
 }; // namespace lmx
@@ -68,6 +68,19 @@ public:
 
   /** Actualizes variables applying an increment. */
   virtual void actualize( lmx::Vector<T> delta ) = 0;
+
+  /**
+   * Configuration where the residue has to be evaluated, for integrators
+   * that impose the equilibrium inside the step (generalized-alpha). The
+   * argument is the differential order of the configuration.
+   * @return 0 if the residue is evaluated at the end of the step.
+   */
+  virtual const lmx::Vector<T>* getResidueConf( int )
+  { return 0; }
+
+  /** Time of the residue evaluation when getResidueConf() is not null. */
+  virtual double getResidueTime( )
+  { return 0.; }
 };
 
 }; // namespace lmx
@@ -28,7 +28,8 @@
       
       \brief IntegratorBDF class implementation
 
-      Implements BDF integrator class for solving dynamic systems.
+      Implements BDF integrator class for solving dynamic systems, with variable
+      coefficients, error estimation and optional variable order.
 
       \author Daniel Iglesias Ib�ez
       
@@ -46,7 +47,22 @@ namespace lmx {
     \class IntegratorBDF
     \brief Template class IntegratorBDF.
     Gear's BDF integrator implementation for ODE systems.
-    
+
+    The coefficients are computed at each step from the times of the stored
+    configurations (variable coefficient form), so the formula keeps its
+    order when the step size changes and no rescaling of the history is
+    needed. The order is ramped up during the first steps.
+
+    With the adaptive time step of DiffProblem, the local error of the step
+    is estimated from the divided differences of the stored history. In
+    variable order mode, the errors of orders k-1 and k+1 are also
+    estimated and the order (between 1 and the given maximum) that allows
+    the largest next step is chosen, as in stiff production solvers. The
+    first guess of each step is then the extrapolation of the history.
+    Without an adaptive time step there is no error estimate to select the
+    order with, so variable order mode works as the fixed order BDF of the
+    given maximum order.
+
     @author Daniel Iglesias Ib��ez.
     */
 template <class T> class IntegratorBDF : public IntegratorBaseImplicit<T>
@@ -57,7 +73,7 @@ template <class T> class IntegratorBDF : public IntegratorBaseImplicit<T>
     IntegratorBDF(){}
   
     /** Standard constructor. */
-    IntegratorBDF(int ord);
+    IntegratorBDF(int ord, bool variable_order=0);
   
     /** Destructor. */
     ~IntegratorBDF(){}
@@ -71,26 +87,32 @@ template <class T> class IntegratorBDF : public IntegratorBaseImplicit<T>
     /** Actualize with delta in actual time-step. */
     void actualize( lmx::Vector<T> delta );
 
+    bool estimateError( double rel_tol, double abs_tol, double& error, double& factor );
+
+    /** Order of the formula used in the last step. */
+    int getOrder( )
+    { return k; }
+
     /** Calculates the factor \f$ \frac{\partial qdot_n}{\partial q_n} \f$. */
     double getPartialQdot( )
-    {
-      return (q->getTimeSize() > this->order) ?
-          1./ ( q->getLastStepSize()*b[order-1] ) :
-          1./ ( q->getLastStepSize()*b[q->getTimeSize()-2] );
-    }
+    { return alpha[0]; }
 
     /** Calculates the factor \f$ \frac{\partial qddot_n}{\partial q_n} \f$. */
     double getPartialQddot( )
-    {
-      return (q->getTimeSize() > this->order) ?
-          1./ ( std::pow( q->getLastStepSize()*b[order-1],2 ) ) :
-          1./ ( std::pow( q->getLastStepSize()*b[q->getTimeSize()-2],2 ) );
-    }
+    { return alpha[0]*alpha[0]; }
   
   private:
-    int order;
-    T b[5];  /**< Array of method's RHS coefficients.*/
-    T a[5][5];  /**< Array (of arrays) of method's coefficients.*/
+    void computeCoefficients( );
+    void predict( );
+    double errorNorm( int, double, double );
+
+    int order; /**< Maximum order.*/
+    int k; /**< Order of the current step.*/
+    int k_next; /**< Order selected for the next steps.*/
+    int steps_at_order; /**< Steps taken since the last change of order.*/
+    bool b_variable; /**< 1 if the order is selected automatically.*/
+    bool b_estimated; /**< 1 if the steps are checked with estimateError.*/
+    T alpha[6];  /**< Derivative coefficients of q_{n-j}, j = 0..k.*/
     Configuration<T>* q;
 
 };
@@ -101,94 +123,188 @@ template <class T> class IntegratorBDF : public IntegratorBaseImplicit<T>
 
 namespace lmx {
 
-  template <class T> IntegratorBDF<T>::IntegratorBDF(int ord) : order(ord)
+  /**
+   * @param ord Order of the method, or maximum order with variable order.
+   * @param variable_order Selects the order automatically if TRUE.
+   */
+  template <class T> IntegratorBDF<T>::IntegratorBDF(int ord, bool variable_order)
+    : order(ord), k(1), k_next(variable_order ? 1 : ord), steps_at_order(0)
+    , b_variable(variable_order), b_estimated(0)
   {
-        // order == 1 -> Euler Implicit
-          b[0] = (1.); // b = 1
-          a[0][0] = (1.); // a[0] = 1
-        
-        // order == 2
-          b[1] = (2./3.); // b
-          a[1][0] = (4./3.); // a[0]
-          a[1][1] = (-1./3.); // a[1]
-        
-        // order == 3
-          b[2] = (6./11.); // b
-          a[2][0] = (18./11.); // a[0]
-          a[2][1] = (-9./11.); // a[1]
-          a[2][2] = (2./11.); // a[2]
-        
-        // order == 4
-          b[3] = (12./25.); // b
-          a[3][0] = (48./25.); // a[0]
-          a[3][1] = (-36./25.); // a[1]
-          a[3][2] = (16./25.); // a[2]
-          a[3][3] = (-3./25.); // a[3]
-        
-        // order == 5
-          b[4] = (60./137.); // b
-          a[4][0] = (300./137.); // a[0]
-          a[4][1] = (-300./137.); // a[1]
-          a[4][2] = (200./137.); // a[2]
-          a[4][3] = (-75./137.); // a[3]
-          a[4][4] = (-12./137.); // a[4]
+    if ( order < 1 || order > 5 ){
+      std::stringstream message;
+      message << "Error in IntegratorBDF: order " << order
+          << " not available (1 to 5)." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
   }
 
   template <class T>
       void IntegratorBDF<T>::initialize( Configuration<T>* configuration_in )
   {
     q = configuration_in;
-    q->setStoredSteps( order+1, order+1, 1 );
+    k = 1;
+    k_next = b_variable ? 1 : order;
+    steps_at_order = 0;
+    b_estimated = 0;
+    // One more step of q for the error estimate of order+1:
+    q->setStoredSteps( order+2, order+1, 1 );
+  }
+
+  /**
+   * Coefficients of the derivative at t_n of the polynomial interpolating
+   * the configurations at t_n, ..., t_{n-k}.
+   */
+  template <class T>
+      void IntegratorBDF<T>::computeCoefficients( )
+  {
+    int i, j;
+    double t_n = q->getTime( 0 );
+    alpha[0] = 0.;
+    for ( j = 1; j <= k; ++j )
+      alpha[0] += 1. / ( t_n - q->getTime( j ) );
+    for ( j = 1; j <= k; ++j ){
+      double num = 1., den = 1.;
+      for ( i = 0; i <= k; ++i ){
+        if ( i == j ) continue;
+        if ( i != 0 ) num *= t_n - q->getTime( i );
+        den *= q->getTime( j ) - q->getTime( i );
+      }
+      alpha[j] = num / den;
+    }
   }
 
+  /**
+   * Extrapolates q_n from the last k+1 stored configurations.
+   */
+  template <class T>
+      void IntegratorBDF<T>::predict( )
+  {
+    int i, j;
+    int m = ( q->getTimeSize()-1 < k+1 ) ? q->getTimeSize()-1 : k+1;
+    if ( m < 2 ) return; // q_n = q_{n-1}, already set by nextStep()
+    double t_n = q->getTime( 0 );
+    Vector<T>& q_n = q->setConf( 0 );
+    q_n.fillIdentity( 0. );
+    for ( j = 1; j <= m; ++j ){
+      double w = 1.;
+      for ( i = 1; i <= m; ++i ){
+        if ( i == j ) continue;
+        w *= ( t_n - q->getTime( i ) ) / ( q->getTime( j ) - q->getTime( i ) );
+      }
+      q_n.axpy( w, q->getConf( 0, j ) );
+    }
+  }
 
   template <class T>
       void IntegratorBDF<T>::advance( )
   { 
     int i, j;
-    if (q->getTimeSize() < order+1){ //orden de integrador > steps
-      for ( i = 0; i < q->getDiffOrder(); ++i ){
-        q->setConf( i+1,( q->getConf(i,0) )
-            * ( 1. / (q->getLastStepSize() * b[q->getTimeSize()-2])) );
-        for ( j=0; j < q->getTimeSize()-1; ++j){
-          q->setConf( i+1, q->getConf(i+1,0) - ( a[q->getTimeSize()-2][j]* q->getConf(i,j+1)  )
-              * ( 1. / (q->getLastStepSize() * b[q->getTimeSize()-2])) );
-        }
-      }
+    // The first step is always checked when the time step is adaptive:
+    if ( b_variable && !b_estimated && q->getTimeSize() > 2 ) k_next = order;
+    k = ( q->getTimeSize()-1 < k_next ) ? q->getTimeSize()-1 : k_next;
+    computeCoefficients( );
+    if ( b_variable ) predict( );
+    for ( i = 0; i < q->getDiffOrder(); ++i ){
+      Vector<T>& qdot = q->setConf( i+1 );
+      qdot = q->getConf( i, 0 ) * alpha[0];
+      for ( j = 1; j <= k; ++j )
+        qdot.axpy( alpha[j], q->getConf( i, j ) );
     }
-     else{//se aplica el orden real de integrador
-       for ( i = 0; i < q->getDiffOrder(); ++i ){
-//          q->setConf( i+1,0).fillIdentity(0);
-         q->setConf( i+1,( q->getConf(i,0) )
-           * ( 1. / (q->getLastStepSize() * b[order-1])) );
-         for ( j=0; j < order; ++j){
-           q->setConf( i+1, q->getConf(i+1,0) - ( a[order-1][j]* q->getConf(i,j+1)  )
-               * ( 1. / (q->getLastStepSize() * b[order-1])) );
-         }
-       }
-     } 
   }
 
   template <class T>
       void IntegratorBDF<T>::actualize( lmx::Vector<T> delta )
   {
     int i;
-    if (q->getTimeSize() < order+1){ //orden de integrador > steps
-      for ( i = 0; i < q->getDiffOrder(); ++i ){
-        q->setConf( i+1) +=  delta
-            * std::pow( 1. / (q->getLastStepSize() * b[q->getTimeSize()-2]), i+1);
-      }
+    for ( i = 0; i < q->getDiffOrder(); ++i ){
+      q->setConf( i+1) += delta * std::pow( alpha[0], i+1 );
     }
-    else{//se aplica el orden real de integrador
-      for ( i = 0; i < q->getDiffOrder(); ++i ){
-        q->setConf( i+1) += delta
-            * std::pow( 1. / (q->getLastStepSize() * b[order-1]), i+1);
-      }
-    }    
-    
     q->setConf( 0, q->getConf(0, 0) + delta );
   }
 
+  /**
+   * Weighted RMS norm of the local error estimate of order p, using the
+   * divided difference of order p+1 over t_n, ..., t_{n-p-1}:
+   * \f$ \frac{1}{(p+1) h \alpha_0^{(p)}} \prod_{j=1}^{p+1}(t_n - t_{n-j}) \, q[t_n, \ldots, t_{n-p-1}] \f$.
+   * @param p Order of the formula.
+   * @param rel_tol Relative tolerance.
+   * @param abs_tol Absolute tolerance.
+   * @return The error relative to the tolerances.
+   */
+  template <class T>
+      double IntegratorBDF<T>::errorNorm( int p, double rel_tol, double abs_tol )
+  {
+    int i, j;
+    double t_n = q->getTime( 0 );
+    double h = t_n - q->getTime( 1 );
+    double alpha_0 = 0., prod = 1.;
+    for ( j = 1; j <= p; ++j )
+      alpha_0 += 1. / ( t_n - q->getTime( j ) );
+    for ( j = 1; j <= p+1; ++j )
+      prod *= t_n - q->getTime( j );
+    // Divided difference weights:
+    double w[7];
+    for ( j = 0; j <= p+1; ++j ){
+      double den = 1.;
+      for ( i = 0; i <= p+1; ++i )
+        if ( i != j ) den *= q->getTime( j ) - q->getTime( i );
+      w[j] = prod / ( (p+1) * h * alpha_0 * den );
+    }
+    const lmx::Vector<T>& q_n = q->getConf( 0 );
+    const lmx::Vector<T>& q_o = q->getConf( 0, 1 );
+    size_type n = q_n.size();
+    double sum = 0., e, scale;
+    for ( size_type l = 0; l < n; ++l ){
+      e = 0.;
+      for ( j = 0; j <= p+1; ++j )
+        e += w[j] * q->getConf( 0, j ).readElement( l );
+      scale = abs_tol + rel_tol * std::max( std::abs( (double)q_n.readElement( l ) ),
+                                           std::abs( (double)q_o.readElement( l ) ) );
+      sum += ( e / scale ) * ( e / scale );
+    }
+    return n ? std::sqrt( sum / n ) : 0.;
+  }
+
+  /**
+   * Local error estimate of the last step, and selection of the order of
+   * the next one in variable order mode.
+   * @param rel_tol Relative tolerance.
+   * @param abs_tol Absolute tolerance.
+   * @param error Weighted RMS norm of the error of the last step.
+   * @param factor Proposed ratio between the next and the last step sizes.
+   * @return FALSE during the first step, where the history is too short.
+   */
+  template <class T>
+      bool IntegratorBDF<T>::estimateError( double rel_tol, double abs_tol, double& error, double& factor )
+  {
+    int history = q->getTimeSize()-1; // steps stored before t_n
+    b_estimated = 1;
+    if ( history < k+1 ) return 0;
+    error = errorNorm( k, rel_tol, abs_tol );
+    factor = ( error > 0. ) ? 0.9 * std::pow( 1. / error, 1. / (k+1) ) : 5.;
+    if ( !b_variable ) return 1;
+
+    ++steps_at_order;
+    int best = k;
+    if ( k > 1 ){
+      double e_down = errorNorm( k-1, rel_tol, abs_tol );
+      double f_down = ( e_down > 0. ) ? 0.9 / 1.3 * std::pow( 1. / e_down, 1. / k ) : 5.;
+      if ( f_down > factor ){ best = k-1; factor = f_down; }
+    }
+    // Raising the order needs a smooth history taken with the current one:
+    if ( error <= 1. && k < order && history >= k+2 && steps_at_order > k ){
+      double e_up = errorNorm( k+1, rel_tol, abs_tol );
+      double f_up = ( e_up > 0. ) ? 0.9 / 1.4 * std::pow( 1. / e_up, 1. / (k+2) ) : 5.;
+      if ( f_up > factor ){ best = k+1; factor = f_up; }
+    }
+    if ( best != k ){
+      k_next = best;
+      steps_at_order = 0;
+    }
+    return 1;
+  }
+
 }; // namespace lmx
 
 
@@ -71,6 +71,23 @@ namespace lmx {
       /** Actualize with delta in actual time-step. */
       void actualize( lmx::Vector<T> delta );
 
+      /**
+       * No own error estimate, the generic one of DiffProblem is used. With
+       * \f$ \beta = 1/6 \f$ the scheme is the linear acceleration method,
+       * so that estimate is always null and the adaptive time step is refused.
+       * @return FALSE.
+       */
+      bool estimateError( double, double, double&, double& )
+      {
+        if ( std::abs( beta - 1./6. ) < 1E-12 ){
+          std::stringstream message;
+          message << "Error in IntegratorNEWMARK: the error estimate is null with beta = 1/6, "
+              << "the adaptive time step can not be used." << endl;
+          LMX_THROW(failure_error, message.str() );
+        }
+        return 0;
+      }
+
       /** Calculates the factor \f$ \frac{\partial qdot_n}{\partial q_n} \f$. */
       double getPartialQdot( )
       {
@@ -0,0 +1,278 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LMXINTEGRATOR_RK_H
+#define LMXINTEGRATOR_RK_H
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_diff_integrator_rk.h
+
+      \brief IntegratorRK class implementation
+
+      Implements explicit Runge-Kutta integrators, with embedded error estimation, for solving dynamic systems.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+#include<cmath>
+#include<vector>
+
+#include"lmx_diff_integrator_base.h"
+
+namespace lmx {
+
+    /**
+    \class IntegratorRK
+    \brief Template class IntegratorRK.
+    Explicit Runge-Kutta integrator implementation for ODE systems.
+
+    Available methods:
+    - 0 = classical RK4 (no error estimate).
+    - 1 = Bogacki-Shampine 3(2), with first same as last stage.
+    - 2 = Dormand-Prince 5(4), with first same as last stage.
+
+    Second order systems are integrated as first order systems in
+    \f$ (q, \dot{q}) \f$. The first stage reuses the derivative stored at
+    the beginning of the step and, in the FSAL methods, the last stage is
+    the evaluation at the end of the step, so a Dormand-Prince step costs
+    six evaluations. All the stage vectors are allocated in initialize().
+
+    The embedded pairs give the error estimate for the adaptive time step
+    of DiffProblem; with RK4 the generic estimate of DiffProblem is used.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <class T> class IntegratorRK : public IntegratorBase<T>
+{
+  public:
+
+    /** Empty constructor. */
+    IntegratorRK(){}
+
+    IntegratorRK( int method );
+
+    /** Destructor. */
+    ~IntegratorRK(){}
+
+    void initialize( Configuration<T>* );
+
+    /** Returns 1 (TRUE) if it is an explicit-scheme integrator. */
+    bool isExplicit()
+    { return 1; }
+
+    void advance( );
+
+    bool estimateError( double rel_tol, double abs_tol, double& error, double& factor );
+
+    /** @param evaluator_in Object that evaluates the stages. */
+    void setEvaluator( StageEvaluator<T>* evaluator_in )
+    { evaluator = evaluator_in; }
+
+    /** Returns 1 (TRUE) for FSAL methods. */
+    bool evaluatesEnd( )
+    { return fsal; }
+
+  private:
+    int stages; /**< Number of stages.*/
+    int order; /**< Order of the error estimate, error = O(h^(order+1)).*/
+    bool fsal; /**< First same as last.*/
+    bool embedded; /**< 1 if the method has an error estimate.*/
+    T a[7][7]; /**< Runge-Kutta matrix.*/
+    T b[7]; /**< Weights of the solution.*/
+    T e[7]; /**< Weights of the error estimate (solution minus embedded solution).*/
+    T c[7]; /**< Stage times.*/
+    int n_conf; /**< Number of integrated configurations (system's differential order).*/
+    std::vector< std::vector< lmx::Vector<T> > > k; /**< Stage derivatives, k[order][stage].*/
+    std::vector< lmx::Vector<T> > stage; /**< Stage configuration.*/
+    Configuration<T>* theConfiguration;
+    StageEvaluator<T>* evaluator;
+
+};
+
+}; // namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+namespace lmx {
+
+  template <class T> IntegratorRK<T>::IntegratorRK( int method )
+    : evaluator(0)
+      /**
+       * Standard constructor.
+       * @param method 0 = RK4, 1 = Bogacki-Shampine 3(2), 2 = Dormand-Prince 5(4).
+       */
+  {
+    int i, j;
+    for ( i = 0; i < 7; ++i ){
+      b[i] = e[i] = c[i] = 0.;
+      for ( j = 0; j < 7; ++j ) a[i][j] = 0.;
+    }
+    switch ( method ){
+      case 0 : // RK4
+        stages = 4; order = 4; fsal = 0; embedded = 0;
+        c[1] = .5; c[2] = .5; c[3] = 1.;
+        a[1][0] = .5;
+        a[2][1] = .5;
+        a[3][2] = 1.;
+        b[0] = 1./6.; b[1] = 1./3.; b[2] = 1./3.; b[3] = 1./6.;
+        break;
+
+      case 1 : // Bogacki-Shampine 3(2)
+        stages = 4; order = 2; fsal = 1; embedded = 1;
+        c[1] = .5; c[2] = .75; c[3] = 1.;
+        a[1][0] = .5;
+        a[2][1] = .75;
+        a[3][0] = 2./9.; a[3][1] = 1./3.; a[3][2] = 4./9.;
+        b[0] = 2./9.; b[1] = 1./3.; b[2] = 4./9.;
+        e[0] = -5./72.; e[1] = 1./12.; e[2] = 1./9.; e[3] = -1./8.;
+        break;
+
+      case 2 : // Dormand-Prince 5(4)
+        stages = 7; order = 4; fsal = 1; embedded = 1;
+        c[1] = 1./5.; c[2] = 3./10.; c[3] = 4./5.; c[4] = 8./9.; c[5] = 1.; c[6] = 1.;
+        a[1][0] = 1./5.;
+        a[2][0] = 3./40.; a[2][1] = 9./40.;
+        a[3][0] = 44./45.; a[3][1] = -56./15.; a[3][2] = 32./9.;
+        a[4][0] = 19372./6561.; a[4][1] = -25360./2187.; a[4][2] = 64448./6561.;
+        a[4][3] = -212./729.;
+        a[5][0] = 9017./3168.; a[5][1] = -355./33.; a[5][2] = 46732./5247.;
+        a[5][3] = 49./176.; a[5][4] = -5103./18656.;
+        a[6][0] = 35./384.; a[6][2] = 500./1113.; a[6][3] = 125./192.;
+        a[6][4] = -2187./6784.; a[6][5] = 11./84.;
+        for ( j = 0; j < 6; ++j ) b[j] = a[6][j];
+        e[0] = 71./57600.; e[2] = -71./16695.; e[3] = 71./1920.;
+        e[4] = -17253./339200.; e[5] = 22./525.; e[6] = -1./40.;
+        break;
+
+      default :
+      {
+        std::stringstream message;
+        message << "Error in IntegratorRK: method " << method << " not implemented." << endl;
+        LMX_THROW(to_be_done_error, message.str() );
+      }
+    }
+  }
+
+
+  template <class T>
+      void IntegratorRK<T>::initialize( Configuration<T>* configuration_in )
+    /**
+     * Stores the beginning of the step and allocates the stage vectors.
+     * @param configuration_in
+     */
+  {
+    theConfiguration = configuration_in;
+    theConfiguration->setStoredSteps( 2, 2, 2 );
+    n_conf = theConfiguration->getDiffOrder();
+    size_type n = theConfiguration->getConf(0).size();
+    k.assign( n_conf, std::vector< lmx::Vector<T> >( stages, lmx::Vector<T>( n ) ) );
+    stage.assign( n_conf, lmx::Vector<T>( n ) );
+  }
+
+  template <class T>
+      void IntegratorRK<T>::advance( )
+      /**
+       * Advances to next time-step, evaluating the stages.
+       */
+  {
+    if ( !evaluator ){
+      std::stringstream message;
+      message << "Error in IntegratorRK: no StageEvaluator has been set." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    int i, j, l;
+    int top = n_conf - 1;
+    T h = theConfiguration->getLastStepSize();
+    double t_o = theConfiguration->getTime( 1 );
+
+    // First stage, the derivatives at the beginning of the step:
+    for ( i = 0; i < n_conf; ++i )
+      k[i][0] = theConfiguration->getConf( i+1, 1 );
+
+    for ( j = 1; j < stages; ++j ){
+      for ( i = 0; i < n_conf; ++i ){
+        stage[i] = theConfiguration->getConf( i, 1 );
+        for ( l = 0; l < j; ++l )
+          if ( a[j][l] != 0. ) stage[i].axpy( h*a[j][l], k[i][l] );
+      }
+      for ( i = 0; i < top; ++i )
+        k[i][j] = stage[i+1];
+      evaluator->evaluateStage( k[top][j], stage[0], stage[top > 0 ? 1 : 0],
+                                t_o + c[j]*h );
+    }
+
+    if ( fsal ){ // The last stage is the end of the step:
+      for ( i = 0; i < n_conf; ++i )
+        theConfiguration->setConf( i ) = stage[i];
+      theConfiguration->setConf( n_conf ) = k[top][stages-1];
+    }
+    else{
+      for ( i = 0; i < n_conf; ++i ){
+        lmx::Vector<T>& q_n = theConfiguration->setConf( i );
+        q_n = theConfiguration->getConf( i, 1 );
+        for ( l = 0; l < stages; ++l )
+          if ( b[l] != 0. ) q_n.axpy( h*b[l], k[i][l] );
+      }
+    }
+  }
+
+  template <class T>
+      bool IntegratorRK<T>::estimateError( double rel_tol, double abs_tol, double& error, double& factor )
+      /**
+       * Weighted RMS norm of the difference between the solution and the
+       * embedded one, over all the integrated configurations.
+       * @param rel_tol Relative tolerance.
+       * @param abs_tol Absolute tolerance.
+       * @param error Weighted RMS norm of the error of the last step.
+       * @param factor Proposed ratio between the next and the last step sizes.
+       * @return FALSE if the method has no embedded estimate.
+       */
+  {
+    if ( !embedded ) return 0;
+    int i, l;
+    T h = theConfiguration->getLastStepSize();
+    size_type n = theConfiguration->getConf(0).size();
+    double sum = 0., err, scale;
+    for ( i = 0; i < n_conf; ++i ){
+      const lmx::Vector<T>& q_n = theConfiguration->getConf( i, 0 );
+      const lmx::Vector<T>& q_o = theConfiguration->getConf( i, 1 );
+      for ( size_type m = 0; m < n; ++m ){
+        err = 0.;
+        for ( l = 0; l < stages; ++l )
+          if ( e[l] != 0. ) err += e[l] * k[i][l].readElement( m );
+        err *= h;
+        scale = abs_tol + rel_tol * std::max( std::abs( (double)q_n.readElement( m ) ),
+                                             std::abs( (double)q_o.readElement( m ) ) );
+        sum += ( err / scale ) * ( err / scale );
+      }
+    }
+    error = ( n*n_conf > 0 ) ? std::sqrt( sum / ( n*n_conf ) ) : 0.;
+    factor = ( error > 0. ) ? 0.9 * std::pow( 1. / error, 1. / (order+1) ) : 5.;
+    return 1;
+  }
+
+}; // namespace lmx
+
+
+#endif
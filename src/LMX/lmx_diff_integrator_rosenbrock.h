@@ -0,0 +1,300 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LMXINTEGRATOR_ROSENBROCK_H
+#define LMXINTEGRATOR_ROSENBROCK_H
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_diff_integrator_rosenbrock.h
+
+      \brief IntegratorRosenbrock class implementation
+
+      Implements linearly implicit Rosenbrock integrators, with embedded error estimation, for solving first order stiff systems.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+#include<cmath>
+#include<vector>
+#include<limits>
+
+#include"lmx_diff_integrator_base.h"
+
+namespace lmx {
+
+    /**
+    \class IntegratorRosenbrock
+    \brief Template class IntegratorRosenbrock.
+    Rosenbrock integrator implementation for first order stiff ODE systems.
+
+    Each step builds one matrix, \f$ W = \frac{1}{h\gamma} I - J \f$, with
+    the Jacobian function of the DiffProblemFirst (called with
+    \f$ \partial \dot{q} / \partial q = 1/(h\gamma) \f$), factorizes it once
+    and solves one linear system per stage reusing the factorization. No
+    Newton iterations are done, so the scheme is treated as explicit by
+    DiffProblem and the system is evaluated with its evaluation function,
+    \f$ \dot{q} = f(q,t) \f$. The time derivative of f is approximated by
+    finite differences with one additional evaluation per step.
+
+    Available methods (stages in the form of Hairer and Wanner):
+    - 0 = ROS2, order 2(1), L-stable (Verwer et al.).
+    - 1 = ROS3, order 3(2), L-stable (Sandu et al.).
+    - 2 = RODAS3, order 3(2), stiffly accurate (Sandu et al.).
+
+    The embedded solutions give the error estimate for the adaptive time
+    step of DiffProblem.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <class T> class IntegratorRosenbrock : public IntegratorBase<T>
+{
+  public:
+
+    /** Empty constructor. */
+    IntegratorRosenbrock(){}
+
+    IntegratorRosenbrock( int method );
+
+    /** Destructor. */
+    ~IntegratorRosenbrock()
+    { delete solver; }
+
+    void initialize( Configuration<T>* );
+
+    /** Returns 1 (TRUE) if it is an explicit-scheme integrator. */
+    bool isExplicit()
+    { return 1; }
+
+    void advance( );
+
+    bool estimateError( double rel_tol, double abs_tol, double& error, double& factor );
+
+    /** @param evaluator_in Object that evaluates the stages and the Jacobian. */
+    void setEvaluator( StageEvaluator<T>* evaluator_in )
+    { evaluator = evaluator_in; }
+
+  private:
+    int stages; /**< Number of stages.*/
+    int order; /**< Order of the error estimate, error = O(h^order).*/
+    T gamma; /**< Diagonal coefficient.*/
+    T a[4][4]; /**< Stage configuration coefficients.*/
+    T c[4][4]; /**< Coupling coefficients of the previous stages.*/
+    T m[4]; /**< Weights of the solution.*/
+    T e[4]; /**< Weights of the error estimate.*/
+    T alpha[4]; /**< Stage times.*/
+    T gamma_i[4]; /**< Coefficients of the time derivative.*/
+    std::vector< lmx::Vector<T> > k; /**< Stage increments.*/
+    lmx::Vector<T> stage; /**< Stage configuration.*/
+    lmx::Vector<T> rhs; /**< Stage right hand side.*/
+    lmx::Vector<T> increment; /**< Solution of the stage systems.*/
+    lmx::Vector<T> f_t; /**< Time derivative of the evaluation function.*/
+    lmx::Matrix<T> W; /**< Iteration matrix.*/
+    lmx::LinearSystem<T>* solver; /**< Keeps the factorization of W.*/
+    Configuration<T>* theConfiguration;
+    StageEvaluator<T>* evaluator;
+
+};
+
+}; // namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+namespace lmx {
+
+  template <class T> IntegratorRosenbrock<T>::IntegratorRosenbrock( int method )
+    : solver(0), evaluator(0)
+      /**
+       * Standard constructor.
+       * @param method 0 = ROS2, 1 = ROS3, 2 = RODAS3.
+       */
+  {
+    int i, j;
+    for ( i = 0; i < 4; ++i ){
+      m[i] = e[i] = alpha[i] = gamma_i[i] = 0.;
+      for ( j = 0; j < 4; ++j ) a[i][j] = c[i][j] = 0.;
+    }
+    switch ( method ){
+      case 0 : // ROS2
+        stages = 2; order = 2;
+        gamma = 1. + 1. / std::sqrt( 2. );
+        a[1][0] = 1. / gamma;
+        c[1][0] = -2. / gamma;
+        m[0] = 1.5 / gamma; m[1] = .5 / gamma;
+        e[0] = .5 / gamma; e[1] = .5 / gamma;
+        alpha[1] = 1.;
+        gamma_i[0] = gamma; gamma_i[1] = -gamma;
+        break;
+
+      case 1 : // ROS3
+        stages = 3; order = 3;
+        gamma = 0.43586652150845899941601945119356;
+        a[1][0] = 1.; a[2][0] = 1.;
+        c[1][0] = -0.10156171083877702091975600115545E+01;
+        c[2][0] = 0.40759956452537699824805835358067E+01;
+        c[2][1] = 0.92076794298330791242156818474003E+01;
+        m[0] = 1.;
+        m[1] = 0.61697947043828245592553615689730E+01;
+        m[2] = -0.42772256543218573326238373806514;
+        e[0] = 0.5;
+        e[1] = -0.29079558716805469821718236208017E+01;
+        e[2] = 0.22354069897811569627360909276199;
+        alpha[1] = gamma; alpha[2] = gamma;
+        gamma_i[0] = gamma;
+        gamma_i[1] = 0.24291996454816804366592249683314;
+        gamma_i[2] = 0.21851380027664058511513169485832E+01;
+        break;
+
+      case 2 : // RODAS3
+        stages = 4; order = 3;
+        gamma = .5;
+        a[2][0] = 2.; a[3][0] = 2.; a[3][2] = 1.;
+        c[1][0] = 4.;
+        c[2][0] = 1.; c[2][1] = -1.;
+        c[3][0] = 1.; c[3][1] = -1.; c[3][2] = -8./3.;
+        m[0] = 2.; m[2] = 1.; m[3] = 1.;
+        e[3] = 1.;
+        alpha[2] = 1.; alpha[3] = 1.;
+        gamma_i[0] = .5; gamma_i[1] = 1.5;
+        break;
+
+      default :
+      {
+        std::stringstream message;
+        message << "Error in IntegratorRosenbrock: method " << method << " not implemented." << endl;
+        LMX_THROW(to_be_done_error, message.str() );
+      }
+    }
+  }
+
+
+  template <class T>
+      void IntegratorRosenbrock<T>::initialize( Configuration<T>* configuration_in )
+    /**
+     * Allocates the stage vectors, the matrix and its linear system.
+     * @param configuration_in
+     */
+  {
+    theConfiguration = configuration_in;
+    if ( theConfiguration->getDiffOrder() != 1 ){
+      std::stringstream message;
+      message << "Differential system must be a first order to apply this method." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    theConfiguration->setStoredSteps( 2, 2, 2 );
+    size_type n = theConfiguration->getConf(0).size();
+    k.assign( stages, lmx::Vector<T>( n ) );
+    stage.resize( n );
+    rhs.resize( n );
+    increment.resize( n );
+    f_t.resize( n );
+    W.resize( n, n );
+    delete solver;
+    solver = new lmx::LinearSystem<T>( W, increment, rhs );
+  }
+
+  template <class T>
+      void IntegratorRosenbrock<T>::advance( )
+      /**
+       * Advances to next time-step: one Jacobian and one factorization,
+       * and a back substitution for each stage.
+       */
+  {
+    if ( !evaluator ){
+      std::stringstream message;
+      message << "Error in IntegratorRosenbrock: no StageEvaluator has been set." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    int i, j;
+    T h = theConfiguration->getLastStepSize();
+    double t_o = theConfiguration->getTime( 1 );
+    const lmx::Vector<T>& q_o = theConfiguration->getConf( 0, 1 );
+    const lmx::Vector<T>& f_o = theConfiguration->getConf( 1, 1 );
+
+    evaluator->evaluateTangent( W, q_o, 1. / ( h*gamma ), t_o );
+
+    // Time derivative of f by forward differences:
+    double dt = std::sqrt( std::numeric_limits<double>::epsilon() )
+              * std::max( 1E-5, std::abs( t_o ) );
+    evaluator->evaluateStage( f_t, q_o, q_o, t_o + dt );
+    f_t -= f_o;
+    f_t *= (T)( 1. / dt );
+
+    for ( i = 0; i < stages; ++i ){
+      bool new_stage = ( alpha[i] != 0. );
+      for ( j = 0; j < i; ++j )
+        if ( a[i][j] != 0. ) new_stage = 1;
+      if ( new_stage ){
+        stage = q_o;
+        for ( j = 0; j < i; ++j )
+          if ( a[i][j] != 0. ) stage.axpy( a[i][j], k[j] );
+        evaluator->evaluateStage( rhs, stage, stage, t_o + alpha[i]*h );
+      }
+      else rhs = f_o;
+      for ( j = 0; j < i; ++j )
+        if ( c[i][j] != 0. ) rhs.axpy( c[i][j] / h, k[j] );
+      if ( gamma_i[i] != 0. ) rhs.axpy( h*gamma_i[i], f_t );
+      solver->solveYourself( i > 0 ); // Only the first stage factorizes W
+      k[i] = increment;
+    }
+
+    lmx::Vector<T>& q_n = theConfiguration->setConf( 0 );
+    q_n = q_o;
+    for ( i = 0; i < stages; ++i )
+      if ( m[i] != 0. ) q_n.axpy( m[i], k[i] );
+  }
+
+  template <class T>
+      bool IntegratorRosenbrock<T>::estimateError( double rel_tol, double abs_tol, double& error, double& factor )
+      /**
+       * Weighted RMS norm of the difference between the solution and the
+       * embedded one.
+       * @param rel_tol Relative tolerance.
+       * @param abs_tol Absolute tolerance.
+       * @param error Weighted RMS norm of the error of the last step.
+       * @param factor Proposed ratio between the next and the last step sizes.
+       * @return TRUE, all the methods have an embedded solution.
+       */
+  {
+    int i;
+    const lmx::Vector<T>& q_n = theConfiguration->getConf( 0, 0 );
+    const lmx::Vector<T>& q_o = theConfiguration->getConf( 0, 1 );
+    size_type n = q_n.size();
+    double sum = 0., err, scale;
+    for ( size_type l = 0; l < n; ++l ){
+      err = 0.;
+      for ( i = 0; i < stages; ++i )
+        if ( e[i] != 0. ) err += e[i] * k[i].readElement( l );
+      scale = abs_tol + rel_tol * std::max( std::abs( (double)q_n.readElement( l ) ),
+                                           std::abs( (double)q_o.readElement( l ) ) );
+      sum += ( err / scale ) * ( err / scale );
+    }
+    error = n ? std::sqrt( sum / n ) : 0.;
+    factor = ( error > 0. ) ? 0.9 * std::pow( 1. / error, 1. / order ) : 5.;
+    return 1;
+  }
+
+}; // namespace lmx
+
+
+#endif
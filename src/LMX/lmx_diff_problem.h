@@ -37,11 +37,14 @@
     */
 //////////////////////////////////////////// Doxygen file documentation (end)
 #include <map>
+#include <cmath>
 #include "lmx_diff_configuration.h"
 #include "lmx_diff_integrator_ab.h"
 #include "lmx_diff_integrator_am.h"
 #include "lmx_diff_integrator_bdf.h"
 #include "lmx_diff_integrator_centraldiff.h"
+#include "lmx_diff_integrator_rk.h"
+#include "lmx_diff_integrator_rosenbrock.h"
 
 namespace lmx {
 
@@ -51,20 +54,25 @@ namespace lmx {
     Implementation for ODE system solvers.
     
   This class implements methods for defining and solving initial value problems described by a TotalDiff class' derivided object, and initial conditions in the form \f$ \dot{q}(t_o) = \dot{q}_o \f$,  \f$ q(t_o) = q_o \f$.
+
+  By default the time step is fixed. setAdaptiveTimeStep() enables the step size control: after each step, the local error is estimated comparing the solution with the trapezoidal rule (first order systems) or with the linear acceleration method (second order systems, as in Zienkiewicz and Xie's estimator), unless the integrator estimates its own error (IntegratorAM, IntegratorBDF and the Runge-Kutta and Rosenbrock ones). Steps with a weighted RMS error over one, or whose non-linear iterations did not converge, are rejected and repeated with a smaller step. The accepted ones set the size of the next step, bounded by the given minimum and maximum. The generic estimate only uses the configuration of the last two steps, so it can be used with the other integrators. It is null for the linear acceleration method, so Newmark's scheme with \f$ \beta = 1/6 \f$ refuses the adaptive time step. The Adams methods keep their fixed step coefficients when the step size changes.
     
     @author Daniel Iglesias Ib��ez.
     */
-template <typename Sys, typename T=double> class DiffProblem{
+template <typename Sys, typename T=double> class DiffProblem : public StageEvaluator<T>{
 
   public:
 
     /** Empty constructor. */
     DiffProblem()
-	 : theConfiguration(0)
+	 : b_steptriggered(0)
+	 , theConfiguration(0)
 	 , theIntegrator(0)
 	 , theNLSolver(0)
 	 , theSystem(0)
-     , b_steptriggered(0)
+     , b_adaptive(0)
+     , steps_accepted(0)
+     , steps_rejected(0)
     {}
 
     /** Destructor. */
@@ -83,6 +91,7 @@ template <typename Sys, typename T=double> class DiffProblem{
     void setInitialConfiguration( lmx::Vector<T>& q_o, lmx::Vector<T>& qdot_o );
     void setOutputFile( char* filename, int diffOrder );
     void setTimeParameters( double to_in, double tf_in, double step_size_in );
+    void setAdaptiveTimeStep( double rel_tol, double abs_tol, double min_step, double max_step );
     void iterationResidue( lmx::Vector<T>& residue, lmx::Vector<T>& q_actual );
 	void setStepTriggered( void (Sys::* stepTriggered_in)() );
 	// needs documentation:
@@ -93,6 +102,18 @@ template <typename Sys, typename T=double> class DiffProblem{
 	const lmx::Vector<T>& getConfiguration( int order, int step=0)
 	{ return theConfiguration->getConf( order, step ); }
 
+    /**
+     * @return Number of accepted steps with adaptive time step.
+     */
+    int getAcceptedSteps( )
+    { return steps_accepted; }
+
+    /**
+     * @return Number of rejected steps with adaptive time step.
+     */
+    int getRejectedSteps( )
+    { return steps_rejected; }
+
     /**
      * Solve method to be implemented in derived classes.
      */
@@ -100,6 +121,9 @@ template <typename Sys, typename T=double> class DiffProblem{
 
   protected:
     void writeStepFiles();
+    bool nextStepSize( double& );
+    bool checkStep( bool );
+    double stepError( );
 
   private:
     virtual void solveExplicit( ) = 0;
@@ -115,6 +139,13 @@ template <typename Sys, typename T=double> class DiffProblem{
     double tf; ///< Value of the finish time stored from input.
     double stepSize; ///< Value of the time step stored from input.
 	double epsilon; ///< Value for L2 convergence.
+    bool b_adaptive; ///< 1 if the time step is adaptive.
+    double tol_rel; ///< Relative tolerance of the local error.
+    double tol_abs; ///< Absolute tolerance of the local error.
+    double step_min; ///< Minimum time step.
+    double step_max; ///< Maximum time step.
+    int steps_accepted; ///< Number of accepted steps.
+    int steps_rejected; ///< Number of rejected steps.
     std::map< int, std::ofstream* > fileOutMap; ///< collection of output streams for each diff-order requested.
     void (Sys::* stepTriggered)(); ///< function called at the end of each time step
 };
@@ -140,13 +171,21 @@ template <typename Sys, typename T>
       theIntegrator = new IntegratorAM<T>( opt1 );
     break;
       
-    case 2 : // integrator == 2 -> BDF
-      theIntegrator = new IntegratorBDF<T>( opt1 );
+    case 2 : // integrator == 2 -> BDF, opt2 == 1 for variable order
+      theIntegrator = new IntegratorBDF<T>( opt1, opt2 );
     break;
     
     case 3 : // integrator == 2 -> BDF
       theIntegrator = new IntegratorCentralDifference<T>( );
     break;
+
+    case 4 : // integrator == 4 -> explicit Runge-Kutta
+      theIntegrator = new IntegratorRK<T>( opt1 );
+    break;
+
+    case 5 : // integrator == 5 -> Rosenbrock
+      theIntegrator = new IntegratorRosenbrock<T>( opt1 );
+    break;
     
   }
 
@@ -175,7 +214,14 @@ template <typename Sys, typename T>
   else if (!strcmp(type, "BDF-3")) theIntegrator = new IntegratorBDF<T>( 3 );
   else if (!strcmp(type, "BDF-4")) theIntegrator = new IntegratorBDF<T>( 4 );
   else if (!strcmp(type, "BDF-5")) theIntegrator = new IntegratorBDF<T>( 5 );
+  else if (!strcmp(type, "BDF")) theIntegrator = new IntegratorBDF<T>( 5, 1 );
   else if (!strcmp(type, "CD")) theIntegrator = new IntegratorCentralDifference<T>( );
+  else if (!strcmp(type, "RK4")) theIntegrator = new IntegratorRK<T>( 0 );
+  else if (!strcmp(type, "BS32")) theIntegrator = new IntegratorRK<T>( 1 );
+  else if (!strcmp(type, "DP54")) theIntegrator = new IntegratorRK<T>( 2 );
+  else if (!strcmp(type, "ROS2")) theIntegrator = new IntegratorRosenbrock<T>( 0 );
+  else if (!strcmp(type, "ROS3")) theIntegrator = new IntegratorRosenbrock<T>( 1 );
+  else if (!strcmp(type, "RODAS3")) theIntegrator = new IntegratorRosenbrock<T>( 2 );
 }
 
 /**
@@ -243,6 +289,124 @@ template <typename Sys, typename T>
   this->stepSize = step_size_in;
 }
 
+  /**
+   * Enables the adaptive time step. The step given in setTimeParameters()
+   * is used as the first trial step.
+   *
+   * @param rel_tol Relative tolerance of the local error.
+   * @param abs_tol Absolute tolerance of the local error.
+   * @param min_step Minimum time step. Steps of this size are always accepted.
+   * @param max_step Maximum time step.
+   */
+template <typename Sys, typename T>
+    void DiffProblem<Sys,T>::setAdaptiveTimeStep( double rel_tol, double abs_tol, double min_step, double max_step )
+{
+  if ( min_step <= 0. || max_step < min_step ){
+    std::stringstream message;
+    message << "Error in DiffProblem: wrong time step bounds (" << min_step
+        << ", " << max_step << ")." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  this->b_adaptive = 1;
+  this->tol_rel = rel_tol;
+  this->tol_abs = abs_tol;
+  this->step_min = min_step;
+  this->step_max = max_step;
+}
+
+/**
+ * Size of the next adaptive step, bounded by the limits and shortened to
+ * finish exactly at the end time.
+ * @param h Size of the next step.
+ * @return FALSE if the end time has been reached.
+ */
+template <typename Sys, typename T>
+    bool DiffProblem<Sys,T>::nextStepSize( double& h )
+{
+  double remaining = tf - theConfiguration->getTime();
+  if ( remaining <= 1E-12 * (tf - to) ) return 0;
+  if ( stepSize < step_min ) stepSize = step_min;
+  if ( stepSize > step_max ) stepSize = step_max;
+  h = stepSize;
+  // Avoids leaving a tiny last step:
+  if ( 1.1 * h >= remaining ) h = remaining;
+  return 1;
+}
+
+/**
+ * Weighted RMS norm of the local error estimate of the last step.
+ * For first order systems it is the difference with the trapezoidal rule,
+ * \f$ q_n - q_{n-1} - \frac{h}{2}(\dot{q}_{n-1} + \dot{q}_n) \f$, and
+ * for second order systems with the linear acceleration method,
+ * \f$ q_n - q_{n-1} - h\dot{q}_{n-1} - \frac{h^2}{6}(2\ddot{q}_{n-1} + \ddot{q}_n) \f$.
+ * @return The error relative to the tolerances.
+ */
+template <typename Sys, typename T>
+    double DiffProblem<Sys,T>::stepError( )
+{
+  double h = theConfiguration->getLastStepSize();
+  const lmx::Vector<T>& q_n = theConfiguration->getConf( 0 );
+  const lmx::Vector<T>& q_o = theConfiguration->getStepStart( 0 );
+  const lmx::Vector<T>& v_n = theConfiguration->getConf( 1 );
+  const lmx::Vector<T>& v_o = theConfiguration->getStepStart( 1 );
+  bool second = theConfiguration->getDiffOrder() > 1;
+  size_type n = q_n.size();
+  double sum = 0., e, scale;
+  for ( size_type i = 0; i < n; ++i ){
+    if ( second )
+      e = q_n.readElement(i) - q_o.readElement(i) - h * v_o.readElement(i)
+          - h * h / 6. * ( 2. * theConfiguration->getStepStart( 2 ).readElement(i)
+                           + theConfiguration->getConf( 2 ).readElement(i) );
+    else
+      e = q_n.readElement(i) - q_o.readElement(i)
+          - 0.5 * h * ( v_o.readElement(i) + v_n.readElement(i) );
+    scale = tol_abs + tol_rel * std::max( std::abs( (double)q_n.readElement(i) ),
+                                         std::abs( (double)q_o.readElement(i) ) );
+    sum += ( e / scale ) * ( e / scale );
+  }
+  return n ? std::sqrt( sum / n ) : 0.;
+}
+
+/**
+ * Accepts or rejects the last step, and sets the size of the next one.
+ * A rejected step is undone in the Configuration.
+ * @param converged FALSE if the iterations of the step did not converge.
+ * @return TRUE if the step is accepted.
+ */
+template <typename Sys, typename T>
+    bool DiffProblem<Sys,T>::checkStep( bool converged )
+{
+  double h = theConfiguration->getLastStepSize();
+  bool at_min = h <= step_min * (1. + 1E-10);
+  double error = 0., factor = 0.25;
+  if ( converged && !theIntegrator->estimateError( tol_rel, tol_abs, error, factor ) ){
+    error = this->stepError();
+    // The estimator is second order for first order systems and third order
+    // for second order systems:
+    double exponent = theConfiguration->getDiffOrder() > 1 ? 1./3. : 1./2.;
+    factor = ( error == 0. ) ? 5. : 0.9 * std::pow( 1. / error, exponent );
+  }
+  bool accept = ( converged && error <= 1. ) || at_min;
+  if ( factor > 5. ) factor = 5.;
+  if ( factor < 0.2 ) factor = 0.2;
+  if ( !accept && factor > 1. ) factor = 1.;
+  stepSize = h * factor;
+  if ( stepSize < step_min ) stepSize = step_min;
+  if ( stepSize > step_max ) stepSize = step_max;
+
+  if ( accept ){
+    ++steps_accepted;
+    if ( at_min && ( !converged || error > 1. ) )
+      cout << ":::WARNING::: Step accepted with the minimum time step size, error = "
+           << error << endl;
+  }
+  else{
+    ++steps_rejected;
+    theConfiguration->rejectStep();
+  }
+  return accept;
+}
+
 /**
  * When the configuration advances, this method is invoked for writing the requested diff-order values.
  */
@@ -106,6 +106,16 @@ class DiffProblemFirst
 
     bool iterationConvergence( lmx::Vector<T>& q_actual );
 
+    void evaluateStage( lmx::Vector<T>& qdot,
+                        const lmx::Vector<T>& q,
+                        const lmx::Vector<T>& unused,
+                        double time );
+
+    void evaluateTangent( lmx::Matrix<T>& tangent,
+                          const lmx::Vector<T>& q,
+                          double partial_qdot,
+                          double time );
+
     void solve( );
 
   private:
@@ -267,6 +277,38 @@ template <typename Sys, typename T>
 }
 
 
+/**
+ * Evaluation of the first derivative for multi-stage integrators. The third
+ * argument is only used by second order systems.
+ * @param qdot First derivative.
+ * @param q Configuration.
+ * @param time Time of the evaluation.
+ */
+template <typename Sys, typename T>
+    void DiffProblemFirst<Sys,T>::evaluateStage( lmx::Vector<T>& qdot,
+                                                 const lmx::Vector<T>& q,
+                                                 const lmx::Vector<T>&,
+                                                 double time )
+{
+  (this->theSystem->*eval)( q, qdot, time );
+}
+
+/**
+ * Evaluation of the Jacobian function for linearly implicit integrators.
+ * @param tangent Tangent matrix.
+ * @param q Configuration.
+ * @param partial_qdot Factor \f$ \frac{\partial qdot}{\partial q} \f$.
+ * @param time Time of the evaluation.
+ */
+template <typename Sys, typename T>
+    void DiffProblemFirst<Sys,T>::evaluateTangent( lmx::Matrix<T>& tangent,
+                                                   const lmx::Vector<T>& q,
+                                                   double partial_qdot,
+                                                   double time )
+{
+  (this->theSystem->*jac)( tangent, q, partial_qdot, time );
+}
+
 /**
  * Solve main function
  */
@@ -274,7 +316,9 @@ template <typename Sys, typename T>
     void DiffProblemFirst<Sys,T>::solve( )
 {
   this->theConfiguration->setTime( this->to );
+  this->theIntegrator->setEvaluator( this );
   this->theIntegrator->initialize( this->theConfiguration );
+  if ( this->b_adaptive ) this->theConfiguration->enableStepRejection();
   if ( this->theIntegrator->isExplicit() )
     this->solveExplicit();
   else this->solveImplicit();
@@ -286,12 +330,35 @@ template <typename Sys, typename T>
 template <typename Sys, typename T>
     void DiffProblemFirst<Sys,T>::solveExplicit( )
 {
-  int max = (int)( (this->tf - this->to) / this->stepSize );
-  for ( int i=0; i<max; ++i){
+  if ( this->b_adaptive ){
+    double h;
     (this->theSystem->*eval)( this->theConfiguration->getConf(0),
                               this->theConfiguration->setConf(1),
                               this->theConfiguration->getTime( )
-                      );
+                            );
+    this->writeStepFiles();
+    while ( this->nextStepSize( h ) ){
+      this->theConfiguration->nextStep( h );
+      this->theIntegrator->advance( );
+      // The derivative at the end of the step is needed by the error estimate:
+      if ( !this->theIntegrator->evaluatesEnd() )
+        (this->theSystem->*eval)( this->theConfiguration->getConf(0),
+                                  this->theConfiguration->setConf(1),
+                                  this->theConfiguration->getTime( )
+                                );
+      if ( !this->checkStep( 1 ) ) continue;
+      this->writeStepFiles();
+      if(this->b_steptriggered) (this->theSystem->*stepTriggered)( );
+    }
+    return;
+  }
+  int max = (int)( (this->tf - this->to) / this->stepSize );
+  for ( int i=0; i<max; ++i){
+    if ( i == 0 || !this->theIntegrator->evaluatesEnd() )
+      (this->theSystem->*eval)( this->theConfiguration->getConf(0),
+                                this->theConfiguration->setConf(1),
+                                this->theConfiguration->getTime( )
+                        );
     this->writeStepFiles();
     this->theConfiguration->nextStep( this->stepSize );
     this->theIntegrator->advance( );
@@ -323,6 +390,19 @@ template <typename Sys, typename T>
   theNLSolver.setResidue( &DiffProblemFirst<Sys,T>::iterationResidue ); // Also advances the integrator
   theNLSolver.setJacobian( &DiffProblemFirst<Sys,T>::iterationJacobian );
 
+  if ( this->b_adaptive ){
+    double h;
+    this->writeStepFiles();
+    while ( this->nextStepSize( h ) ){
+      this->theConfiguration->nextStep( h );
+      this->theIntegrator->advance( );
+      theNLSolver.solve( 20 );
+      if ( !this->checkStep( theNLSolver.isConverged() ) ) continue;
+      this->writeStepFiles();
+      if(this->b_steptriggered) (this->theSystem->*stepTriggered)( );
+    }
+    return;
+  }
   for ( int i=0; i<max; ++i){
     this->writeStepFiles();
     this->theConfiguration->nextStep( this->stepSize );
@@ -39,6 +39,7 @@
 
 #include "lmx_diff_problem.h"
 #include "lmx_diff_integrator_newmark.h"
+#include "lmx_diff_integrator_alpha.h"
 
 namespace lmx {
 
@@ -64,6 +65,7 @@ class DiffProblemSecond
        , b_jacobianByParts(0)
        , b_alpha(0)
        , b_convergence(0)
+       , precond(0)
     {}
 
     /** Destructor. */
@@ -189,11 +191,27 @@ class DiffProblemSecond
 
     bool iterationConvergence( lmx::Vector<T>& q_actual );
 
+    void evaluateStage( lmx::Vector<T>& qddot,
+                        const lmx::Vector<T>& q,
+                        const lmx::Vector<T>& qdot,
+                        double time );
+
+    /**
+     * Sets the preconditioner of the iterative linear solvers of the implicit
+     * scheme. The same object is used in all the time steps, so an
+     * AmgPrecond keeps its hierarchy and only updates its values.
+     * @param precond_in Preconditioner (not deleted by the DiffProblem).
+     */
+    void setPreconditioner( lmx::LinearOperator<T>* precond_in )
+    { precond = precond_in; }
+
     void solve( );
 
   private:
     void solveExplicit( );
     void solveImplicit( );
+    const lmx::Vector<T>& residueConf( int order );
+    double residueTime( );
 
   private:
     bool b_solveInitialEquilibrium; ///< default TRUE.
@@ -201,6 +219,7 @@ class DiffProblemSecond
     bool b_jacobianByParts; ///< 0 if setJacobian is called, 1 if setJacobianByParts is called.
     bool b_alpha; ///< 1 if HHT-alpha integrator is set.
     bool b_convergence; ///< 1 if external convergence function is set.
+    lmx::LinearOperator<T>* precond; ///< Preconditioner of the implicit linear systems.
     double alpha;
     std::vector< lmx::Vector<T>* > residueParts;
     std::vector< lmx::Matrix<T>* > jacobianParts;
@@ -365,8 +384,10 @@ template <typename Sys, typename T>
 
 /**
  * Defines the integrator that will be used for configuration advance & actualization (Alpha version).
+ * "ALPHA" combines the residue parts with Newmark's integrator, while "GENERALIZED-ALPHA"
+ * and "HHT" use IntegratorGeneralizedAlpha with any type of residue.
  * @param type Key of integrator family to use.
- * @param alpha_in HHT's alpha.
+ * @param alpha_in HHT's alpha for "ALPHA", spectral radius at infinite frequency otherwise.
  */
 template <typename Sys, typename T>
     void DiffProblemSecond<Sys,T>::setIntegrator
@@ -379,6 +400,10 @@ template <typename Sys, typename T>
     this->alpha = alpha_in;
     this->theIntegrator = new IntegratorNEWMARK<T>( .25*std::pow(1+alpha,2), .5+alpha );
   }
+  else if (!strcmp(type, "GENERALIZED-ALPHA"))
+    this->theIntegrator = new IntegratorGeneralizedAlpha<T>( alpha_in );
+  else if (!strcmp(type, "HHT"))
+    this->theIntegrator = new IntegratorGeneralizedAlpha<T>( alpha_in, 1 );
 }
 
 /**
@@ -438,10 +463,10 @@ template <typename Sys, typename T>
   static_cast< IntegratorBaseImplicit<T>* >
       (this->theIntegrator)->actualize( q_actual );
   (this->theSystem->*res)( residue,
-                           this->theConfiguration->getConf(0),
-                           this->theConfiguration->getConf(1),
-                           this->theConfiguration->getConf(2),
-                           this->theConfiguration->getTime( )
+                           this->residueConf(0),
+                           this->residueConf(1),
+                           this->residueConf(2),
+                           this->residueTime( )
                          );
 
 }
@@ -459,14 +484,14 @@ template <typename Sys, typename T>
       (this->theIntegrator)->actualize( q_actual );
 
   (this->theSystem->*res_q_qdot)( *(residueParts[0]),
-                                  this->theConfiguration->getConf(0),
-                                  this->theConfiguration->getConf(1)
+                                  this->residueConf(0),
+                                  this->residueConf(1)
                                 );
   (this->theSystem->*res_qddot)( *(residueParts[1]),
-                                 this->theConfiguration->getConf(2)
+                                 this->residueConf(2)
                                );
   (this->theSystem->*res_time)( *(residueParts[2]),
-                                this->theConfiguration->getTime( )
+                                this->residueTime( )
                               );
   residue = *residueParts[0] + *residueParts[1] + *residueParts[2];
 }
@@ -509,11 +534,11 @@ template <typename Sys, typename T>
     void DiffProblemSecond<Sys,T>::iterationJacobian( lmx::Matrix<T>& jacobian, lmx::Vector<T>& q_actual )
 {
   (this->theSystem->*jac)( jacobian,
-              this->theConfiguration->getConf(0),
-              this->theConfiguration->getConf(1),
+              this->residueConf(0),
+              this->residueConf(1),
               static_cast< IntegratorBaseImplicit<T>* >(this->theIntegrator)->getPartialQdot( ),
               static_cast< IntegratorBaseImplicit<T>* >(this->theIntegrator)->getPartialQddot( ),
-              this->theConfiguration->getTime( )
+              this->residueTime( )
             );
 }
 
@@ -526,14 +551,14 @@ template <typename Sys, typename T>
     void DiffProblemSecond<Sys,T>::iterationJacobianByParts( lmx::Matrix<T>& jacobian, lmx::Vector<T>& q_actual )
 {
   (this->theSystem->*jac_q_qdot)( *(jacobianParts[0]),
-                                  this->theConfiguration->getConf(0),
-                                  this->theConfiguration->getConf(1),
+                                  this->residueConf(0),
+                                  this->residueConf(1),
                                   static_cast< IntegratorBaseImplicit<T>* >(this->theIntegrator)->getPartialQdot( ),
-                                  this->theConfiguration->getTime( )
+                                  this->residueTime( )
                                 );
   (this->theSystem->*jac_qddot)( *(jacobianParts[1]),
                                  static_cast< IntegratorBaseImplicit<T>* >(this->theIntegrator)->getPartialQddot( ),
-                                 this->theConfiguration->getTime( )
+                                 this->residueTime( )
                                );
   jacobian = *jacobianParts[0] + *jacobianParts[1];
 }
@@ -559,6 +584,30 @@ template <typename Sys, typename T>
   jacobian = (T)(1-alpha)* (*jacobianParts[0]) + *jacobianParts[1];
 }
 
+/**
+ * Configuration used in the residue and Jacobian evaluations: the end of
+ * the step, or the intermediate point of generalized-alpha integrators.
+ * @param order Differential order of configuration.
+ */
+template <typename Sys, typename T>
+    const lmx::Vector<T>& DiffProblemSecond<Sys,T>::residueConf( int order )
+{
+  const lmx::Vector<T>* conf = static_cast< IntegratorBaseImplicit<T>* >
+      (this->theIntegrator)->getResidueConf( order );
+  return conf ? *conf : this->theConfiguration->getConf( order );
+}
+
+/**
+ * Time of the residue and Jacobian evaluations.
+ */
+template <typename Sys, typename T>
+    double DiffProblemSecond<Sys,T>::residueTime( )
+{
+  IntegratorBaseImplicit<T>* integrator = static_cast< IntegratorBaseImplicit<T>* >(this->theIntegrator);
+  return integrator->getResidueConf( 0 ) ? integrator->getResidueTime( )
+                                         : this->theConfiguration->getTime( );
+}
+
 /**
  * Function for NLSolver convergence evaluation.
  * @param q_actual Configuration computed by the NLSolver.
@@ -574,6 +623,22 @@ template <typename Sys, typename T>
 }
 
 
+/**
+ * Evaluation of the second derivative for multi-stage integrators.
+ * @param qddot Second derivative.
+ * @param q Configuration.
+ * @param qdot First derivative.
+ * @param time Time of the evaluation.
+ */
+template <typename Sys, typename T>
+    void DiffProblemSecond<Sys,T>::evaluateStage( lmx::Vector<T>& qddot,
+                                                  const lmx::Vector<T>& q,
+                                                  const lmx::Vector<T>& qdot,
+                                                  double time )
+{
+  (this->theSystem->*eval)( q, qdot, qddot, time );
+}
+
 /**
  * Solve main function
  */
@@ -581,7 +646,9 @@ template <typename Sys, typename T>
     void DiffProblemSecond<Sys,T>::solve( )
 {
   this->theConfiguration->setTime( this->to );
+  this->theIntegrator->setEvaluator( this );
   this->theIntegrator->initialize( this->theConfiguration );
+  if ( this->b_adaptive ) this->theConfiguration->enableStepRejection();
   if ( this->theIntegrator->isExplicit() )
     this->solveExplicit();
   else this->solveImplicit();
@@ -593,13 +660,38 @@ template <typename Sys, typename T>
 template <typename Sys, typename T>
     void DiffProblemSecond<Sys,T>::solveExplicit( )
 {
-  int max = (int)( (this->tf - this->to) / this->stepSize );
-  for ( int i=0; i<max; ++i){
+  if ( this->b_adaptive ){
+    double h;
     (this->theSystem->*eval)( this->theConfiguration->getConf(0),
                               this->theConfiguration->getConf(1),
                               this->theConfiguration->setConf(2),
                               this->theConfiguration->getTime( )
-                      );
+                            );
+    this->writeStepFiles();
+    while ( this->nextStepSize( h ) ){
+      this->theConfiguration->nextStep( h );
+      this->theIntegrator->advance( );
+      // The acceleration at the end of the step is needed by the error estimate:
+      if ( !this->theIntegrator->evaluatesEnd() )
+        (this->theSystem->*eval)( this->theConfiguration->getConf(0),
+                                  this->theConfiguration->getConf(1),
+                                  this->theConfiguration->setConf(2),
+                                  this->theConfiguration->getTime( )
+                                );
+      if ( !this->checkStep( 1 ) ) continue;
+      this->writeStepFiles();
+      if(this->b_steptriggered) (this->theSystem->*(this->stepTriggered))( );
+    }
+    return;
+  }
+  int max = (int)( (this->tf - this->to) / this->stepSize );
+  for ( int i=0; i<max; ++i){
+    if ( i == 0 || !this->theIntegrator->evaluatesEnd() )
+      (this->theSystem->*eval)( this->theConfiguration->getConf(0),
+                                this->theConfiguration->getConf(1),
+                                this->theConfiguration->setConf(2),
+                                this->theConfiguration->getTime( )
+                        );
     this->writeStepFiles();
     this->theConfiguration->nextStep( this->stepSize );
     this->theIntegrator->advance( );
@@ -651,6 +743,7 @@ template <typename Sys, typename T>
   theNLSolver.setInitialConfiguration( this->theConfiguration->getConf(0) );
   theNLSolver.setDeltaInResidue(  );
   theNLSolver.setSystem( *this );
+  theNLSolver.setPreconditioner( precond );
   if( b_convergence ){
     theNLSolver.setConvergence( &DiffProblemSecond<Sys,T>::iterationConvergence );
   }
@@ -669,6 +762,20 @@ template <typename Sys, typename T>
   else
     theNLSolver.setJacobian( &DiffProblemSecond<Sys,T>::iterationJacobian );
 
+  if ( this->b_adaptive ){
+    double h;
+    this->writeStepFiles();
+    while ( this->nextStepSize( h ) ){
+      this->theConfiguration->nextStep( h );
+      this->theIntegrator->advance( );
+      theNLSolver.solve( );
+      if ( !this->checkStep( theNLSolver.isConverged() ) ) continue;
+      if(b_alpha) *residueParts[3] = *residueParts[0];
+      this->writeStepFiles();
+      if(this->b_steptriggered) (this->theSystem->*(this->stepTriggered))( );
+    }
+    return;
+  }
   for ( int i=0; i<max; ++i){
     this->writeStepFiles();
     this->theConfiguration->nextStep( this->stepSize );
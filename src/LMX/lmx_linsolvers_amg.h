@@ -0,0 +1,670 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMX_AMG_H
+#define LMX_AMG_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "lmx_mat_vector.h"
+#include "lmx_linsolvers_operator.h"
+#include "lmx_linsolvers_precond.h"
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_amg.h
+
+      \brief Smoothed aggregation algebraic multigrid
+
+      Implements the AmgPrecond class, a smoothed aggregation AMG hierarchy
+      that can be used as preconditioner of the iterative solvers or as a
+      standalone solver.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+  *
+  * \class AmgPrecond
+  * \brief Template class AmgPrecond.
+  * Smoothed aggregation algebraic multigrid (Vanek, Mandel & Brezina, 1996)
+  * for sparse symmetric positive definite matrices. The finest level is
+  * taken from the compressed arrays of Type_csc, as in the other
+  * SparsePrecond classes.
+  *
+  * The setup builds the hierarchy: the strongly connected nodes are grouped
+  * in aggregates, the tentative prolongator (constant over each aggregate)
+  * is smoothed with a damped Jacobi step and the coarse matrices are the
+  * Galerkin products P^T * A * P. The coarsest level is solved with a dense
+  * LU factorization, or relaxed with symmetric Gauss-Seidel if it is still
+  * larger than the coarsest size (strongly diagonal dominant matrices, as
+  * the ones with large mass terms, are not coarsened).
+  *
+  * Each apply() performs one symmetric V-cycle, with forward Gauss-Seidel
+  * pre-smoothing and backward Gauss-Seidel post-smoothing, so it can be
+  * used as preconditioner of Cg.
+  *
+  * The setup and the solution are separated: update() is called by
+  * LinearSystem each time the matrix is refactorized, and only recomputes
+  * the numerical values of the hierarchy keeping the aggregates (or nothing
+  * at all if setFixedHierarchy() is set). The same object can thus be kept
+  * across the time steps of an implicit integration.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class AmgPrecond : public SparsePrecond<T>{
+
+public:
+  AmgPrecond();
+
+  AmgPrecond( Matrix<T>* );
+
+  void setStrengthThreshold( T theta_in )
+  /**
+   * @param theta_in Strength of connection threshold, |a_ij| >= theta*sqrt(|a_ii*a_jj|). Default 0.08.
+   */
+  { theta = theta_in; }
+
+  void setCoarsestSize( size_type n )
+  /**
+   * @param n Size below which the level is solved directly. Default 50.
+   */
+  { coarse_size = n; }
+
+  void setMaxLevels( size_type n )
+  /**
+   * @param n Maximum number of levels, including the finest one. Default 10.
+   */
+  { max_levels = n; }
+
+  void setSmoothingSteps( size_type nu_in )
+  /**
+   * @param nu_in Gauss-Seidel sweeps before and after the coarse correction. Default 1.
+   */
+  { nu = nu_in; }
+
+  void setFixedHierarchy( bool fixed_in )
+  /**
+   * @param fixed_in If TRUE, update() keeps the whole hierarchy of the first setup.
+   */
+  { fixed = fixed_in; }
+
+  void setTolerance( T eps )
+  /**
+   * @param eps Relative residual reduction of the standalone solve().
+   */
+  { epsi = eps; }
+
+  void setMaxCycles( size_type kmax_in )
+  /**
+   * @param kmax_in Maximum number of V-cycles of the standalone solve().
+   */
+  { kmax = kmax_in; }
+
+  size_type getIterations() const
+  /**
+   * @return Number of V-cycles of the last solve() call.
+   */
+  { return iterations; }
+
+  T getResidual() const
+  /**
+   * @return Relative residual achieved by the last solve() call.
+   */
+  { return tole; }
+
+  size_type getLevels() const
+  /**
+   * @return Number of levels of the hierarchy.
+   */
+  { return levels.size(); }
+
+  size_type getLevelSize( size_type l ) const
+  /**
+   * @param l Level, zero being the finest.
+   * @return Number of unknowns of the level.
+   */
+  { return levels[l].n; }
+
+  void setup( Matrix<T>* );
+
+  void update( Matrix<T>* );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void solve( Vector<T>&, const Vector<T>&, int info = 0 );
+
+private:
+  /** Matrix, prolongator and work vectors of one level. */
+  struct Level{
+    size_type n;
+    std::vector<size_type> row_ptr, col_idx, diag_pos;
+    std::vector<T> val;
+    std::vector<size_type> aggregate; /**< Coarse unknown of each node. */
+    std::vector<size_type> p_ptr, p_col; /**< Prolongator in compressed rows. */
+    std::vector<T> p_val;
+    std::vector<T> x, b, r;
+  };
+
+  void loadFinest( Matrix<T>* );
+  size_type buildAggregates( size_type );
+  void buildCoarse( size_type, size_type );
+  void factorizeCoarsest();
+  void coarseSolve( Level& );
+  void smooth( Level&, bool );
+  void residual( Level& );
+  void cycle( size_type );
+
+  std::vector<Level> levels;
+  std::vector<T> coarse_lu; /**< Dense LU factors of the coarsest matrix (by rows). */
+  std::vector<size_type> coarse_piv; /**< Row permutation of coarse_lu. */
+  T theta;
+  size_type coarse_size;
+  size_type max_levels;
+  size_type nu;
+  bool fixed;
+  size_type kmax;
+  size_type iterations;
+  T epsi;
+  T tole;
+};
+
+} //namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+
+namespace lmx{
+
+/**
+ * Empty constructor. The hierarchy is built by setup() or by the first
+ * update() call.
+ */
+template <typename T>
+    AmgPrecond<T>::AmgPrecond()
+  : theta(0.08), coarse_size(50), max_levels(10), nu(1), fixed(0)
+  , kmax(100), iterations(0), epsi(1E-6), tole(1)
+{ }
+
+
+/**
+ * Constructor. Builds the hierarchy of the matrix.
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    AmgPrecond<T>::AmgPrecond( Matrix<T>* A )
+  : theta(0.08), coarse_size(50), max_levels(10), nu(1), fixed(0)
+  , kmax(100), iterations(0), epsi(1E-6), tole(1)
+{
+  setup( A );
+}
+
+
+/**
+ * Builds the whole hierarchy: aggregates, prolongators and coarse matrices.
+ * @param A Matrix of the finest level.
+ */
+template <typename T>
+    void AmgPrecond<T>::setup( Matrix<T>* A )
+{
+  levels.clear();
+  levels.push_back( Level() );
+  loadFinest( A );
+  while ( levels.back().n > coarse_size && levels.size() < max_levels ){
+    size_type l = levels.size() - 1;
+    size_type nc = buildAggregates( l );
+    if ( nc == levels[l].n ) break; // no coarsening
+    levels.push_back( Level() );
+    buildCoarse( l, nc );
+  }
+  levels.back().aggregate.clear();
+  factorizeCoarsest();
+}
+
+
+/**
+ * Recomputes the hierarchy for new values of the matrix. The aggregates
+ * of the previous setup are kept, so only the prolongators, the Galerkin
+ * products and the coarse factorization are computed. Nothing is done if
+ * setFixedHierarchy() is set, and the full setup is done if there was no
+ * previous one or the size has changed.
+ * @param A Matrix of the finest level.
+ */
+template <typename T>
+    void AmgPrecond<T>::update( Matrix<T>* A )
+{
+  if ( levels.empty() || levels[0].n != A->rows() ){
+    setup( A );
+    return;
+  }
+  if ( fixed ) return;
+  loadFinest( A );
+  for ( size_type l = 0; l+1 < levels.size(); ++l )
+    buildCoarse( l, levels[l+1].n );
+  factorizeCoarsest();
+}
+
+
+/**
+ * Applies one V-cycle with null initial guess: z = M^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void AmgPrecond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  if ( levels.empty() ){
+    std::stringstream message;
+    message << "Error in AmgPrecond: the hierarchy has not been built, "
+        << "use setup() or update() before apply()." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  Level& F = levels[0];
+  for ( size_type i = 0; i < F.n; ++i ) F.b[i] = r.readElement(i);
+  cycle( 0 );
+  for ( size_type i = 0; i < F.n; ++i ) z.writeElement( F.x[i], i );
+}
+
+
+/**
+ * Standalone solver: V-cycles until the relative residual is below the
+ * tolerance.
+ * @param x Initial guess on input, solution on output.
+ * @param b RHS Vector.
+ * @param info Prints the residual of each cycle if greater than zero.
+ */
+template <typename T>
+    void AmgPrecond<T>::solve( Vector<T>& x, const Vector<T>& b, int info )
+{
+  if ( levels.empty() ){
+    std::stringstream message;
+    message << "Error in AmgPrecond: the hierarchy has not been built, "
+        << "use setup() or update() before solve()." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  Level& F = levels[0];
+  std::vector<T> xs( F.n );
+  for ( size_type i = 0; i < F.n; ++i ) xs[i] = x.readElement(i);
+  iterations = 0;
+  T b_norm = b.norm2();
+  if ( b_norm == 0. ) b_norm = 1.;
+
+  while ( 1 ){
+    // F.b = b - A * xs
+    for ( size_type i = 0; i < F.n; ++i ){
+      T temp = b.readElement(i);
+      for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k )
+        temp -= F.val[k] * xs[ F.col_idx[k] ];
+      F.b[i] = temp;
+    }
+    T r_norm = 0.;
+    for ( size_type i = 0; i < F.n; ++i ) r_norm += F.b[i] * F.b[i];
+    tole = std::sqrt( r_norm ) / b_norm;
+    if ( info > 0 )
+      cout << "ciclo :" << iterations << "\t" << "tole = " << tole << endl;
+    if ( tole <= epsi || iterations >= kmax ) break;
+    cycle( 0 );
+    for ( size_type i = 0; i < F.n; ++i ) xs[i] += F.x[i];
+    ++iterations;
+  }
+  for ( size_type i = 0; i < F.n; ++i ) x.writeElement( xs[i], i );
+
+  if ( tole > epsi )
+    cout << ":::WARNING:::" << endl
+         << ":::AMG convergence was not achieved after " << iterations << " cycles.:::" << endl
+         << ":::END WARNING:::" << endl;
+}
+
+
+/**
+ * Copies the matrix in the finest level.
+ * @param A Matrix of the finest level.
+ */
+template <typename T>
+    void AmgPrecond<T>::loadFinest( Matrix<T>* A )
+{
+  this->load( A );
+  Level& F = levels[0];
+  F.n = this->nrow;
+  F.row_ptr.swap( this->row_ptr );
+  F.col_idx.swap( this->col_idx );
+  F.diag_pos.swap( this->diag_pos );
+  F.val.swap( this->val );
+  F.x.resize( F.n );
+  F.b.resize( F.n );
+  F.r.resize( F.n );
+}
+
+
+/**
+ * Groups the nodes of a level in aggregates of strongly connected nodes.
+ * First, aggregates are formed with the nodes whose strong neighbourhood is
+ * still free; then the remaining nodes join a neighbouring aggregate and,
+ * finally, the ones left form new aggregates with their free neighbours.
+ * @param l Level.
+ * @return Number of aggregates.
+ */
+template <typename T>
+    size_type AmgPrecond<T>::buildAggregates( size_type l )
+{
+  Level& F = levels[l];
+  size_type n = F.n;
+  size_type none = n;
+  std::vector<char> strong( F.col_idx.size(), 0 );
+  for ( size_type i = 0; i < n; ++i ){
+    T aii = F.val[ F.diag_pos[i] ];
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k ){
+      size_type j = F.col_idx[k];
+      if ( j != i && std::abs( F.val[k] )
+           >= theta * std::sqrt( std::abs( aii * F.val[ F.diag_pos[j] ] ) ) )
+        strong[k] = 1;
+    }
+  }
+
+  std::vector<size_type>& agg = F.aggregate;
+  agg.assign( n, none );
+  size_type nc = 0;
+  for ( size_type i = 0; i < n; ++i ){
+    if ( agg[i] != none ) continue;
+    bool free = 1;
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1] && free; ++k )
+      if ( strong[k] && agg[ F.col_idx[k] ] != none ) free = 0;
+    if ( !free ) continue;
+    agg[i] = nc;
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k )
+      if ( strong[k] ) agg[ F.col_idx[k] ] = nc;
+    ++nc;
+  }
+  std::vector<size_type> roots( agg );
+  for ( size_type i = 0; i < n; ++i ){
+    if ( agg[i] != none ) continue;
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k ){
+      if ( strong[k] && roots[ F.col_idx[k] ] != none ){
+        agg[i] = roots[ F.col_idx[k] ];
+        break;
+      }
+    }
+  }
+  for ( size_type i = 0; i < n; ++i ){
+    if ( agg[i] != none ) continue;
+    agg[i] = nc;
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k )
+      if ( strong[k] && agg[ F.col_idx[k] ] == none ) agg[ F.col_idx[k] ] = nc;
+    ++nc;
+  }
+  return nc;
+}
+
+
+/**
+ * Computes the smoothed prolongator of a level, P = (I - w*D^-1*A) * P0,
+ * and the matrix of the next level, P^T * A * P. The damping is
+ * w = 4/(3*rho), with the spectral radius of D^-1*A estimated by
+ * Gershgorin's theorem.
+ * @param l Fine level, with its aggregates already computed.
+ * @param nc Number of aggregates.
+ */
+template <typename T>
+    void AmgPrecond<T>::buildCoarse( size_type l, size_type nc )
+{
+  Level& F = levels[l];
+  Level& C = levels[l+1];
+  size_type n = F.n;
+  size_type none = nc;
+  const std::vector<size_type>& agg = F.aggregate;
+
+  std::vector<T> weight( nc, 0. );
+  for ( size_type i = 0; i < n; ++i ) weight[ agg[i] ] += 1.;
+  for ( size_type c = 0; c < nc; ++c ) weight[c] = 1. / std::sqrt( weight[c] );
+  T rho = 0.;
+  for ( size_type i = 0; i < n; ++i ){
+    T sum = 0.;
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k )
+      sum += std::abs( F.val[k] );
+    rho = std::max( rho, sum / std::abs( F.val[ F.diag_pos[i] ] ) );
+  }
+  T omega = 4. / ( 3. * rho );
+
+  // Prolongator, by rows:
+  std::vector<size_type> marker( nc, none );
+  F.p_ptr.assign( n+1, 0 );
+  F.p_col.clear();
+  F.p_val.clear();
+  for ( size_type i = 0; i < n; ++i ){
+    size_type start = F.p_col.size();
+    T scale = omega / F.val[ F.diag_pos[i] ];
+    marker[ agg[i] ] = F.p_col.size();
+    F.p_col.push_back( agg[i] );
+    F.p_val.push_back( weight[ agg[i] ] );
+    for ( size_type k = F.row_ptr[i]; k < F.row_ptr[i+1]; ++k ){
+      size_type c = agg[ F.col_idx[k] ];
+      T value = -scale * F.val[k] * weight[c];
+      if ( marker[c] == none || marker[c] < start ){
+        marker[c] = F.p_col.size();
+        F.p_col.push_back( c );
+        F.p_val.push_back( value );
+      }
+      else F.p_val[ marker[c] ] += value;
+    }
+    F.p_ptr[i+1] = F.p_col.size();
+  }
+
+  // Galerkin product, row c of P^T*A*P = sum over i of P(i,c) * (A*P)(i,:):
+  std::vector<size_type> pt_ptr( nc+1, 0 ), pt_row( F.p_col.size() );
+  std::vector<T> pt_val( F.p_col.size() );
+  for ( size_type k = 0; k < F.p_col.size(); ++k ) ++pt_ptr[ F.p_col[k]+1 ];
+  for ( size_type c = 0; c < nc; ++c ) pt_ptr[c+1] += pt_ptr[c];
+  std::vector<size_type> next( pt_ptr.begin(), pt_ptr.end()-1 );
+  for ( size_type i = 0; i < n; ++i ){
+    for ( size_type k = F.p_ptr[i]; k < F.p_ptr[i+1]; ++k ){
+      size_type pos = next[ F.p_col[k] ]++;
+      pt_row[pos] = i;
+      pt_val[pos] = F.p_val[k];
+    }
+  }
+  std::vector<T> row( nc, 0. );
+  std::vector<char> used( nc, 0 );
+  std::vector<size_type> cols;
+  C.n = nc;
+  C.row_ptr.assign( nc+1, 0 );
+  C.col_idx.clear();
+  C.val.clear();
+  for ( size_type c = 0; c < nc; ++c ){
+    cols.clear();
+    for ( size_type kt = pt_ptr[c]; kt < pt_ptr[c+1]; ++kt ){
+      size_type i = pt_row[kt];
+      for ( size_type ka = F.row_ptr[i]; ka < F.row_ptr[i+1]; ++ka ){
+        size_type j = F.col_idx[ka];
+        T factor = pt_val[kt] * F.val[ka];
+        for ( size_type kp = F.p_ptr[j]; kp < F.p_ptr[j+1]; ++kp ){
+          size_type d = F.p_col[kp];
+          if ( !used[d] ){
+            used[d] = 1;
+            cols.push_back( d );
+          }
+          row[d] += factor * F.p_val[kp];
+        }
+      }
+    }
+    std::sort( cols.begin(), cols.end() );
+    for ( size_type k = 0; k < cols.size(); ++k ){
+      C.col_idx.push_back( cols[k] );
+      C.val.push_back( row[ cols[k] ] );
+      row[ cols[k] ] = 0.;
+      used[ cols[k] ] = 0;
+    }
+    C.row_ptr[c+1] = C.col_idx.size();
+  }
+  C.diag_pos.resize( nc );
+  for ( size_type c = 0; c < nc; ++c ){
+    typename std::vector<size_type>::iterator first = C.col_idx.begin() + C.row_ptr[c];
+    typename std::vector<size_type>::iterator last = C.col_idx.begin() + C.row_ptr[c+1];
+    C.diag_pos[c] = std::lower_bound( first, last, c ) - C.col_idx.begin();
+  }
+  C.x.resize( nc );
+  C.b.resize( nc );
+  C.r.resize( nc );
+}
+
+
+/**
+ * Dense LU factorization with partial pivoting of the coarsest matrix.
+ */
+template <typename T>
+    void AmgPrecond<T>::factorizeCoarsest()
+{
+  Level& C = levels.back();
+  size_type n = C.n;
+  if ( n > coarse_size ){ // relaxed in coarseSolve()
+    coarse_lu.clear();
+    coarse_piv.clear();
+    return;
+  }
+  coarse_lu.assign( n*n, 0. );
+  coarse_piv.resize( n );
+  for ( size_type i = 0; i < n; ++i ){
+    coarse_piv[i] = i;
+    for ( size_type k = C.row_ptr[i]; k < C.row_ptr[i+1]; ++k )
+      coarse_lu[ i*n + C.col_idx[k] ] = C.val[k];
+  }
+  for ( size_type k = 0; k < n; ++k ){
+    size_type p = k;
+    for ( size_type i = k+1; i < n; ++i )
+      if ( std::abs( coarse_lu[i*n+k] ) > std::abs( coarse_lu[p*n+k] ) ) p = i;
+    if ( coarse_lu[p*n+k] == 0. ){
+      std::stringstream message;
+      message << "Error in AmgPrecond: the coarsest matrix is singular." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    if ( p != k ){
+      for ( size_type j = 0; j < n; ++j )
+        std::swap( coarse_lu[k*n+j], coarse_lu[p*n+j] );
+      std::swap( coarse_piv[k], coarse_piv[p] );
+    }
+    for ( size_type i = k+1; i < n; ++i ){
+      T factor = coarse_lu[i*n+k] /= coarse_lu[k*n+k];
+      if ( factor != 0. )
+        for ( size_type j = k+1; j < n; ++j )
+          coarse_lu[i*n+j] -= factor * coarse_lu[k*n+j];
+    }
+  }
+}
+
+
+/**
+ * Solves the coarsest level with the dense factors, or applies the
+ * Gauss-Seidel sweeps if it was not factorized.
+ * @param C Coarsest level, with the RHS in C.b.
+ */
+template <typename T>
+    void AmgPrecond<T>::coarseSolve( Level& C )
+{
+  size_type n = C.n;
+  if ( coarse_piv.size() != n ){
+    std::fill( C.x.begin(), C.x.end(), T(0) );
+    for ( size_type s = 0; s < nu; ++s ) smooth( C, 1 );
+    for ( size_type s = 0; s < nu; ++s ) smooth( C, 0 );
+    return;
+  }
+  for ( size_type i = 0; i < n; ++i ){
+    T temp = C.b[ coarse_piv[i] ];
+    for ( size_type j = 0; j < i; ++j ) temp -= coarse_lu[i*n+j] * C.x[j];
+    C.x[i] = temp;
+  }
+  for ( size_type i = n; i-- > 0; ){
+    T temp = C.x[i];
+    for ( size_type j = i+1; j < n; ++j ) temp -= coarse_lu[i*n+j] * C.x[j];
+    C.x[i] = temp / coarse_lu[i*n+i];
+  }
+}
+
+
+/**
+ * Gauss-Seidel sweep over L.x with RHS L.b.
+ * @param L Level.
+ * @param forward Increasing row order if TRUE, decreasing otherwise.
+ */
+template <typename T>
+    void AmgPrecond<T>::smooth( Level& L, bool forward )
+{
+  for ( size_type ii = 0; ii < L.n; ++ii ){
+    size_type i = forward ? ii : L.n-1-ii;
+    T temp = L.b[i];
+    for ( size_type k = L.row_ptr[i]; k < L.row_ptr[i+1]; ++k )
+      if ( k != L.diag_pos[i] ) temp -= L.val[k] * L.x[ L.col_idx[k] ];
+    L.x[i] = temp / L.val[ L.diag_pos[i] ];
+  }
+}
+
+
+/**
+ * Computes L.r = L.b - A * L.x.
+ * @param L Level.
+ */
+template <typename T>
+    void AmgPrecond<T>::residual( Level& L )
+{
+  for ( size_type i = 0; i < L.n; ++i ){
+    T temp = L.b[i];
+    for ( size_type k = L.row_ptr[i]; k < L.row_ptr[i+1]; ++k )
+      temp -= L.val[k] * L.x[ L.col_idx[k] ];
+    L.r[i] = temp;
+  }
+}
+
+
+/**
+ * V-cycle from a level with null initial guess, solving for L.x with RHS L.b.
+ * @param l Level.
+ */
+template <typename T>
+    void AmgPrecond<T>::cycle( size_type l )
+{
+  Level& F = levels[l];
+  if ( l+1 == levels.size() ){
+    coarseSolve( F );
+    return;
+  }
+  Level& C = levels[l+1];
+  std::fill( F.x.begin(), F.x.end(), T(0) );
+  for ( size_type s = 0; s < nu; ++s ) smooth( F, 1 );
+  residual( F );
+  std::fill( C.b.begin(), C.b.end(), T(0) );
+  for ( size_type i = 0; i < F.n; ++i )
+    for ( size_type k = F.p_ptr[i]; k < F.p_ptr[i+1]; ++k )
+      C.b[ F.p_col[k] ] += F.p_val[k] * F.r[i];
+  cycle( l+1 );
+  for ( size_type i = 0; i < F.n; ++i )
+    for ( size_type k = F.p_ptr[i]; k < F.p_ptr[i+1]; ++k )
+      F.x[i] += F.p_val[k] * C.x[ F.p_col[k] ];
+  for ( size_type s = 0; s < nu; ++s ) smooth( F, 0 );
+}
+
+} //namespace lmx
+
+
+#endif
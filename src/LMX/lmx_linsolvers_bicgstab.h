@@ -0,0 +1,253 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef BICGSTAB_SOLVER_H
+#define BICGSTAB_SOLVER_H
+
+#include <cmath>
+
+#include "lmx_mat_vector.h"
+#include "lmx_linsolvers_operator.h"
+#include "lmx_linsolvers_precond.h"
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_bicgstab.h
+
+      \brief BiCGStab class implementation
+
+      Implements the stabilized bi-conjugate gradient linear solver method.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+  *
+  * \class BiCGStab
+  * \brief Template class BiCGStab.
+  * This class implements the BiCGStab iterative linear solver (van der
+  * Vorst, 1992) for non-symmetric systems, with optional right
+  * preconditioning. Like Gmres, it works over any LinearOperator or any
+  * type of Matrix, and precond() sets the JacobiPrecond, as in Cg.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class BiCGStab{
+
+public:
+  BiCGStab( LinearOperator<T>*, Vector<T>* );
+
+  BiCGStab( Matrix<T>*, Vector<T>* );
+
+  ~BiCGStab()
+  { delete matrix_op; delete jacobi; }
+
+  void precond();
+
+  void setPreconditioner( LinearOperator<T>* prec_in )
+  /**
+   * Sets the right preconditioner: the operator that approximates M^-1.
+   * @param prec_in Preconditioner operator, z = M^-1 * r.
+   */
+  { M = prec_in; }
+
+  void setTolerance( T eps )
+  /**
+   * @param eps Relative residual reduction || b - A*x || / || b ||.
+   */
+  { epsi = eps; }
+
+  void setMaxIterations( size_type kmax_in )
+  /**
+   * @param kmax_in Maximum number of iterations (two operator products each).
+   */
+  { kmax = kmax_in; }
+
+  size_type getIterations() const
+  /**
+   * @return Number of iterations of the last solve() call.
+   */
+  { return iterations; }
+
+  T getResidual() const
+  /**
+   * @return Relative residual achieved by the last solve() call.
+   */
+  { return tole; }
+
+  Vector<T>& solve( int info = 0 );
+
+private:
+  void applyPrecond( Vector<T>&, const Vector<T>& );
+
+  LinearOperator<T>* A;
+  LinearOperator<T>* M;
+  Matrix<T>* A_mat;
+  MatrixOperator<T>* matrix_op;
+  JacobiPrecond<T>* jacobi;
+  Vector<T>* b;
+  Vector<T> x;
+  size_type nrow;
+  size_type kmax;
+  size_type iterations;
+  T epsi;
+  T tole;
+};
+
+} //namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+
+namespace lmx{
+
+/**
+ * Standard constructor.
+ * @param A_in LHS operator.
+ * @param b_in RHS Vector.
+ */
+template <typename T>
+    BiCGStab<T>::BiCGStab( LinearOperator<T>* A_in, Vector<T>* b_in )
+  : A(A_in), M(0), A_mat(0), matrix_op(0), jacobi(0), b(b_in)
+  , nrow(b_in->size()), iterations(0), epsi(1E-6), tole(1)
+{
+  kmax = nrow+20;
+  x.resize( nrow );
+}
+
+
+/**
+ * Constructor for Matrix systems.
+ * @param A_in LHS Matrix.
+ * @param b_in RHS Vector.
+ */
+template <typename T>
+    BiCGStab<T>::BiCGStab( Matrix<T>* A_in, Vector<T>* b_in )
+  : M(0), A_mat(A_in), jacobi(0), b(b_in)
+  , nrow(b_in->size()), iterations(0), epsi(1E-6), tole(1)
+{
+  matrix_op = new MatrixOperator<T>( A_in );
+  A = matrix_op;
+  kmax = nrow+20;
+  x.resize( nrow );
+}
+
+
+/**
+ * Sets the Jacobi (or block-Jacobi) preconditioner of the Matrix.
+ */
+template <typename T>
+    void BiCGStab<T>::precond()
+{
+  if ( !A_mat ){
+    std::stringstream message;
+    message << "Error in BiCGStab: precond() needs a Matrix, "
+        << "use setPreconditioner() with LinearOperator systems." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  delete jacobi;
+  jacobi = new JacobiPrecond<T>( A_mat );
+  M = jacobi;
+}
+
+
+/**
+ * Applies the preconditioner: z = M^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void BiCGStab<T>::applyPrecond( Vector<T>& z, const Vector<T>& r )
+{
+  if (M) M->apply(z, r);
+  else z = r;
+}
+
+
+/**
+ * Solves the system starting from a null initial guess.
+ * @param info Prints the residual of each iteration if greater than zero.
+ * @return Reference to the solution Vector.
+ */
+template <typename T>
+    Vector<T>& BiCGStab<T>::solve( int info )
+{
+  Vector<T> r( *b ), r_hat( *b );
+  Vector<T> p( nrow ), v( nrow ), s( nrow ), t( nrow );
+  Vector<T> p_hat( nrow ), s_hat( nrow );
+  T rho = 1., alpha = 1., omega = 1., rho_new, beta;
+
+  x.fillIdentity( 0. );
+  iterations = 0;
+  T b_norm = b->norm2();
+  tole = 0;
+  if ( b_norm == 0. ) return x;
+  tole = 1.;
+
+  while ( iterations < kmax ){
+    ++iterations;
+    rho_new = r_hat * r;
+    if ( rho_new == 0. ) break; // breakdown
+    beta = ( rho_new / rho ) * ( alpha / omega );
+    // p = r + beta*(p - omega*v)
+    p.axpy( -omega, v );
+    p *= beta;
+    p += r;
+    applyPrecond( p_hat, p );
+    A->apply( v, p_hat );
+    alpha = rho_new / ( r_hat * v );
+    // s = r - alpha*v
+    s = r;
+    s.axpy( -alpha, v );
+    x.axpy( alpha, p_hat );
+    tole = s.norm2() / b_norm;
+    if ( tole <= epsi ) break;
+
+    applyPrecond( s_hat, s );
+    A->apply( t, s_hat );
+    omega = ( t * s ) / ( t * t );
+    x.axpy( omega, s_hat );
+    // r = s - omega*t
+    r = s;
+    r.axpy( -omega, t );
+    tole = r.norm2() / b_norm;
+    if ( info > 0 )
+      cout << "iteracion :" << iterations << "\t" << "tole = " << tole << endl;
+    if ( tole <= epsi || omega == 0. ) break;
+    rho = rho_new;
+  }
+
+  if ( tole > epsi )
+    cout << ":::WARNING:::" << endl
+         << ":::BiCGStab convergence was not achieved after " << iterations << " iterations.:::" << endl
+         << ":::END WARNING:::" << endl;
+
+  return x;
+}
+
+} //namespace lmx
+
+
+#endif
@@ -22,6 +22,7 @@
 
 
 #include "lmx_mat_vector.h"
+#include "lmx_linsolvers_precond.h"
 
 
 //////////////////////////////////////////// Doxygen file documentation entry:
@@ -50,6 +51,9 @@ namespace lmx{
   * with and without preconditioner. It uses LMX matrix and vector facilities
   * so any kind of linked object can be used.
   *
+  * The preconditioner is any LinearOperator, shared with Gmres and BiCGStab
+  * (see lmx_linsolvers_precond.h); precond() selects the JacobiPrecond.
+  *
   * @author Roberto Ortega.
 */
 template <typename T> class Cg{
@@ -66,7 +70,6 @@ private:
   //+Vector residuo inicial  r1={b};
   Vector<T> r;
   Vector<T> d;
-  Vector<T> mp;
   Vector<T> s;
   size_type nrow;
   //+Tolerancia inicial para el residuo
@@ -79,6 +82,12 @@ private:
 //   numType epsi;
   //Nmero mximo de iteraciones:
   size_type kmax;
+  size_type iterations;
+  //Precondicionador:
+  LinearOperator<T>* M;
+  JacobiPrecond<T>* jacobi;
+
+  void applyPrecond( Vector<T>&, const Vector<T>& );
 
 public:
   // Constructor:
@@ -89,6 +98,31 @@ public:
 //+rutina para el precondicionador (diagonal)
   void precond();
 
+  void setPreconditioner( LinearOperator<T>* prec_in )
+  /**
+   * Sets an external preconditioner.
+   * @param prec_in Preconditioner operator, z = M^-1 * r.
+   */
+  { M = prec_in; }
+
+  void setTolerance( T eps )
+  /**
+   * @param eps Relative residual reduction, sqrt( (r*M^-1*r) / (r0*M^-1*r0) ).
+   */
+  { epsi = eps; }
+
+  void setMaxIterations( size_type kmax_in )
+  /**
+   * @param kmax_in Maximum number of iterations (default: rows + 20).
+   */
+  { kmax = kmax_in; }
+
+  size_type getIterations() const
+  /**
+   * @return Number of iterations of the last solve() call.
+   */
+  { return iterations; }
+
 //+rutina para el metodo de los gradientes conjugados
   Vector<T> solve( int );
 };
@@ -105,14 +139,12 @@ namespace lmx{
  * @param A_in LHS Matrix
  * @param b_in RHS Vector
  */
-  template <typename T> Cg<T>::Cg(Matrix<T>* A_in, Vector<T>* b_in) : A(*A_in), b(*b_in), r(*b_in), d(*b_in), tole(1), epsi(1E-6)
+  template <typename T> Cg<T>::Cg(Matrix<T>* A_in, Vector<T>* b_in) : A(*A_in), b(*b_in), r(*b_in), d(*b_in), tole(1), epsi(1E-6), iterations(0), M(0), jacobi(0)
 {
   nrow = A_in->rows();
   kmax = nrow+20;
   x.resize( nrow );
   s.resize( nrow );
-  mp.resize( nrow );
-  for (size_type i=0; i<nrow; ++i) mp(i) = 1;
 }
 
 
@@ -121,25 +153,33 @@ namespace lmx{
  * Destructor
  */
 template <typename T> Cg<T>::~Cg(){
-
+  delete jacobi;
 }
 
 
 template <typename T>
 /**
  * Preconditioner function.
+ * Sets the Jacobi preconditioner: block sparse matrices (Type_bsr) use the
+ * inverses of their diagonal blocks (block-Jacobi), the rest of types use
+ * the inverse of the diagonal.
  */
 void Cg<T>::precond(){
-  
-  double temp;
-
-  for (size_type i=0; i < nrow; ++i){
-    temp = A(i,i);
-    mp(i) = 1. / temp;
-//     if (d(i) != 0){
-      d(i) /= temp;
-//     }
-  }
+  delete jacobi;
+  jacobi = new JacobiPrecond<T>( &A );
+  M = jacobi;
+}
+
+
+template <typename T>
+/**
+ * Applies the preconditioner: z = M^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+void Cg<T>::applyPrecond( Vector<T>& z, const Vector<T>& r ){
+  if (M) M->apply(z, r);
+  else z = r;
 }
 
 
@@ -152,6 +192,9 @@ template <typename T>
  */
 Vector<T> Cg<T>::solve(int info){
 
+  // d = M^-1 * r
+  applyPrecond(d, r);
+
   //valor h y h0
   T hnew;
   hnew = r*d;
@@ -178,29 +221,27 @@ Vector<T> Cg<T>::solve(int info){
     temp = d * q;
     alfa = hnew / temp;
 //     x = x + alfa * d;
-    temp_vec.mult(alfa, d);
-    x += temp_vec;
+    x.axpy(alfa, d);
     //for(size_type i=1;i<Nrow+1;++i)cout<<"x "<<x[i]<<endl;cout<<endl;
 
     if(k%50 != 0){
 //       r = r - alfa * q;
-      temp_vec.mult(alfa, q);
-      r -= temp_vec;
+      r.axpy(-alfa, q);
     }
     else{
 //       r = b - A*x;
       temp_vec.mult(A,x);
       r.subs(b, temp_vec);
     }
-//       s(i) = mp(i) * r(i);
-    s.multElem(mp,r);
+//       s = M^-1 * r;
+    applyPrecond(s, r);
 
     hold = hnew;
     hnew = r*s;
     beta = hnew / hold;
 //     d = s + beta*d;
-    temp_vec.mult(beta,d);
-    d.add(s, temp_vec);
+    d *= beta;
+    d += s;
 
     resi = sqrt(hnew);
     if (info > 0) cout << "res = " << resi << "\t";
@@ -210,6 +251,8 @@ Vector<T> Cg<T>::solve(int info){
   }
 
 
+  iterations = k-1;
+
   if (k==kmax)
     cout<<":::WARNING:::" << endl
      << ":::Convegence was not achieved after " << k << " iterations.:::" << endl
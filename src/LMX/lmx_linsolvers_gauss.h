@@ -20,6 +20,10 @@
 #ifndef GAUSS_SOLVER_H
 #define GAUSS_SOLVER_H
 
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
 //////////////////////////////////////////// Doxygen file documentation entry:
     /*!
       \file lmx_linsolvers_gauss.h
@@ -41,19 +45,39 @@ namespace lmx{
  * \class Gauss
  * \brief Template class Gauss for solving linear systems.
  *
+ * The elimination (factorize()) keeps the L and U factors in place of the
+ * matrix copy, so the same object can solve for several right hand sides
+ * with only the forward and back substitutions (see solve(const Vector<T>&)),
+ * or for a block of right hand sides at once (see solve(const DenseMatrix<T>&)).
+ *
+ * The factorization is a right-looking LU with partial pivoting (P*A = L*U),
+ * blocked by panels of columns so that the update of the trailing matrix
+ * reuses each row of U while it stays in cache.
+ *
  * @author Daniel Iglesias Ibez.
  */
 template <typename T> class Gauss{
   private:
     DenseMatrix<T> mat;
     Vector<T> vec;
+    DenseMatrix<T> block; /**< Solution of the last block of right hand sides. */
+    std::vector<size_type> piv; /**< Row interchanged with row k at step k. */
     size_type dim;
+    bool factorized;
+
+    void load( Matrix<T>* );
+
+    void substitute( T*, size_type );
+
+    static const size_type block_size = 64; /**< Columns of each panel. */
 
   public:
     /**
    * Empty constructor.
      */
-    Gauss(){}
+    Gauss() : dim(0), factorized(0) {}
+
+    Gauss( Matrix<T>* );
 
     Gauss( Matrix<T>*, Vector<T>* );
 
@@ -62,10 +86,35 @@ template <typename T> class Gauss{
      */
     ~Gauss(){}
 
+    void factorize();
+
     Vector<T>& solve();
 
+    Vector<T>& solve( const Vector<T>& );
+
+    DenseMatrix<T>& solve( const DenseMatrix<T>& );
+
+    /**
+     * Factorization state.
+     * @return TRUE if the LU factors are stored.
+     */
+    bool isFactorized() const
+    { return factorized; }
+
 };
 
+template <typename T>
+    /**
+ * Constructor for solving blocks of right hand sides.
+ * @param mat_in Pointer to Matrix.
+     */
+    Gauss<T>::Gauss( Matrix<T>* mat_in )
+  : dim( mat_in->rows() ), factorized(0)
+{
+  load( mat_in );
+}
+
+
 template <typename T>
     /**
  * Standard constructor.
@@ -73,7 +122,20 @@ template <typename T>
  * @param vec_in Pointer to Vector.
      */
     Gauss<T>::Gauss( Matrix<T>* mat_in, Vector<T>* vec_in )
-  : dim( mat_in->rows() )
+  : dim( mat_in->rows() ), factorized(0)
+{
+  load( mat_in );
+  vec.resize( *vec_in );
+  vec = *vec_in;
+}
+
+
+template <typename T>
+    /**
+ * Copies the matrix, by rows if its storage is contiguous.
+ * @param mat_in Pointer to Matrix.
+     */
+    void Gauss<T>::load( Matrix<T>* mat_in )
 {
   if( mat_in->rows() != mat_in->cols() ){
     std::stringstream message;
@@ -82,63 +144,213 @@ template <typename T>
   }
 
   mat.resize( dim , dim );
-  for (size_type i=0; i<dim; ++i){
-    for (size_type j=0; j<dim; ++j){
-      mat.writeElement( mat_in->readElement(i,j), i, j );
+  T* a = mat.data_pointer();
+  const size_type ld = mat.getLeadingDim();
+  const T* a_in = mat_in->data_pointer();
+  if ( a_in ){ // contiguous types, copied by rows
+    const size_type ld_in = mat_in->getLeadingDim();
+    for (size_type i=0; i<dim; ++i)
+      std::copy( a_in + i*ld_in, a_in + i*ld_in + dim, a + i*ld );
+  }
+  else{
+    for (size_type i=0; i<dim; ++i){
+      for (size_type j=0; j<dim; ++j){
+        a[i*ld + j] = mat_in->readElement(i,j);
+      }
     }
   }
-  vec.resize( *vec_in );
-  vec = *vec_in;
 }
 
 
 template <typename T>
     /**
- * Solve system
- * @return Reference to solution vector.
+ * Blocked LU factorization with partial pivoting. The multipliers (L) are
+ * stored below the diagonal, U on and above it, and the row interchanges
+ * in piv. For each panel of block_size columns:
+ * - the panel is factorized column by column, swapping whole rows;
+ * - the rows of U right of the panel are computed (L11^-1 * A12);
+ * - the trailing matrix is updated, A22 -= L21 * U12, by chunks of
+ *   columns so that the rows of U12 are reused from cache.
      */
-    Vector<T>& Gauss<T>::solve()
+    void Gauss<T>::factorize()
 {
-  int i;
-  unsigned int j, k;
-  T mult;
-
-  for(k = 0; k < dim - 1 ;++k)
-  {
-    if ( mat.readElement(k,k) == 0 ){
-      std::stringstream message;
-      message << "Null pivot diagonal term!!. Term position: " << k << ". Squared Matrix dimension: " << dim << "." << endl;
-      LMX_THROW(internal_error, message.str() );
+  T* a = mat.data_pointer();
+  const size_type ld = mat.getLeadingDim();
+  const size_type chunk = 256;
+  piv.resize( dim );
+
+  for (size_type kb = 0; kb < dim; kb += block_size){
+    const size_type ke = std::min( kb + block_size, dim );
+
+    // Panel factorization:
+    for (size_type k = kb; k < ke; ++k){
+      size_type p = k;
+      T pmax = std::abs( a[k*ld + k] );
+      for (size_type i = k+1; i < dim; ++i){
+        if ( std::abs( a[i*ld + k] ) > pmax ){
+          pmax = std::abs( a[i*ld + k] );
+          p = i;
+        }
+      }
+      piv[k] = p;
+      if ( pmax == T(0) ){
+        std::stringstream message;
+        message << "Singular matrix, null pivot column!!. Term position: " << k << ". Squared Matrix dimension: " << dim << "." << endl;
+        LMX_THROW(internal_error, message.str() );
+      }
+      if ( p != k )
+        std::swap_ranges( a + k*ld, a + k*ld + dim, a + p*ld );
+
+      const T* row_k = a + k*ld;
+      for (size_type i = k+1; i < dim; ++i){
+        T* row_i = a + i*ld;
+        if( row_i[k] != T(0) ){
+          T mult = row_i[k] / row_k[k];
+          row_i[k] = mult;
+          for (size_type j = k+1; j < ke; ++j)
+            row_i[j] -= mult * row_k[j];
+        }
+      }
     }
+    if ( ke == dim ) break;
 
-    for(i = k + 1; i < dim; ++i){
+    // U12 = L11^-1 * A12:
+    for (size_type i = kb+1; i < ke; ++i){
+      T* row_i = a + i*ld;
+      for (size_type k = kb; k < i; ++k){
+        const T mult = row_i[k];
+        if ( mult != T(0) ){
+          const T* row_k = a + k*ld;
+          for (size_type j = ke; j < dim; ++j)
+            row_i[j] -= mult * row_k[j];
+        }
+      }
+    }
 
-      if( mat.readElement(i,k) != 0 ){
-        mult = mat.readElement(i,k) / mat.readElement(k,k);
-        mat.writeElement(mult, i, k);
-        for(j = k + 1; j < dim; ++j)
-          mat(i,j) -= mult * mat.readElement(k,j);
+    // A22 -= L21 * U12:
+    for (size_type jb = ke; jb < dim; jb += chunk){
+      const size_type je = std::min( jb + chunk, dim );
+      for (size_type i = ke; i < dim; ++i){
+        T* row_i = a + i*ld;
+        for (size_type k = kb; k < ke; ++k){
+          const T mult = row_i[k];
+          if ( mult != T(0) ){
+            const T* row_k = a + k*ld;
+            for (size_type j = jb; j < je; ++j)
+              row_i[j] -= mult * row_k[j];
+          }
+        }
       }
     }
   }
+  factorized = 1;
+}
+
+
+template <typename T>
+    /**
+ * Solve system. Factorizes the matrix if it was not done before.
+ * @return Reference to solution vector.
+     */
+    Vector<T>& Gauss<T>::solve()
+{
+  if ( !factorized ) factorize();
+  std::vector<T> b( dim );
+  for (size_type k = 0; k < dim; ++k) b[k] = vec.readElement(k);
+  substitute( &b[0], 1 );
+  for (size_type k = 0; k < dim; ++k) vec.writeElement( b[k], k );
+  return vec;
+}
+
+
+template <typename T>
+    /**
+ * Solve system for a new right hand side, reusing the factorization.
+ * @param vec_in RHS Vector.
+ * @return Reference to solution vector.
+     */
+    Vector<T>& Gauss<T>::solve( const Vector<T>& vec_in )
+{
+  if ( vec.size() != vec_in.size() ) vec.resize( vec_in.size() );
+  vec = vec_in;
+  return this->solve();
+}
 
-  for(i = 1; i < dim; ++i){
-    for(j = 0; j < i; ++j)
-      vec(i) -= mat.readElement(i,j) * vec.readElement(j);
+
+template <typename T>
+    /**
+ * Solve system for a block of right hand sides with a single
+ * factorization (factorizes the matrix if it was not done before).
+ * @param rhs DenseMatrix with one right hand side in each column.
+ * @return Reference to the DenseMatrix of solutions, one in each column.
+     */
+    DenseMatrix<T>& Gauss<T>::solve( const DenseMatrix<T>& rhs )
+{
+  if ( rhs.rows() != dim ){
+    std::stringstream message;
+    message << "Gauss: the right hand sides have " << rhs.rows() << " rows, Squared Matrix dimension: " << dim << "." << endl;
+    LMX_THROW(dimension_error, message.str() );
   }
+  if ( !factorized ) factorize();
+  const size_type nrhs = rhs.cols();
+  block.resize( dim, nrhs );
+  std::vector<T> b( dim*nrhs );
+  const T* r = rhs.data_pointer();
+  const size_type ld_r = rhs.getLeadingDim();
+  for (size_type i = 0; i < dim; ++i)
+    std::copy( r + i*ld_r, r + i*ld_r + nrhs, &b[i*nrhs] );
+  substitute( &b[0], nrhs );
+  T* x = block.data_pointer();
+  const size_type ld_x = block.getLeadingDim();
+  for (size_type i = 0; i < dim; ++i)
+    std::copy( &b[i*nrhs], &b[i*nrhs] + nrhs, x + i*ld_x );
+  return block;
+}
+
 
-  for(i = dim - 1; i >= 0; --i){
-    for(j = i+1; j<dim; ++j){
-      vec(i) -= mat.readElement(i,j) * vec.readElement(j);
+template <typename T>
+    /**
+ * Row interchanges, forward and back substitution with the stored factors.
+ * @param b Right hand sides, overwritten by the solutions: b[i*nrhs + l]
+ * is the row i of the right hand side l.
+ * @param nrhs Number of right hand sides.
+     */
+    void Gauss<T>::substitute( T* b, size_type nrhs )
+{
+  const T* a = mat.data_pointer();
+  const size_type ld = mat.getLeadingDim();
+
+  for (size_type k = 0; k < dim; ++k)
+    if ( piv[k] != k )
+      std::swap_ranges( b + k*nrhs, b + (k+1)*nrhs, b + piv[k]*nrhs );
+
+  for (size_type i = 1; i < dim; ++i){
+    const T* row_i = a + i*ld;
+    T* b_i = b + i*nrhs;
+    for (size_type j = 0; j < i; ++j){
+      const T mult = row_i[j];
+      if ( mult != T(0) ){
+        const T* b_j = b + j*nrhs;
+        for (size_type l = 0; l < nrhs; ++l) b_i[l] -= mult * b_j[l];
+      }
     }
-    vec(i) /= mat.readElement(i,i);
   }
 
-  return vec;
+  for (size_type i = dim; i-- > 0; ){
+    const T* row_i = a + i*ld;
+    T* b_i = b + i*nrhs;
+    for (size_type j = i+1; j < dim; ++j){
+      const T mult = row_i[j];
+      if ( mult != T(0) ){
+        const T* b_j = b + j*nrhs;
+        for (size_type l = 0; l < nrhs; ++l) b_i[l] -= mult * b_j[l];
+      }
+    }
+    for (size_type l = 0; l < nrhs; ++l) b_i[l] /= row_i[i];
+  }
 }
 
 
-
 }
 
 #endif
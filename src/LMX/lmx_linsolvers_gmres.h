@@ -0,0 +1,293 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef GMRES_SOLVER_H
+#define GMRES_SOLVER_H
+
+#include <vector>
+#include <cmath>
+
+#include "lmx_mat_vector.h"
+#include "lmx_linsolvers_operator.h"
+#include "lmx_linsolvers_precond.h"
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_gmres.h
+
+      \brief Restarted GMRES class implementation
+
+      Implements the GMRES(m) linear solver method over a LinearOperator.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+  *
+  * \class Gmres
+  * \brief Template class Gmres.
+  * This class implements the restarted generalized minimal residual
+  * method, GMRES(m), with optional right preconditioning. The operator
+  * is only accessed through LinearOperator::apply(), so the matrix of
+  * the system never needs to be formed. Built from a Matrix, any type
+  * of container can be used and precond() sets the JacobiPrecond, as in Cg.
+  *
+  * The Arnoldi basis is orthogonalized with modified Gram-Schmidt and
+  * the least squares problem is solved with Givens rotations.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class Gmres{
+
+public:
+  Gmres( LinearOperator<T>*, Vector<T>* );
+
+  Gmres( Matrix<T>*, Vector<T>* );
+
+  ~Gmres()
+  { delete matrix_op; delete jacobi; }
+
+  void precond();
+
+  void setPreconditioner( LinearOperator<T>* prec_in )
+  /**
+   * Sets the right preconditioner: the operator that approximates M^-1.
+   * @param prec_in Preconditioner operator, z = M^-1 * r.
+   */
+  { M = prec_in; }
+
+  void setRestart( size_type m )
+  /**
+   * @param m Dimension of the Krylov subspace before restarting.
+   */
+  { restart = m; }
+
+  void setTolerance( T eps )
+  /**
+   * @param eps Relative residual reduction || b - A*x || / || b ||.
+   */
+  { epsi = eps; }
+
+  void setMaxIterations( size_type kmax_in )
+  /**
+   * @param kmax_in Maximum number of operator products.
+   */
+  { kmax = kmax_in; }
+
+  size_type getIterations() const
+  /**
+   * @return Number of iterations of the last solve() call.
+   */
+  { return iterations; }
+
+  T getResidual() const
+  /**
+   * @return Relative residual achieved by the last solve() call.
+   */
+  { return tole; }
+
+  Vector<T>& solve( int info = 0 );
+
+private:
+  LinearOperator<T>* A;
+  LinearOperator<T>* M;
+  Matrix<T>* A_mat;
+  MatrixOperator<T>* matrix_op;
+  JacobiPrecond<T>* jacobi;
+  Vector<T>* b;
+  Vector<T> x;
+  size_type nrow;
+  size_type restart;
+  size_type kmax;
+  size_type iterations;
+  T epsi;
+  T tole;
+};
+
+} //namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+
+namespace lmx{
+
+/**
+ * Standard constructor.
+ * @param A_in LHS operator.
+ * @param b_in RHS Vector.
+ */
+template <typename T>
+    Gmres<T>::Gmres( LinearOperator<T>* A_in, Vector<T>* b_in )
+  : A(A_in), M(0), A_mat(0), matrix_op(0), jacobi(0), b(b_in)
+  , nrow(b_in->size()), restart(30), iterations(0), epsi(1E-6), tole(1)
+{
+  kmax = nrow+20;
+  x.resize( nrow );
+}
+
+
+/**
+ * Constructor for Matrix systems.
+ * @param A_in LHS Matrix.
+ * @param b_in RHS Vector.
+ */
+template <typename T>
+    Gmres<T>::Gmres( Matrix<T>* A_in, Vector<T>* b_in )
+  : M(0), A_mat(A_in), jacobi(0), b(b_in)
+  , nrow(b_in->size()), restart(30), iterations(0), epsi(1E-6), tole(1)
+{
+  matrix_op = new MatrixOperator<T>( A_in );
+  A = matrix_op;
+  kmax = nrow+20;
+  x.resize( nrow );
+}
+
+
+/**
+ * Sets the Jacobi (or block-Jacobi) preconditioner of the Matrix.
+ */
+template <typename T>
+    void Gmres<T>::precond()
+{
+  if ( !A_mat ){
+    std::stringstream message;
+    message << "Error in Gmres: precond() needs a Matrix, "
+        << "use setPreconditioner() with LinearOperator systems." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  delete jacobi;
+  jacobi = new JacobiPrecond<T>( A_mat );
+  M = jacobi;
+}
+
+
+/**
+ * Solves the system starting from a null initial guess.
+ * @param info Prints the residual of each iteration if greater than zero.
+ * @return Reference to the solution Vector.
+ */
+template <typename T>
+    Vector<T>& Gmres<T>::solve( int info )
+{
+  size_type m = restart < nrow ? restart : nrow;
+  std::vector< Vector<T> > V( m+1, Vector<T>(nrow) );
+  std::vector< Vector<T> > Z( M ? m : 0, Vector<T>(nrow) );
+  std::vector<T> H( (m+1)*m ); // column major, H[i+j*(m+1)]
+  std::vector<T> cs( m ), sn( m ), g( m+1 ), y( m );
+  Vector<T> w( nrow );
+
+  x.fillIdentity( 0. );
+  iterations = 0;
+  T beta0 = b->norm2();
+  tole = 0;
+  if ( beta0 == 0. ) return x;
+
+  bool first = 1;
+  while ( iterations < kmax ){
+    // r = b - A*x:
+    if ( first ) V[0] = *b;
+    else{
+      A->apply( w, x );
+      V[0].subs( *b, w );
+    }
+    first = 0;
+    T beta = V[0].norm2();
+    tole = beta / beta0;
+    if ( tole <= epsi ) break;
+    V[0] *= 1. / beta;
+    g[0] = beta;
+
+    size_type k = 0;
+    while ( k < m && iterations < kmax ){
+      if ( M ){
+        M->apply( Z[k], V[k] );
+        A->apply( w, Z[k] );
+      }
+      else A->apply( w, V[k] );
+      // Modified Gram-Schmidt:
+      for ( size_type i = 0; i <= k; ++i ){
+        H[i+k*(m+1)] = w * V[i];
+        w.axpy( -H[i+k*(m+1)], V[i] );
+      }
+      T h = w.norm2();
+      H[k+1+k*(m+1)] = h;
+      if ( h != 0. ){
+        V[k+1] = w;
+        V[k+1] *= 1. / h;
+      }
+      // Previous rotations over the new column:
+      for ( size_type i = 0; i < k; ++i ){
+        T temp = cs[i]*H[i+k*(m+1)] + sn[i]*H[i+1+k*(m+1)];
+        H[i+1+k*(m+1)] = -sn[i]*H[i+k*(m+1)] + cs[i]*H[i+1+k*(m+1)];
+        H[i+k*(m+1)] = temp;
+      }
+      // New rotation eliminating H(k+1,k):
+      T hkk = H[k+k*(m+1)];
+      T den = std::sqrt( hkk*hkk + h*h );
+      cs[k] = den == 0. ? 1. : hkk / den;
+      sn[k] = den == 0. ? 0. : h / den;
+      H[k+k*(m+1)] = den;
+      H[k+1+k*(m+1)] = 0.;
+      g[k+1] = -sn[k]*g[k];
+      g[k] = cs[k]*g[k];
+
+      ++k;
+      ++iterations;
+      tole = std::abs( g[k] ) / beta0;
+      if ( info > 0 )
+        cout << "iteracion :" << iterations << "\t" << "tole = " << tole << endl;
+      if ( tole <= epsi || h == 0. ) break;
+    }
+
+    // Back substitution H(0:k,0:k)*y = g(0:k):
+    for ( size_type i = k; i-- > 0; ){
+      y[i] = g[i];
+      for ( size_type j = i+1; j < k; ++j )
+        y[i] -= H[i+j*(m+1)] * y[j];
+      y[i] /= H[i+i*(m+1)];
+    }
+    if ( M ){
+      for ( size_type i = 0; i < k; ++i )
+        x.axpy( y[i], Z[i] );
+    }
+    else{
+      for ( size_type i = 0; i < k; ++i )
+        x.axpy( y[i], V[i] );
+    }
+    if ( tole <= epsi ) break;
+  }
+
+  if ( tole > epsi )
+    cout << ":::WARNING:::" << endl
+         << ":::GMRES convergence was not achieved after " << iterations << " iterations.:::" << endl
+         << ":::END WARNING:::" << endl;
+
+  return x;
+}
+
+} //namespace lmx
+
+
+#endif
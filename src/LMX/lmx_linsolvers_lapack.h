@@ -39,6 +39,18 @@
 extern "C" void   dgesv_(int *n, int *nrhs, double *a, int *lda, int *ipiv, 
                          double *b, int *ldb, int *info );
 
+/**
+ * Declaration of external function (LU factorization). Defined in any Lapack compatible library.
+ */
+extern "C" void   dgetrf_(int *m, int *n, double *a, int *lda, int *ipiv,
+                          int *info );
+
+/**
+ * Declaration of external function (solution with the LU factors). Defined in any Lapack compatible library.
+ */
+extern "C" void   dgetrs_(char *trans, int *n, int *nrhs, double *a, int *lda,
+                          int *ipiv, double *b, int *ldb, int *info );
+
 namespace lmx{
 
 /**
@@ -46,6 +58,9 @@ namespace lmx{
  * \class Gesv
  * \brief Template class for lapack ?gesv routine.
  *
+ * factorize() calls ?getrf and keeps the LU factors and pivots, so
+ * solve(Vector<T>*) can solve for a new right hand side with ?getrs only.
+ *
  * @author Daniel Iglesias Ibez.
  */
 template <typename T> class Gesv{
@@ -60,19 +75,24 @@ template <typename T> class Gesv{
     int info;
     int i,j;
     T** la;
+    bool factorized;
 
   public:
     /**
      * Empty constructor.
      */
-    Gesv(){}
+    Gesv() : lb(0), ipiv(0), la(0), factorized(0) {}
 
     Gesv( Matrix<T>*, Vector<T>*, Vector<T>* );
 
     ~Gesv();
 
+    void factorize();
+
     void solve();
 
+    void solve( Vector<T>* );
+
 };
 
 template <typename T>
@@ -89,7 +109,8 @@ Gesv<T>::Gesv( Matrix<T>* a_in, Vector<T>* x_in, Vector<T>* b_in ) :
     lda( n ),
     ldb( n ),
     lb( new T[n] ),
-    ipiv( new int[n] )
+    ipiv( new int[n] ),
+    factorized(0)
 {
   if( a_in->rows() != a_in->cols() ){
     std::stringstream message;
@@ -102,10 +123,23 @@ Gesv<T>::Gesv( Matrix<T>* a_in, Vector<T>* x_in, Vector<T>* b_in ) :
     *(la+i) = lla;
     lla += n;
   }
-  for(i = 0; i < n; ++i){
-    for(j = 0; j < n; ++j)
-      la[j][i] = a_in->readElement(i,j);
-    lb[i] = b_in->readElement(i);
+  const Type_dense<T>* dense_in = dynamic_cast<const Type_dense<T>*>(a_in->type_matrix);
+  if (dense_in){ // contiguous rows, read them with unit stride
+    const T* a = dense_in->data_pointer();
+    const size_type ld = dense_in->getLeadingDim();
+    for(i = 0; i < n; ++i){
+      const T* row_i = a + i*ld;
+      for(j = 0; j < n; ++j)
+        la[j][i] = row_i[j];
+      lb[i] = b_in->readElement(i);
+    }
+  }
+  else{
+    for(i = 0; i < n; ++i){
+      for(j = 0; j < n; ++j)
+        la[j][i] = a_in->readElement(i,j);
+      lb[i] = b_in->readElement(i);
+    }
   }
 }
 
@@ -119,6 +153,10 @@ template <typename T>
     delete [] lb;
     lb = 0;
   }
+  if (ipiv){
+    delete [] ipiv;
+    ipiv = 0;
+  }
   if (la){
     delete [] *la;
     delete [] la;
@@ -126,6 +164,31 @@ template <typename T>
   }
 } 
 
+/**
+ * LU factorization
+ */
+template <typename T>
+    void Gesv<T>::factorize()
+{
+  std::stringstream message;
+  message << "ERROR: Solver not implemented for this data type."
+          << endl;
+  LMX_THROW(to_be_done_error, message.str() );
+
+}
+
+/**
+ * Solve system for a new right hand side, reusing the factorization.
+ * @param b_in Pointer to rhs Vector.
+ */
+template <typename T>
+    void Gesv<T>::solve( Vector<T>* b_in )
+{
+  for(i = 0; i < n; ++i)
+    lb[i] = b_in->readElement(i);
+  this->solve();
+}
+
 /**
  * Solve system
  * @return Reference to solution vector.
@@ -147,11 +210,28 @@ template <typename T>
 template <>
     inline void Gesv<double>::solve()
 {
-  dgesv_(&n, &nrhs, la[0], &lda, ipiv, lb, &ldb, &info);
+  if (factorized){
+    char trans = 'N';
+    dgetrs_(&trans, &n, &nrhs, la[0], &lda, ipiv, lb, &ldb, &info);
+  }
+  else{
+    dgesv_(&n, &nrhs, la[0], &lda, ipiv, lb, &ldb, &info);
+    factorized = 1;
+  }
   for(i = 0; i < n; ++i)
     x->writeElement( lb[i], i );
 }
 
+/**
+ * LU factorization, specialized for double data type.
+ */
+template <>
+    inline void Gesv<double>::factorize()
+{
+  dgetrf_(&n, &n, la[0], &lda, ipiv, &info);
+  factorized = 1;
+}
+
 }
 
 #endif
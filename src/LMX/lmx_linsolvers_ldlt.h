@@ -0,0 +1,622 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LDLT_SOLVER_H
+#define LDLT_SOLVER_H
+
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <utility>
+#include <cmath>
+
+#include "lmx_mat_vector.h"
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_ldlt.h
+
+      \brief Sparse LDL^T class implementation
+
+      Implements the sparse LDL^T direct solver for symmetric sparse
+      matrices, with approximate minimum degree ordering.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+ *
+ * \class Ldlt
+ * \brief Template class Ldlt for sparse symmetric linear systems.
+ *
+ * Factorizes P*A*P^T = L*D*L^T, with L unit lower triangular and D
+ * diagonal, reading the values directly from the arrays of a sparse Matrix:
+ * Type_csc (1), Type_csr (5), Type_csc_sym (6) or Type_bsr (7, 8, 9). Only
+ * the upper part of the permuted matrix is read, and the pattern of Type_csr
+ * rows is taken as the one of the columns, so A must be symmetric. No
+ * pivoting is done, so A must be positive definite or quasi-definite.
+ *
+ * The solution is split in three phases:
+ * - analyse(): fill-reducing ordering (approximate minimum degree),
+ *   elimination tree and column counts of L. It only depends on the
+ *   sparsity pattern.
+ * - factorize(): numerical values of L and D (up-looking factorization,
+ *   row by row following the elimination tree). The analysis is reused
+ *   while the pattern of the Matrix does not change.
+ * - solve(): forward, diagonal and backward substitutions.
+ *
+ * @author Daniel Iglesias Ib��ez.
+ */
+template <typename T> class Ldlt{
+  public:
+    Ldlt();
+
+    Ldlt( Matrix<T>* );
+
+    /**
+     * Destructor
+     */
+    ~Ldlt(){}
+
+    void setOrdering( int type )
+    /**
+     * @param type 0 = natural order, 1 = approximate minimum degree (default).
+     */
+    { ordering = type; analysed = 0; }
+
+    void analyse( Matrix<T>* );
+
+    void factorize( Matrix<T>* );
+
+    void solve( Vector<T>&, const Vector<T>& );
+
+    /**
+     * Analysis state.
+     * @return TRUE if the ordering and the structure of L are computed.
+     */
+    bool isAnalysed() const
+    { return analysed; }
+
+    /**
+     * Factorization state.
+     * @return TRUE if the L and D factors are stored.
+     */
+    bool isFactorized() const
+    { return factorized; }
+
+    /**
+     * @return Number of non-zeros of L, not counting its unit diagonal.
+     */
+    size_type getFactorNonZeros() const
+    { return l_ptr.empty() ? 0 : l_ptr[dim]; }
+
+    /**
+     * @return Permutation, the k-th unknown eliminated is perm[k].
+     */
+    const std::vector<size_type>& getPermutation() const
+    { return perm; }
+
+  private:
+    void minimumDegree( const std::vector<size_type>&,
+                        const std::vector<size_type>& );
+    void readPattern( const Matrix<T>*, std::vector<size_type>&,
+                      std::vector<size_type>&, std::vector<size_type>& );
+    template <int B> void readBlocks( const Type_bsr<T,B>* );
+    void compressTriplets( size_type, std::vector<size_type>&,
+                           std::vector<size_type>&, std::vector<size_type>& );
+    const T* values( const Matrix<T>* ) const;
+    bool samePattern( const Matrix<T>* );
+
+    size_type dim;
+    int ordering;
+    bool analysed;
+    bool factorized;
+    std::vector<size_type> pattern_ptr, pattern_row; /**< Analysed pattern of A, both triangles. */
+    std::vector<size_type> pattern_pos; /**< Position of each term of the pattern in the values of A. */
+    std::vector<size_type> check_ptr, check_row, check_pos; /**< Pattern read to check for changes. */
+    std::vector<size_type> t_row, t_col, t_pos; /**< Triplets of the expanded pattern. */
+    std::vector<size_type> perm, pinv; /**< Ordering and its inverse. */
+    std::vector<size_type> c_ptr, c_row, c_pos; /**< Upper part of P*A*P^T, positions in A. */
+    std::vector<size_type> parent; /**< Elimination tree. */
+    std::vector<size_type> l_ptr, l_row, l_nz; /**< Structure of L by columns. */
+    std::vector<T> l_val, d; /**< Values of L and D. */
+    std::vector<T> y; /**< Work vector. */
+    std::vector<size_type> flag, stack; /**< Work vectors. */
+};
+
+}; // namespace lmx
+
+
+/////////////////////////////// Implementation of the methods defined previously
+
+
+namespace lmx{
+
+template <typename T>
+    /**
+ * Empty constructor.
+     */
+    Ldlt<T>::Ldlt()
+  : dim(0), ordering(1), analysed(0), factorized(0)
+{ }
+
+
+template <typename T>
+    /**
+ * Standard constructor. Analyses the pattern of the matrix.
+ * @param mat_in Pointer to a Type_csc Matrix.
+     */
+    Ldlt<T>::Ldlt( Matrix<T>* mat_in )
+  : dim(0), ordering(1), analysed(0), factorized(0)
+{
+  analyse( mat_in );
+}
+
+
+template <typename T>
+    /**
+ * Symbolic factorization: ordering, elimination tree and column counts.
+ * @param mat_in Pointer to a sparse Matrix (types 1, 5, 6, 7, 8 or 9).
+     */
+    void Ldlt<T>::analyse( Matrix<T>* mat_in )
+{
+  if( mat_in->rows() != mat_in->cols() ){
+    std::stringstream message;
+    message << "Trying to build a Ldlt object with a non-squared matrix.\nSize of matrix(" << mat_in->rows() << ", " << mat_in->cols() << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  dim = mat_in->rows();
+  size_type none = dim;
+  readPattern( mat_in, pattern_ptr, pattern_row, pattern_pos );
+
+  if ( ordering == 1 ) minimumDegree( pattern_ptr, pattern_row );
+  else{
+    perm.resize( dim );
+    for ( size_type k = 0; k < dim; ++k ) perm[k] = k;
+  }
+  pinv.resize( dim );
+  for ( size_type k = 0; k < dim; ++k ) pinv[ perm[k] ] = k;
+
+  // Upper part of the permuted matrix, by columns:
+  c_ptr.assign( dim+1, 0 );
+  c_row.clear();
+  c_pos.clear();
+  for ( size_type k = 0; k < dim; ++k ){
+    size_type j = perm[k];
+    for ( size_type p = pattern_ptr[j]; p < pattern_ptr[j+1]; ++p ){
+      if ( pinv[ pattern_row[p] ] <= k ){
+        c_row.push_back( pinv[ pattern_row[p] ] );
+        c_pos.push_back( pattern_pos[p] );
+      }
+    }
+    c_ptr[k+1] = c_row.size();
+  }
+
+  // Elimination tree and number of non-zeros of each column of L:
+  parent.assign( dim, none );
+  flag.assign( dim, none );
+  l_nz.assign( dim, 0 );
+  for ( size_type k = 0; k < dim; ++k ){
+    flag[k] = k;
+    for ( size_type p = c_ptr[k]; p < c_ptr[k+1]; ++p ){
+      for ( size_type i = c_row[p]; flag[i] != k; i = parent[i] ){
+        if ( parent[i] == none ) parent[i] = k;
+        ++l_nz[i];
+        flag[i] = k;
+      }
+    }
+  }
+  l_ptr.assign( dim+1, 0 );
+  for ( size_type k = 0; k < dim; ++k ) l_ptr[k+1] = l_ptr[k] + l_nz[k];
+  l_row.resize( l_ptr[dim] );
+  l_val.resize( l_ptr[dim] );
+  d.resize( dim );
+  y.assign( dim, 0. );
+  stack.resize( dim );
+  analysed = 1;
+  factorized = 0;
+}
+
+
+template <typename T>
+    /**
+ * Numerical factorization. The matrix is analysed first if it was not, or
+ * if its sparsity pattern is not the analysed one.
+ * @param mat_in Pointer to a sparse Matrix (types 1, 5, 6, 7, 8 or 9).
+     */
+    void Ldlt<T>::factorize( Matrix<T>* mat_in )
+{
+  if ( !analysed || mat_in->rows() != dim || !samePattern( mat_in ) )
+    analyse( mat_in );
+  const T* aa = values( mat_in );
+  size_type none = dim;
+
+  factorized = 0;
+  flag.assign( dim, none );
+  for ( size_type k = 0; k < dim; ++k ){
+    // Scatter column k of the permuted matrix and find the pattern of row k of L:
+    size_type top = dim;
+    flag[k] = k;
+    l_nz[k] = 0;
+    for ( size_type p = c_ptr[k]; p < c_ptr[k+1]; ++p ){
+      size_type i = c_row[p];
+      y[i] += aa[ c_pos[p] ];
+      size_type len = 0;
+      for ( ; flag[i] != k; i = parent[i] ){
+        stack[len++] = i;
+        flag[i] = k;
+      }
+      while ( len > 0 ) stack[--top] = stack[--len];
+    }
+    // Sparse triangular solve for row k of L:
+    d[k] = y[k];
+    y[k] = 0.;
+    for ( ; top < dim; ++top ){
+      size_type i = stack[top];
+      T yi = y[i];
+      y[i] = 0.;
+      size_type end = l_ptr[i] + l_nz[i];
+      for ( size_type p = l_ptr[i]; p < end; ++p )
+        y[ l_row[p] ] -= l_val[p] * yi;
+      T l_ki = yi / d[i];
+      d[k] -= l_ki * yi;
+      l_row[end] = k;
+      l_val[end] = l_ki;
+      ++l_nz[i];
+    }
+    if ( d[k] == 0. ){
+      std::stringstream message;
+      message << "Null pivot in Ldlt factorization. Term position: " << perm[k]
+          << ". Squared Matrix dimension: " << dim << "." << endl;
+      LMX_THROW(internal_error, message.str() );
+    }
+  }
+  factorized = 1;
+}
+
+
+template <typename T>
+    /**
+ * Solves the system with the stored factors.
+ * @param x Solution Vector.
+ * @param b RHS Vector (may be the same object as x).
+     */
+    void Ldlt<T>::solve( Vector<T>& x, const Vector<T>& b )
+{
+  if ( !factorized ){
+    std::stringstream message;
+    message << "Ldlt solve() called before factorize()." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  for ( size_type k = 0; k < dim; ++k ) y[k] = b.readElement( perm[k] );
+  for ( size_type j = 0; j < dim; ++j ){
+    T yj = y[j];
+    for ( size_type p = l_ptr[j]; p < l_ptr[j+1]; ++p )
+      y[ l_row[p] ] -= l_val[p] * yj;
+  }
+  for ( size_type j = 0; j < dim; ++j ) y[j] /= d[j];
+  for ( size_type j = dim; j-- > 0; ){
+    T yj = y[j];
+    for ( size_type p = l_ptr[j]; p < l_ptr[j+1]; ++p )
+      yj -= l_val[p] * y[ l_row[p] ];
+    y[j] = yj;
+  }
+  for ( size_type k = 0; k < dim; ++k ){
+    x.writeElement( y[k], perm[k] );
+    y[k] = 0.;
+  }
+}
+
+
+template <typename T>
+    /**
+ * Compares the pattern of a matrix with the analysed one.
+ * @param mat_in Pointer to a sparse Matrix.
+ * @return TRUE if both patterns are equal.
+     */
+    bool Ldlt<T>::samePattern( const Matrix<T>* mat_in )
+{
+  readPattern( mat_in, check_ptr, check_row, check_pos );
+  return check_ptr == pattern_ptr && check_row == pattern_row
+      && check_pos == pattern_pos;
+}
+
+
+template <typename T>
+    /**
+ * Reads the pattern of both triangles of the matrix by columns.
+ * @param mat_in Pointer to a sparse Matrix (types 1, 5, 6, 7, 8 or 9).
+ * @param ptr Column pointers.
+ * @param row Row indices.
+ * @param pos Position of each term in the values of the Matrix.
+     */
+    void Ldlt<T>::readPattern( const Matrix<T>* mat_in,
+                               std::vector<size_type>& ptr,
+                               std::vector<size_type>& row,
+                               std::vector<size_type>& pos )
+{
+  size_type n = mat_in->rows();
+  switch ( getMatrixType() ) {
+    case 1 :
+    {
+      const Type_csc<T>* csc = static_cast<const Type_csc<T>*>( mat_in->type_matrix );
+      ptr.assign( csc->ja.begin(), csc->ja.begin() + n+1 );
+      row.assign( csc->ia.begin(), csc->ia.begin() + csc->ja[n] );
+      pos.resize( row.size() );
+      for ( size_type p = 0; p < pos.size(); ++p ) pos[p] = p;
+      return;
+    }
+
+    case 5 : // rows of the symmetric matrix are read as columns
+    {
+      const Type_csr<T>* csr = static_cast<const Type_csr<T>*>( mat_in->type_matrix );
+      ptr.assign( csr->ia.begin(), csr->ia.begin() + n+1 );
+      row.assign( csr->ja.begin(), csr->ja.begin() + csr->ia[n] );
+      pos.resize( row.size() );
+      for ( size_type p = 0; p < pos.size(); ++p ) pos[p] = p;
+      return;
+    }
+
+    case 6 : // each stored term of the lower triangle is also its symmetric one
+    {
+      const Type_csc_sym<T>* sym = static_cast<const Type_csc_sym<T>*>( mat_in->type_matrix );
+      t_row.clear(); t_col.clear(); t_pos.clear();
+      for ( size_type j = 0; j < n; ++j ){
+        for ( size_type p = sym->ja[j]; p < (size_type)sym->ja[j+1]; ++p ){
+          size_type i = sym->ia[p];
+          t_row.push_back( i ); t_col.push_back( j ); t_pos.push_back( p );
+          if ( i != j ){
+            t_row.push_back( j ); t_col.push_back( i ); t_pos.push_back( p );
+          }
+        }
+      }
+      break;
+    }
+
+    case 7 :
+      readBlocks( static_cast<const Type_bsr<T,2>*>( mat_in->type_matrix ) );
+      break;
+
+    case 8 :
+      readBlocks( static_cast<const Type_bsr<T,3>*>( mat_in->type_matrix ) );
+      break;
+
+    case 9 :
+      readBlocks( static_cast<const Type_bsr<T,6>*>( mat_in->type_matrix ) );
+      break;
+
+    default :
+    {
+      std::stringstream message;
+      message << "Ldlt solver needs a sparse Matrix (types 1, 5, 6, 7, 8 or 9), Matrix type = "
+          << getMatrixType() << "." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+  }
+  compressTriplets( n, ptr, row, pos );
+}
+
+
+template <typename T>
+  template <int B>
+    /**
+ * Expands the blocks of a Type_bsr matrix to triplets.
+ * @param bsr Matrix container.
+     */
+    void Ldlt<T>::readBlocks( const Type_bsr<T,B>* bsr )
+{
+  t_row.clear(); t_col.clear(); t_pos.clear();
+  for ( size_type bi = 0; bi < bsr->Nbrow; ++bi ){
+    for ( size_type k = bsr->ia[bi]; k < (size_type)bsr->ia[bi+1]; ++k ){
+      size_type bj = bsr->ja[k];
+      for ( size_type i = 0; i < (size_type)B; ++i ){
+        for ( size_type j = 0; j < (size_type)B; ++j ){
+          t_row.push_back( bi*B + i );
+          t_col.push_back( bj*B + j );
+          t_pos.push_back( k*B*B + i*B + j );
+        }
+      }
+    }
+  }
+}
+
+
+template <typename T>
+    /**
+ * Sorts the triplets by columns (counting sort, rows keep their order).
+ * @param n Number of columns.
+ * @param ptr Column pointers.
+ * @param row Row indices.
+ * @param pos Position of each term in the values of the Matrix.
+     */
+    void Ldlt<T>::compressTriplets( size_type n,
+                                    std::vector<size_type>& ptr,
+                                    std::vector<size_type>& row,
+                                    std::vector<size_type>& pos )
+{
+  size_type nnz = t_row.size();
+  ptr.assign( n+1, 0 );
+  for ( size_type p = 0; p < nnz; ++p ) ++ptr[ t_col[p]+1 ];
+  for ( size_type j = 0; j < n; ++j ) ptr[j+1] += ptr[j];
+  row.resize( nnz );
+  pos.resize( nnz );
+  std::vector<size_type> next( ptr.begin(), ptr.end()-1 );
+  for ( size_type p = 0; p < nnz; ++p ){
+    size_type q = next[ t_col[p] ]++;
+    row[q] = t_row[p];
+    pos[q] = t_pos[p];
+  }
+}
+
+
+template <typename T>
+    /**
+ * @param mat_in Pointer to a sparse Matrix (types 1, 5, 6, 7, 8 or 9).
+ * @return Pointer to the values array of the Matrix.
+     */
+    const T* Ldlt<T>::values( const Matrix<T>* mat_in ) const
+{
+  switch ( getMatrixType() ) {
+    case 1 : return &static_cast<const Type_csc<T>*>( mat_in->type_matrix )->aa[0];
+    case 5 : return &static_cast<const Type_csr<T>*>( mat_in->type_matrix )->aa[0];
+    case 6 : return &static_cast<const Type_csc_sym<T>*>( mat_in->type_matrix )->aa[0];
+    case 7 : return &static_cast<const Type_bsr<T,2>*>( mat_in->type_matrix )->aa[0];
+    case 8 : return &static_cast<const Type_bsr<T,3>*>( mat_in->type_matrix )->aa[0];
+    case 9 : return &static_cast<const Type_bsr<T,6>*>( mat_in->type_matrix )->aa[0];
+  }
+  return 0;
+}
+
+
+template <typename T>
+    /**
+ * Approximate minimum degree ordering (Amestoy, Davis & Duff, 1996) of the
+ * symmetrized pattern, on the quotient graph: each eliminated unknown
+ * becomes an element that groups its neighbours, so the fill is never
+ * formed explicitly. Elements adjacent to the pivot are absorbed, and so
+ * are the ones contained in the new element (aggressive absorption).
+ * @param col_ptr Column pointers of the pattern.
+ * @param row_idx Row indices of the pattern.
+     */
+    void Ldlt<T>::minimumDegree( const std::vector<size_type>& col_ptr,
+                                 const std::vector<size_type>& row_idx )
+{
+  size_type n = dim;
+  std::vector< std::vector<size_type> > var_adj( n ), elem_adj( n ), elem_vars( n );
+  for ( size_type j = 0; j < n; ++j ){
+    for ( size_type p = col_ptr[j]; p < col_ptr[j+1]; ++p ){
+      size_type i = row_idx[p];
+      if ( i != j ){
+        var_adj[i].push_back( j );
+        var_adj[j].push_back( i );
+      }
+    }
+  }
+  std::vector<size_type> degree( n );
+  std::set< std::pair<size_type, size_type> > queue;
+  for ( size_type i = 0; i < n; ++i ){
+    std::sort( var_adj[i].begin(), var_adj[i].end() );
+    var_adj[i].erase( std::unique( var_adj[i].begin(), var_adj[i].end() ), var_adj[i].end() );
+    degree[i] = var_adj[i].size();
+    queue.insert( std::make_pair( degree[i], i ) );
+  }
+
+  std::vector<char> eliminated( n, 0 ), absorbed( n, 0 );
+  std::vector<size_type> mark( n, 0 ), w_mark( n, 0 ), w( n, 0 );
+  size_type stamp = 0;
+  perm.clear();
+  for ( size_type k = 0; k < n; ++k ){
+    size_type p = queue.begin()->second;
+    queue.erase( queue.begin() );
+    eliminated[p] = 1;
+    perm.push_back( p );
+
+    // New element: neighbours of p, directly or through its elements.
+    ++stamp;
+    std::vector<size_type>& lp = elem_vars[p];
+    for ( size_type q = 0; q < var_adj[p].size(); ++q ){
+      size_type j = var_adj[p][q];
+      if ( !eliminated[j] && mark[j] != stamp ){
+        mark[j] = stamp;
+        lp.push_back( j );
+      }
+    }
+    for ( size_type q = 0; q < elem_adj[p].size(); ++q ){
+      size_type e = elem_adj[p][q];
+      for ( size_type r = 0; r < elem_vars[e].size(); ++r ){
+        size_type j = elem_vars[e][r];
+        if ( !eliminated[j] && mark[j] != stamp ){
+          mark[j] = stamp;
+          lp.push_back( j );
+        }
+      }
+      absorbed[e] = 1;
+      std::vector<size_type>().swap( elem_vars[e] );
+    }
+    std::vector<size_type>().swap( var_adj[p] );
+    std::vector<size_type>().swap( elem_adj[p] );
+
+    // Update the adjacency of the unknowns in the new element:
+    for ( size_type q = 0; q < lp.size(); ++q ){
+      size_type i = lp[q];
+      std::vector<size_type>& ei = elem_adj[i];
+      size_type len = 0;
+      for ( size_type r = 0; r < ei.size(); ++r )
+        if ( !absorbed[ ei[r] ] ) ei[len++] = ei[r];
+      ei.resize( len );
+      ei.push_back( p );
+      std::vector<size_type>& ai = var_adj[i];
+      len = 0;
+      for ( size_type r = 0; r < ai.size(); ++r )
+        if ( !eliminated[ ai[r] ] && mark[ ai[r] ] != stamp ) ai[len++] = ai[r];
+      ai.resize( len );
+    }
+
+    // |Le \ Lp| for the elements adjacent to the new one:
+    for ( size_type q = 0; q < lp.size(); ++q ){
+      std::vector<size_type>& ei = elem_adj[ lp[q] ];
+      for ( size_type r = 0; r + 1 < ei.size(); ++r ){
+        size_type e = ei[r];
+        if ( w_mark[e] != stamp ){
+          w_mark[e] = stamp;
+          w[e] = elem_vars[e].size();
+        }
+        --w[e];
+      }
+    }
+
+    // Approximate external degrees:
+    size_type remaining = n - k - 1;
+    for ( size_type q = 0; q < lp.size(); ++q ){
+      size_type i = lp[q];
+      std::vector<size_type>& ei = elem_adj[i];
+      size_type deg = var_adj[i].size() + lp.size() - 1;
+      size_type len = 0;
+      for ( size_type r = 0; r + 1 < ei.size(); ++r ){
+        size_type e = ei[r];
+        if ( absorbed[e] ) continue;
+        if ( w[e] == 0 ){ // Le is contained in Lp
+          absorbed[e] = 1;
+          std::vector<size_type>().swap( elem_vars[e] );
+          continue;
+        }
+        deg += w[e];
+        ei[len++] = e;
+      }
+      ei[len++] = p;
+      ei.resize( len );
+      deg = std::min( deg, remaining - 1 );
+      deg = std::min( deg, degree[i] + lp.size() );
+      queue.erase( std::make_pair( degree[i], i ) );
+      degree[i] = deg;
+      queue.insert( std::make_pair( deg, i ) );
+    }
+  }
+}
+
+}; // namespace lmx
+
+
+#endif
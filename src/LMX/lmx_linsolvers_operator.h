@@ -0,0 +1,101 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LMX_LINEAR_OPERATOR_H
+#define LMX_LINEAR_OPERATOR_H
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_operator.h
+
+      \brief LinearOperator class definition
+
+      Abstract "y = A*x" operator used by the iterative solvers, and its
+      implementation for Matrix objects.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+  *
+  * \class LinearOperator
+  * \brief Template class LinearOperator.
+  * Interface for objects that compute the product of a linear operator
+  * by a Vector without storing its Matrix (e.g. finite-difference
+  * Jacobians or preconditioners).
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class LinearOperator{
+
+public:
+  virtual ~LinearOperator(){}
+
+  /**
+   * Computes the operator product.
+   * @param y Result Vector, y = A*x.
+   * @param x Vector to be multiplied.
+   */
+  virtual void apply( Vector<T>& y, const Vector<T>& x ) = 0;
+
+  /**
+   * Called by LinearSystem when the values of its Matrix may have changed
+   * (solveYourself() with recalc == FALSE). Operators that depend on the
+   * Matrix, passed as argument, can recompute themselves; by default
+   * nothing is done.
+   */
+  virtual void update( Matrix<T>* ) {}
+};
+
+
+/**
+  *
+  * \class MatrixOperator
+  * \brief Template class MatrixOperator.
+  * LinearOperator that multiplies by a Matrix of any type.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class MatrixOperator : public LinearOperator<T>{
+
+public:
+  /**
+   * Standard constructor.
+   * @param A_in Matrix of the operator (not copied).
+   */
+  MatrixOperator( Matrix<T>* A_in ) : A(A_in) {}
+
+  void apply( Vector<T>& y, const Vector<T>& x )
+  { y.mult( *A, x ); }
+
+private:
+  Matrix<T>* A;
+};
+
+} //namespace lmx
+
+
+#endif
@@ -0,0 +1,660 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMX_PRECOND_H
+#define LMX_PRECOND_H
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "lmx_mat_vector.h"
+#include "lmx_linsolvers_operator.h"
+
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_linsolvers_precond.h
+
+      \brief Preconditioners for the iterative linear solvers
+
+      Implements preconditioners as LinearOperator objects (z = M^-1 * r), so
+      they can be shared by Cg, Gmres and BiCGStab:
+      - JacobiPrecond: inverse of the diagonal (or of the Type_bsr blocks).
+      - BlockJacobiPrecond: inverses of consecutive diagonal blocks.
+      - SSORPrecond: symmetric successive over-relaxation.
+      - ILU0Precond: incomplete LU without fill-in.
+      - IC0Precond: incomplete Cholesky without fill-in (symmetric matrices).
+
+      The last four are built on the compressed arrays of Type_csc (Matrix
+      type 1); other matrix types are compressed first reading all their
+      elements.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx{
+
+/**
+  *
+  * \class JacobiPrecond
+  * \brief Template class JacobiPrecond.
+  * Diagonal (Jacobi) preconditioner. Block sparse matrices (Type_bsr)
+  * use the inverses of their diagonal blocks (block-Jacobi).
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class JacobiPrecond : public LinearOperator<T>{
+
+public:
+  JacobiPrecond( Matrix<T>* );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void update( Matrix<T>* );
+
+private:
+  size_type nrow;
+  Vector<T> mp; /**< Inverse of the diagonal. */
+  std::vector<T> block_inv; /**< Inverses of the diagonal blocks (Type_bsr). */
+  size_type block_size;
+};
+
+
+/**
+  *
+  * \class SparsePrecond
+  * \brief Template class SparsePrecond.
+  * Base of the preconditioners built on the sparsity pattern of the matrix.
+  * Keeps the matrix in compressed sparse rows, obtained from the Type_csc
+  * container, with the columns of each row in increasing order.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class SparsePrecond : public LinearOperator<T>{
+
+protected:
+  SparsePrecond() : nrow(0) {}
+
+  SparsePrecond( Matrix<T>* );
+
+  void load( Matrix<T>* );
+
+  size_type find( size_type, size_type ) const;
+
+  size_type nrow;
+  std::vector<size_type> row_ptr; /**< Start of each row in col_idx and val. */
+  std::vector<size_type> col_idx; /**< Column of each stored element. */
+  std::vector<size_type> diag_pos; /**< Position of the diagonal element of each row. */
+  std::vector<T> val; /**< Values of the stored elements. */
+};
+
+
+/**
+  *
+  * \class BlockJacobiPrecond
+  * \brief Template class BlockJacobiPrecond.
+  * Block-Jacobi preconditioner with consecutive diagonal blocks of a given
+  * size (the last one may be smaller), e.g. the degrees of freedom of each
+  * node.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class BlockJacobiPrecond : public SparsePrecond<T>{
+
+public:
+  BlockJacobiPrecond( Matrix<T>*, size_type );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void update( Matrix<T>* A )
+  /** Recomputes the inverses with the new values of the Matrix. */
+  { this->load( A ); factorize(); }
+
+private:
+  void factorize();
+
+  size_type block_size;
+  std::vector<T> block_inv; /**< Row-major inverses of the diagonal blocks. */
+};
+
+
+/**
+  *
+  * \class SSORPrecond
+  * \brief Template class SSORPrecond.
+  * Symmetric successive over-relaxation preconditioner,
+  * M = (D + w*L) * D^-1 * (D + w*U) / (w*(2-w)).
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class SSORPrecond : public SparsePrecond<T>{
+
+public:
+  SSORPrecond( Matrix<T>*, T omega = 1. );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void update( Matrix<T>* A )
+  /** Copies the new values of the Matrix. */
+  { this->load( A ); }
+
+private:
+  T omega;
+};
+
+
+/**
+  *
+  * \class ILU0Precond
+  * \brief Template class ILU0Precond.
+  * Incomplete LU factorization with the sparsity pattern of the matrix,
+  * M = L*U with unit lower L. Valid for non-symmetric matrices.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class ILU0Precond : public SparsePrecond<T>{
+
+public:
+  ILU0Precond( Matrix<T>* );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void update( Matrix<T>* A )
+  /** Refactorizes with the new values of the Matrix. */
+  { this->load( A ); factorize(); }
+
+private:
+  void factorize();
+};
+
+
+/**
+  *
+  * \class IC0Precond
+  * \brief Template class IC0Precond.
+  * Incomplete Cholesky factorization with the sparsity pattern of the upper
+  * triangle of a symmetric matrix, M = U^T*U. The diagonal can be shifted,
+  * (1+shift)*D, if the factorization breaks down.
+  *
+  * @author Daniel Iglesias Ib��ez.
+*/
+template <typename T> class IC0Precond : public SparsePrecond<T>{
+
+public:
+  IC0Precond( Matrix<T>*, T shift = 0. );
+
+  void apply( Vector<T>&, const Vector<T>& );
+
+  void update( Matrix<T>* A )
+  /** Refactorizes with the new values of the Matrix. */
+  { this->load( A ); factorize(); }
+
+private:
+  void factorize();
+
+  T shift; /**< Relative diagonal shift. */
+};
+
+} //namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+
+namespace lmx{
+
+/**
+ * Standard constructor. Computes the inverse of the diagonal (or diagonal
+ * blocks) of the matrix.
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    JacobiPrecond<T>::JacobiPrecond( Matrix<T>* A )
+{
+  update( A );
+}
+
+
+/**
+ * Recomputes the inverse of the diagonal (or diagonal blocks).
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    void JacobiPrecond<T>::update( Matrix<T>* A )
+{
+  nrow = A->rows();
+  block_size = 1;
+  switch (getMatrixType()) {
+    case 7 :
+      static_cast<Type_bsr<T,2>*>(A->type_matrix)->invertDiagonalBlocks( block_inv );
+      block_size = 2;
+      break;
+    case 8 :
+      static_cast<Type_bsr<T,3>*>(A->type_matrix)->invertDiagonalBlocks( block_inv );
+      block_size = 3;
+      break;
+    case 9 :
+      static_cast<Type_bsr<T,6>*>(A->type_matrix)->invertDiagonalBlocks( block_inv );
+      block_size = 6;
+      break;
+  }
+  if (block_size > 1) return;
+
+  mp.resize( nrow );
+  A->getDiagonal( mp );
+  for (size_type i=0; i < nrow; ++i)
+    mp.writeElement( 1. / mp.readElement(i), i );
+}
+
+
+/**
+ * Applies the preconditioner: z = M^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void JacobiPrecond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  if (block_size == 1){
+    z.multElem(mp,r);
+    return;
+  }
+  T temp;
+  for (size_type bi=0; bi < nrow / block_size; ++bi){
+    const T* inv = &block_inv[bi*block_size*block_size];
+    for (size_type i=0; i < block_size; ++i){
+      temp = 0;
+      for (size_type j=0; j < block_size; ++j)
+        temp += inv[i*block_size+j] * r.readElement( bi*block_size+j );
+      z.writeElement( temp, bi*block_size+i );
+    }
+  }
+}
+
+
+/**
+ * Constructor. Copies the matrix in compressed sparse rows.
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    SparsePrecond<T>::SparsePrecond( Matrix<T>* A )
+{
+  load( A );
+}
+
+
+/**
+ * Copies the matrix in compressed sparse rows (row_ptr, col_idx, val and
+ * diag_pos), replacing the previous contents.
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    void SparsePrecond<T>::load( Matrix<T>* A )
+{
+  nrow = A->rows();
+  row_ptr.assign( nrow+1, 0 );
+  col_idx.clear();
+  val.clear();
+  if (getMatrixType() == 1){
+    // Transpose the Type_csc arrays:
+    const Type_csc<T>* csc = static_cast<const Type_csc<T>*>(A->type_matrix);
+    size_type nnz = csc->ja[csc->Ncol];
+    for (size_type k=0; k < nnz; ++k) ++row_ptr[ csc->ia[k]+1 ];
+    for (size_type i=0; i < nrow; ++i) row_ptr[i+1] += row_ptr[i];
+    col_idx.resize( nnz );
+    val.resize( nnz );
+    std::vector<size_type> next( row_ptr.begin(), row_ptr.end()-1 );
+    for (size_type j=0; j < csc->Ncol; ++j){
+      for (size_type k = csc->ja[j]; k < (size_type)csc->ja[j+1]; ++k){
+        size_type pos = next[ csc->ia[k] ]++;
+        col_idx[pos] = j;
+        val[pos] = csc->aa[k];
+      }
+    }
+  }
+  else{
+    for (size_type i=0; i < nrow; ++i){
+      for (size_type j=0; j < A->cols(); ++j){
+        T value = A->readElement(i,j);
+        if (value != 0. || i == j){
+          col_idx.push_back( j );
+          val.push_back( value );
+        }
+      }
+      row_ptr[i+1] = col_idx.size();
+    }
+  }
+  diag_pos.resize( nrow );
+  for (size_type i=0; i < nrow; ++i){
+    diag_pos[i] = find( i, i );
+    if (diag_pos[i] == col_idx.size()){
+      std::stringstream message;
+      message << "Error in preconditioner: diagonal element (" << i << "," << i
+          << ") is not in the sparsity pattern." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+  }
+}
+
+
+/**
+ * Position of an element in the compressed arrays.
+ * @param i Row.
+ * @param j Column.
+ * @return Position in col_idx and val, or the number of elements if (i,j) is not stored.
+ */
+template <typename T>
+    size_type SparsePrecond<T>::find( size_type i, size_type j ) const
+{
+  typename std::vector<size_type>::const_iterator first = col_idx.begin() + row_ptr[i];
+  typename std::vector<size_type>::const_iterator last = col_idx.begin() + row_ptr[i+1];
+  typename std::vector<size_type>::const_iterator it = std::lower_bound( first, last, j );
+  if (it != last && *it == j) return it - col_idx.begin();
+  return col_idx.size();
+}
+
+
+/**
+ * Constructor. Inverts the diagonal blocks with Gauss-Jordan elimination.
+ * @param A Matrix to be preconditioned.
+ * @param block_size_in Size of the diagonal blocks.
+ */
+template <typename T>
+    BlockJacobiPrecond<T>::BlockJacobiPrecond( Matrix<T>* A, size_type block_size_in )
+  : SparsePrecond<T>( A ), block_size( block_size_in )
+{
+  factorize();
+}
+
+
+/**
+ * Inverts the diagonal blocks with Gauss-Jordan elimination.
+ */
+template <typename T>
+    void BlockJacobiPrecond<T>::factorize()
+{
+  size_type n = this->nrow;
+  size_type bs = block_size;
+  block_inv.assign( ((n + bs - 1) / bs) * bs * bs, T(0) );
+  std::vector<T> a( bs*bs );
+  for (size_type b0 = 0, bi = 0; b0 < n; b0 += bs, ++bi){
+    size_type m = (b0 + bs <= n) ? bs : n - b0;
+    T* inv = &block_inv[bi*bs*bs];
+    std::fill( a.begin(), a.end(), T(0) );
+    for (size_type i=0; i < m; ++i){
+      for (size_type k = this->row_ptr[b0+i]; k < this->row_ptr[b0+i+1]; ++k){
+        size_type j = this->col_idx[k];
+        if (j >= b0 && j < b0 + m) a[i*m + j-b0] = this->val[k];
+      }
+      inv[i*m+i] = 1.;
+    }
+    // Gauss-Jordan with partial pivoting:
+    for (size_type c=0; c < m; ++c){
+      size_type p = c;
+      for (size_type r=c+1; r < m; ++r)
+        if (std::abs(a[r*m+c]) > std::abs(a[p*m+c])) p = r;
+      if (a[p*m+c] == 0.){
+        std::stringstream message;
+        message << "Error in BlockJacobiPrecond: singular diagonal block " << bi << "." << endl;
+        LMX_THROW(failure_error, message.str() );
+      }
+      for (size_type k=0; k < m; ++k){
+        std::swap( a[c*m+k], a[p*m+k] );
+        std::swap( inv[c*m+k], inv[p*m+k] );
+      }
+      T pivot = a[c*m+c];
+      for (size_type k=0; k < m; ++k){
+        a[c*m+k] /= pivot;
+        inv[c*m+k] /= pivot;
+      }
+      for (size_type r=0; r < m; ++r){
+        if (r == c || a[r*m+c] == 0.) continue;
+        T factor = a[r*m+c];
+        for (size_type k=0; k < m; ++k){
+          a[r*m+k] -= factor * a[c*m+k];
+          inv[r*m+k] -= factor * inv[c*m+k];
+        }
+      }
+    }
+  }
+}
+
+
+/**
+ * Applies the preconditioner: z = M^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void BlockJacobiPrecond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  size_type n = this->nrow;
+  size_type bs = block_size;
+  T temp;
+  for (size_type b0 = 0, bi = 0; b0 < n; b0 += bs, ++bi){
+    size_type m = (b0 + bs <= n) ? bs : n - b0;
+    const T* inv = &block_inv[bi*bs*bs];
+    for (size_type i=0; i < m; ++i){
+      temp = 0;
+      for (size_type j=0; j < m; ++j)
+        temp += inv[i*m+j] * r.readElement( b0+j );
+      z.writeElement( temp, b0+i );
+    }
+  }
+}
+
+
+/**
+ * Constructor.
+ * @param A Matrix to be preconditioned.
+ * @param omega_in Relaxation factor, 0 < omega < 2.
+ */
+template <typename T>
+    SSORPrecond<T>::SSORPrecond( Matrix<T>* A, T omega_in )
+  : SparsePrecond<T>( A ), omega( omega_in )
+{ }
+
+
+/**
+ * Applies the preconditioner: z = M^-1 * r, with a forward and a backward
+ * relaxed substitution.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void SSORPrecond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  size_type n = this->nrow;
+  std::vector<T> y( n );
+  // (D + w*L) * y = r
+  for (size_type i=0; i < n; ++i){
+    T temp = r.readElement(i);
+    for (size_type k = this->row_ptr[i]; k < this->diag_pos[i]; ++k)
+      temp -= omega * this->val[k] * y[ this->col_idx[k] ];
+    y[i] = temp / this->val[ this->diag_pos[i] ];
+  }
+  // (D + w*U) * z = w*(2-w) * D * y
+  for (size_type i = n; i-- > 0; ){
+    T diag = this->val[ this->diag_pos[i] ];
+    T temp = omega * (2. - omega) * diag * y[i];
+    for (size_type k = this->diag_pos[i]+1; k < this->row_ptr[i+1]; ++k)
+      temp -= omega * this->val[k] * y[ this->col_idx[k] ];
+    y[i] = temp / diag;
+  }
+  for (size_type i=0; i < n; ++i) z.writeElement( y[i], i );
+}
+
+
+/**
+ * Constructor. Computes the ILU(0) factors in place of the matrix values.
+ * @param A Matrix to be preconditioned.
+ */
+template <typename T>
+    ILU0Precond<T>::ILU0Precond( Matrix<T>* A )
+  : SparsePrecond<T>( A )
+{
+  factorize();
+}
+
+
+/**
+ * Computes the ILU(0) factors in place of the matrix values.
+ */
+template <typename T>
+    void ILU0Precond<T>::factorize()
+{
+  size_type n = this->nrow;
+  std::vector<size_type> pos( n, this->col_idx.size() ); // position of (i,j) in row i
+  for (size_type i=0; i < n; ++i){
+    for (size_type k = this->row_ptr[i]; k < this->row_ptr[i+1]; ++k)
+      pos[ this->col_idx[k] ] = k;
+    for (size_type k = this->row_ptr[i]; k < this->diag_pos[i]; ++k){
+      size_type c = this->col_idx[k];
+      T pivot = this->val[ this->diag_pos[c] ];
+      if (pivot == 0.){
+        std::stringstream message;
+        message << "Error in ILU0Precond: null pivot in row " << c << "." << endl;
+        LMX_THROW(failure_error, message.str() );
+      }
+      this->val[k] /= pivot;
+      // row_i -= l_ic * U(c, c+1:n), only in the pattern of row i
+      for (size_type kk = this->diag_pos[c]+1; kk < this->row_ptr[c+1]; ++kk){
+        size_type p = pos[ this->col_idx[kk] ];
+        if (p != this->col_idx.size())
+          this->val[p] -= this->val[k] * this->val[kk];
+      }
+    }
+    for (size_type k = this->row_ptr[i]; k < this->row_ptr[i+1]; ++k)
+      pos[ this->col_idx[k] ] = this->col_idx.size();
+  }
+}
+
+
+/**
+ * Applies the preconditioner: z = U^-1 * L^-1 * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void ILU0Precond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  size_type n = this->nrow;
+  std::vector<T> y( n );
+  for (size_type i=0; i < n; ++i){
+    T temp = r.readElement(i);
+    for (size_type k = this->row_ptr[i]; k < this->diag_pos[i]; ++k)
+      temp -= this->val[k] * y[ this->col_idx[k] ];
+    y[i] = temp;
+  }
+  for (size_type i = n; i-- > 0; ){
+    T temp = y[i];
+    for (size_type k = this->diag_pos[i]+1; k < this->row_ptr[i+1]; ++k)
+      temp -= this->val[k] * y[ this->col_idx[k] ];
+    y[i] = temp / this->val[ this->diag_pos[i] ];
+  }
+  for (size_type i=0; i < n; ++i) z.writeElement( y[i], i );
+}
+
+
+/**
+ * Constructor. Computes the IC(0) factor U in place of the upper triangle.
+ * @param A Symmetric matrix to be preconditioned.
+ * @param shift_in Relative diagonal shift.
+ */
+template <typename T>
+    IC0Precond<T>::IC0Precond( Matrix<T>* A, T shift_in )
+  : SparsePrecond<T>( A ), shift( shift_in )
+{
+  factorize();
+}
+
+
+/**
+ * Computes the IC(0) factor U in place of the upper triangle.
+ */
+template <typename T>
+    void IC0Precond<T>::factorize()
+{
+  size_type n = this->nrow;
+  size_type end = this->col_idx.size();
+  for (size_type i=0; i < n; ++i)
+    this->val[ this->diag_pos[i] ] *= 1. + shift;
+  std::vector<size_type> pos( n, end ); // position of (j,c) in row j
+  for (size_type k=0; k < n; ++k){
+    T pivot = this->val[ this->diag_pos[k] ];
+    if (pivot <= 0.){
+      std::stringstream message;
+      message << "Error in IC0Precond: non positive pivot in row " << k
+          << ", try a diagonal shift." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    pivot = std::sqrt( pivot );
+    this->val[ this->diag_pos[k] ] = pivot;
+    for (size_type kk = this->diag_pos[k]+1; kk < this->row_ptr[k+1]; ++kk)
+      this->val[kk] /= pivot;
+    // U(j,i) -= U(k,j)*U(k,i) for j <= i in the upper pattern of row k:
+    for (size_type kj = this->diag_pos[k]+1; kj < this->row_ptr[k+1]; ++kj){
+      size_type j = this->col_idx[kj];
+      for (size_type kk = this->diag_pos[j]; kk < this->row_ptr[j+1]; ++kk)
+        pos[ this->col_idx[kk] ] = kk;
+      for (size_type ki = kj; ki < this->row_ptr[k+1]; ++ki){
+        size_type p = pos[ this->col_idx[ki] ];
+        if (p != end) this->val[p] -= this->val[kj] * this->val[ki];
+      }
+      for (size_type kk = this->diag_pos[j]; kk < this->row_ptr[j+1]; ++kk)
+        pos[ this->col_idx[kk] ] = end;
+    }
+  }
+}
+
+
+/**
+ * Applies the preconditioner: z = U^-1 * U^-T * r.
+ * @param z Preconditioned vector.
+ * @param r Residual vector.
+ */
+template <typename T>
+    void IC0Precond<T>::apply( Vector<T>& z, const Vector<T>& r )
+{
+  size_type n = this->nrow;
+  std::vector<T> y( n );
+  for (size_type i=0; i < n; ++i) y[i] = r.readElement(i);
+  // U^T * y = r
+  for (size_type k=0; k < n; ++k){
+    y[k] /= this->val[ this->diag_pos[k] ];
+    for (size_type kk = this->diag_pos[k]+1; kk < this->row_ptr[k+1]; ++kk)
+      y[ this->col_idx[kk] ] -= this->val[kk] * y[k];
+  }
+  // U * z = y
+  for (size_type k = n; k-- > 0; ){
+    T temp = y[k];
+    for (size_type kk = this->diag_pos[k]+1; kk < this->row_ptr[k+1]; ++kk)
+      temp -= this->val[kk] * y[ this->col_idx[kk] ];
+    y[k] = temp / this->val[ this->diag_pos[k] ];
+  }
+  for (size_type i=0; i < n; ++i) z.writeElement( y[i], i );
+}
+
+} //namespace lmx
+
+
+#endif
@@ -22,10 +22,8 @@
 #define SUPERLU_INTERFACE_H
 
 #include <vector>
-// #include "dsp_defs.h"
 #include "slu_ddefs.h"
 
-//////////////////////////////////////////// Doxygen file documentation entry:
     /*!
       \file lmx_linsolvers_superlu_interface.h
 
@@ -34,17 +32,27 @@
       \author Daniel Iglesias Ibez
 
     */
-//////////////////////////////////////////// Doxygen file documentation (end)
 
 
 namespace lmx {
 
     /**
     \class Superlu
-    \brief Template class LinearSystem.
-    Linear systems implementation: "A*x = b" .
-
-    This class permits the creation of a linear system object. Each object has three parameters, corresponding to each of the matrices or vectors base of the problem. The basic methods solve the problem and add functionality to control the solution procedure. Not only one solver can be used as well as the number data type (class) may be differ between the input and the one used to solve the system.
+    \brief Template class Superlu.
+    Persistent SuperLU factorization of a sparse matrix in compressed columns.
+
+    The arrays of the matrix (zero-based, int indices, as the ones of
+    Type_csc) and of the vectors are given to SuperLU without copies, so
+    equilibration is disabled: the values of the matrix are never modified.
+
+    The object keeps the L and U factors, the column permutation, the row
+    permutation and the elimination tree. factorize() only does the full
+    analysis the first time or when the sparsity pattern changes; otherwise
+    the previous analysis is reused, depending on setPatternReuse():
+    SamePattern_SameRowPerm (default) also keeps the row permutation and
+    the structure of the factors, SamePattern keeps the column permutation
+    and the elimination tree. solve() can be called any number of times
+    with the stored factors.
 
     \author Daniel Iglesias Ibez.
     */
@@ -53,443 +61,238 @@ class Superlu{
 
 private:
     char           equed[1];
-    yes_no_t       equil;
-    trans_t        trans;
-    SuperMatrix    A, A1, L, U;
-    SuperMatrix    B, B1, X;
-    NCformat       *Astore;
-    NCformat       *Ustore;
-    SCformat       *Lstore;
-    double         *a, *a1;
-    int            *asub, *xa, *asub1, *xa1;
+    SuperMatrix    A, L, U;
     int            *perm_r; /* row permutations from partial pivoting */
     int            *perm_c; /* column permutation vector */
     int            *etree;
-    void           *work;
-    int            info, lwork, nrhs, ldx;
-    int            i, j, m, n, nnz;
-    double         *rhsb, *rhsb1, *rhsx, *xact;
     double         *R, *C;
-    double         *ferr, *berr;
-    double         u, rpg, rcond;
+    int            info, m, n, nnz;
+    int            reuse;
+    bool           factorized;
+    unsigned long  pattern_key;
+    double         rpg, rcond;
     mem_usage_t    mem_usage;
     superlu_options_t options;
     SuperLUStat_t stat;
 
+    unsigned long patternKey( const int *, const int * ) const;
 
-public:
-  Superlu(size_type&, size_type&, size_type&, size_type *, size_type *, T *, T *, T * );
-
-  Superlu(size_type&, size_type&, size_type&, size_type *, size_type *, T *, std::vector<T>&, std::vector<T>& );
+    void freeFactors();
 
-  Superlu(size_type&, size_type&, size_type&, std::vector<size_type>&, std::vector<size_type>&, std::vector<T>&, std::vector<T>&, std::vector<T>& );
+    void printInfo();
 
-  Superlu(size_type&, size_type&, size_type&, std::vector<size_type>&, std::vector<size_type>&, std::vector<T>&, T *, T * );
+public:
+  Superlu();
 
   ~Superlu();
 
-  void init();
+  void setPatternReuse( int type )
+  /**
+   * @param type 0 = full factorization each time, 1 = SamePattern,
+   * 2 = SamePattern_SameRowPerm (default).
+   */
+  { reuse = type; }
 
-//   void reinit(size_type&, size_type&, size_type&, std::vector<size_type>&, std::vector<size_type>&, std::vector<T>&, std::vector<T>&);
+  /**
+   * Factorization state.
+   * @return TRUE if the L and U factors are stored.
+   */
+  bool isFactorized() const
+  { return factorized; }
 
-  void calc(int);
+  void factorize( int, int, int *, int *, T *, int noisy = 0 );
 
-  void recalc(int);
-
-  void get_solution(std::vector<T>&);
+  void solve( T *, T *, int nrhs = 1 );
 
 }; // class superlu
 
-template<typename T>
-/**
- * Constructor from c-array style vectors.
- * @param m_in Number of rows of matrix.
- * @param n_in Number of columns of matrix.
- * @param nnz_in Number of non-zeros in sparse matrix.
- * @param asub_in Array of integers.
- * @param xa_in Array of integers.
- * @param a_in Array of matrix's values.
- * @param x_in Array of solution values.
- * @param b_in Array of RHS vector's values.
- */
-    Superlu<T>::Superlu(size_type & m_in,
-                        size_type & n_in,
-                        size_type & nnz_in,
-                        size_type * asub_in,
-                        size_type * xa_in,
-                        T * a_in,
-                        T * x_in,
-                        T * b_in)
-  : m(m_in), n(n_in), nnz(nnz_in)
-{
-    if ( !(a = doubleMalloc(nnz)) ) ABORT("Malloc fails for a1[].");
-    if ( !(asub = intMalloc(nnz)) ) ABORT("Malloc fails for asub1[].");
-    if ( !(xa = intMalloc(n+1)) ) ABORT("Malloc fails for xa1[].");
-    for (i = 0; i < nnz; ++i) {
-      a[i] = a_in[i];
-      asub[i] = asub_in[i];
-    }
-    for (i = 0; i < n+1; ++i)
-      xa[i] = xa_in[i];
-
-// Guardar b_in y x_in
-}
-
 
 template<typename T>
 /**
- * Constructor from c-array style sparse matrix and STL style vectors.
- * @param m_in Number of rows of matrix.
- * @param n_in Number of columns of matrix.
- * @param nnz_in Number of non-zeros in sparse matrix.
- * @param asub_in Array of integers.
- * @param xa_in Array of integers.
- * @param a_in Array of matrix's values.
- * @param x_in Vector of solution values.
- * @param b_in Vector of RHS vector's values.
+ * Empty constructor.
  */
-    Superlu<T>::Superlu(size_type & m_in,
-                        size_type & n_in,
-                        size_type & nnz_in,
-                        size_type * asub_in,
-                        size_type * xa_in,
-                        T * a_in,
-                        std::vector<T>& x_in,
-                        std::vector<T>& b_in)
-  : m(m_in), n(n_in), nnz(nnz_in)
+    Superlu<T>::Superlu()
+  : perm_r(0), perm_c(0), etree(0), R(0), C(0)
+  , info(0), m(0), n(0), nnz(0), reuse(2), factorized(0), pattern_key(0)
 {
-  if ( !(a = doubleMalloc(nnz)) ) ABORT("Malloc fails for a1[].");
-  if ( !(asub = intMalloc(nnz)) ) ABORT("Malloc fails for asub1[].");
-  if ( !(xa = intMalloc(n+1)) ) ABORT("Malloc fails for xa1[].");
-  for (i = 0; i < nnz; ++i) {
-    a[i] = a_in[i];
-    asub[i] = asub_in[i];
-  }
-  for (i = 0; i < n+1; ++i)
-    xa[i] = xa_in[i];
-
-// Guardar b_in y x_in
+  set_default_options(&options);
+  options.Equil = NO; // A is not copied, so it must not be scaled
+  options.ColPerm = COLAMD;
+  options.IterRefine = NOREFINE;
+  options.PrintStat = NO;
+  equed[0] = 'N';
 }
 
 
 template<typename T>
 /**
- * Constructor for STL style sparse matrix and vectors.
- * @param m_in Number of rows of matrix.
- * @param n_in Number of columns of matrix.
- * @param nnz_in Number of non-zeros in sparse matrix.
- * @param asub_in Vector of integers.
- * @param xa_in Vector of integers.
- * @param a_in Vector of matrix's values.
- * @param x_in Vector of solution values.
- * @param b_in Vector of RHS vector's values.
+ * Destructor
  */
-    Superlu<T>::Superlu(size_type& m_in,
-                        size_type& n_in,
-                        size_type& nnz_in,
-                        std::vector<size_type>& asub_in,
-                        std::vector<size_type>& xa_in,
-                        std::vector<T>& a_in,
-                        std::vector<T>& x_in,
-                        std::vector<T>& b_in)
-    : m(m_in), n(n_in), nnz(nnz_in)
+Superlu<T>::~Superlu()
 {
-    if ( !(a = doubleMalloc(nnz)) ) ABORT("Malloc fails for a1[].");
-    if ( !(asub = intMalloc(nnz)) ) ABORT("Malloc fails for asub1[].");
-    if ( !(xa = intMalloc(n+1)) ) ABORT("Malloc fails for xa1[].");
-    for (i = 0; i < nnz; ++i) {
-      a[i] = a_in[i];
-      asub[i] = asub_in[i] - 1;
-    }
-    for (i = 0; i < n+1; ++i)
-      xa[i] = xa_in[i] - 1;
-
-    if ( !(rhsx = doubleMalloc(m)) ) ABORT("Malloc fails for rhsx[].");
-    if ( !(rhsb = doubleMalloc(m)) ) ABORT("Malloc fails for rhsb[].");
-    for (i = 0; i < m; ++i) {
-      rhsx[i] = x_in[i];
-      rhsb[i] = b_in[i];
-
-    }
-
+  freeFactors();
 }
 
 
 template<typename T>
 /**
- * Constructor for STL style sparse matrix and STL vectors.
- * @param m_in Number of rows of matrix.
- * @param n_in Number of columns of matrix.
- * @param nnz_in Number of non-zeros in sparse matrix.
- * @param asub_in Vector of integers.
- * @param xa_in Vector of integers.
- * @param a_in Vector of matrix's values.
- * @param x_in Array of solution values.
- * @param b_in Array of RHS vector's values.
+ * Releases the factors and the permutations.
  */
-    Superlu<T>::Superlu(size_type& m_in,
-                        size_type& n_in,
-                        size_type& nnz_in,
-                        std::vector<size_type>& asub_in,
-                        std::vector<size_type>& xa_in,
-                        std::vector<T>& a_in,
-                        T* x_in,
-                        T* b_in)
-  : m(m_in), n(n_in), nnz(nnz_in)
+void Superlu<T>::freeFactors()
 {
-  if ( !(a = doubleMalloc(nnz)) ) ABORT("Malloc fails for a1[].");
-  if ( !(asub = intMalloc(nnz)) ) ABORT("Malloc fails for asub1[].");
-  if ( !(xa = intMalloc(n+1)) ) ABORT("Malloc fails for xa1[].");
-  for (i = 0; i < nnz; ++i) {
-    a[i] = a_in[i];
-    asub[i] = asub_in[i] - 1;
-  }
-  for (i = 0; i < n+1; ++i)
-    xa[i] = xa_in[i] - 1;
-
-  if ( !(rhsx = doubleMalloc(m)) ) ABORT("Malloc fails for rhsx[].");
-  if ( !(rhsb = doubleMalloc(m)) ) ABORT("Malloc fails for rhsb[].");
-  for (i = 0; i < m; ++i) {
-    rhsx[i] = x_in[i];
-    rhsb[i] = b_in[i];
-
+  if ( factorized ){
+    Destroy_SuperNode_Matrix(&L);
+    Destroy_CompCol_Matrix(&U);
+    Destroy_SuperMatrix_Store(&A); // the arrays belong to the caller
+    factorized = 0;
   }
-
+  if ( perm_r ) SUPERLU_FREE (perm_r);
+  if ( perm_c ) SUPERLU_FREE (perm_c);
+  if ( etree ) SUPERLU_FREE (etree);
+  if ( R ) SUPERLU_FREE (R);
+  if ( C ) SUPERLU_FREE (C);
+  perm_r = perm_c = etree = 0;
+  R = C = 0;
 }
 
 
 template<typename T>
 /**
- * Destructor
+ * Hash of the sparsity pattern, used to detect changes without keeping a
+ * copy of the index arrays.
+ * @param asub Row indices.
+ * @param xa Column pointers.
+ * @return Pattern key.
  */
-Superlu<T>::~Superlu()
-  {
-    StatFree(&stat);
-
-    SUPERLU_FREE (xact);
-    SUPERLU_FREE (etree);
-    SUPERLU_FREE (perm_r);
-    SUPERLU_FREE (perm_c);
-    SUPERLU_FREE (R);
-    SUPERLU_FREE (C);
-    SUPERLU_FREE (ferr);
-    SUPERLU_FREE (berr);
-    Destroy_CompCol_Matrix(&A);
-    Destroy_Dense_Matrix(&B);
-    Destroy_Dense_Matrix(&X);
-    if ( lwork >= 0 ) { /* Deallocate storage associated with L and U. */
-        Destroy_SuperNode_Matrix(&L);
-        Destroy_CompCol_Matrix(&U);
-    }
+unsigned long Superlu<T>::patternKey( const int * asub, const int * xa ) const
+{
+  unsigned long key = 2166136261ul;
+  for (int j = 0; j <= n; ++j) key = ( key ^ (unsigned long)xa[j] ) * 16777619ul;
+  for (int k = 0; k < xa[n]; ++k) key = ( key ^ (unsigned long)asub[k] ) * 16777619ul;
+  return key;
+}
 
-  }
 
 template<typename T>
 /**
- * Initialize function.
+ * Computes the LU factors of the matrix. The arrays are used in place and
+ * must not be released while the object is used.
+ * @param m_in Number of rows of matrix.
+ * @param n_in Number of columns of matrix.
+ * @param asub Zero-based row indices.
+ * @param xa Zero-based column pointers, xa[n_in] being the number of non-zeros.
+ * @param a Matrix's values.
+ * @param noisy Sets the level of output information.
  */
-void Superlu<T>::init()
+void Superlu<T>::factorize( int m_in, int n_in, int * asub, int * xa, T * a, int noisy )
 {
-// #if ( DEBUGlevel>=1 )
-//     CHECK_MALLOC("Enter main()");
-// #endif
-
-
-    /* Defaults */
-    lwork = 0;
-    nrhs  = 1;
-    equil = YES;  
-    u     = 1.0;
-    trans = NOTRANS;
-
-//      Set the default input options:
-    options.Fact = DOFACT;
-    options.Equil = YES;
-    options.ColPerm = COLAMD;
-    options.DiagPivotThresh = 1.0;
-    options.Trans = NOTRANS;
-    options.IterRefine = NOREFINE;
-    options.SymmetricMode = NO;
-    options.PivotGrowth = NO;
-    options.ConditionNumber = NO;
-    options.PrintStat = YES;
-
-    set_default_options(&options);
-
-//     options.ColPerm = MMD_ATA;
-//     options.Equil = equil;
-//     options.DiagPivotThresh = u;
-//     options.Trans = trans;
-
-    if ( lwork > 0 ) {
-      work = SUPERLU_MALLOC(lwork);
-      if ( !work ) {
-        ABORT("DLINSOLX: cannot allocate work[]");
-      }
-    }
-
-    dCreate_CompCol_Matrix(&A, m, n, nnz, a, asub, xa, SLU_NC, SLU_D, SLU_GE);
-//     Astore = A.Store;
-//     printf("Dimension %dx%d; # nonzeros %d\n", A.nrow, A.ncol, Astore->nnz);
-
-    dCreate_Dense_Matrix(&B, m, nrhs, rhsb, m, SLU_DN, SLU_D, SLU_GE);
-    dCreate_Dense_Matrix(&X, m, nrhs, rhsx, m, SLU_DN, SLU_D, SLU_GE);
-    xact = doubleMalloc(n * nrhs);
-    ldx = n;
-    dGenXtrue(n, nrhs, xact, ldx);
-
-    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
+  SuperMatrix B, X;
+  double ferr, berr;
+  bool same = factorized && m_in == m && n_in == n && xa[n_in] == nnz;
+  n = n_in;
+  unsigned long key = patternKey( asub, xa );
+  same = same && key == pattern_key;
+
+  if ( !same ){
+    freeFactors();
+    m = m_in;
+    nnz = xa[n];
     if ( !(perm_r = intMalloc(m)) ) ABORT("Malloc fails for perm_r[].");
+    if ( !(perm_c = intMalloc(n)) ) ABORT("Malloc fails for perm_c[].");
     if ( !(etree = intMalloc(n)) ) ABORT("Malloc fails for etree[].");
-    if ( !(R = (double *) SUPERLU_MALLOC(A.nrow * sizeof(double))) ) 
-        ABORT("SUPERLU_MALLOC fails for R[].");
-    if ( !(C = (double *) SUPERLU_MALLOC(A.ncol * sizeof(double))) )
-        ABORT("SUPERLU_MALLOC fails for C[].");
-    if ( !(ferr = (double *) SUPERLU_MALLOC(nrhs * sizeof(double))) )
-        ABORT("SUPERLU_MALLOC fails for ferr[].");
-    if ( !(berr = (double *) SUPERLU_MALLOC(nrhs * sizeof(double))) ) 
-        ABORT("SUPERLU_MALLOC fails for berr[].");
-
-    /* Initialize the statistics variables. */
-    StatInit(&stat);
+    if ( !(R = (double *) SUPERLU_MALLOC(m * sizeof(double))) )
+      ABORT("SUPERLU_MALLOC fails for R[].");
+    if ( !(C = (double *) SUPERLU_MALLOC(n * sizeof(double))) )
+      ABORT("SUPERLU_MALLOC fails for C[].");
+    options.Fact = DOFACT;
+  }
+  else{
+    Destroy_SuperMatrix_Store(&A);
+    if ( reuse == 2 ) options.Fact = SamePattern_SameRowPerm;
+    else{
+      Destroy_SuperNode_Matrix(&L);
+      Destroy_CompCol_Matrix(&U);
+      options.Fact = reuse == 1 ? SamePattern : DOFACT;
+    }
+  }
+  pattern_key = key;
 
+  dCreate_CompCol_Matrix(&A, m, n, nnz, a, asub, xa, SLU_NC, SLU_D, SLU_GE);
+  // No right hand side: factorization only.
+  dCreate_Dense_Matrix(&B, m, 0, a, m, SLU_DN, SLU_D, SLU_GE);
+  dCreate_Dense_Matrix(&X, n, 0, a, n, SLU_DN, SLU_D, SLU_GE);
 
+  StatInit(&stat);
+  dgssvx(&options, &A, perm_c, perm_r, etree, equed, R, C,
+         &L, &U, 0, 0, &B, &X, &rpg, &rcond, &ferr, &berr,
+         &mem_usage, &stat, &info);
+  if ( noisy > 0 ) printInfo();
+  StatFree(&stat);
+  Destroy_SuperMatrix_Store(&B);
+  Destroy_SuperMatrix_Store(&X);
+  factorized = 1;
+
+  if ( info != 0 ){
+    std::stringstream message;
+    if ( info <= n )
+      message << "SuperLU factorization failed: U(" << info-1 << "," << info-1
+          << ") is exactly zero." << endl;
+    else
+      message << "SuperLU factorization failed: memory allocation failure, info = "
+          << info << "." << endl;
+    freeFactors();
+    LMX_THROW(failure_error, message.str() );
+  }
 }
 
 
 template<typename T>
 /**
- * Function to compute solution vector.
- * @param noisy Sets the level of output information.
+ * Solves the system with the stored factors. The vectors are used in place.
+ * @param x Solution values (n x nrhs, by columns).
+ * @param b RHS values (m x nrhs, by columns), not modified.
+ * @param nrhs Number of right hand sides.
  */
-void Superlu<T>::calc(int noisy) {
-
-    /* ------------------------------------------------------------
-       WE SOLVE THE LINEAR SYSTEM FOR THE FIRST TIME: AX = B
-       ------------------------------------------------------------*/
-
-//     dgssv(&options, &A, perm_c, perm_r, &L, &U, &B, &stat, &info);
-
+void Superlu<T>::solve( T * x, T * b, int nrhs )
+{
+  if ( !factorized ){
+    std::stringstream message;
+    message << "Superlu solve() called before factorize()." << endl;
+    LMX_THROW(failure_error, message.str() );
+  }
+  SuperMatrix B, X;
+  std::vector<double> ferr( nrhs ), berr( nrhs );
 
+  options.Fact = FACTORED;
+  dCreate_Dense_Matrix(&B, m, nrhs, b, m, SLU_DN, SLU_D, SLU_GE);
+  dCreate_Dense_Matrix(&X, n, nrhs, x, n, SLU_DN, SLU_D, SLU_GE);
+  StatInit(&stat);
   dgssvx(&options, &A, perm_c, perm_r, etree, equed, R, C,
-         &L, &U, work, lwork, &B, &X, &rpg, &rcond, ferr, berr,
+         &L, &U, 0, 0, &B, &X, &rpg, &rcond, &ferr[0], &berr[0],
          &mem_usage, &stat, &info);
-
-//     printf("First system: dgssvx() returns info %d\n", info);
-
-  if (noisy > 0){
-
-    if ( info == 0 || info == n+1 ) {
-  
-    if ( options.PivotGrowth ) printf("Recip. pivot growth = %e\n", rpg);
-    if ( options.ConditionNumber )
-      printf("Recip. condition number = %e\n", rcond);
-      Lstore = (SCformat *) L.Store;
-      Ustore = (NCformat *) U.Store;
-      printf("No of nonzeros in factor L = %d\n", Lstore->nnz);
-      printf("No of nonzeros in factor U = %d\n", Ustore->nnz);
-      printf("No of nonzeros in L+U = %d\n", Lstore->nnz + Ustore->nnz - n);
-      printf("L\\U MB %.3f\ttotal MB needed %.3f\texpansions %d\n",
-              mem_usage.for_lu/1e6, mem_usage.total_needed/1e6,
-              mem_usage.expansions);
-      if ( options.IterRefine ) {
-        printf("Iterative Refinement:\n");
-        printf("%8s%8s%16s%16s\n", "rhsb", "Steps", "FERR", "BERR");
-        for (i = 0; i < nrhs; ++i)
-          printf("%8d%8d%16e%16e\n", i+1, stat.RefineSteps, ferr[i], berr[i]);
-      }
-      fflush(stdout);
-  
-    }
-    else if ( info > 0 && lwork == -1 ) {
-      printf("** Estimated memory: %d bytes\n", info - n);
-    }
-
-    if ( options.PrintStat ) StatPrint(&stat);
-
-  }
-
+  StatFree(&stat);
+  Destroy_SuperMatrix_Store(&B);
+  Destroy_SuperMatrix_Store(&X);
 }
 
+
 template<typename T>
 /**
- * Function to compute solution vector using previous factorization.
- * @param noisy Sets the level of output information.
+ * Prints the size of the factors and the memory used.
  */
-void Superlu<T>::recalc(int noisy) {
-
-    /* ------------------------------------------------------------
-       NOW WE SOLVE ANOTHER LINEAR SYSTEM: A1*X = B1
-       ONLY THE SPARSITY PATTERN OF A1 IS THE SAME AS THAT OF A.
-       ------------------------------------------------------------*/
-    for (i = 0; i < nnz; ++i) {
-      a[i] += 1.5E-2;
-    }
-
-//     options.Fact = SamePattern;
-    options.Fact = SamePattern_SameRowPerm;
-    StatInit(&stat); /* Initialize the statistics variables. */
-
-//     dCreate_CompCol_Matrix(&A1, m, n, nnz, a1, asub1, xa1,
-//                            SLU_NC, SLU_D, SLU_GE);
-//     dCreate_Dense_Matrix(&B1, m, nrhs, rhsb1, m, SLU_DN, SLU_D, SLU_GE);
-
-    dgssvx(&options, &A, perm_c, perm_r, etree, equed, R, C,
-           &L, &U, work, lwork, &B, &X, &rpg, &rcond, ferr, berr,
-           &mem_usage, &stat, &info);
-
-  if (noisy > 0){
-
-    printf("\n Resolving system: dgssvx() returns info %d\n", info);
-
-    if ( info == 0 || info == n+1 ) {
-
-        /* This is how you could access the solution matrix. */
-//         double *sol = (double*) ((DNformat*) X.Store)->nzval; 
-
-    if ( options.PivotGrowth ) printf("Recip. pivot growth = %e\n", rpg);
-    if ( options.ConditionNumber )
-        printf("Recip. condition number = %e\n", rcond);
-          Lstore = (SCformat *) L.Store;
-          Ustore = (NCformat *) U.Store;
+void Superlu<T>::printInfo()
+{
+  if ( info == 0 || info == n+1 ) {
+    SCformat *Lstore = (SCformat *) L.Store;
+    NCformat *Ustore = (NCformat *) U.Store;
     printf("No of nonzeros in factor L = %d\n", Lstore->nnz);
-        printf("No of nonzeros in factor U = %d\n", Ustore->nnz);
-        printf("No of nonzeros in L+U = %d\n", Lstore->nnz + Ustore->nnz - n);
-    printf("L\\U MB %.3f\ttotal MB needed %.3f\texpansions %d\n",
-          mem_usage.for_lu/1e6, mem_usage.total_needed/1e6,
-          mem_usage.expansions);
-    if ( options.IterRefine ) {
-              printf("Iterative Refinement:\n");
-        printf("%8s%8s%16s%16s\n", "rhs", "Steps", "FERR", "BERR");
-        for (i = 0; i < nrhs; ++i)
-          printf("%8d%8d%16e%16e\n", i+1, stat.RefineSteps, ferr[i], berr[i]);
-    }
+    printf("No of nonzeros in factor U = %d\n", Ustore->nnz);
+    printf("No of nonzeros in L+U = %d\n", Lstore->nnz + Ustore->nnz - n);
+    printf("L\\U MB %.3f\ttotal MB needed %.3f\n",
+           mem_usage.for_lu/1e6, mem_usage.total_needed/1e6);
     fflush(stdout);
-      } else if ( info > 0 && lwork == -1 ) {
-          printf("** Estimated memory: %d bytes\n", info - n);
-      }
-    if ( options.PrintStat ) StatPrint(&stat);
   }
-
-
-
-// #if ( DEBUGlevel>=1 )
-//     CHECK_MALLOC("Exit main()");
-// #endif
-
-}
-
-template<typename T>
-/**
- * Writes solution in vector.
- * @param x_out STL-style vector for writing the computed solution.
- */
-void Superlu<T>::get_solution(std::vector<T>& x_out)
-{ 
-    rhsx = (T*) ((DNformat*) X.Store)->nzval;
-
-    for (i = 0; i < m; ++i) x_out[i] = rhsx[i];
-
+  StatPrint(&stat);
 }
 
 
@@ -25,7 +25,11 @@
 
 #include "lmx_mat_dense_matrix.h"
 #include "lmx_linsolvers_cg.h"
+#include "lmx_linsolvers_gmres.h"
+#include "lmx_linsolvers_bicgstab.h"
+#include "lmx_linsolvers_amg.h"
 #include "lmx_linsolvers_gauss.h"
+#include "lmx_linsolvers_ldlt.h"
 
 #ifdef HAVE_LAPACK
 #include "lmx_linsolvers_lapack.h"
@@ -74,15 +78,33 @@ private:
   Vector<T>* b;
   bool A_new, x_new, b_new;
   int info; /**< sets level of information in std output **/
+  LinearOperator<T>* P; /**< Preconditioner for the iterative solvers (0 = Jacobi). */
+  Gauss<T>* G; /**< Factorization kept between calls to solveYourself(). */
+  Ldlt<T>* LD; /**< Sparse factorization (and analysis) kept between calls. */
+#ifdef HAVE_LAPACK
+  Gesv<T>* L; /**< Factorization kept between calls to solveYourself(). */
+#endif
 #ifdef HAVE_SUPERLU
   Superlu<T>* S;
 #endif
 
+  void solveGauss( Matrix<T>*, bool );
+  void solveLdlt( bool );
+#ifdef HAVE_LAPACK
+  void solveGesv( Matrix<T>*, bool );
+#endif
+
 public:
 
   /** Empty constructor. */
-  LinearSystem() : A(0), dA(0),x(0), b(0), A_new(0), x_new(0), b_new(0)
+  LinearSystem() : A(0), dA(0),x(0), b(0), A_new(0), x_new(0), b_new(0), info(0)
   { 
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
     #ifdef HAVE_SUPERLU
         S = 0;
     #endif
@@ -93,12 +115,18 @@ public:
    * @param A_in LHS Matrix.
    * @param b_in RHS Vector.
    */
-  LinearSystem(Matrix<T>& A_in, Vector<T>& b_in) : A(&A_in), dA(0), b(&b_in), x(0), A_new(0), x_new(1), b_new(0)
+  LinearSystem(Matrix<T>& A_in, Vector<T>& b_in) : A(&A_in), dA(0), x(0), b(&b_in), A_new(0), x_new(1), b_new(0), info(0)
   {
     x = new Vector<T>( b_in.size() );
 //     x->resize( b_in.size() );
     *x = b_in;
 
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
         S = 0;
 #endif
@@ -110,12 +138,18 @@ public:
    * @param dA_in LHS DenseMatrix.
    * @param b_in RHS Vector.
    */
-  LinearSystem(DenseMatrix<T>& dA_in, Vector<T>& b_in) : A(0), dA(&dA_in), b(&b_in), x(0), A_new(0), x_new(1), b_new(0)
+  LinearSystem(DenseMatrix<T>& dA_in, Vector<T>& b_in) : A(0), dA(&dA_in), x(0), b(&b_in), A_new(0), x_new(1), b_new(0), info(0)
   {
     x = new Vector<T>;
     x->resize( b_in.size() );
     *x = b_in;
 
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
     S = 0;
 #endif
@@ -128,7 +162,7 @@ public:
    * @param A_in LHS Matrix.
    * @param b_in RHS Vector.
    */
-      LinearSystem(Matrix<C>& A_in, Vector<C>& b_in) : dA(0), A_new(1), x_new(1), b_new(1)
+      LinearSystem(Matrix<C>& A_in, Vector<C>& b_in) : dA(0), A_new(1), x_new(1), b_new(1), info(0)
   {
     A = new Matrix<T>;
     *A = A_in;
@@ -141,6 +175,12 @@ public:
     b->resize( rows(b_in) );
     *b = b_in;
 
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
     S = 0;
 #endif
@@ -154,8 +194,14 @@ public:
    * @param b_in RHS Vector.
    * @return
    */
-  LinearSystem(Matrix<T>& A_in, Vector<T>& x_in, Vector<T>& b_in) : A(&A_in), dA(0), x(&x_in), b(&b_in), A_new(0), x_new(0), b_new(0)
+  LinearSystem(Matrix<T>& A_in, Vector<T>& x_in, Vector<T>& b_in) : A(&A_in), dA(0), x(&x_in), b(&b_in), A_new(0), x_new(0), b_new(0), info(0)
   {
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
     S = 0;
 #endif
@@ -167,8 +213,14 @@ public:
    * @param x_in Solution vector.
    * @param b_in RHS Vector.
    */
-  LinearSystem(DenseMatrix<T>& dA_in, Vector<T>& x_in, Vector<T>& b_in) : A(0), dA(&dA_in), x(&x_in), b(&b_in), A_new(0), x_new(0), b_new(0)
+  LinearSystem(DenseMatrix<T>& dA_in, Vector<T>& x_in, Vector<T>& b_in) : A(0), dA(&dA_in), x(&x_in), b(&b_in), A_new(0), x_new(0), b_new(0), info(0)
   {
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
     S = 0;
 #endif
@@ -182,7 +234,7 @@ public:
    * @param b_in RHS Vector.
    * @return
    */
-  LinearSystem(Matrix<C>& A_in, Vector<T>& x_in, Vector<C>& b_in) : dA(0), x(&x_in), A_new(1), x_new(0), b_new(1)
+  LinearSystem(Matrix<C>& A_in, Vector<T>& x_in, Vector<C>& b_in) : dA(0), x(&x_in), A_new(1), x_new(0), b_new(1), info(0)
   {
     A = new Matrix<T>;
     *A = A_in;
@@ -191,6 +243,12 @@ public:
     b->resize( rows(b_in) );
     *b = b_in;
 
+    G = 0;
+    LD = 0;
+    P = 0;
+#ifdef HAVE_LAPACK
+    L = 0;
+#endif
 #ifdef HAVE_SUPERLU
     S = 0;
 #endif
@@ -216,6 +274,15 @@ public:
        b = 0;
      }
 
+     delete G;
+     G = 0;
+     delete LD;
+     LD = 0;
+#ifdef HAVE_LAPACK
+     delete L;
+     L = 0;
+#endif
+
 #ifdef HAVE_SUPERLU
      delete S;
      S = 0;
@@ -227,6 +294,15 @@ public:
   void setInfo(int level)
   { info = level; }
 
+  /** Set the preconditioner used by the iterative solvers (Cg, Gmres and
+   * BiCGStab) instead of the default Jacobi one. It is not deleted by the
+   * LinearSystem. Its update() function is called when solveYourself() is
+   * called with recalc == FALSE.
+   * @param P_in Preconditioner (e.g. AmgPrecond, IC0Precond, ILU0Precond, SSORPrecond), or 0 for Jacobi.
+    */
+  void setPreconditioner(LinearOperator<T>* P_in)
+  { P = P_in; }
+
   Vector<T>& solveYourself(bool);
 
   /**
@@ -253,32 +329,51 @@ namespace lmx {
    *
    * <table> <tr> <td>getLinSolverType()</td>    <td>getMatrixType()</td>    <td>Solver used:</td> </tr>
    *  <tr> <td> 0 </td>    <td> 0 </td>    <td> Gauss</td> </tr>
-   *  <tr> <td> 0 </td>    <td> 1 </td>    <td> SuperLU </td> </tr>
+   *  <tr> <td> 0 </td>    <td> 1 </td>    <td> lmx::Ldlt (sparse LDL^T with minimum degree ordering)</td> </tr>
    *  <tr> <td> 0 </td>    <td> 2 </td>    <td> gmm::lu_solve (SuperLU in the future)</td>    </tr>
    *  <tr> <td> 0 </td>    <td> 3 </td>    <td> gmm::lu_solve (SuperLU in the future)</td> </tr>
+   *  <tr> <td> 0 </td>    <td> 4 </td>    <td> Gauss</td> </tr>
+   *  <tr> <td> 0 </td>    <td> 5, 6, 7, 8, 9 </td>    <td> lmx::Ldlt </td> </tr>
    *
    *  <tr> <td> 1 </td>    <td> 0 </td>    <td> Gauss</td> </tr>
    *  <tr> <td> 1 </td>    <td> 1 </td>    <td> SuperLU </td> </tr>
    *  <tr> <td> 1 </td>    <td> 2 </td>    <td> gmm::lu_solve (SuperLU in the future)</td>    </tr>
    *  <tr> <td> 1 </td>    <td> 3 </td>    <td> gmm::lu_solve (SuperLU in the future)</td> </tr>
+   *  <tr> <td> 1 </td>    <td> 4 </td>    <td> Gauss</td> </tr>
+   *  <tr> <td> 1 </td>    <td> 5 </td>    <td> Gauss</td> </tr>
+   *  <tr> <td> 1 </td>    <td> 6 </td>    <td> Gauss</td> </tr>
+   *  <tr> <td> 1 </td>    <td> 7, 8, 9 </td>    <td> Gauss</td> </tr>
    *
    *  <tr> <td> 2 </td>    <td> 0 </td>    <td> lmx::Cg </td> </tr>
    *  <tr> <td> 2 </td>    <td> 1 </td>    <td> lmx::Cg </td> </tr>
    *  <tr> <td> 2 </td>    <td> 2 </td>    <td> lmx::Cg (and gmm::cg possible if uncommented)</td> </tr>
    *  <tr> <td> 2 </td>    <td> 3 </td>    <td> lmx::Cg (and gmm::cg possible if uncommented)</td> </tr>
+   *  <tr> <td> 2 </td>    <td> 4 </td>    <td> lmx::Cg </td> </tr>
+   *  <tr> <td> 2 </td>    <td> 5 </td>    <td> lmx::Cg </td> </tr>
+   *  <tr> <td> 2 </td>    <td> 6 </td>    <td> lmx::Cg </td> </tr>
+   *  <tr> <td> 2 </td>    <td> 7, 8, 9 </td>    <td> lmx::Cg (block-Jacobi preconditioner)</td> </tr>
    *
-   *  <tr> <td> 3 </td>    <td> 0 </td>    <td> - </td> </tr>
-   *  <tr> <td> 3 </td>    <td> 1 </td>    <td> - </td> </tr>
-   *  <tr> <td> 3 </td>    <td> 2 </td>    <td> - </td> </tr>
+   *  <tr> <td> 3 </td>    <td> 0, 1, 2, 4, 5, 6 </td>    <td> lmx::Gmres (Jacobi preconditioner) </td> </tr>
    *  <tr> <td> 3 </td>    <td> 3 </td>    <td> gmm::gmres </td> </tr>
+   *  <tr> <td> 3 </td>    <td> 7, 8, 9 </td>    <td> lmx::Gmres (block-Jacobi preconditioner) </td> </tr>
+   *
+   *  <tr> <td> 4 </td>    <td> all </td>    <td> lmx::BiCGStab (Jacobi or block-Jacobi preconditioner) </td> </tr>
    *  </table>
    *
    * IMPORTANT: gmm::lu_solve is not implemented when the vector_type
    * is set to code 1 (Type_gmmVector_sparse). To Be Done.
    *
-   * When a solver is not available, an error will be thrown.
+   * When a solver is not available, or the Matrix or solver type is unknown,
+   * an error will be thrown.
+   *
+   * The direct solvers (Gauss, Gesv, Ldlt and SuperLU) keep the factorization in
+   * the LinearSystem object. Calling again with recalc == TRUE reuses it, so
+   * only the forward and back substitutions are done for the current "b".
+   * This is only valid if the Matrix has not changed since the last call with
+   * recalc == FALSE (e.g. modified Newton or linear dynamics with constant step).
+   * The iterative solvers ignore the flag.
    *
-   * @param recalc For SuperLU switches between refactoring (FALSE) or use old factoring (TRUE).
+   * @param recalc Switches between refactoring (FALSE) or use old factoring (TRUE).
    * @return reference of solution Vector.
    */
   template <class T>
@@ -296,11 +391,9 @@ namespace lmx {
       }
       // Using built-in gauss elimination procedure:
 #ifdef HAVE_LAPACK
-      Gesv<T> solver( dA, x, b );
-      solver.solve();
+      solveGesv( dA, recalc );
 #else
-      Gauss<T> solver( dA, b );
-      *x = solver.solve();
+      solveGauss( dA, recalc );
 #endif
       return *x;
     }
@@ -319,48 +412,27 @@ namespace lmx {
         case 0 : // solver_type == 0 -> directos para sistemas simetrico
           switch (getMatrixType()) {
             case 0 :
+            case 4 :
             {  // Using built-in gauss elimination procedure:
 #ifdef HAVE_LAPACK
-              Gesv<T> solver( A, x, b );
-              solver.solve();
+              solveGesv( A, recalc );
 #else
-              Gauss<T> solver( A, b );
-              *x = solver.solve();
+              solveGauss( A, recalc );
 #endif
               return *x;
             }
             break;
 
             case 1 :
-#ifdef HAVE_SUPERLU
-              if (recalc == FALSE){
-                cout << "S: " << S << endl;
-                if (S == 0)
-                  S = new Superlu<T>( static_cast<Type_csc<T>*>(A->type_matrix)-> Nrow,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> Ncol,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> Nnze,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> ia,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> ja,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> aa,
-                                      *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ),
-                                      *(static_cast<Type_stdVector<T>*>(b->type_vector)->data_pointer() ) );
-                S->init();
-                S->calc(info);
-                S->get_solution( *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ) );
-              }
-              else{
-
-                S->recalc(info);
-                S->get_solution( *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ) );
-              }
-#else
-              {
-                  std::stringstream message;
-                  message << "SuperLU not defined.\nYou must set \"#define HAVE_SUPERLU\" in your file in order to use this library." << endl;
-                  LMX_THROW(failure_error, message.str() );
-              }
-#endif
+            case 5 :
+            case 6 :
+            case 7 :
+            case 8 :
+            case 9 :
+            {  // Native sparse LDL^T, the analysis is kept while the pattern does not change:
+              solveLdlt( recalc );
               return *x;
+            }
             break;
 
             case 2 :
@@ -419,6 +491,13 @@ namespace lmx {
               return *x;
               break;
 
+            default :
+            {
+              std::stringstream message;
+              message << "Unknown matrix type.\nLinear solver type = " << getLinSolverType() << ", Matrix type = " << getMatrixType() << "." << endl;
+              LMX_THROW(failure_error, message.str() );
+            }
+
           }
           break;
 
@@ -427,34 +506,34 @@ namespace lmx {
 
             switch (getMatrixType()) {
             case 0 :
+            case 4 :
+            case 5 :
+            case 6 :
+            case 7 :
+            case 8 :
+            case 9 :
             {  // Using built-in gauss elimination procedure:
-              Gauss<T> solver( A, b );
-              *x = solver.solve();
+              solveGauss( A, recalc );
               return *x;
             }
             break;
 
             case 1 :
 #ifdef HAVE_SUPERLU
-              if (recalc == FALSE){
-                cout << "S: " << S << endl;
-                if (S == 0)
-                  S = new Superlu<T>( static_cast<Type_csc<T>*>(A->type_matrix)-> Nrow,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> Ncol,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> Nnze,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> ia,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> ja,
-                                      static_cast<Type_csc<T>*>(A->type_matrix)-> aa,
-                                      *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ),
-                                      *(static_cast<Type_stdVector<T>*>(b->type_vector)->data_pointer() ) );
-                S->init();
-                S->calc(info);
-                S->get_solution( *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ) );
-              }
-              else{
-                S->recalc(info);
-                S->get_solution( *(static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer() ) );
+            {  // The arrays are passed without copies, the analysis is kept while the pattern does not change:
+              if (getVectorType() != 0){
+                std::stringstream message;
+                message << "Solver not implemented.\nLinear solver type = " << getLinSolverType() << ", Matrix type = " << getMatrixType() << ", Vector type = " << getVectorType() << "." << endl;
+                LMX_THROW(to_be_done_error, message.str() );
               }
+              Type_csc<T>* csc = static_cast<Type_csc<T>*>(A->type_matrix);
+              if (S == 0)
+                S = new Superlu<T>();
+              if (!recalc || !S->isFactorized())
+                S->factorize( csc->Nrow, csc->Ncol, &csc->ia[0], &csc->ja[0], &csc->aa[0], info );
+              S->solve( &(*static_cast<Type_stdVector<T>*>(x->type_vector)->data_pointer())[0],
+                        &(*static_cast<Type_stdVector<T>*>(b->type_vector)->data_pointer())[0] );
+            }
 #else
               {
                   std::stringstream message;
@@ -516,15 +595,32 @@ namespace lmx {
 #endif
               return *x;
               break;
+
+            default :
+            {
+              std::stringstream message;
+              message << "Unknown matrix type.\nLinear solver type = " << getLinSolverType() << ", Matrix type = " << getMatrixType() << "." << endl;
+              LMX_THROW(failure_error, message.str() );
+            }
             }
           break;
 
         case 2 : // solver_type == 2 -> iterativos para sistemas simetricos
           switch (getMatrixType()) {
             case 0 :
+            case 4 :
+            case 5 :
+            case 6 :
+            case 7 :
+            case 8 :
+            case 9 :
             {
               Cg<T> cg_solver(A, b);
-              cg_solver.precond();
+              if (P){
+                if (!recalc) P->update(A);
+                cg_solver.setPreconditioner(P);
+              }
+              else cg_solver.precond();
               *x = cg_solver.solve(info);
 
               return *x;
@@ -534,7 +630,11 @@ namespace lmx {
             case 1 :
             {
               Cg<T> cg_solver(A, b);
-              cg_solver.precond();
+              if (P){
+                if (!recalc) P->update(A);
+                cg_solver.setPreconditioner(P);
+              }
+              else cg_solver.precond();
               *x = cg_solver.solve(info);
 
               return *x;
@@ -545,7 +645,11 @@ namespace lmx {
             { 
               // CG de lmx
               Cg<T> cg_solver(A, b);
-              cg_solver.precond();
+              if (P){
+                if (!recalc) P->update(A);
+                cg_solver.setPreconditioner(P);
+              }
+              else cg_solver.precond();
               *x = cg_solver.solve(info);
 
               // CG de gmm SOLO PARA VECTORES STL
@@ -621,24 +725,38 @@ namespace lmx {
   //////////////////////////////////////// Just another form of calling gmm's CG, END:
           break;
 
+            default :
+            {
+              std::stringstream message;
+              message << "Unknown matrix type.\nLinear solver type = " << getLinSolverType() << ", Matrix type = " << getMatrixType() << "." << endl;
+              LMX_THROW(failure_error, message.str() );
+            }
+
           }
           break;
 
         case 3 : // solver_type == 3 -> iterativos para sistemas simetrico y no simetrico
           switch (getMatrixType()) {
             case 0 :
-              // Not available (error)
-
-            break;
-
             case 1 :
-              // TBI
-
-              break;
-
             case 2 :
-              // Not available (error)
+            case 4 :
+            case 5 :
+            case 6 :
+            case 7 :
+            case 8 :
+            case 9 :
+            {
+              Gmres<T> gmres_solver(A, b);
+              if (P){
+                if (!recalc) P->update(A);
+                gmres_solver.setPreconditioner(P);
+              }
+              else gmres_solver.precond();
+              *x = gmres_solver.solve(info);
 
+              return *x;
+            }
             break;
 
             case 3 :
@@ -679,13 +797,93 @@ namespace lmx {
 
             break;
 
+            default :
+            {
+              std::stringstream message;
+              message << "Unknown matrix type.\nLinear solver type = " << getLinSolverType() << ", Matrix type = " << getMatrixType() << "." << endl;
+              LMX_THROW(failure_error, message.str() );
+            }
+
           }
           break;
+
+        case 4 : // solver_type == 4 -> BiCGStab para sistemas no simetricos
+        {
+          BiCGStab<T> bicgstab_solver(A, b);
+          if (P){
+            if (!recalc) P->update(A);
+            bicgstab_solver.setPreconditioner(P);
+          }
+          else bicgstab_solver.precond();
+          *x = bicgstab_solver.solve(info);
+
+          return *x;
+        }
+        break;
+
+        default :
+        {
+          std::stringstream message;
+          message << "Unknown linear solver type = " << getLinSolverType() << "." << endl;
+          LMX_THROW(failure_error, message.str() );
+        }
       }
     }
     return *x;
   }
 
+  /**
+   * \brief Solves the system with the built-in Gauss elimination.
+   * The factorization is kept in G and reused when recalc == TRUE.
+   * @param A_in LHS Matrix (or DenseMatrix).
+   * @param recalc Switches between refactoring (FALSE) or use old factoring (TRUE).
+   */
+  template <class T>
+      void LinearSystem<T>::solveGauss( Matrix<T>* A_in, bool recalc )
+  {
+    if ( !recalc || G == 0 ){
+      delete G;
+      G = new Gauss<T>( A_in, b );
+      G->factorize();
+    }
+    *x = G->solve( *b );
+  }
+
+  /**
+   * \brief Solves the system with the sparse LDL^T factorization.
+   * The symbolic analysis is only repeated if the sparsity pattern of the
+   * Matrix changes, and the numerical factorization is reused when
+   * recalc == TRUE.
+   * @param recalc Switches between refactoring (FALSE) or use old factoring (TRUE).
+   */
+  template <class T>
+      void LinearSystem<T>::solveLdlt( bool recalc )
+  {
+    if ( LD == 0 ) LD = new Ldlt<T>();
+    if ( !recalc || !LD->isFactorized() )
+      LD->factorize( A );
+    LD->solve( *x, *b );
+  }
+
+#ifdef HAVE_LAPACK
+  /**
+   * \brief Solves the system with Lapack's ?getrf/?getrs.
+   * The factorization is kept in L and reused when recalc == TRUE.
+   * @param A_in LHS Matrix (or DenseMatrix).
+   * @param recalc Switches between refactoring (FALSE) or use old factoring (TRUE).
+   */
+  template <class T>
+      void LinearSystem<T>::solveGesv( Matrix<T>* A_in, bool recalc )
+  {
+    if ( !recalc || L == 0 ){
+      delete L;
+      L = new Gesv<T>( A_in, x, b );
+      L->factorize();
+    }
+    L->solve( b );
+  }
+#endif
+
 }; // namespace lmx
 
 
@@ -45,6 +45,18 @@ typedef size_t size_type;
 
 namespace lmx {
 
+template <typename T> class Data_mat;
+template <typename T> class Data_vec;
+
+/** Matrix and Vector take the data container as a second template
+ * parameter. The default (Data_mat<T>, Data_vec<T>) is the polymorphic
+ * container selected at run time with setMatrixType() and setVectorType().
+ * Giving a concrete container type (e.g. Matrix<double, Type_csr<double> >)
+ * fixes it at compile time; see lmx_mat_static.h.
+ */
+template <typename T, typename Storage = Data_mat<T> > class Matrix;
+template <typename T, typename Storage = Data_vec<T> > class Vector;
+
     /**
     \class Data
     \brief Template class Data.
@@ -56,6 +68,8 @@ namespace lmx {
     */
 template <typename T> class Data{
 public:
+  /** Numeric type of the stored data. */
+  typedef T value_type;
 
   /** Empty constructor.
    */
@@ -79,6 +93,13 @@ public:
    */
   virtual void writeElement(T, size_type, size_type) = 0;
 
+  /** Method for adding a value to the stored data.
+   * Used by the "+=" and "-=" operators of Elem_ref. Containers that can
+   * accumulate without reading first (see Type_csc) override it.
+   */
+  virtual void addElement(T value, size_type m, size_type n)
+  { this->writeElement( this->readElement(m,n) + value, m, n ); }
+
   /** Method for knowing the number of data rows. 
    * \returns Number of rows.
    */
@@ -21,6 +21,7 @@
 #define LMXDATA_BLAS_H
 
 #include<algorithm>
+#include"lmx_mat_dense_gemm.h"
 
 //////////////////////////////////////////// Doxygen file documentation entry:
     /*!
@@ -40,6 +41,13 @@
  */
 typedef size_t size_type;
 
+/**
+ * Default index type of sparse CSC matrices (Type_csc).
+ */
+#ifndef LMX_CSC_INDEX
+#define LMX_CSC_INDEX int
+#endif
+
 
 namespace lmx{
 
@@ -47,7 +55,12 @@ template <typename T> class Data_mat;
 template <typename T> class Data_vec;
 
 template <typename T> class Type_stdmatrix;
-template <typename T> class Type_csc;
+template <typename T> class Type_dense;
+template <typename T, typename IndexType = LMX_CSC_INDEX> class Type_csc;
+template <typename T> class Type_csr;
+template <typename T, typename IndexType = LMX_CSC_INDEX> class Type_csc_sym;
+template <typename T, int B, typename IndexType = LMX_CSC_INDEX> class Type_bsr;
+template <typename T, int B> struct Bsr_block;
 template <typename T> class Type_stdVector;
 #ifdef HAVE_GMM
 template <typename T> class Type_gmm;
@@ -56,6 +69,11 @@ template <typename T> class Type_gmmVector_sparse;
 #endif
 
 
+template <typename T>
+    void mat_mat_mult( const Type_dense<T>* A,
+                       const Type_dense<T>* B,
+                       Type_dense<T>* C);
+
 // Matrix generalized methods (not very efficient but robust):
 
 /**
@@ -115,20 +133,25 @@ template <typename T>
 	    << endl << "  This cannot be done." << endl;
       LMX_THROW(failure_error, message.str() );
     }
+  // Contiguous storage in the three operands, go through the raw pointers:
+  const Type_dense<T>* A_dense = dynamic_cast<const Type_dense<T>*>(A);
+  const Type_dense<T>* B_dense = dynamic_cast<const Type_dense<T>*>(B);
+  Type_dense<T>* C_dense = dynamic_cast<Type_dense<T>*>(C);
+  if ( A_dense && B_dense && C_dense ){
+    mat_mat_mult( A_dense, B_dense, C_dense );
+    return;
+  }
   size_type i, j, k;
   C->resize( A->getRows(), B->getCols() );
-  for (i=0; i< C->getRows(); ++i){
-    for (j=0; j< C->getCols(); ++j){
-      C->writeElement( T(0), i, j );
-	}
-  }
-  // This can have a good optimization...
+  // One write per element, accumulating the dot product locally:
+  T sum;
   for (i=0; i < C->getRows(); ++i){
     for (j=0; j < C->getCols(); ++j){
-      C->writeElement( 0, i, j );
+      sum = T(0);
       for (k=0; k < A->getCols(); ++k){
-        C->writeElement( C->readElement(i,j) + A->readElement(i,k) * B->readElement(k,j) , i, j );
+        sum += A->readElement(i,k) * B->readElement(k,j);
       }
+      C->writeElement( sum, i, j );
     }
   }
 }
@@ -170,8 +193,61 @@ template <typename T>
 }
 
 
+/**
+ * Matrix vector (pre)multiplication for any pair of containers.
+ * Calculates the product A*b = c element by element. The specialized
+ * overloads below are preferred when the container types match them.
+ * Used by Vector<T,Storage>::mult() (see lmx_mat_static.h), where the
+ * container types are known at compile time and the element access is inlined.
+ * @param matrix_in Matrix container A.
+ * @param vector_in Vector container b.
+ * @param vector_out Vector container c = A*b.
+ */
+template <typename M, typename V>
+    void mat_vec_mult( const M* matrix_in,
+                       const V* vector_in,
+                       V* vector_out )
+{
+  typedef typename M::value_type T;
+  const size_type rows = matrix_in->getRows();
+  const size_type cols = matrix_in->getCols();
+  T sum;
+  for (size_type i=0; i < rows; ++i){
+    sum = T(0);
+    for (size_type j=0; j < cols; ++j){
+      sum += matrix_in->readElement(i,j) * vector_in->readElement(j,0);
+    }
+    vector_out->writeElement( sum, i, 0 );
+  }
+}
+
 // Multiplication specialized methods:
 
+/**
+ * Matrix matrix multiplication, specialized for Type_dense Data_mat (contiguous dense) format.
+ * Calculates the product A*B = C with the cache-blocked kernel dense_gemm().
+ * @param A LHS Type_dense *Matrix.
+ * @param B RHS Type_dense *Matrix.
+ * @param C Result Type_dense *Matrix, C=A*B.
+ */
+template <typename T>
+    void mat_mat_mult( const Type_dense<T>* A,
+                       const Type_dense<T>* B,
+                       Type_dense<T>* C)
+{
+  if ( A->getCols() != B->getRows() ){
+    std::stringstream message;
+    message << "Matrix dimensions mismatch in multiplication: (" << A->getRows() << "," << A->getCols()
+        << ") * (" << B->getRows() << "," << B->getCols() << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  C->resize( A->getRows(), B->getCols() );
+  dense_gemm( A->getRows(), B->getCols(), A->getCols(),
+              A->data_pointer(), A->getLeadingDim(),
+              B->data_pointer(), B->getLeadingDim(),
+              C->data_pointer(), C->getLeadingDim() );
+}
+
 /**
  * Matrix vector (pre)multiplication, specialized for Type_csc Data_mat (matrix) and Type_stdVector (STL vector) formats.
  * Calculates the product A*b = c using pointers.
@@ -179,37 +255,142 @@ template <typename T>
  * @param vector_in Type_stdVector *Vector b.
  * @param vector_out Type_stdVector *Vector c = A*b.
  */
-template <typename T>
+template <typename T, typename IndexType>
     void mat_vec_mult
-    ( const Type_csc<T>* matrix_in,
+    ( const Type_csc<T,IndexType>* matrix_in,
       const Type_stdVector<T>* vector_in,
       Type_stdVector<T>* vector_out
     )
 {
-  size_type a;
-  size_type b;
-  T c;
-  size_type d;
+  const size_type cols = matrix_in->getCols();
+  const IndexType* ja = &(matrix_in->ja[0]);
+  const IndexType* ia = matrix_in->Nnze ? &(matrix_in->ia[0]) : 0;
+  const T* aa = matrix_in->Nnze ? &(matrix_in->aa[0]) : 0;
+  const std::vector<T>& x = *(vector_in->data_pointer());
+  std::vector<T>& y = *(vector_out->data_pointer());
 
  //rutina que multiplica la  matriz A (en formato Harwell-Boeing) con el vector X
 
-  for(unsigned int i=0; i < (matrix_in->getRows()); ++i)
-    vector_out->contents[i] = 0;
+  std::fill(y.begin(), y.end(), T(0));
 
-  //std::fill(vector_out->contents.begin(), vector_out->contents.end(), 0);
+  for(size_type j=0; j < cols; ++j) {
+    const T x_j = x[j];
+    for(IndexType k=ja[j]; k<ja[j+1]; ++k) {
+      y[ ia[k] ] += aa[k] * x_j;
+    }
+  }
+}
 
-  for(unsigned int i=0; i < (matrix_in->getCols()); ++i) {
-    a = matrix_in->ja[i];
-    b = matrix_in->ja[i+1];
+/**
+ * Matrix vector (pre)multiplication, specialized for Type_csr Data_mat (matrix) and Type_stdVector (STL vector) formats.
+ * Calculates the product A*b = c using pointers. Each row writes only its
+ * own component of c, so rows are distributed among threads when OpenMP is enabled.
+ * @param matrix_in Type_csr *Matrix A.
+ * @param vector_in Type_stdVector *Vector b.
+ * @param vector_out Type_stdVector *Vector c = A*b.
+ */
+template <typename T>
+    void mat_vec_mult
+    ( const Type_csr<T>* matrix_in,
+      const Type_stdVector<T>* vector_in,
+      Type_stdVector<T>* vector_out
+    )
+{
+  const long rows = static_cast<long>( matrix_in->getRows() );
+  const size_type* ia = &(matrix_in->ia[0]);
+  const size_type* ja = matrix_in->Nnze ? &(matrix_in->ja[0]) : 0;
+  const T* aa = matrix_in->Nnze ? &(matrix_in->aa[0]) : 0;
+  const T* x = vector_in->contents.empty() ? 0 : &(vector_in->contents[0]);
+  T* y = vector_out->contents.empty() ? 0 : &(vector_out->contents[0]);
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(long i=0; i < rows; ++i) {
+    T sum = T(0);
+    for(size_type k=ia[i]; k<ia[i+1]; ++k)
+      sum += aa[k] * x[ ja[k] ];
+    y[i] = sum;
+  }
+}
 
-    for(unsigned int j=a; j<b; ++j) {
-      c = matrix_in->aa[j-1];
-      d = matrix_in->ia[j-1]-1;
-      vector_out->contents[d] += c * vector_in->contents[i];
+/**
+ * Matrix vector (pre)multiplication, specialized for Type_csc_sym Data_mat (matrix) and Type_stdVector (STL vector) formats.
+ * Calculates the product A*b = c using pointers. Each stored element a_ij
+ * of the lower triangle is used twice, for c_i += a_ij*b_j and for
+ * c_j += a_ij*b_i, so the matrix is swept only once.
+ * @param matrix_in Type_csc_sym *Matrix A.
+ * @param vector_in Type_stdVector *Vector b.
+ * @param vector_out Type_stdVector *Vector c = A*b.
+ */
+template <typename T, typename IndexType>
+    void mat_vec_mult
+    ( const Type_csc_sym<T,IndexType>* matrix_in,
+      const Type_stdVector<T>* vector_in,
+      Type_stdVector<T>* vector_out
+    )
+{
+  const size_type cols = matrix_in->getCols();
+  const IndexType* ja = &(matrix_in->ja[0]);
+  const IndexType* ia = matrix_in->Nnze ? &(matrix_in->ia[0]) : 0;
+  const T* aa = matrix_in->Nnze ? &(matrix_in->aa[0]) : 0;
+  const std::vector<T>& x = *(vector_in->data_pointer());
+  std::vector<T>& y = *(vector_out->data_pointer());
+
+  std::fill(y.begin(), y.end(), T(0));
+
+  for(size_type j=0; j < cols; ++j) {
+    const T x_j = x[j];
+    IndexType k = ja[j];
+    const IndexType end = ja[j+1];
+    T sum = T(0);
+    if( k < end && static_cast<size_type>(ia[k]) == j ) { // diagonal goes first
+      sum = aa[k] * x_j;
+      ++k;
+    }
+    for( ; k < end; ++k) {
+      const IndexType i = ia[k];
+      y[i] += aa[k] * x_j;
+      sum += aa[k] * x[i];
     }
+    y[j] += sum;
   }
 }
 
+/**
+ * Matrix vector (pre)multiplication, specialized for Type_bsr Data_mat (matrix) and Type_stdVector (STL vector) formats.
+ * Calculates the product A*b = c using pointers. The product of each B x B
+ * block is unrolled (Bsr_block) and each block row writes only its own B
+ * components of c, so block rows are distributed among threads when OpenMP is enabled.
+ * @param matrix_in Type_bsr *Matrix A.
+ * @param vector_in Type_stdVector *Vector b.
+ * @param vector_out Type_stdVector *Vector c = A*b.
+ */
+template <typename T, int B, typename IndexType>
+    void mat_vec_mult
+    ( const Type_bsr<T,B,IndexType>* matrix_in,
+      const Type_stdVector<T>* vector_in,
+      Type_stdVector<T>* vector_out
+    )
+{
+  const long brows = static_cast<long>( matrix_in->Nbrow );
+  const IndexType* ia = &(matrix_in->ia[0]);
+  const IndexType* ja = matrix_in->Nblocks ? &(matrix_in->ja[0]) : 0;
+  const T* aa = matrix_in->Nblocks ? &(matrix_in->aa[0]) : 0;
+  const std::vector<T>& x = *(vector_in->data_pointer());
+  std::vector<T>& y = *(vector_out->data_pointer());
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for(long bi=0; bi < brows; ++bi) {
+    T sum[B];
+    for(int i=0; i < B; ++i) sum[i] = T(0);
+    for(IndexType k=ia[bi]; k<ia[bi+1]; ++k)
+      Bsr_block<T,B>::mult_add( aa + k*B*B, &x[ ja[k]*B ], sum );
+    for(int i=0; i < B; ++i) y[bi*B+i] = sum[i];
+  }
+}
 
 #ifdef HAVE_GMM
 /**
@@ -277,11 +458,11 @@ void mat_vec_mult( Type_gmm_sparse<T>* matrix_in,
  * @param dense_matrix_in Type_stdMatrix *Matrix B.
  * @param matrix_in Type_csc *Matrix A.
  */
-template <typename T>
+template <typename T, typename IndexType>
     void copy( const Type_stdmatrix<T>* dense_matrix_in,
-               Type_csc<T>* matrix_in )
+               Type_csc<T,IndexType>* matrix_in )
 {
-  size_type i,j, col_counter=1;
+  size_type i,j, col_counter=0;
   size_type rows = matrix_in->getRows();
   size_type cols = matrix_in->getCols();
   T value;
@@ -295,7 +476,7 @@ template <typename T>
     for (i=0; i<rows; ++i){
       value = dense_matrix_in->contents[i][j];
       if ( value != T(0) ){
-        matrix_in->ia.push_back(i+1);
+        matrix_in->ia.push_back(i);
         matrix_in->aa.push_back(value);
         ++col_counter;
       }
@@ -308,6 +489,113 @@ template <typename T>
   matrix_in->Nnze = matrix_in->aa.size();
 }                           
 
+/**
+ * Copy from dense to sparse, specialized for Type_dense Data_mat (contiguous dense) and Type_csc formats.
+ * @param dense_matrix_in Type_dense *Matrix B.
+ * @param matrix_in Type_csc *Matrix A.
+ */
+template <typename T, typename IndexType>
+    void copy( const Type_dense<T>* dense_matrix_in,
+               Type_csc<T,IndexType>* matrix_in )
+{
+  size_type i,j, col_counter=0;
+  size_type rows = matrix_in->getRows();
+  size_type cols = matrix_in->getCols();
+  size_type ld = dense_matrix_in->ld;
+  T value;
+
+  matrix_in->aa.clear();
+  matrix_in->ia.clear();
+  matrix_in->ja.clear();
+
+  for (j=0; j<cols; ++j){
+    matrix_in->ja.push_back(col_counter);
+    for (i=0; i<rows; ++i){
+      value = dense_matrix_in->contents[i*ld + j];
+      if ( value != T(0) ){
+        matrix_in->ia.push_back(i);
+        matrix_in->aa.push_back(value);
+        ++col_counter;
+      }
+    }
+  }
+  matrix_in->ja.push_back(col_counter);
+
+  matrix_in->Nrow = rows;
+  matrix_in->Ncol = cols;
+  matrix_in->Nnze = matrix_in->aa.size();
+}
+
+
+/**
+ * Conversion from CSC to CSR format.
+ * Counting sort over the rows, O(Nnze + Nrow).
+ * @param csc_in Type_csc *Matrix to read from.
+ * @param csr_out Type_csr *Matrix to write to.
+ */
+template <typename T, typename IndexType>
+    void copy( const Type_csc<T,IndexType>* csc_in,
+               Type_csr<T>* csr_out )
+{
+  size_type rows = csc_in->getRows();
+  size_type cols = csc_in->getCols();
+  size_type nnze = csc_in->Nnze;
+
+  csr_out->ia.assign( rows+1, 0 );
+  csr_out->ja.resize( nnze );
+  csr_out->aa.resize( nnze );
+
+  for (size_type k=0; k<nnze; ++k) ++csr_out->ia[ csc_in->ia[k]+1 ];
+  for (size_type i=0; i<rows; ++i) csr_out->ia[i+1] += csr_out->ia[i];
+
+  std::vector<size_type> next( csr_out->ia.begin(), csr_out->ia.end()-1 );
+  for (size_type j=0; j<cols; ++j){
+    for (size_type k=csc_in->ja[j]; k<(size_type)csc_in->ja[j+1]; ++k){
+      size_type pos = next[ csc_in->ia[k] ]++;
+      csr_out->ja[pos] = j;
+      csr_out->aa[pos] = csc_in->aa[k];
+    }
+  }
+
+  csr_out->Nrow = rows;
+  csr_out->Ncol = cols;
+  csr_out->Nnze = nnze;
+}
+
+/**
+ * Conversion from CSR to CSC format.
+ * Counting sort over the columns, O(Nnze + Ncol).
+ * @param csr_in Type_csr *Matrix to read from.
+ * @param csc_out Type_csc *Matrix to write to.
+ */
+template <typename T, typename IndexType>
+    void copy( const Type_csr<T>* csr_in,
+               Type_csc<T,IndexType>* csc_out )
+{
+  size_type rows = csr_in->getRows();
+  size_type cols = csr_in->getCols();
+  size_type nnze = csr_in->Nnze;
+
+  csc_out->ja.assign( cols+1, 0 );
+  csc_out->ia.resize( nnze );
+  csc_out->aa.resize( nnze );
+
+  for (size_type k=0; k<nnze; ++k) ++csc_out->ja[ csr_in->ja[k]+1 ];
+  for (size_type j=0; j<cols; ++j) csc_out->ja[j+1] += csc_out->ja[j];
+
+  std::vector<IndexType> next( csc_out->ja.begin(), csc_out->ja.end()-1 );
+  for (size_type i=0; i<rows; ++i){
+    for (size_type k=csr_in->ia[i]; k<csr_in->ia[i+1]; ++k){
+      size_type pos = next[ csr_in->ja[k] ]++;
+      csc_out->ia[pos] = i;
+      csc_out->aa[pos] = csr_in->aa[k];
+    }
+  }
+
+  csc_out->Nrow = rows;
+  csc_out->Ncol = cols;
+  csc_out->Nnze = nnze;
+}
 
 } //namespace lmx
 
@@ -42,7 +42,7 @@
 namespace lmx {
 
 // Forward declarations:
-template <typename T> class Vector;
+template <typename T, typename Storage> class Vector;
 
     /**
     \class Data_mat 
@@ -95,6 +95,14 @@ public:
   virtual void setSparsePattern( Vector<T>&, Vector<T>& )
   {}
 
+  /** Starts a staged assembly. Writes to new positions may be delayed until endAssembly(). */
+  virtual void beginAssembly()
+  {}
+
+  /** Ends a staged assembly, inserting every delayed element. */
+  virtual void endAssembly()
+  {}
+
   /** Prepares the sparse structure of a CSC matrix. */
   virtual void setSparsePattern( std::vector<size_type>&,
                                  std::vector<size_type>&
@@ -0,0 +1,331 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXDENSE_GEMM_H
+#define LMXDENSE_GEMM_H
+
+#include <cstddef>
+#include <algorithm>
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_dense_gemm.h
+
+      \brief Cache-blocked matrix-matrix product for contiguous row-major buffers.
+
+      Implements C = A*B over raw pointers with leading dimensions (as given by Type_dense). The loops are blocked so that a KC x NC panel of B stays in cache while it is swept by MC x KC blocks of A, and the inner product is done by register-tiled micro-kernels. For double precision, AVX2 and AVX-512 micro-kernels are selected at run time when the compiler and the processor support them; otherwise a portable scalar kernel is used.
+
+      Define LMX_NO_SIMD to force the scalar kernel.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+#if !defined(LMX_NO_SIMD) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+  #if (__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__)
+    #define LMX_GEMM_X86 1
+    #include <immintrin.h>
+    #if (__GNUC__ >= 5) || defined(__clang__)
+      #define LMX_GEMM_AVX512 1
+    #endif
+  #endif
+#endif
+
+/** Rows of A in a cache block (L2). */
+#ifndef LMX_GEMM_MC
+#define LMX_GEMM_MC 96
+#endif
+
+/** Depth of a cache block (L1/L2). */
+#ifndef LMX_GEMM_KC
+#define LMX_GEMM_KC 256
+#endif
+
+/** Columns of B in a cache block (L3). */
+#ifndef LMX_GEMM_NC
+#define LMX_GEMM_NC 2048
+#endif
+
+namespace lmx {
+
+/**
+ * Scalar block update, valid for any size and data type.
+ * Calculates C(i0:i1, j0:j1) += A(i0:i1, k0:k1) * B(k0:k1, j0:j1).
+ */
+template <typename T>
+    inline void gemm_block_scalar( size_t i0, size_t i1,
+                                   size_t j0, size_t j1,
+                                   size_t k0, size_t k1,
+                                   const T* a, size_t lda,
+                                   const T* b, size_t ldb,
+                                   T* c, size_t ldc )
+{
+  for (size_t i=i0; i<i1; ++i){
+    T* c_row = c + i*ldc;
+    const T* a_row = a + i*lda;
+    for (size_t k=k0; k<k1; ++k){
+      const T a_ik = a_row[k];
+      const T* b_row = b + k*ldb;
+      for (size_t j=j0; j<j1; ++j) c_row[j] += a_ik * b_row[j];
+    }
+  }
+}
+
+/**
+ * Portable 4x4 register tile micro-kernel.
+ * Calculates C(0:4, 0:4) += A(0:4, 0:kc) * B(0:kc, 0:4), with the
+ * pointers already placed at the first element of each block.
+ */
+template <typename T>
+    inline void gemm_micro_scalar( size_t kc,
+                                   const T* a, size_t lda,
+                                   const T* b, size_t ldb,
+                                   T* c, size_t ldc )
+{
+  T c00=T(0), c01=T(0), c02=T(0), c03=T(0);
+  T c10=T(0), c11=T(0), c12=T(0), c13=T(0);
+  T c20=T(0), c21=T(0), c22=T(0), c23=T(0);
+  T c30=T(0), c31=T(0), c32=T(0), c33=T(0);
+  for (size_t k=0; k<kc; ++k){
+    const T* b_row = b + k*ldb;
+    const T b0 = b_row[0], b1 = b_row[1], b2 = b_row[2], b3 = b_row[3];
+    T a_ik = a[k];
+    c00 += a_ik*b0; c01 += a_ik*b1; c02 += a_ik*b2; c03 += a_ik*b3;
+    a_ik = a[lda + k];
+    c10 += a_ik*b0; c11 += a_ik*b1; c12 += a_ik*b2; c13 += a_ik*b3;
+    a_ik = a[2*lda + k];
+    c20 += a_ik*b0; c21 += a_ik*b1; c22 += a_ik*b2; c23 += a_ik*b3;
+    a_ik = a[3*lda + k];
+    c30 += a_ik*b0; c31 += a_ik*b1; c32 += a_ik*b2; c33 += a_ik*b3;
+  }
+  c[0] += c00; c[1] += c01; c[2] += c02; c[3] += c03;
+  c += ldc;
+  c[0] += c10; c[1] += c11; c[2] += c12; c[3] += c13;
+  c += ldc;
+  c[0] += c20; c[1] += c21; c[2] += c22; c[3] += c23;
+  c += ldc;
+  c[0] += c30; c[1] += c31; c[2] += c32; c[3] += c33;
+}
+
+#ifdef LMX_GEMM_X86
+/**
+ * AVX2/FMA 4x8 micro-kernel for double precision.
+ * Eight 256 bit accumulators, B rows loaded with unit stride and A broadcasted.
+ */
+__attribute__((target("avx2,fma")))
+    inline void gemm_micro_avx2( size_t kc,
+                                 const double* a, size_t lda,
+                                 const double* b, size_t ldb,
+                                 double* c, size_t ldc )
+{
+  __m256d c00 = _mm256_setzero_pd(), c01 = _mm256_setzero_pd();
+  __m256d c10 = _mm256_setzero_pd(), c11 = _mm256_setzero_pd();
+  __m256d c20 = _mm256_setzero_pd(), c21 = _mm256_setzero_pd();
+  __m256d c30 = _mm256_setzero_pd(), c31 = _mm256_setzero_pd();
+  for (size_t k=0; k<kc; ++k){
+    const double* b_row = b + k*ldb;
+    const __m256d b0 = _mm256_loadu_pd(b_row);
+    const __m256d b1 = _mm256_loadu_pd(b_row + 4);
+    __m256d a_ik = _mm256_broadcast_sd(a + k);
+    c00 = _mm256_fmadd_pd(a_ik, b0, c00); c01 = _mm256_fmadd_pd(a_ik, b1, c01);
+    a_ik = _mm256_broadcast_sd(a + lda + k);
+    c10 = _mm256_fmadd_pd(a_ik, b0, c10); c11 = _mm256_fmadd_pd(a_ik, b1, c11);
+    a_ik = _mm256_broadcast_sd(a + 2*lda + k);
+    c20 = _mm256_fmadd_pd(a_ik, b0, c20); c21 = _mm256_fmadd_pd(a_ik, b1, c21);
+    a_ik = _mm256_broadcast_sd(a + 3*lda + k);
+    c30 = _mm256_fmadd_pd(a_ik, b0, c30); c31 = _mm256_fmadd_pd(a_ik, b1, c31);
+  }
+  _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c00));
+  _mm256_storeu_pd(c+4, _mm256_add_pd(_mm256_loadu_pd(c+4), c01));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c10));
+  _mm256_storeu_pd(c+4, _mm256_add_pd(_mm256_loadu_pd(c+4), c11));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c20));
+  _mm256_storeu_pd(c+4, _mm256_add_pd(_mm256_loadu_pd(c+4), c21));
+  c += ldc;
+  _mm256_storeu_pd(c, _mm256_add_pd(_mm256_loadu_pd(c), c30));
+  _mm256_storeu_pd(c+4, _mm256_add_pd(_mm256_loadu_pd(c+4), c31));
+}
+#endif
+
+#ifdef LMX_GEMM_AVX512
+/**
+ * AVX-512 4x16 micro-kernel for double precision.
+ * Eight 512 bit accumulators, B rows loaded with unit stride and A broadcasted.
+ */
+__attribute__((target("avx512f")))
+    inline void gemm_micro_avx512( size_t kc,
+                                   const double* a, size_t lda,
+                                   const double* b, size_t ldb,
+                                   double* c, size_t ldc )
+{
+  __m512d c00 = _mm512_setzero_pd(), c01 = _mm512_setzero_pd();
+  __m512d c10 = _mm512_setzero_pd(), c11 = _mm512_setzero_pd();
+  __m512d c20 = _mm512_setzero_pd(), c21 = _mm512_setzero_pd();
+  __m512d c30 = _mm512_setzero_pd(), c31 = _mm512_setzero_pd();
+  for (size_t k=0; k<kc; ++k){
+    const double* b_row = b + k*ldb;
+    const __m512d b0 = _mm512_loadu_pd(b_row);
+    const __m512d b1 = _mm512_loadu_pd(b_row + 8);
+    __m512d a_ik = _mm512_set1_pd(a[k]);
+    c00 = _mm512_fmadd_pd(a_ik, b0, c00); c01 = _mm512_fmadd_pd(a_ik, b1, c01);
+    a_ik = _mm512_set1_pd(a[lda + k]);
+    c10 = _mm512_fmadd_pd(a_ik, b0, c10); c11 = _mm512_fmadd_pd(a_ik, b1, c11);
+    a_ik = _mm512_set1_pd(a[2*lda + k]);
+    c20 = _mm512_fmadd_pd(a_ik, b0, c20); c21 = _mm512_fmadd_pd(a_ik, b1, c21);
+    a_ik = _mm512_set1_pd(a[3*lda + k]);
+    c30 = _mm512_fmadd_pd(a_ik, b0, c30); c31 = _mm512_fmadd_pd(a_ik, b1, c31);
+  }
+  _mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), c00));
+  _mm512_storeu_pd(c+8, _mm512_add_pd(_mm512_loadu_pd(c+8), c01));
+  c += ldc;
+  _mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), c10));
+  _mm512_storeu_pd(c+8, _mm512_add_pd(_mm512_loadu_pd(c+8), c11));
+  c += ldc;
+  _mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), c20));
+  _mm512_storeu_pd(c+8, _mm512_add_pd(_mm512_loadu_pd(c+8), c21));
+  c += ldc;
+  _mm512_storeu_pd(c, _mm512_add_pd(_mm512_loadu_pd(c), c30));
+  _mm512_storeu_pd(c+8, _mm512_add_pd(_mm512_loadu_pd(c+8), c31));
+}
+#endif
+
+/**
+ * \struct Gemm_kernel
+ * \brief Micro-kernel function and its register tile size (mr x nr).
+ */
+template <typename T> struct Gemm_kernel
+{
+  typedef void (*function)( size_t, const T*, size_t, const T*, size_t, T*, size_t );
+  function micro;
+  size_t mr, nr;
+};
+
+/**
+ * Selects the micro-kernel for a data type. Generic types use the scalar 4x4 tile.
+ * @return Kernel to be used.
+ */
+template <typename T>
+    inline const Gemm_kernel<T>& gemm_select_kernel()
+{
+  static const Gemm_kernel<T> kernel = { &gemm_micro_scalar<T>, 4, 4 };
+  return kernel;
+}
+
+/**
+ * Checks the processor for the best double precision micro-kernel:
+ * AVX-512, then AVX2 with FMA, else the scalar one.
+ * @return Kernel to be used.
+ */
+inline Gemm_kernel<double> gemm_detect_kernel_double()
+{
+  Gemm_kernel<double> kernel = { &gemm_micro_scalar<double>, 4, 4 };
+#ifdef LMX_GEMM_X86
+  __builtin_cpu_init();
+  #ifdef LMX_GEMM_AVX512
+  if ( __builtin_cpu_supports("avx512f") ){
+    kernel.micro = &gemm_micro_avx512;
+    kernel.nr = 16;
+  }
+  else
+  #endif
+  if ( __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") ){
+    kernel.micro = &gemm_micro_avx2;
+    kernel.nr = 8;
+  }
+#endif
+  return kernel;
+}
+
+/**
+ * Selects the micro-kernel for double precision at the first call. The
+ * local static is initialized only once, even with concurrent calls.
+ * @return Kernel to be used.
+ */
+template <>
+    inline const Gemm_kernel<double>& gemm_select_kernel<double>()
+{
+  static const Gemm_kernel<double> kernel = gemm_detect_kernel_double();
+  return kernel;
+}
+
+/**
+ * Dense matrix-matrix product over contiguous row-major buffers.
+ * Calculates C = A*B, with A (m x k), B (k x n) and C (m x n).
+ * Element (i,j) of each matrix is found at ptr[i*ld + j].
+ * @param m Rows of A and C.
+ * @param n Columns of B and C.
+ * @param k Columns of A and rows of B.
+ * @param a Pointer to A(0,0).
+ * @param lda Leading dimension of A.
+ * @param b Pointer to B(0,0).
+ * @param ldb Leading dimension of B.
+ * @param c Pointer to C(0,0). Must not overlap with A or B.
+ * @param ldc Leading dimension of C.
+ */
+template <typename T>
+    void dense_gemm( size_t m, size_t n, size_t k,
+                     const T* a, size_t lda,
+                     const T* b, size_t ldb,
+                     T* c, size_t ldc )
+{
+  for (size_t i=0; i<m; ++i){
+    T* c_row = c + i*ldc;
+    for (size_t j=0; j<n; ++j) c_row[j] = T(0);
+  }
+  if (m == 0 || n == 0 || k == 0) return;
+
+  const Gemm_kernel<T>& kernel = gemm_select_kernel<T>();
+  const size_t mr = kernel.mr;
+  const size_t nr = kernel.nr;
+
+  for (size_t jc=0; jc<n; jc+=LMX_GEMM_NC){
+    const size_t jc_end = std::min(jc + LMX_GEMM_NC, n);
+    for (size_t pc=0; pc<k; pc+=LMX_GEMM_KC){
+      const size_t kc = std::min((size_t)LMX_GEMM_KC, k - pc);
+      for (size_t ic=0; ic<m; ic+=LMX_GEMM_MC){
+        const size_t ic_end = std::min(ic + LMX_GEMM_MC, m);
+        // Full register tiles:
+        size_t ir, jr;
+        for (ir=ic; ir + mr <= ic_end; ir+=mr){
+          for (jr=jc; jr + nr <= jc_end; jr+=nr){
+            kernel.micro( kc,
+                          a + ir*lda + pc, lda,
+                          b + pc*ldb + jr, ldb,
+                          c + ir*ldc + jr, ldc );
+          }
+          // Right edge:
+          if (jr < jc_end)
+            gemm_block_scalar( ir, ir+mr, jr, jc_end, pc, pc+kc,
+                               a, lda, b, ldb, c, ldc );
+        }
+        // Bottom edge:
+        if (ir < ic_end)
+          gemm_block_scalar( ir, ic_end, jc, jc_end, pc, pc+kc,
+                             a, lda, b, ldb, c, ldc );
+      }
+    }
+  }
+}
+
+} // namespace lmx
+
+#endif
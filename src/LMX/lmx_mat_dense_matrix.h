@@ -36,7 +36,7 @@
     
 namespace lmx {
 
-template <typename T> class Matrix;
+template <typename T, typename Storage> class Matrix;
 
     /**
     \class DenseMatrix
@@ -73,6 +73,22 @@ public:
 
   inline DenseMatrix& multElem ( const Matrix<T>&, const Matrix<T>&);
 
+  /** Raw data access.
+   *  Element (i,j) is stored in data_pointer()[i*getLeadingDim() + j].
+   *  \return Pointer to the first element of the contiguous row-major buffer. */
+  T* data_pointer()
+  { return static_cast<Type_dense<T>*>(this->type_matrix)->data_pointer(); }
+
+  /** Raw data access (read only).
+   *  \return Const pointer to the first element of the contiguous row-major buffer. */
+  const T* data_pointer() const
+  { return static_cast<const Type_dense<T>*>(this->type_matrix)->data_pointer(); }
+
+  /** Row stride of the buffer returned by data_pointer().
+   *  \return Number of elements between the start of two consecutive rows. */
+  size_type getLeadingDim() const
+  { return static_cast<const Type_dense<T>*>(this->type_matrix)->getLeadingDim(); }
+
       /** Overloaded operator for adding elements between a DenseMatrix and a Matrix object.
        *  */
   DenseMatrix operator + (const Matrix<T>& B) const
@@ -96,15 +112,7 @@ public:
   DenseMatrix<T> operator * (const Matrix<T>& B) const
   {
     DenseMatrix<T> res( this->mrows, B.cols() );
-//       res.mult(*this, B);
-    for (size_type i=0; i<this->mrows; ++i){
-      for (size_type j=0; j<this->ncolumns; ++j){
-        for (size_type k=0; k < this->ncolumns; ++k){
-//             cout << "k = " << k << ", res(i,j) = " << res.readElement(i,j) << ", A(i,k) = " << this->readElement(i,k) << ", B(k,j) = " << B.readElement(k,j) << endl;
-          res.writeElement(res.readElement(i,j) + this->readElement(i,k) * B.readElement(k,j), i, j);
-        }
-      }
-    }
+    res.mult(*this, B);
     return res;
   }
 
@@ -120,7 +128,7 @@ namespace lmx {
    *  */
 template <typename T>
 DenseMatrix<T>::DenseMatrix()
-  : Matrix<T>(0)
+  : Matrix<T>(4)
 {
 }
 
@@ -129,7 +137,7 @@ DenseMatrix<T>::DenseMatrix()
    *  \param columns Number of columns in DenseMatrix. */
 template <typename T>
 DenseMatrix<T>::DenseMatrix(size_type rows, size_type columns)
- : Matrix<T>(rows, columns, 0)
+ : Matrix<T>(rows, columns, 4)
 {
 }
 
@@ -138,7 +146,7 @@ DenseMatrix<T>::DenseMatrix(size_type rows, size_type columns)
    *  */
 template <typename T>
 DenseMatrix<T>::DenseMatrix(const DenseMatrix& A) :
- Matrix<T>(0)
+ Matrix<T>(4)
 { this->mrows = A.rows();
   this->ncolumns = A.cols();
   this->type_matrix->resize(this->mrows, this->ncolumns);
@@ -164,12 +172,8 @@ template <typename T>
 {
   this->mrows = A.rows();
   this->ncolumns = A.cols();
-  for (size_type i=0; i<this->mrows; ++i){
-    for (size_type j=0; j<this->mrows; ++j){
-      this->writeElement(A.readElement(i,j), i, j);
-    }
-  }
-    
+  this->type_matrix->equals(A.type_matrix);
+  return *this;
 }
 
 /** Overload operator for negation.
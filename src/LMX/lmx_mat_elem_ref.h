@@ -154,7 +154,7 @@ template <typename T> inline
 template <typename T> inline
     T Elem_ref<T>::operator += (T data_in)
 {
-  type->writeElement( type->readElement(i,j) + data_in, i, j );
+  type->addElement( data_in, i, j );
   return type->readElement(i,j);
 }
 
@@ -166,7 +166,7 @@ template <typename T> inline
 template <typename T> inline
     T Elem_ref<T>::operator -= (T data_in)
 {
-  type->writeElement( type->readElement(i,j) - data_in, i, j );
+  type->addElement( -data_in, i, j );
   return type->readElement(i,j);
 }
 
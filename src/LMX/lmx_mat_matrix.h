@@ -27,7 +27,11 @@
 
 #include"lmx_except.h"
 #include"lmx_mat_type_stdmatrix.h"
+#include"lmx_mat_type_dense.h"
 #include"lmx_mat_type_csc.h"
+#include"lmx_mat_type_csr.h"
+#include"lmx_mat_type_csc_sym.h"
+#include"lmx_mat_type_bsr.h"
 
 #ifdef HAVE_GMM
 #include"lmx_mat_type_gmm_sparse1.h"
@@ -53,8 +57,13 @@ namespace cofe{
 namespace lmx {
 /// \endcond
 
-template <typename T> class Vector;
+template <typename T, typename Storage> class Vector;
 template <typename T> class LinearSystem;
+template <typename T> class Gesv;
+template <typename T> class Cg;
+template <typename T> class JacobiPrecond;
+template <typename T> class SparsePrecond;
+template <typename T> class Ldlt;
 class LMXTester;
 
 int setMatrixType(int);
@@ -76,7 +85,7 @@ template <typename C>
 
     @author Daniel Iglesias Ib��ez.
     */
-template <typename T> class Matrix{
+template <typename T> class Matrix<T, Data_mat<T> >{
 protected:
 
   size_type mrows,    /**< Number of rows in matrix object. */ 
@@ -92,6 +101,11 @@ public:
   friend class Vector<T>;
   friend class DenseMatrix<T>;
   friend class LinearSystem<T>;
+  friend class Gesv<T>;
+  friend class Cg<T>;
+  friend class JacobiPrecond<T>;
+  friend class SparsePrecond<T>;
+  friend class Ldlt<T>;
   friend class LMXTester;
 
 public:
@@ -134,6 +148,10 @@ public:
 
   void sparsePattern( std::vector<size_type>& , std::vector<size_type>& );
 
+  void beginAssembly();
+
+  void endAssembly();
+
   inline Elem_ref<T> operator () (size_type, size_type);
 
   inline Matrix& operator = (const Matrix&);
@@ -188,6 +206,39 @@ public:
 
   inline Matrix& multElem(const DenseMatrix<T>&, const DenseMatrix<T>&);
 
+  inline Matrix& axpy(const T&, const Matrix&);
+
+  void gather(T*, const size_type*, size_type, const size_type*, size_type) const;
+
+  void scatterAdd(const T*, const size_type*, size_type, const size_type*, size_type);
+
+  void getDiagonal(Vector<T>&) const;
+
+  /** Raw data access.
+   *  Element (i,j) is stored in data_pointer()[i*getLeadingDim() + j].
+   *  \return Pointer to the first element if the container is contiguous (Type_dense), 0 otherwise. */
+  T* data_pointer()
+  {
+    Type_dense<T>* dense = dynamic_cast<Type_dense<T>*>(this->type_matrix);
+    return dense ? dense->data_pointer() : 0;
+  }
+
+  /** Raw data access (read only).
+   *  \return Const pointer to the first element, or 0 (see data_pointer()). */
+  const T* data_pointer() const
+  {
+    const Type_dense<T>* dense = dynamic_cast<const Type_dense<T>*>(this->type_matrix);
+    return dense ? dense->data_pointer() : 0;
+  }
+
+  /** Row stride of the buffer returned by data_pointer().
+   *  \return Number of elements between the start of two consecutive rows, 0 if the container is not contiguous. */
+  size_type getLeadingDim() const
+  {
+    const Type_dense<T>* dense = dynamic_cast<const Type_dense<T>*>(this->type_matrix);
+    return dense ? dense->getLeadingDim() : 0;
+  }
+
   /** Function that returns the value in specified position of Matrix object.
    *  */
     inline
@@ -290,14 +341,7 @@ public:
     Matrix<T> operator * (const DenseMatrix<T>& B) const
     {
       Matrix<T> res( this->mrows, B.cols() );
-//       res.mult(*this, B);
-      for (size_type i=0; i<mrows; ++i){
-        for (size_type j=0; j<ncolumns; ++j){
-          for (size_type k=0; k < this->ncolumns; ++k){
-            res.writeElement(res.readElement(i,j) + this->readElement(i,k) * B.readElement(k,j), i, j);
-          }
-        }
-      }
+      res.mult(*this, B);
       return res;
     }
 
@@ -492,6 +536,30 @@ template <typename T> inline
 #endif
     break;
 
+    case 4 :
+      type_matrix = new Type_dense< T >;
+    break;
+
+    case 5 :
+      type_matrix = new Type_csr< T >;
+    break;
+
+    case 6 :
+      type_matrix = new Type_csc_sym< T >;
+    break;
+
+    case 7 :
+      type_matrix = new Type_bsr< T, 2 >;
+    break;
+
+    case 8 :
+      type_matrix = new Type_bsr< T, 3 >;
+    break;
+
+    case 9 :
+      type_matrix = new Type_bsr< T, 6 >;
+    break;
+
   }
 
   reference = new Elem_ref<T>(type_matrix);
@@ -602,6 +670,143 @@ template <typename T>
   this->type_matrix->setSparsePattern( row_index, col_index );
 }
 
+/**
+ * \brief Starts a staged assembly of the matrix.
+ * Sparse types keep the elements written to new positions apart and insert
+ * them all at once in endAssembly(), instead of shifting the storage on every
+ * insertion. Writes to existing positions go directly to the storage.
+ * Elements added between both calls are not readable until endAssembly() is called.
+ * Does nothing in the rest of matrix types.
+ */
+template <typename T>
+    void Matrix<T>::beginAssembly()
+{
+  this->type_matrix->beginAssembly();
+}
+
+/**
+ * \brief Ends a staged assembly started with beginAssembly().
+ * Inserts the pending elements in the sparse storage, adding up repeated positions.
+ */
+template <typename T>
+    void Matrix<T>::endAssembly()
+{
+  this->type_matrix->endAssembly();
+}
+
+/**
+ * Scaled addition, Y += alpha*X, where Y is the object.
+ * Runs over the raw storage when both matrices are contiguous (Type_dense).
+ * @param alpha Scaling factor.
+ * @param X Matrix to scale and add.
+ * @return Reference to result.
+ */
+template <typename T>
+    inline
+    Matrix<T>& Matrix<T>::axpy(const T& alpha, const Matrix<T>& X)
+{
+  if (mrows != X.mrows || ncolumns != X.ncolumns){
+    std::stringstream message;
+    message << "Trying to add matrices of different dimensions: (" << mrows << "," << ncolumns << ") += alpha*(" << X.mrows << "," << X.ncolumns << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  T* py = this->data_pointer();
+  const T* px = X.data_pointer();
+  if ( py && px ){
+    const size_type ldy = this->getLeadingDim();
+    const size_type ldx = X.getLeadingDim();
+    for (size_type i=0; i<mrows; ++i){
+      T* row_y = py + i*ldy;
+      const T* row_x = px + i*ldx;
+      for (size_type j=0; j<ncolumns; ++j) row_y[j] += alpha * row_x[j];
+    }
+  }
+  else{
+    Matrix<T> scaled( X );
+    scaled.type_matrix->multiplyScalar( alpha );
+    this->type_matrix->add( scaled.type_matrix );
+  }
+  return *this;
+}
+
+/**
+ * Reads a block of elements.
+ * values[k*n+l] = A(rows[k], cols[l]), k = 0..m-1, l = 0..n-1.
+ * @param values Array of (at least) m*n elements, filled in row-major order.
+ * @param rows Row positions.
+ * @param m Number of rows.
+ * @param cols Column positions.
+ * @param n Number of columns.
+ */
+template <typename T>
+    void Matrix<T>::gather( T* values,
+                            const size_type* rows, size_type m,
+                            const size_type* cols, size_type n ) const
+{
+  const T* a = this->data_pointer();
+  if ( a ){
+    const size_type ld = this->getLeadingDim();
+    for (size_type k=0; k<m; ++k){
+      const T* row_k = a + rows[k]*ld;
+      for (size_type l=0; l<n; ++l) values[k*n+l] = row_k[ cols[l] ];
+    }
+  }
+  else{
+    for (size_type k=0; k<m; ++k)
+      for (size_type l=0; l<n; ++l)
+        values[k*n+l] = this->type_matrix->readElement( rows[k], cols[l] );
+  }
+}
+
+/**
+ * Adds a block of elements, as in the assembly of element matrices.
+ * A(rows[k], cols[l]) += values[k*n+l], k = 0..m-1, l = 0..n-1.
+ * Sparse types accumulate with addElement(), so the block can be added
+ * inside a staged assembly (see beginAssembly()).
+ * @param values Array of m*n values in row-major order.
+ * @param rows Row positions.
+ * @param m Number of rows.
+ * @param cols Column positions.
+ * @param n Number of columns.
+ */
+template <typename T>
+    void Matrix<T>::scatterAdd( const T* values,
+                                const size_type* rows, size_type m,
+                                const size_type* cols, size_type n )
+{
+  T* a = this->data_pointer();
+  if ( a ){
+    const size_type ld = this->getLeadingDim();
+    for (size_type k=0; k<m; ++k){
+      T* row_k = a + rows[k]*ld;
+      for (size_type l=0; l<n; ++l) row_k[ cols[l] ] += values[k*n+l];
+    }
+  }
+  else{
+    for (size_type k=0; k<m; ++k)
+      for (size_type l=0; l<n; ++l)
+        this->type_matrix->addElement( values[k*n+l], rows[k], cols[l] );
+  }
+}
+
+/**
+ * Copies the diagonal of the Matrix in a Vector.
+ * @param diag Vector resized to min(rows, cols) that receives the diagonal.
+ */
+template <typename T>
+    void Matrix<T>::getDiagonal( Vector<T>& diag ) const
+{
+  const size_type n = std::min( mrows, ncolumns );
+  if ( diag.size() != n ) diag.resize( n );
+  T* d = diag.data_pointer();
+  if ( d ){
+    for (size_type i=0; i<n; ++i) d[i] = this->type_matrix->readElement(i,i);
+  }
+  else{
+    for (size_type i=0; i<n; ++i) diag.writeElement( this->type_matrix->readElement(i,i), i );
+  }
+}
+
 /** Overloaded operator for extracting elements from the Matrix object.
  *  \param m Row position of element.
  *  \param n Column position of element.
@@ -678,13 +883,19 @@ template <typename T>
 //       ;
 //       break;
     case 1 :
-      copy<T>( static_cast<const Type_stdmatrix<T>*>(A.type_matrix),
+      this->type_matrix->resize(mrows, ncolumns);
+      copy<T>( static_cast<const Type_dense<T>*>(A.type_matrix),
                static_cast<Type_csc<T>*>(this->type_matrix) );
       break;
 
+    case 4 :
+      this->type_matrix->equals(A.type_matrix);
+      break;
+
     default :
+      this->type_matrix->resize(mrows, ncolumns);
       for (size_type i=0; i<mrows; ++i){
-        for (size_type j=0; j<mrows; ++j){
+        for (size_type j=0; j<ncolumns; ++j){
           this->writeElement(A.readElement(i,j), i, j);
         }
       }
@@ -0,0 +1,913 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+#ifndef LMXSTATIC_H
+#define LMXSTATIC_H
+
+#include"lmx_mat_dense_matrix.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_static.h
+
+      \brief This file contains the Matrix and Vector classes with a container type fixed at compile time.
+
+      Matrix<T, Storage> and Vector<T, Storage> own a Storage object instead of a pointer to a Data_mat or Data_vec selected with setMatrixType() and setVectorType(). Every call to the container is made on its concrete type, so the compiler can inline readElement(), writeElement(), add(), multiplyScalar()... and different storage types can be used in the same program. Example:
+
+      \code
+      Matrix< double, Type_csr<double> > A(n,n);
+      Vector< double, Type_stdVector<double> > x(n), y(n);
+      y.mult(A,x);
+      \endcode
+
+      Matrix<T> and Vector<T> (i.e. Storage = Data_mat<T>, Data_vec<T>) are still the run-time selected classes, and the only ones used by LinearSystem and the other solvers.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx {
+
+/**
+ * Contiguous storage of a vector container.
+ * \return 0, the container does not store its elements in a plain array.
+ */
+template <typename T, typename Storage>
+    inline T* contiguous_data( Storage& )
+{ return 0; }
+
+/**
+ * Contiguous storage of a vector container, specialized for Type_stdVector.
+ * \return Pointer to the first element, 0 if the vector is empty.
+ */
+template <typename T>
+    inline T* contiguous_data( Type_stdVector<T>& vector_in )
+{
+  std::vector<T>& contents = *vector_in.data_pointer();
+  return contents.empty() ? 0 : &contents[0];
+}
+
+
+    /**
+    \class Matrix
+    \brief Template class Matrix with static container type.
+
+    Same interface as the run-time selected Matrix<T> for element access and matrix algebra. The container is a member of type Storage, which must derive from Data_mat<T> (Type_stdmatrix, Type_dense, Type_csc, Type_csr, Type_csc_sym, Type_bsr...).
+
+    @param mrows The number of rows of the Data Container.
+    @param ncolumns The number of columns of the Data Container.
+    @param type_matrix The matrix data container.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <typename T, typename Storage> class Matrix{
+private:
+  size_type mrows,    /**< Number of rows in matrix object. */
+        ncolumns; /**< Number of colums in matrix object. */
+  Storage type_matrix; /**< Container. */
+
+public:
+  template <typename C, typename S> friend class Vector;
+  template <typename C, typename S> friend class Matrix;
+
+public:
+  /** Empty constructor.
+   *  */
+  Matrix() : mrows(0), ncolumns(0)
+  {}
+
+  /** Standard constructor.
+   *  \param rows Number of rows in Matrix.
+   *  \param columns Number of columns in Matrix. */
+  Matrix(size_type rows, size_type columns) : mrows(rows), ncolumns(columns)
+  { type_matrix.resize(mrows, ncolumns); }
+
+  /** Copy constructor.
+   *  \param A Matrix to copy from.
+   *  */
+  Matrix(const Matrix& A) : mrows(A.mrows), ncolumns(A.ncolumns)
+  {
+    type_matrix.resize(mrows, ncolumns);
+    type_matrix.equals(&A.type_matrix);
+  }
+
+  /**
+   * Read number of rows.
+   * @return Number of rows of matrix.
+   */
+  inline size_type rows() const { return this->mrows; }
+
+  /**
+   * Read number of cols.
+   * @return Number of cols of matrix.
+   */
+  inline size_type cols() const { return this->ncolumns; }
+
+  void fillIdentity(T factor = static_cast<T>(1));
+
+  void fillRandom(T factor = static_cast<T>(1));
+
+  /**
+   * \brief Function for preparing a sparse non-zero pattern in matrix.
+   * See Matrix<T>::sparsePattern().
+   */
+  void sparsePattern( std::vector<size_type>& row_index, std::vector<size_type>& col_index )
+  { this->type_matrix.setSparsePattern( row_index, col_index ); }
+
+  /** Starts a staged assembly of the matrix. See Matrix<T>::beginAssembly().
+   *  */
+  void beginAssembly()
+  { this->type_matrix.beginAssembly(); }
+
+  /** Ends a staged assembly started with beginAssembly().
+   *  */
+  void endAssembly()
+  { this->type_matrix.endAssembly(); }
+
+  inline Elem_ref<T> operator () (size_type, size_type);
+
+  inline Matrix& operator = (const Matrix&);
+
+  template <typename S> inline Matrix& operator = (const Matrix<T,S>&);
+
+  inline Matrix& operator += (const Matrix&);
+
+  inline Matrix& operator -= (const Matrix&);
+
+  inline Matrix& operator *= (T);
+
+  inline Matrix& operator /= (T);
+
+  inline Matrix& mult(const Matrix& A, const Matrix& B);
+
+  void gather(T*, const size_type*, size_type, const size_type*, size_type) const;
+
+  void scatterAdd(const T*, const size_type*, size_type, const size_type*, size_type);
+
+  template <typename S> void getDiagonal(Vector<T,S>&) const;
+
+  /** Function that returns the value in specified position of Matrix object.
+   *  */
+  inline
+      const T& readElement(size_type m, size_type n) const
+  { return this->type_matrix.readElement(m,n); }
+
+  /** Function writes the value in specified position of Matrix object.
+   *  */
+  inline
+      void writeElement(T theValue, size_type m, size_type n)
+  { this->type_matrix.writeElement(theValue, m, n); }
+
+  /** Function adds the value to the specified position of Matrix object.
+   *  */
+  inline
+      void addElement(T theValue, size_type m, size_type n)
+  { this->type_matrix.addElement(theValue, m, n); }
+
+  /** Cleans all numbers below given factor.
+   *  */
+  inline
+      void clean(T factor)
+  { this->type_matrix.cleanBelow(factor); }
+
+  /** Resize the Matrix with given size parameters.
+   *  \param i Rows.
+   *  \param j Columns.
+   *  */
+  inline
+      void resize(size_type i, size_type j)
+  { mrows = i;
+    ncolumns = j;
+    type_matrix.resize(mrows, ncolumns);
+  }
+
+  /**
+   * Function to transpose a matrix.
+   */
+  inline
+      Matrix& transpose()
+  {
+    this->type_matrix.trn();
+    mrows = this->type_matrix.getRows();
+    ncolumns = this->type_matrix.getCols();
+    return *this;
+  }
+
+  /** Retuns 1 if the element exists inside the storing structure
+   * and 0 if it does not.
+   *  */
+  inline bool exists( size_type row, size_type col )
+  { return this->type_matrix.exists(row, col); }
+
+};
+
+
+    /**
+    \class Vector
+    \brief Template class Vector with static container type.
+
+    Same interface as the run-time selected Vector<T> for element access and vector algebra, including the expressions of lmx_mat_vector_expr.h. The container is a member of type Storage, which must derive from Data_vec<T> (Type_stdVector...).
+
+    \param elements The size of the Data Container.
+    \param type_vector The vector data container.
+    \param reference An Elem_ref object for r/w data access.
+
+    \author Daniel Iglesias Ib��ez.
+    */
+template <typename T, typename Storage> class Vector{
+private:
+  size_type elements;    /**< Number of rows in vector object. */
+  Storage type_vector; /**< Container. */
+  Elem_ref<T> reference; /**< Reference to an element in type_vector. */
+
+  /** Contiguous storage of the elements (see contiguous_data()).
+   *  */
+  T* storage() const
+  { return contiguous_data<T>( const_cast<Storage&>(this->type_vector) ); }
+
+public:
+  friend class VectorLeaf<T,Storage>;
+
+public:
+  /** Empty constructor.
+   *  */
+  Vector() : elements(0), reference(&type_vector)
+  {}
+
+  /** Standard constructor.
+   *  \param rows Number of Vector's rows.
+   *  */
+  explicit Vector(size_type rows) : elements(rows), reference(&type_vector)
+  { type_vector.resize(elements, 1); }
+
+  /** Copy constructor.
+   *  \param A Vector to copy from.
+   *  */
+  Vector(const Vector& A) : elements(A.elements), reference(&type_vector)
+  {
+    type_vector.resize(elements, 1);
+    type_vector.equals(&A.type_vector);
+  }
+
+  /** Constructor from an expression.
+   *  \param expr Expression to evaluate.
+   *  */
+  template <typename E> Vector(const VectorExpr<T,E>& expr)
+    : elements(expr.size()), reference(&type_vector)
+  {
+    type_vector.resize(elements, 1);
+    *this = expr;
+  }
+
+  /**
+   * Read number of rows.
+   * \return Dimension of vector.
+   */
+  inline size_type size() const { return this->elements; }
+
+  void fillIdentity(T factor = static_cast<T>(1));
+
+  void fillRandom(T factor = static_cast<T>(1));
+
+  inline Elem_ref<T>& operator () (size_type);
+
+  inline Vector& operator = (const Vector&);
+
+  template <typename E> inline Vector& operator = (const VectorExpr<T,E>&);
+
+  inline Vector& operator += (const Vector&);
+
+  template <typename E> inline Vector& operator += (const VectorExpr<T,E>&);
+
+  inline Vector& operator -= (const Vector&);
+
+  template <typename E> inline Vector& operator -= (const VectorExpr<T,E>&);
+
+  inline Vector& operator *= (const T&);
+
+  template <typename S> inline Vector& mult(const Matrix<T,S>&, const Vector&);
+
+  inline T norm1 () const;
+
+  inline T norm2 () const;
+
+  inline Vector& axpy(const T&, const Vector&);
+
+  void gather(T*, const size_type*, size_type) const;
+
+  void scatter(const T*, const size_type*, size_type);
+
+  void scatterAdd(const T*, const size_type*, size_type);
+
+  /** Raw data access.
+   * \return Pointer to the first element if the elements are stored
+   * contiguously (Type_stdVector), 0 otherwise.
+   *  */
+  T* data_pointer()
+  { return this->storage(); }
+
+  /** Raw data access (read only).
+   * \return Const pointer to the first element, or 0 (see data_pointer()).
+   *  */
+  const T* data_pointer() const
+  { return this->storage(); }
+
+  /** Function for reading a Vector object's element from it's known position.
+   * \param m vec's position (row) for lookup.
+   * \return The element.
+   *  */
+  inline
+      const T& readElement(size_type m) const
+  { return type_vector.readElement(m,0); }
+
+  /** Function writes the value in specified position of Vector object.
+   *  */
+  inline
+      void writeElement(T theValue, size_type m)
+  { this->type_vector.writeElement(theValue, m, 0); }
+
+  /** Cleans all numbers below given factor.
+   *  */
+  void clean(double factor)
+  { this->type_vector.cleanBelow(factor); }
+
+  /** Resize the Vector with given size parameter.
+   *  \param i New size.
+   *  */
+  void resize(size_type i)
+  {
+    this->elements = i;
+    this->type_vector.resize(this->elements, 1);
+  }
+
+  /** Operator for scalar product of two Vector objects.
+   * \param B Vector reference for second LHS term.
+   * \return The numeric result of the operation.
+   *  */
+  T operator * (const Vector& B) const
+  {
+    if ( elements != B.size() )
+      LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+
+    return VectorLeaf<T,Storage>(*this) * VectorLeaf<T,Storage>(B);
+  }
+
+};
+
+}; // namespace lmx
+
+/////////////////////////////// Implementation of the methods defined previously
+
+namespace lmx {
+
+/**
+ * Cleans matrix and sets diagonal terms to specified value. Matrix must be square.
+ * @param factor Value of diagonal terms. Default is one.
+ */
+template <typename T, typename Storage>
+    void Matrix<T,Storage>::fillIdentity( T factor )
+{
+  if (this->ncolumns != this->mrows){
+    std::stringstream message;
+    message << "Trying to make identity a non-squared matrix.\nSize of matrix(" << this->mrows << ", " << this->ncolumns << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  for (size_type i=0; i<this->mrows; ++i){
+    for (size_type j=0; j<this->ncolumns; ++j){
+      this->type_matrix.writeElement(static_cast<T>(0),i,j);
+    }
+  }
+  for (size_type i=0; i<this->mrows; ++i)
+    this->type_matrix.writeElement(factor,i,i);
+}
+
+/**
+ * Function for filling a matrix with random numbers
+ * @param factor Scales the random numbers (default value is unity).
+ */
+template <typename T, typename Storage>
+    void Matrix<T,Storage>::fillRandom( T factor )
+{
+  for (size_type i=0; i<this->mrows; ++i){
+    for (size_type j=0; j<this->ncolumns; ++j){
+      this->type_matrix.writeElement( factor * static_cast<T>( std::rand() ) / static_cast<T>(RAND_MAX),i,j);
+    }
+  }
+}
+
+/** Overloaded operator for extracting elements from the Matrix object.
+ *  \param m Row position of element.
+ *  \param n Column position of element.
+ */
+template <typename T, typename Storage>
+    inline
+    Elem_ref<T> Matrix<T,Storage>::operator () (size_type m, size_type n)
+{
+  if (m >= this->mrows || n >= this->ncolumns){
+    std::stringstream message;
+    message << "Index exceeds matrix dimensions. Trying to access element (" << m << ", " << n << ") of matrix with dimension " << this->mrows << "x" << this->ncolumns << "." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  Elem_ref<T> reference(&this->type_matrix);
+  reference.write_pos(m,n);
+  return reference;
+}
+
+/** Overloaded operator for equaling every element between two
+ *  Matrix objects of the same type.
+ *  \param A Matrix to be equal to.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator = (const Matrix& A)
+{
+  mrows = A.mrows;
+  ncolumns = A.ncolumns;
+  type_matrix.resize(mrows, ncolumns);
+  type_matrix.equals(&A.type_matrix);
+  return *this;
+}
+
+/** Overloaded operator for equaling every element between two
+ *  Matrix objects of different storage types.
+ *  \param A Matrix to be equal to.
+ */
+template <typename T, typename Storage>
+    template <typename S>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator = (const Matrix<T,S>& A)
+{
+  this->resize( A.rows(), A.cols() );
+  for (size_type i=0; i<mrows; ++i){
+    for (size_type j=0; j<ncolumns; ++j){
+      if ( A.readElement(i,j) != static_cast<T>(0) )
+        this->type_matrix.writeElement( A.readElement(i,j), i, j );
+    }
+  }
+  return *this;
+}
+
+/** Overloaded operator for adding elements between two Matrix objects.
+ *  \param A Matrix to add.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator += (const Matrix& A)
+{
+  if (mrows != A.mrows || ncolumns != A.ncolumns){
+    std::stringstream message;
+    message << "Trying to add matrices of different dimensions: (" << mrows << "," << ncolumns << ") += (" << A.mrows << "," << A.ncolumns << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  type_matrix.add(&A.type_matrix);
+  return *this;
+}
+
+/** Overloaded operator for substracting elements between two Matrix objects.
+ *  \param A Matrix to substract.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator -= (const Matrix& A)
+{
+  if (mrows != A.mrows || ncolumns != A.ncolumns){
+    std::stringstream message;
+    message << "Trying to substract matrices of different dimensions: (" << mrows << "," << ncolumns << ") -= (" << A.mrows << "," << A.ncolumns << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  type_matrix.substract(&A.type_matrix);
+  return *this;
+}
+
+/** Overloaded operator for scaling the Matrix.
+ *  \param scalar Scaling factor.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator *= (T scalar)
+{
+  type_matrix.multiplyScalar(scalar);
+  return *this;
+}
+
+/** Overloaded operator for dividing the Matrix by a scalar.
+ *  \param scalar Dividing factor.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::operator /= (T scalar)
+{
+  type_matrix.multiplyScalar( static_cast<T>(1) / scalar );
+  return *this;
+}
+
+/** Function for multiplying two Matrix objects, C = A*B.
+ *  Uses the mat_mat_mult() kernel of the storage type, if any.
+ *  \param A First term.
+ *  \param B Second term.
+ */
+template <typename T, typename Storage>
+    inline
+    Matrix<T,Storage>& Matrix<T,Storage>::mult(const Matrix& A, const Matrix& B)
+{
+  if ( A.ncolumns != B.mrows ){
+    std::stringstream message;
+    message << "Matrix dimensions mismatch in multiplication: (" << A.mrows << "," << A.ncolumns
+        << ") * (" << B.mrows << "," << B.ncolumns << ")." << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  this->resize( A.mrows, B.ncolumns );
+  mat_mat_mult( &A.type_matrix, &B.type_matrix, &this->type_matrix );
+  return *this;
+}
+
+/**
+ * Reads a block of elements.
+ * values[k*n+l] = A(rows[k], cols[l]), k = 0..m-1, l = 0..n-1.
+ * See Matrix<T>::gather().
+ */
+template <typename T, typename Storage>
+    void Matrix<T,Storage>::gather( T* values,
+                                    const size_type* rows, size_type m,
+                                    const size_type* cols, size_type n ) const
+{
+  for (size_type k=0; k<m; ++k)
+    for (size_type l=0; l<n; ++l)
+      values[k*n+l] = this->type_matrix.readElement( rows[k], cols[l] );
+}
+
+/**
+ * Adds a block of elements, as in the assembly of element matrices.
+ * A(rows[k], cols[l]) += values[k*n+l], k = 0..m-1, l = 0..n-1.
+ * See Matrix<T>::scatterAdd().
+ */
+template <typename T, typename Storage>
+    void Matrix<T,Storage>::scatterAdd( const T* values,
+                                        const size_type* rows, size_type m,
+                                        const size_type* cols, size_type n )
+{
+  for (size_type k=0; k<m; ++k)
+    for (size_type l=0; l<n; ++l)
+      this->type_matrix.addElement( values[k*n+l], rows[k], cols[l] );
+}
+
+/**
+ * Copies the diagonal of the Matrix in a Vector.
+ * @param diag Vector resized to min(rows, cols) that receives the diagonal.
+ */
+template <typename T, typename Storage>
+    template <typename S>
+    void Matrix<T,Storage>::getDiagonal( Vector<T,S>& diag ) const
+{
+  const size_type n = std::min( mrows, ncolumns );
+  if ( diag.size() != n ) diag.resize( n );
+  for (size_type i=0; i<n; ++i)
+    diag.writeElement( this->type_matrix.readElement(i,i), i );
+}
+
+
+/**
+ * Cleans vector and sets all terms to specified value.
+ * \param factor Value of terms. Default is unit value.
+ */
+template <typename T, typename Storage>
+    void Vector<T,Storage>::fillIdentity( T factor )
+{
+  for (size_type i=0; i<this->elements; ++i)
+    this->type_vector.writeElement(factor,i,0);
+}
+
+/**
+ * Function for filling a vector with random numbers
+ * \param factor Scales the random numbers (default value is unity).
+ */
+template <typename T, typename Storage>
+    void Vector<T,Storage>::fillRandom( T factor )
+{
+  for (size_type i=0; i<this->elements; ++i)
+    this->type_vector.writeElement( factor * static_cast<T>( std::rand() ) / static_cast<T>(RAND_MAX),i,0);
+}
+
+/**
+ * Overload of element extraction method.
+ * \param row Position in Vector for the element to extract.
+ * \return element referenced.
+ */
+template <typename T, typename Storage>
+    inline
+    Elem_ref<T>& Vector<T,Storage>::operator () (size_type row)
+{
+  if ( row >= this->elements ){
+    std::stringstream message;
+    message << "Row index exceeds vector dimensions. \n"
+        << "Index: (" << row << ")" << endl
+        << "Vector dimension: (" << this->elements << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  reference.write_pos(row,0);
+  return reference;
+}
+
+/** Overload of equals operator.
+ * \param v Vector to equal to.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator = (const Vector& v)
+{
+  if ( this->elements != v.size() ){
+    std::stringstream message;
+    message << "Vectors dimensions mismatch. \n"
+        << "LHS vector dimension: (" << this->elements << ")" << endl
+        << "RHS vector dimension: (" << v.size() << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  type_vector.equals(&v.type_vector);
+  return *this;
+}
+
+/** Overload of equals operator for expressions.
+ * Evaluates the expression element by element in a single loop.
+ * \param expr Expression to equal to.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    template <typename E>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator = (const VectorExpr<T,E>& expr)
+{
+  if ( this->elements != expr.size() ){
+    std::stringstream message;
+    message << "Vectors dimensions mismatch. \n"
+        << "LHS vector dimension: (" << this->elements << ")" << endl
+        << "RHS vector dimension: (" << expr.size() << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  const E& e = expr.self();
+  T* y = this->storage();
+  if ( y ){
+    for (size_type i=0; i<this->elements; ++i) y[i] = e[i];
+  }
+  else{
+    for (size_type i=0; i<this->elements; ++i) this->writeElement( e[i], i );
+  }
+  return *this;
+}
+
+/** Overloaded operator for adding a Vector.
+ * \param b Vector to add.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator += (const Vector& b)
+{
+  if ( this->elements != b.size() )
+    LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  type_vector.add(&b.type_vector);
+  return *this;
+}
+
+/** Overloaded operator for adding an expression to the Vector.
+ * \param expr Expression to add.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    template <typename E>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator += (const VectorExpr<T,E>& expr)
+{
+  return *this = *this + expr;
+}
+
+/** Overloaded operator for substracting a Vector.
+ * \param b Vector to substract.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator -= (const Vector& b)
+{
+  if ( this->elements != b.size() )
+    LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  type_vector.substract(&b.type_vector);
+  return *this;
+}
+
+/** Overloaded operator for substracting an expression to the Vector.
+ * \param expr Expression to substract.
+ * \return A reference to the Vector object.
+ */
+template <typename T, typename Storage>
+    template <typename E>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator -= (const VectorExpr<T,E>& expr)
+{
+  return *this = *this - expr;
+}
+
+/**
+ * Scaling operator.
+ * \param scalar Scaling factor.
+ * \return Reference to result.
+ */
+template <typename T, typename Storage>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::operator *= (const T& scalar)
+{
+  type_vector.multiplyScalar(scalar);
+  return *this;
+}
+
+/**
+ * Function for multiplying Matrix and Vector objects, c = A*b.
+ *
+ * The mat_vec_mult() kernel is chosen at compile time from the storage
+ * types; combinations without a specialized kernel use the generic one.
+ *
+ * \param A Matrix reference for first LHS term.
+ * \param b Const Vector reference for second LHS term.
+ */
+template <typename T, typename Storage>
+    template <typename S>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::mult(const Matrix<T,S>& A, const Vector& b)
+{
+  if ( A.cols() != b.size() ){
+    std::stringstream message;
+    message << "Can't multiply matrix * vector: Dimensions mismatch. \n"
+        << "Matrix dimension: (" << A.rows() << "," << A.cols() << ")" << endl
+        << "Vector dimension: (" << b.size() << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  if ( &b == this )
+    LMX_THROW(failure_error, "Trying to multiply and save results on same data at the same time." );
+
+  if( elements != A.rows() ) resize( A.rows() );
+
+  mat_vec_mult( &A.type_matrix, &b.type_vector, &this->type_vector );
+  return *this;
+}
+
+/**
+ * Computes the first norm of the Vector.
+ * \return The first norm of object.
+ */
+template <typename T, typename Storage>
+    inline
+    T Vector<T,Storage>::norm1 () const
+{
+  T norm = 0;
+  for (size_type i=0; i<elements; ++i)
+    norm += std::abs(type_vector.readElement(i,0));
+  return norm;
+}
+
+/** Computes de second (euclidean) norm of the Vector.
+  * \return The second (euclidean) norm of object.*/
+template <typename T, typename Storage>
+    inline
+    T Vector<T,Storage>::norm2 () const
+{
+  return std::sqrt( (*this) * (*this) );
+}
+
+/**
+ * Scaled addition, y += alpha*x, where y is the object.
+ * \param alpha Scaling factor.
+ * \param x Vector to scale and add.
+ * \return Reference to result.
+ */
+template <typename T, typename Storage>
+    inline
+    Vector<T,Storage>& Vector<T,Storage>::axpy(const T& alpha, const Vector& x)
+{
+  if ( this->elements != x.size() )
+    LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  T* py = this->storage();
+  const T* px = x.storage();
+  if ( py && px ){
+    for (size_type i=0; i<this->elements; ++i) py[i] += alpha * px[i];
+  }
+  else{
+    for (size_type i=0; i<this->elements; ++i)
+      this->type_vector.writeElement( this->type_vector.readElement(i,0)
+                                      + alpha * x.type_vector.readElement(i,0), i, 0 );
+  }
+  return *this;
+}
+
+/**
+ * Reads the elements in the given positions.
+ * values[k] = v(index[k]), k = 0..n-1.
+ */
+template <typename T, typename Storage>
+    void Vector<T,Storage>::gather(T* values, const size_type* index, size_type n) const
+{
+  for (size_type k=0; k<n; ++k) values[k] = this->type_vector.readElement(index[k],0);
+}
+
+/**
+ * Writes the values in the given positions.
+ * v(index[k]) = values[k], k = 0..n-1.
+ */
+template <typename T, typename Storage>
+    void Vector<T,Storage>::scatter(const T* values, const size_type* index, size_type n)
+{
+  for (size_type k=0; k<n; ++k) this->type_vector.writeElement(values[k], index[k], 0);
+}
+
+/**
+ * Adds the values to the given positions, as in the assembly of element vectors.
+ * v(index[k]) += values[k], k = 0..n-1.
+ */
+template <typename T, typename Storage>
+    void Vector<T,Storage>::scatterAdd(const T* values, const size_type* index, size_type n)
+{
+  for (size_type k=0; k<n; ++k) this->type_vector.addElement(values[k], index[k], 0);
+}
+
+
+ //////////////////////////////////////////////////////////////////
+ // Overloaded operators with static Matrix and Vector: ///////////
+ //////////////////////////////////////////////////////////////////
+
+/**
+ * Operator for multiplying Matrix and Vector objects with static storage.
+ * \param A Matrix reference for first LHS term.
+ * \param b Vector reference for second LHS term.
+ * \return A new Vector (c = A*b).
+ */
+template <typename T, typename MS, typename VS>
+    Vector<T,VS> operator * (const Matrix<T,MS>& A, const Vector<T,VS>& b)
+{
+  Vector<T,VS> c(A.rows());
+  c.mult(A,b);
+  return c;
+}
+
+/**
+ * Overloaded operator that prints a Matrix object with static storage.
+ * \param mat Matrix reference to the object that is going to be printed.
+ * \param os An output std stream.
+ * \return (\a os ) The stream that was passed as a parameter.
+ */
+template <typename T, typename Storage>
+    std::ostream& operator << (std::ostream& os, const Matrix<T,Storage>& mat)
+{
+  os << "Matrix (" << mat.rows() << "," << mat.cols() << ") = " ;
+  if ( !mat.rows() && !mat.cols() ) os << "void";
+  for (size_type i=0; i<mat.rows(); ++i)
+  {
+    os << endl;
+    for (size_type j=0; j<mat.cols(); ++j)
+      os << mat.readElement(i,j) << " ";
+  }
+  os << endl;
+  return os;
+}
+
+/**
+ * Overloaded operator that prints a Vector object with static storage.
+ * \param vec Vector reference to the object that is going to be printed.
+ * \param os An output std stream.
+ * \return (\a os ) The stream that was passed as a parameter.
+ */
+template <typename T, typename Storage>
+    std::ostream& operator << (std::ostream& os, const Vector<T,Storage>& vec)
+{
+  os << "Vector (" << vec.size() << ") = " ;
+  if ( !vec.size() ) os << "void";
+  for (size_type i=0; i<vec.size(); ++i)
+  {
+    os << endl;
+    os << vec.readElement(i) << " ";
+  }
+  os << endl;
+  return os;
+}
+
+}; // namespace lmx
+
+
+#endif
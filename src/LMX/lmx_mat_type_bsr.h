@@ -0,0 +1,748 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXTYPE_BSR_H
+#define LMXTYPE_BSR_H
+
+#include <algorithm>
+#include "lmx_mat_data_mat.h"
+#include "lmx_mat_type_csc.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_type_bsr.h
+
+      \brief This file contains both the declaration and implementation for Type_bsr class member functions.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx {
+
+  /**
+    \struct Bsr_block
+    \brief Dense operations on the B x B (row major) blocks of Type_bsr.
+
+    The loops have compile time bounds so they are completely unrolled;
+    the most used sizes are also written out explicitly.
+   */
+template <typename T, int B> struct Bsr_block
+{
+  /** y += a*x, with a a B x B block and x, y of size B. */
+  static inline void mult_add( const T* a, const T* x, T* y )
+  {
+    for( int i=0 ; i < B ; ++i ){
+      T sum = y[i];
+      for( int j=0 ; j < B ; ++j ) sum += a[i*B+j] * x[j];
+      y[i] = sum;
+    }
+  }
+};
+
+/// 2 x 2 block, 2D problems with two DOF per node.
+template <typename T> struct Bsr_block<T,2>
+{
+  static inline void mult_add( const T* a, const T* x, T* y )
+  {
+    const T x0 = x[0], x1 = x[1];
+    y[0] += a[0]*x0 + a[1]*x1;
+    y[1] += a[2]*x0 + a[3]*x1;
+  }
+};
+
+/// 3 x 3 block, solids with three DOF per node.
+template <typename T> struct Bsr_block<T,3>
+{
+  static inline void mult_add( const T* a, const T* x, T* y )
+  {
+    const T x0 = x[0], x1 = x[1], x2 = x[2];
+    y[0] += a[0]*x0 + a[1]*x1 + a[2]*x2;
+    y[1] += a[3]*x0 + a[4]*x1 + a[5]*x2;
+    y[2] += a[6]*x0 + a[7]*x1 + a[8]*x2;
+  }
+};
+
+
+  /**
+    \class Type_bsr
+
+    \brief Block Sparse Row matrix with fixed size B x B blocks.
+
+    The matrix is divided in B x B dense blocks (B = number of degrees of
+    freedom per node) and only the non-zero blocks are stored, so one column
+    index is kept per block instead of per element. All the indices are zero
+    based and refer to blocks: the blocks of block row I are
+    aa[ia[I]*B*B] ... aa[ia[I+1]*B*B-1], each one stored by rows, and their
+    block columns are in ja[] in increasing order. The matrix dimensions must
+    be multiples of B.
+
+    Matrix types 7, 8 and 9 select Type_bsr with B = 2, 3 and 6.
+
+    \param B Block size.
+    \param IndexType Integer type of ia[] and ja[], defaults to LMX_CSC_INDEX.
+
+    \author Daniel Iglesias Ib��ez
+  */
+template <typename T, int B, typename IndexType> class Type_bsr : public Data_mat<T>
+{
+  // Public for the same reason as in Type_csc (lmx_mat_data_blas.h functions).
+public:
+  std::vector<T>     aa; /**< Blocks contents. */
+  std::vector<IndexType> ia; /**< Block row pointer (size Nbrow+1). */
+  std::vector<IndexType> ja; /**< Block column indexer. */
+  size_type Nblocks; /**< Number of non-zero blocks. */
+  size_type Nbrow; /**< Number of block rows. */
+  size_type Nbcol; /**< Number of block columns. */
+
+private:
+  T zero;
+
+  size_type find( size_type, size_type ) const;
+
+  void check_dimensions( size_type, size_type ) const;
+
+public:
+  Type_bsr();
+
+  Type_bsr(size_type rows, size_type columns);
+
+  ~Type_bsr();
+
+  void resize(size_type, size_type);
+
+  const T& readElement(const size_type& mrows, const size_type& ncolumns) const;
+
+  void writeElement(T value, size_type mrows, size_type ncolumns);
+
+  void addElement(T value, size_type mrows, size_type ncolumns);
+
+  T* create_block(size_type, size_type);
+
+  /** Method for knowing the number of data rows.
+   * \returns Number of rows.
+   */
+  size_type getRows() const
+  { return this->Nbrow * B; }
+
+  /** Method for knowing the number of data columns.
+   * \returns Number of columns.
+   */
+  size_type getCols() const
+  { return this->Nbcol * B; }
+
+  void equals(const Data<T>* matrix_in);
+
+  void add(const Data<T>* matrix_in_1);
+
+  void substract(const Data<T>* matrix_in_1);
+
+  void multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2);
+
+  void multiplyScalar(const T&);
+
+  void multiplyElements(const Data<T>* matrix_in);
+
+  void trn();
+
+  void cleanBelow(const double factor);
+
+  void read_mm_file(const char* input_file);
+
+  void read_hb_file(const char* input_file);
+
+  void write_hb_file(const char* input_file);
+
+  bool exists( size_type, size_type );
+
+  void setSparsePattern( std::vector<size_type>&, std::vector<size_type>& );
+
+  void invertDiagonalBlocks( std::vector<T>& ) const;
+};
+
+
+/// Empty constructor.
+template <typename T, int B, typename IndexType>
+    Type_bsr<T,B,IndexType>::Type_bsr() : Nblocks(0), Nbrow(0), Nbcol(0)
+{
+  ia.push_back( 0 );
+  zero = 0;
+}
+
+/**
+ * Standard constructor.
+ * Creates a new object with parameter contents resized to (rows, columns) dimension.
+ * \param rows Rows of matrix, multiple of B.
+ * \param columns Columns of matrix, multiple of B.
+ */
+template <typename T, int B, typename IndexType>
+    Type_bsr<T,B,IndexType>::Type_bsr(size_type rows, size_type columns)
+  : Data_mat<T>(), Nblocks(0), Nbrow(0), Nbcol(0)
+{
+  ia.push_back( 0 );
+  this->resize(rows,columns);
+  zero = 0;
+}
+
+/// Destructor.
+template <typename T, int B, typename IndexType>
+    Type_bsr<T,B,IndexType>::~Type_bsr()
+{
+}
+
+/**
+ * Throws a dimension_error if the dimensions given are not multiples of the block size.
+ * \param mrows Number of rows.
+ * \param ncolumns Number of columns.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::check_dimensions( size_type mrows, size_type ncolumns ) const
+{
+  if( mrows % B != 0 || ncolumns % B != 0 ){
+    std::stringstream message;
+    message << "Block sparse matrix (Type_bsr) dimensions must be multiples of the block size (" << B << ").\n"
+        << "Dimension requested: (" << mrows << "," << ncolumns << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+}
+
+/**
+ * Position of block (brow, bcol) in ja[].
+ * Binary search over the (sorted) block columns of the block row.
+ * \param brow Block row index.
+ * \param bcol Block column index.
+ * \return Position of block if it exists, Nblocks otherwise.
+ */
+template <typename T, int B, typename IndexType>
+    size_type Type_bsr<T,B,IndexType>::find( size_type brow, size_type bcol ) const
+{
+  typename std::vector<IndexType>::const_iterator first = ja.begin() + ia[brow];
+  typename std::vector<IndexType>::const_iterator last = ja.begin() + ia[brow+1];
+  typename std::vector<IndexType>::const_iterator it
+      = std::lower_bound(first, last, static_cast<IndexType>(bcol));
+  if ( it != last && static_cast<size_type>(*it) == bcol ) return it - ja.begin();
+  return Nblocks;
+}
+
+/**
+ * Resize method.
+ * Changes the size of the sparse matrix, removing the blocks that are left outside.
+ * \param mrows New value for rows of matrix, multiple of B.
+ * \param ncolumns New value for columns of matrix, multiple of B.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::resize(size_type mrows, size_type ncolumns)
+{
+  check_dimensions( mrows, ncolumns );
+  size_type nbrows = mrows / B;
+  size_type nbcols = ncolumns / B;
+
+  if( nbcols < Nbcol ){ // compact, dropping block columns >= nbcols
+    size_type pos = 0;
+    size_type row_begin = 0;
+    for( size_type i=0 ; i < Nbrow ; ++i ){
+      for( size_type k=row_begin ; k < static_cast<size_type>(ia[i+1]) ; ++k ){
+        if( static_cast<size_type>(ja[k]) < nbcols ){
+          ja[pos] = ja[k];
+          std::copy( aa.begin() + k*B*B, aa.begin() + (k+1)*B*B, aa.begin() + pos*B*B );
+          ++pos;
+        }
+      }
+      row_begin = ia[i+1];
+      ia[i+1] = pos;
+    }
+    aa.resize(pos*B*B);
+    ja.resize(pos);
+    Nblocks = pos;
+  }
+  Nbcol = nbcols;
+
+  if( nbrows < Nbrow ){
+    Nblocks = ia[nbrows];
+    aa.resize(Nblocks*B*B);
+    ja.resize(Nblocks);
+    ia.resize(nbrows+1);
+  }
+  else if( nbrows > Nbrow ){
+    ia.resize(nbrows+1, static_cast<IndexType>(Nblocks) );
+  }
+  Nbrow = nbrows;
+}
+
+/**
+ * Read element method.
+ * Implements a method for reading data of the BSR matrix.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ * \return Value of the element in the position given by the parameters.
+ */
+template <typename T, int B, typename IndexType>
+    const T& Type_bsr<T,B,IndexType>::readElement(const size_type& mrows, const size_type& ncolumns) const
+{
+  size_type pos = this->find(mrows / B, ncolumns / B);
+  if( pos == Nblocks ) return zero;
+  return aa[ pos*B*B + (mrows % B)*B + ncolumns % B ];
+}
+
+/**
+ * Write element method.
+ * Implements a method for writing data on the BSR matrix. A new (zero
+ * filled) block is only created if the value is not null.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ * \param value Numerical type value.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::writeElement(T value, size_type mrows, size_type ncolumns)
+{
+  size_type pos = this->find(mrows / B, ncolumns / B);
+  if( pos != Nblocks ) aa[ pos*B*B + (mrows % B)*B + ncolumns % B ] = value;
+  else if( value != T(0) )
+    this->create_block(mrows / B, ncolumns / B)[ (mrows % B)*B + ncolumns % B ] = value;
+}
+
+/**
+ * Add element method.
+ * Adds value to the element, creating its block if needed.
+ * \param value Numerical type value.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::addElement(T value, size_type mrows, size_type ncolumns)
+{
+  size_type pos = this->find(mrows / B, ncolumns / B);
+  if( pos != Nblocks ) aa[ pos*B*B + (mrows % B)*B + ncolumns % B ] += value;
+  else if( value != T(0) )
+    this->create_block(mrows / B, ncolumns / B)[ (mrows % B)*B + ncolumns % B ] = value;
+}
+
+/**
+ * Create block method.
+ * Implements a method for creating a new (zero filled) block in the matrix.
+ * \param brow Block row position.
+ * \param bcol Block column position.
+ * \return A pointer to the first element of the block.
+ */
+template <typename T, int B, typename IndexType>
+    T* Type_bsr<T,B,IndexType>::create_block( size_type brow, size_type bcol)
+{
+  size_type pos = std::lower_bound( ja.begin() + ia[brow],
+                                    ja.begin() + ia[brow+1],
+                                    static_cast<IndexType>(bcol) ) - ja.begin();
+  if( pos < static_cast<size_type>(ia[brow+1])
+      && static_cast<size_type>(ja[pos]) == bcol ) return &( aa[pos*B*B] );
+
+  aa.insert( aa.begin() + pos*B*B, B*B, T(0) );
+  ja.insert( ja.begin()+pos, static_cast<IndexType>(bcol) );
+  for( size_type i=brow+1 ; i < Nbrow+1 ; ++i ) ++ia[i];
+  ++Nblocks;
+  return &( aa[pos*B*B] );
+}
+
+/**
+ * Copy method.
+ * Equals the data in the object's contents to those given by the input matrix parameter.
+ * \param matrix_in pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::equals(const Data<T>* matrix_in)
+{
+  const Type_bsr* bsr_in = dynamic_cast<const Type_bsr*>(matrix_in);
+  if( bsr_in ){
+    aa = bsr_in->aa;
+    ia = bsr_in->ia;
+    ja = bsr_in->ja;
+    Nbrow = bsr_in->Nbrow;
+    Nbcol = bsr_in->Nbcol;
+    Nblocks = bsr_in->Nblocks;
+  }
+  else{ // Block row by block row, appending the non-zero blocks at the end
+    size_type rows = matrix_in->getRows();
+    size_type cols = matrix_in->getCols();
+    check_dimensions( rows, cols );
+    T block[B*B];
+    bool non_zero;
+    aa.clear();
+    ja.clear();
+    ia.assign(1, 0);
+    for( size_type bi=0 ; bi < rows/B ; ++bi ){
+      for( size_type bj=0 ; bj < cols/B ; ++bj ){
+        non_zero = false;
+        for( int i=0 ; i < B ; ++i ){
+          for( int j=0 ; j < B ; ++j ){
+            block[i*B+j] = matrix_in->readElement( bi*B+i, bj*B+j );
+            if( block[i*B+j] != T(0) ) non_zero = true;
+          }
+        }
+        if( non_zero ){
+          aa.insert( aa.end(), block, block + B*B );
+          ja.push_back( static_cast<IndexType>(bj) );
+        }
+      }
+      ia.push_back( static_cast<IndexType>( ja.size() ) );
+    }
+    Nbrow = rows/B;
+    Nbcol = cols/B;
+    Nblocks = ja.size();
+  }
+}
+
+/**
+ * Add method.
+ * Adds the the input matrix parameter's elements to the object's contents.
+ * Necessary for overloading the "+=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::add(const Data<T>* matrix_in_1)
+{
+  const Type_bsr* bsr_in = dynamic_cast<const Type_bsr*>(matrix_in_1);
+  if( bsr_in ){ // only the stored blocks of the operand
+    for( size_type i=0 ; i < Nbrow ; ++i ){
+      for( IndexType k=bsr_in->ia[i] ; k < bsr_in->ia[i+1] ; ++k ){
+        T* block = this->create_block( i , bsr_in->ja[k] );
+        for( int l=0 ; l < B*B ; ++l ) block[l] += bsr_in->aa[k*B*B+l];
+      }
+    }
+  }
+  else{
+    for( size_type i=0 ; i < this->getRows() ; ++i ){
+      for( size_type j=0 ; j < this->getCols() ; ++j ){
+        this->addElement( matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Substract method.
+ * Substracts the the input matrix parameter's elements to the object's contents.
+ * Necessary for overloading the "-=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::substract(const Data<T>* matrix_in_1)
+{
+  const Type_bsr* bsr_in = dynamic_cast<const Type_bsr*>(matrix_in_1);
+  if( bsr_in ){ // only the stored blocks of the operand
+    for( size_type i=0 ; i < Nbrow ; ++i ){
+      for( IndexType k=bsr_in->ia[i] ; k < bsr_in->ia[i+1] ; ++k ){
+        T* block = this->create_block( i , bsr_in->ja[k] );
+        for( int l=0 ; l < B*B ; ++l ) block[l] -= bsr_in->aa[k*B*B+l];
+      }
+    }
+  }
+  else{
+    for( size_type i=0 ; i < this->getRows() ; ++i ){
+      for( size_type j=0 ; j < this->getCols() ; ++j ){
+        this->addElement( -matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Multiply method.
+ * Multiplies the input matrices and saves the result into the object's contents.
+ * Necessary for overloading the "*" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ * \param matrix_in_2 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
+{
+// this = matrix_in_1 * matrix_in_2
+  size_type rows = matrix_in_1->getRows();
+  size_type cols = matrix_in_2->getCols();
+  size_type inner = matrix_in_1->getCols();
+  check_dimensions( rows, cols );
+  T block[B*B];
+  bool non_zero;
+
+  aa.clear();
+  ja.clear();
+  ia.assign(1, 0);
+  for( size_type bi=0 ; bi < rows/B ; ++bi ){
+    for( size_type bj=0 ; bj < cols/B ; ++bj ){
+      non_zero = false;
+      for( int i=0 ; i < B ; ++i ){
+        for( int j=0 ; j < B ; ++j ){
+          T val_mult = 0;
+          for( size_type k=0 ; k < inner ; ++k )
+            val_mult += matrix_in_1->readElement( bi*B+i , k ) * matrix_in_2->readElement( k , bj*B+j );
+          block[i*B+j] = val_mult;
+          if( val_mult != T(0) ) non_zero = true;
+        }
+      }
+      if( non_zero ){
+        aa.insert( aa.end(), block, block + B*B );
+        ja.push_back( static_cast<IndexType>(bj) );
+      }
+    }
+    ia.push_back( static_cast<IndexType>( ja.size() ) );
+  }
+  Nbrow = rows/B;
+  Nbcol = cols/B;
+  Nblocks = ja.size();
+}
+
+/**
+ * Multiply scalar method.
+ * Multiplies the object's matrix (contents) with a scalar.
+ * Necessary for overloading the "*" operator.
+ * \param scalar A scalar factor of template's class.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::multiplyScalar(const T& scalar)
+{
+  for( size_type k=0 ; k < aa.size() ; ++k ) aa[k] *= scalar;
+}
+
+/**
+ * Method multiplying element-by-element of two matrices.
+ * One would be the object's contents and the other the parameter's contents.
+ * Only the stored blocks are visited.
+ *
+ * \param matrix_in pointer to an object that belongs to a class derived from Data.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::multiplyElements(const Data<T>* matrix_in)
+{
+  for( size_type bi=0 ; bi < Nbrow ; ++bi ){
+    for( IndexType k=ia[bi] ; k < ia[bi+1] ; ++k ){
+      for( int i=0 ; i < B ; ++i ){
+        for( int j=0 ; j < B ; ++j ){
+          aa[k*B*B+i*B+j] *= matrix_in->readElement( bi*B+i , ja[k]*B+j );
+        }
+      }
+    }
+  }
+}
+
+/**
+ * Traspose method.
+ * Swaps elements with respect to the diagonal: A(i,j) = A(j,i).
+ * The block structure is transposed with a counting sort over the block
+ * columns and every block is transposed in place.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::trn()
+{
+  std::vector<IndexType> ia_t( Nbcol+1, 0 );
+  std::vector<IndexType> ja_t( Nblocks );
+  std::vector<T> aa_t( Nblocks*B*B );
+
+  for( size_type k=0 ; k < Nblocks ; ++k ) ++ia_t[ ja[k]+1 ];
+  for( size_type j=0 ; j < Nbcol ; ++j ) ia_t[j+1] += ia_t[j];
+
+  std::vector<IndexType> next( ia_t.begin(), ia_t.end()-1 );
+  for( size_type bi=0 ; bi < Nbrow ; ++bi ){
+    for( IndexType k=ia[bi] ; k < ia[bi+1] ; ++k ){
+      size_type pos = next[ ja[k] ]++;
+      ja_t[pos] = static_cast<IndexType>(bi);
+      for( int i=0 ; i < B ; ++i )
+        for( int j=0 ; j < B ; ++j )
+          aa_t[pos*B*B+j*B+i] = aa[k*B*B+i*B+j];
+    }
+  }
+
+  ia.swap(ia_t);
+  ja.swap(ja_t);
+  aa.swap(aa_t);
+  std::swap(Nbrow, Nbcol);
+}
+
+/**
+ * Clean below method.
+ * Makes equal to zero every element below given factor.
+ * \param factor Reference value for cleaning.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::cleanBelow(const double factor)
+{
+  for (size_type i=0; i<this->aa.size(); ++i){
+    if (std::abs(this->aa[i]) < factor) this->aa[i] = static_cast<T>(0);
+  }
+}
+
+/**
+ * Read data in Matrix Market format method.
+ * The matrix is read as a Type_csc and then split in blocks.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T, int B, typename IndexType>
+void Type_bsr<T,B,IndexType>::read_mm_file(const char* input_file)
+{
+  Type_csc<T> scalar;
+  scalar.read_mm_file(input_file);
+  this->equals(&scalar);
+}
+
+/**
+ * Read data in Harwell-Boeing format method.
+ * The matrix is read as a Type_csc and then split in blocks.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::read_hb_file(const char* input_file)
+{
+  Type_csc<T> scalar;
+  scalar.read_hb_file(input_file);
+  this->equals(&scalar);
+}
+
+/**
+ * Write data in Harwell-Boeing format method.
+ * The elements of the stored blocks are copied to a Type_csc, which is written.
+ *
+ * \param input_file Name of the file to be written.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::write_hb_file(const char* input_file)
+{
+  Type_csc<T> scalar( this->getRows(), this->getCols() );
+  for( size_type bi=0 ; bi < Nbrow ; ++bi ){
+    for( IndexType k=ia[bi] ; k < ia[bi+1] ; ++k ){
+      for( int i=0 ; i < B ; ++i ){
+        for( int j=0 ; j < B ; ++j ){
+          scalar.writeElement( aa[k*B*B+i*B+j], bi*B+i, ja[k]*B+j );
+        }
+      }
+    }
+  }
+  scalar.write_hb_file(input_file);
+}
+
+/**
+ * Returns TRUE or FALSE depending of element existance.
+ *
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * @return TRUE if the block of the element exists in internal storage structure.
+ */
+template <typename T, int B, typename IndexType>
+    bool Type_bsr<T,B,IndexType>::exists( size_type mrows, size_type ncolumns )
+{
+  return this->find(mrows / B, ncolumns / B) != Nblocks;
+}
+
+/**
+ * Prepares the sparse structure of the matrix.
+ * The pattern is given for the elements in the same (one based,
+ * Harwell-Boeing) form used by Type_csc; every block containing at least
+ * one element of the pattern is created.
+ * @param row_index CSC row indices.
+ * @param col_index CSC columns indices.
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::setSparsePattern( std::vector<size_type>& row_index,
+                                                    std::vector<size_type>& col_index
+                                                  )
+{
+  size_type ncols = col_index.size() - 1;
+  size_type nrows = this->getRows();
+  for( size_type k=0 ; k < row_index.size() ; ++k ) nrows = std::max( nrows, row_index[k] );
+  check_dimensions( nrows, ncols );
+
+  std::vector< std::vector<IndexType> > rows_blocks( nrows/B );
+  for( size_type j=0 ; j < ncols ; ++j ){
+    for( size_type k=col_index[j]-1 ; k < col_index[j+1]-1 ; ++k ){
+      std::vector<IndexType>& row = rows_blocks[ (row_index[k]-1) / B ];
+      if( row.empty() || row.back() != static_cast<IndexType>(j / B) )
+        row.push_back( static_cast<IndexType>(j / B) );
+    }
+  }
+
+  ia.assign(1, 0);
+  ja.clear();
+  for( size_type bi=0 ; bi < rows_blocks.size() ; ++bi ){
+    std::vector<IndexType>& row = rows_blocks[bi];
+    std::sort( row.begin(), row.end() );
+    row.erase( std::unique( row.begin(), row.end() ), row.end() );
+    ja.insert( ja.end(), row.begin(), row.end() );
+    ia.push_back( static_cast<IndexType>( ja.size() ) );
+  }
+  Nbrow = nrows / B;
+  Nbcol = std::max( Nbcol, ncols / B );
+  Nblocks = ja.size();
+  aa.assign( Nblocks*B*B, T(0) );
+}
+
+/**
+ * Computes the inverses of the diagonal blocks, for block-Jacobi preconditioning.
+ * Each block is inverted by Gauss-Jordan elimination with partial pivoting.
+ * @param inverse Vector to write the Nbrow inverted blocks to (row major).
+ */
+template <typename T, int B, typename IndexType>
+    void Type_bsr<T,B,IndexType>::invertDiagonalBlocks( std::vector<T>& inverse ) const
+{
+  inverse.assign( Nbrow*B*B, T(0) );
+  T a[B*B];
+  for( size_type bi=0 ; bi < Nbrow ; ++bi ){
+    size_type pos = this->find(bi, bi);
+    if( pos == Nblocks ){
+      std::stringstream message;
+      message << "Null diagonal block!!. Block position: " << bi << "." << endl;
+      LMX_THROW(internal_error, message.str() );
+    }
+    std::copy( aa.begin() + pos*B*B, aa.begin() + (pos+1)*B*B, a );
+    T* inv = &inverse[bi*B*B];
+    for( int i=0 ; i < B ; ++i ) inv[i*B+i] = T(1);
+
+    for( int k=0 ; k < B ; ++k ){
+      int p = k;
+      for( int i=k+1 ; i < B ; ++i )
+        if( std::abs(a[i*B+k]) > std::abs(a[p*B+k]) ) p = i;
+      if( a[p*B+k] == T(0) ){
+        std::stringstream message;
+        message << "Singular diagonal block!!. Block position: " << bi << "." << endl;
+        LMX_THROW(internal_error, message.str() );
+      }
+      if( p != k ){
+        for( int j=0 ; j < B ; ++j ){
+          std::swap( a[k*B+j], a[p*B+j] );
+          std::swap( inv[k*B+j], inv[p*B+j] );
+        }
+      }
+      const T pivot = a[k*B+k];
+      for( int j=0 ; j < B ; ++j ){
+        a[k*B+j] /= pivot;
+        inv[k*B+j] /= pivot;
+      }
+      for( int i=0 ; i < B ; ++i ){
+        if( i == k || a[i*B+k] == T(0) ) continue;
+        const T factor = a[i*B+k];
+        for( int j=0 ; j < B ; ++j ){
+          a[i*B+j] -= factor * a[k*B+j];
+          inv[i*B+j] -= factor * inv[k*B+j];
+        }
+      }
+    }
+  }
+}
+
+};
+
+
+#endif
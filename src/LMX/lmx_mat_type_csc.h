@@ -20,6 +20,7 @@
 #ifndef LMXTYPE_CSC_H
 #define LMXTYPE_CSC_H
 
+#include <algorithm>
 #include "lmx_mat_data_mat.h"
 #include "lmx_base_iohb.h"
 
@@ -33,6 +34,11 @@
 
       \brief This file contains both the declaration and implementation for Type_csc class member functions.
 
+      The index type of Type_csc defaults to LMX_CSC_INDEX (int), so the
+      arrays can be given to SuperLU without copies. Define LMX_CSC_INDEX
+      as a 64 bit integer (i.e. "long long") before including LMX when the
+      number of non-zeros exceeds 2^31.
+
       \author Roberto Ortega Aguilera.
 
      */
@@ -46,16 +52,23 @@ namespace lmx {
 
     \brief Compressed Storaged by Columns matrix.
 
+    All the indices are zero based: the elements of column j are
+    aa[ja[j]] ... aa[ja[j+1]-1], and their rows are stored in ia[] in
+    increasing order. One based (Harwell-Boeing) indices are only used
+    when reading or writing HB files and in setSparsePattern().
+
+    \param IndexType Integer type of ia[] and ja[], defaults to LMX_CSC_INDEX.
+
     \author Roberto Ortega
   */
-template <typename T> class Type_csc : public Data_mat<T>
+template <typename T, typename IndexType> class Type_csc : public Data_mat<T>
 {
   // Should be changed to private but needs comprobation of compiler compliance using
   // template friend funtions (needed for lmx_mat_data_blas.h functions).
 public:
   std::vector<T>     aa; /**< Matrix data contents. */
-  std::vector<size_type> ia; /**< Row indexer. */
-  std::vector<size_type> ja; /**< Column indexer. */
+  std::vector<IndexType> ia; /**< Row indexer. */
+  std::vector<IndexType> ja; /**< Column indexer. */
   size_type Nnze; /**< Number of non-zero values. */
   size_type Nrow; /**< Number of rows. */
   size_type Ncol; /**< Number of columns. */
@@ -63,6 +76,25 @@ public:
 private:
   T zero;
 
+  /** Element waiting to be inserted during a staged assembly. */
+  struct Triplet {
+    size_type row; /**< Row (zero based). */
+    size_type col; /**< Column (zero based). */
+    T value; /**< Value to write or add. */
+    bool additive; /**< TRUE if value is added, FALSE if it replaces. */
+  };
+
+  /** Column-major ordering of triplets. */
+  static bool triplet_less( const Triplet& a, const Triplet& b )
+  { return (a.col < b.col) || (a.col == b.col && a.row < b.row); }
+
+  bool staged; /**< TRUE between beginAssembly() and endAssembly(). */
+  std::vector<Triplet> pending; /**< Elements waiting for endAssembly(). */
+
+  size_type find( size_type, size_type ) const;
+
+  void stage( T, size_type, size_type, bool );
+
 public:
   Type_csc();
 
@@ -76,8 +108,14 @@ public:
 
   void writeElement(T value, size_type mrows, size_type ncolumns);
 
+  void addElement(T value, size_type mrows, size_type ncolumns);
+
   T* create_element(size_type, size_type);
 
+  void beginAssembly();
+
+  void endAssembly();
+
   inline size_type getRows() const;
 
   inline size_type getCols() const;
@@ -108,13 +146,13 @@ public:
   void print()
   {
     std::cout << "aa:" << endl;
-    for(int i=0; i<Nnze; ++i) std::cout << aa[i] << "; ";
+    for(size_type i=0; i<Nnze; ++i) std::cout << aa[i] << "; ";
     std::cout << endl;
     std::cout << "ia:" << endl;
-    for(int i=0; i<Nnze; ++i) std::cout << ia[i] << "; ";
+    for(size_type i=0; i<Nnze; ++i) std::cout << ia[i] << "; ";
     std::cout << endl;
     std::cout << "ja:" << endl;
-    for(int i=0; i<ja.size(); ++i) std::cout << ja[i] << "; ";
+    for(size_type i=0; i<ja.size(); ++i) std::cout << ja[i] << "; ";
     std::cout << endl;
   }
 
@@ -124,20 +162,17 @@ public:
 
   void setSparsePattern( std::vector<size_type>&, std::vector<size_type>& );
 
-  friend void mat_vec_mult<>( const Type_csc<T>*,
-                              const Type_stdVector<T>*,
-                              Type_stdVector<T>*);
 };
 
 
 /// Empty constructor.
-template <typename T> 
-    Type_csc<T>::Type_csc()
+template <typename T, typename IndexType>
+    Type_csc<T,IndexType>::Type_csc() : staged(false)
 {
     Nrow = 0;
     Ncol = 0;
     Nnze = 0;
-    ja.push_back( 1 );
+    ja.push_back( 0 );
     zero = 0;
 }
 
@@ -147,22 +182,20 @@ template <typename T>
  * \param rows Rows of H-B matrix.
  * \param columns Columns of H-B matrix.
  */
-template <typename T>
-    Type_csc<T>::Type_csc(size_type rows, size_type columns) : Data_mat<T>()
+template <typename T, typename IndexType>
+    Type_csc<T,IndexType>::Type_csc(size_type rows, size_type columns) : Data_mat<T>(), staged(false)
 {
-  Nrow = rows;
-  Ncol = columns;
+  Nrow = 0;
+  Ncol = 0;
   Nnze = 0;
-  for(size_type i=0;i<columns+1;++i){
-  ja.push_back( 1 );
-  }
+  ja.push_back( 0 );
   this->resize(rows,columns);
   zero = 0;
 }
 
 /// Destructor.
-template <typename T>
-    Type_csc<T>::~Type_csc()
+template <typename T, typename IndexType>
+    Type_csc<T,IndexType>::~Type_csc()
 {
 }
 
@@ -172,123 +205,198 @@ template <typename T>
  * \param mrows New value for rows of matrix.
  * \param ncolumns New value for columns of matrix.
  */
-template <typename T>
-    void Type_csc<T>::resize(size_type mrows, size_type ncolumns)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::resize(size_type mrows, size_type ncolumns)
 {
-  size_type end_val_ja;
-  size_type pos_end_col;
-  size_type row_end_col;
-  size_type num_col_del;
-  size_type num_val_del;
-  typename std::vector<T>::iterator it_aa;
-  typename std::vector<size_type>::iterator it_ia;
-
-  if( mrows < Nrow ){
-
-    for( size_type i=0 ; i < Ncol ; ++i ){
-
-      if( ja[i] != ja [i+1] ) {
-
-        pos_end_col = ja[i+1]-2;
-        row_end_col = ia[pos_end_col];
-
-        while( row_end_col > mrows ){
-          it_aa = aa.begin() + pos_end_col;
-          aa.erase( it_aa );
-          it_ia = ia.begin() + pos_end_col;
-          ia.erase( it_ia );
-          --Nnze;
-          for ( size_type j=i+1 ; j < Ncol+1 ; ++j ) {
-            --ja[j];
-          }
-          if( ja[i] != ja [i+1] ) {
-            pos_end_col = ja[i+1]-2;
-            row_end_col = ia[pos_end_col];
-          }
-          else{ break;}
+  if( mrows < Nrow ){ // compact, dropping rows >= mrows
+    size_type pos = 0;
+    size_type col_begin = 0;
+    for( size_type j=0 ; j < Ncol ; ++j ){
+      for( size_type k=col_begin ; k < (size_type)ja[j+1] ; ++k ){
+        if( (size_type)ia[k] < mrows ){
+          ia[pos] = ia[k];
+          aa[pos] = aa[k];
+          ++pos;
         }
       }
+      col_begin = ja[j+1];
+      ja[j+1] = pos;
     }
-  }
-  else if( mrows > Nrow ){
-
+    aa.resize( pos );
+    ia.resize( pos );
+    Nnze = pos;
   }
   Nrow = mrows;
 
   if( ncolumns > Ncol ){
-
-    end_val_ja = ja[Ncol];
-    ja.resize( ncolumns + 1 );
-
-    for( size_type i = Ncol+1 ; i < ncolumns+1 ; ++i){
-      ja[i] = end_val_ja;
-    }
+    ja.resize( ncolumns + 1, ja[Ncol] );
   }
   else if( ncolumns < Ncol ){
-
-    num_col_del = Ncol - ncolumns ;
-    num_val_del = ja[Ncol] - ja[ncolumns];
-
-    aa.resize( Nnze-num_val_del );
-    ia.resize( Nnze-num_val_del );
-    ja.resize( Ncol+1-num_col_del );
-    Nnze = Nnze - num_val_del;
+    Nnze = ja[ncolumns];
+    aa.resize( Nnze );
+    ia.resize( Nnze );
+    ja.resize( ncolumns + 1 );
   }
   Ncol = ncolumns;
 }
 
+/**
+ * Position of element (mrows, ncolumns) in aa[] and ia[].
+ * Binary search over the (sorted) rows of the column.
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * \return Position of element if it exists, Nnze otherwise.
+ */
+template <typename T, typename IndexType>
+    size_type Type_csc<T,IndexType>::find( size_type mrows, size_type ncolumns ) const
+{
+  typename std::vector<IndexType>::const_iterator first = ia.begin() + ja[ncolumns];
+  typename std::vector<IndexType>::const_iterator last = ia.begin() + ja[ncolumns+1];
+  typename std::vector<IndexType>::const_iterator it
+      = std::lower_bound(first, last, static_cast<IndexType>(mrows));
+  if ( it != last && (size_type)*it == mrows ) return it - ia.begin();
+  return Nnze;
+}
 
 /**
  * Read element method.
  * Implements a method for reading data of the Harwell-Boeing matrix.
+ * Elements written during a staged assembly are not seen until endAssembly().
  * \param mrows Row position in Harwell-Boeing matrix.
  * \param ncolumns Column position in Harwell-Boeing matrix.
  * \return Value of the element in the position given by the parameters.
  */
-template <typename T>
-    const T& Type_csc<T>::readElement(const size_type& mrows, const size_type& ncolumns) const
+template <typename T, typename IndexType>
+    const T& Type_csc<T,IndexType>::readElement(const size_type& mrows, const size_type& ncolumns) const
 {
-  if(ja[ncolumns]==ja[ncolumns+1]){
-    return zero;
-  }
-  else{
-    for (size_type i=ja[ncolumns];i<ja[ncolumns+1];++i){
-      if (mrows+1==ia[i-1]){
-        return aa[i-1];
-        break;
-      }
-    }
-    return zero;
-  }
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos == Nnze ) return zero;
+  return aa[pos];
 }
 
 /**
  * Write element method.
  * Implements a method for writing data on the Harwell-Boeing matrix.
+ * Existing positions are written directly. New ones are inserted at once or,
+ * during a staged assembly, kept until endAssembly().
  * \param mrows Row position in Harwell-Boeing matrix.
  * \param ncolumns Column position in Harwell-Boeing matrix.
  * \param value Numerical type value.
  */
-template <typename T>
-    void Type_csc<T>::writeElement(T value, size_type mrows, size_type ncolumns)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::writeElement(T value, size_type mrows, size_type ncolumns)
 {
-  if(ja[ncolumns]==ja[ncolumns+1]){
-    *(this->create_element(mrows, ncolumns) ) = value;
-  }
-  else{
-    if(mrows+1>ia[ja[ncolumns+1]-2]){
-      *(this->create_element(mrows, ncolumns) ) = value;
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos != Nnze ) aa[pos] = value;
+  else if( staged ) this->stage(value, mrows, ncolumns, 0);
+  else *(this->create_element(mrows, ncolumns) ) = value;
+}
+
+/**
+ * Add element method.
+ * Adds a value to an element of the Harwell-Boeing matrix, with the same
+ * insertion policy than writeElement().
+ * \param value Numerical type value.
+ * \param mrows Row position in Harwell-Boeing matrix.
+ * \param ncolumns Column position in Harwell-Boeing matrix.
+ */
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::addElement(T value, size_type mrows, size_type ncolumns)
+{
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos != Nnze ) aa[pos] += value;
+  else if( staged ) this->stage(value, mrows, ncolumns, 1);
+  else *(this->create_element(mrows, ncolumns) ) += value;
+}
+
+/**
+ * Keeps an element for insertion at endAssembly().
+ * \param value Numerical type value.
+ * \param mrows Row position in Harwell-Boeing matrix.
+ * \param ncolumns Column position in Harwell-Boeing matrix.
+ * \param additive TRUE if value is to be added, FALSE if it replaces.
+ */
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::stage(T value, size_type mrows, size_type ncolumns, bool additive)
+{
+  Triplet t;
+  t.row = mrows;
+  t.col = ncolumns;
+  t.value = value;
+  t.additive = additive;
+  pending.push_back(t);
+}
+
+/**
+ * Starts a staged assembly.
+ * From now on, elements in new positions are stored as triplets and inserted in endAssembly().
+ */
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::beginAssembly()
+{
+  staged = 1;
+}
+
+/**
+ * Ends a staged assembly.
+ * Sorts the pending triplets (stable, so the order of the writes is kept),
+ * reduces the ones in the same position and merges them with the existing
+ * columns in a single pass. Cost is O(Nnze + p log p) for p triplets.
+ */
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::endAssembly()
+{
+  staged = 0;
+  if( pending.empty() ) return;
+
+  std::stable_sort( pending.begin(), pending.end(), triplet_less );
+
+  // Reduce repeated positions:
+  size_type unique = 0;
+  for( size_type k=0 ; k < pending.size() ; ++k ){
+    if( unique > 0
+        && pending[unique-1].row == pending[k].row
+        && pending[unique-1].col == pending[k].col ){
+      if( pending[k].additive ) pending[unique-1].value += pending[k].value;
+      else pending[unique-1].value = pending[k].value;
     }
     else{
-      for (size_type i=ja[ncolumns];i<ja[ncolumns+1];++i){
-        if (mrows+1==ia[i-1]){
-          aa[i-1] = value;
-          return;
-        }
+      pending[unique] = pending[k]; // new position, starts from zero
+      ++unique;
+    }
+  }
+  pending.resize(unique);
+
+  // Merge with existing columns:
+  std::vector<T> aa_new;
+  std::vector<IndexType> ia_new;
+  aa_new.reserve( Nnze + unique );
+  ia_new.reserve( Nnze + unique );
+  size_type p = 0;
+  for( size_type j=0 ; j < Ncol ; ++j ){
+    size_type k = ja[j];
+    size_type k_end = ja[j+1];
+    ja[j] = aa_new.size();
+    while( k < k_end || (p < unique && pending[p].col == j) ){
+      if( p < unique && pending[p].col == j
+          && (k == k_end || pending[p].row < (size_type)ia[k]) ){
+        ia_new.push_back( pending[p].row );
+        aa_new.push_back( pending[p].value );
+        ++p;
+      }
+      else{
+        ia_new.push_back( ia[k] );
+        aa_new.push_back( aa[k] );
+        ++k;
       }
-      *(this->create_element(mrows, ncolumns) ) = value;
     }
   }
+  ja[Ncol] = aa_new.size();
+
+  aa.swap(aa_new);
+  ia.swap(ia_new);
+  Nnze = aa.size();
+  pending.clear();
 }
 
 /**
@@ -298,53 +406,29 @@ template <typename T>
  * \param ncolumns Column position in Harwell-Boeing matrix.
  * \return A pointer to the element in the position given by the parameters.
  */
-template <typename T>
-    T* Type_csc<T>::create_element( size_type mrows, size_type ncolumns)
+template <typename T, typename IndexType>
+    T* Type_csc<T,IndexType>::create_element( size_type mrows, size_type ncolumns)
 {
-  if(ja[ncolumns]==ja[ncolumns+1]){
-    //caso 1
-    aa.insert(aa.begin()+ja[ncolumns]-1,0);
-    ia.insert(ia.begin()+ja[ncolumns]-1,mrows+1);
-    for(size_type i=ncolumns+1;i<ja.size();++i){
-      ++ja[i];
-    }
-    ++Nnze;
-    return &( aa[ja[ncolumns]-1] );
-  }
-  else{
-    if(mrows+1>=ia[ja[ncolumns+1]-2]){//caso 2
-      aa.insert(aa.begin()+ja[ncolumns+1]-1,0); 
-      ia.insert(ia.begin()+ja[ncolumns+1]-1,mrows+1);
-      for(size_type i=ncolumns+1;i<ja.size();++i){
-        ++ja[i];
-      }
-      ++Nnze;
-      return &( aa[ja[ncolumns+1]-2] );
-    }
-    else{
-      for (size_type i=ja[ncolumns];i<ja[ncolumns+1];++i){//
-        if (mrows+1<ia[i-1]){
-          aa.insert(aa.begin()+i-1,0);
-          ia.insert(ia.begin()+i-1,mrows+1);
-          for(size_type k=ncolumns+1;k<ja.size();++k){
-            ++ja[k];
-          }
-          ++Nnze;
-          return &( aa[i-1] );
-          break;
-        }
-      }
-    }
+  size_type pos = std::lower_bound( ia.begin() + ja[ncolumns],
+                                    ia.begin() + ja[ncolumns+1],
+                                    static_cast<IndexType>(mrows) ) - ia.begin();
+  if( pos < (size_type)ja[ncolumns+1] && (size_type)ia[pos] == mrows ) return &( aa[pos] );
+
+  aa.insert(aa.begin()+pos,0);
+  ia.insert(ia.begin()+pos,mrows);
+  for(size_type i=ncolumns+1;i<ja.size();++i){
+    ++ja[i];
   }
-  return 0;
+  ++Nnze;
+  return &( aa[pos] );
 }
 
 /**
  * Method for knowing the number of data rows.
  * \return Number of rows.
  */
-template <typename T> inline
-    size_type Type_csc<T>::getRows() const
+template <typename T, typename IndexType> inline
+    size_type Type_csc<T,IndexType>::getRows() const
 {
   return this->Nrow;
 }
@@ -353,8 +437,8 @@ template <typename T> inline
  * Method for knowing the number of data columns.
  * \returns Number of columns.
  */
-template <typename T> inline
-    size_type Type_csc<T>::getCols() const
+template <typename T, typename IndexType> inline
+    size_type Type_csc<T,IndexType>::getCols() const
 {
   return this->Ncol;
 }
@@ -365,8 +449,8 @@ template <typename T> inline
  * Equals the data in the object's contents to those given by the input matrix parameter.
  * \param matrix_in pointer to an object that belongs to a class derived from Data_mat.
  */
-template <typename T>
-    void Type_csc<T>::equals(const Data<T>* matrix_in)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::equals(const Data<T>* matrix_in)
 {
   aa = static_cast<const Type_csc*>(matrix_in)-> aa;
   ia = static_cast<const Type_csc*>(matrix_in)-> ia;
@@ -382,8 +466,8 @@ template <typename T>
  * Necessary for overloading the "+=" operator.
  * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
  */
-template <typename T>
-    void Type_csc<T>::add(const Data<T>* matrix_in_1)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::add(const Data<T>* matrix_in_1)
 {
   // this += matrix_in_1
   for( size_type i=0 ; i < Nrow ; ++i ){
@@ -399,8 +483,8 @@ template <typename T>
  * Necessary for overloading the "-=" operator.
  * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
  */
-template <typename T> 
-    void Type_csc<T>::substract(const Data<T>* matrix_in_1)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::substract(const Data<T>* matrix_in_1)
 {
 // this -= matrix_in_1
   for( size_type i=0 ; i < Nrow ; ++i ){
@@ -417,8 +501,8 @@ template <typename T>
  * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
  * \param matrix_in_2 pointer to an object that belongs to a class derived from Data_mat.
  */
-template <typename T>  
-    void Type_csc<T>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
 {
 // this = matrix_in_1 * matrix_in_2
   T val_mat1;
@@ -444,8 +528,8 @@ template <typename T>
  * Necessary for overloading the "*" operator.
  * \param scalar A scalar factor of template's class.
  */
-template <typename T>
-    void Type_csc<T>::multiplyScalar(const T& scalar)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::multiplyScalar(const T& scalar)
 {
   typename std::vector<T>::iterator aa_iterator;
   for(aa_iterator = aa.begin();aa_iterator != aa.end();++aa_iterator){
@@ -461,86 +545,44 @@ template <typename T>
  *
  * \param matrix_in pointer to an object that belongs to a class derived from Data.
  */
-template <typename T>
-    void Type_csc<T>::multiplyElements(const Data<T>* matrix_in)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::multiplyElements(const Data<T>* matrix_in)
 {
-  // NEEDS OPTIMIZATION FOR MULTIPLYING EXCLUSIVELY THE ELEMENTS OF aa[].
-  T temp;
-  for (size_type i=0; i<Nrow; ++i){
-    for (size_type j=0; j<Ncol; ++j){
-      temp = this->readElement(i,j);
-      if( temp != static_cast<T>(0) )
-        this->writeElement( temp * matrix_in->readElement(i,j), i,j);
+  for (size_type j=0; j<Ncol; ++j){
+    for (size_type k=ja[j]; k<(size_type)ja[j+1]; ++k){
+      aa[k] *= matrix_in->readElement(ia[k], j);
     }
   }
 }
 
-
 /**
  * Traspose method.
  * Swaps elements with respect to the diagonal: A(i,j) = A(j,i)
  */
-template <typename T>
-    void Type_csc<T>::trn()
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::trn()
 {
-
-  size_type ja_starO[Nnze];
-
-  size_type NrowT = Ncol;
-  size_type NcolT = Nrow;
-
-  size_type k=0;
-  for( size_type i=0 ; i < Ncol ; ++i){
-    for( size_type j=ja[i] ; j < ja[i+1] ; ++j){
-      ja_starO[k] = i+1;
-      ++k;
-    }
-  }
-
-//rutina para ordenar (metodo de la burbuja)
-//ordena de acuerdo a ia[] y modifica aa[] and jatmp[]
-  T aux_aa;
-  size_type aux_ia;
-  size_type aux_ja;
-
-  for( size_type j=Nnze-1 ; j > 0 ; j-- ){
-    for( size_type i=0 ; i < j ; ++i ){
-      if ( ia[i] > ia[i+1] ){
-        aux_ia = ia[i];
-        aux_aa = aa[i];
-        aux_ja = ja_starO[i];
-
-        ia[i] = ia[i+1];
-        aa[i] = aa[i+1];
-        ja_starO[i] = ja_starO[i+1];
-
-        ia[i+1]    = aux_ia;
-        aa[i+1]    = aux_aa;
-        ja_starO[i+1] = aux_ja;
-      }
-    }
-  }
-
-  ja.resize( Nrow + 1 );
-  ja[0] = 1;
-  size_type  j = 0;
-  size_type  l = 1;
-  for( size_type i=0 ; i < Nrow+1 ; ++i){
-    while( i+1 == ia[j] ){
-      ++j;
+  // Counting sort by rows, O(Nnze + Nrow):
+  std::vector<IndexType> ja_t( Nrow+1, 0 );
+  std::vector<IndexType> ia_t( Nnze );
+  std::vector<T> aa_t( Nnze );
+
+  for( size_type k=0 ; k < Nnze ; ++k ) ++ja_t[ ia[k]+1 ];
+  for( size_type i=0 ; i < Nrow ; ++i ) ja_t[i+1] += ja_t[i];
+
+  std::vector<IndexType> next( ja_t.begin(), ja_t.end()-1 );
+  for( size_type j=0 ; j < Ncol ; ++j ){
+    for( size_type k=ja[j] ; k < (size_type)ja[j+1] ; ++k ){
+      size_type pos = next[ ia[k] ]++;
+      ia_t[pos] = j;
+      aa_t[pos] = aa[k];
     }
-    ja[l] = j+1;
-    ++l;
   }
 
-  ia.resize( Nnze );
-  for( size_type i=0 ; i < Nnze ; ++i ){
-    ia[i] = ja_starO[i];
-  }
-
-  Nrow = NrowT;
-  Ncol = NcolT;
-
+  ja.swap(ja_t);
+  ia.swap(ia_t);
+  aa.swap(aa_t);
+  std::swap(Nrow, Ncol);
 }
 
 /**
@@ -548,8 +590,8 @@ template <typename T>
  * Makes equal to zero every element below given factor.
  * \param factor Reference value for cleaning.
  */
-template <typename T>
-    void Type_csc<T>::cleanBelow(const double factor)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::cleanBelow(const double factor)
 {
   for (size_type i=0; i<this->Nnze; ++i){
     if (std::abs(this->aa[i]) < factor) this->aa[i] = static_cast<T>(0);
@@ -563,8 +605,12 @@ template <typename T>
  *
  * \param input_file Name of the file to be read.
  */
-template <typename T> 
-void Type_csc<T>::read_mm_file(const char* input_file)
+template <typename T, typename IndexType>
+#ifndef HAVE_GMM
+void Type_csc<T,IndexType>::read_mm_file(const char*)
+#else
+void Type_csc<T,IndexType>::read_mm_file(const char* input_file)
+#endif
 {
 #ifndef HAVE_GMM
   std::stringstream message;
@@ -591,12 +637,11 @@ void Type_csc<T>::read_mm_file(const char* input_file)
   Ncol = cscmat.nc;
   Nrow = cscmat.nr;
   for (size_type j = 0; j<Ncol+1; ++j){
-    ja.push_back( cscmat.jc[j]+1 );
+    ja.push_back( cscmat.jc[j] );
   }
-  cout << ja.size();
   Nnze = ja[Ncol];
   for (size_type i = 0; i<Nnze; ++i){
-    ia.push_back( cscmat.ir[i]+1 );
+    ia.push_back( cscmat.ir[i] );
     aa.push_back( cscmat.pr[i] );
   }  
 #endif
@@ -609,8 +654,8 @@ void Type_csc<T>::read_mm_file(const char* input_file)
  *
  * \param input_file Name of the file to be read.
  */
-template <typename T> 
-    void Type_csc<T>::read_hb_file(const char* input_file)
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::read_hb_file(const char* input_file)
 {
   int M;
   int N;
@@ -633,11 +678,11 @@ template <typename T>
   
   for(int i = 0 ; i < nonzeros ; ++i){
     aa.push_back(val[i]);
-    ia.push_back(rowind[i]);
+    ia.push_back(rowind[i]-1);
   }
 
   for(int i = 0 ; i < N+1 ; ++i){
-    ja.push_back(colptr[i]);
+    ja.push_back(colptr[i]-1);
   }
 }
 
@@ -647,8 +692,12 @@ template <typename T>
  *
  * \param input_file Name of the file to be read.
  */
-template <typename T> 
-    void Type_csc<T>::write_hb_file(const char* input_file)
+template <typename T, typename IndexType>
+#ifndef HAVE_GMM
+    void Type_csc<T,IndexType>::write_hb_file(const char*)
+#else
+    void Type_csc<T,IndexType>::write_hb_file(const char* input_file)
+#endif
 {
 #ifndef HAVE_GMM
   std::stringstream message;
@@ -673,13 +722,13 @@ template <typename T>
   cscmat.jc = new IND_TYPE[cscmat.nc+1];
 
   for (size_type j = 0; j<Ncol+1; ++j){
-    cscmat.jc[j] = ja[j]-1;
+    cscmat.jc[j] = ja[j];
   }
   
   cscmat.pr = new T[cscmat.jc[cscmat.nc]];
   cscmat.ir = new IND_TYPE[cscmat.jc[cscmat.nc]];
   for (size_type i = 0; i<Nnze; ++i){
-    cscmat.ir[i] = ia[i]-1;
+    cscmat.ir[i] = ia[i];
     cscmat.pr[i] = aa[i];
   }
 
@@ -695,67 +744,53 @@ template <typename T>
  * \param ncolumns Column index.
  * @return TRUE if the element exists in internal storage structure.
  */
-template <typename T> 
-    bool Type_csc<T>::exists( size_type mrows, size_type ncolumns )
+template <typename T, typename IndexType>
+    bool Type_csc<T,IndexType>::exists( size_type mrows, size_type ncolumns )
 {
-  if(ja[ncolumns]==ja[ncolumns+1]){
-    return 0;
-  }
-  else{
-    if(mrows+1>ia[ja[ncolumns+1]-2]){
-      return 0;
-    }
-    else{
-      for (size_type i=ja[ncolumns];i<ja[ncolumns+1];++i){
-        if (mrows+1==ia[i-1]){
-          return 1;
-        }
-      }
-      return 0;
-    }
-  }
+  return this->find(mrows, ncolumns) != Nnze;
 }
 
 /**
  * Prepares the sparse structure of a CSC matrix.
+ * The pattern is given with one based (Harwell-Boeing) indices.
  * @param row_index CSC row indices.
  * @param col_index CSC columns indices.
  */
-template <typename T> 
-    void Type_csc<T>::setSparsePattern( Vector<size_type>& row_index,
-                                        Vector<size_type>& col_index 
-                                      )
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::setSparsePattern( Vector<size_type>& row_index,
+                                                  Vector<size_type>& col_index
+                                                )
 {
-  int i;
+  size_type i;
   ia.clear();
   ja.clear();
   aa.clear();
   for (i=0; i<row_index.size(); ++i ){
-    ia.push_back( row_index(i) );
+    ia.push_back( row_index(i)-1 );
     aa.push_back( T(0) );
   }
-  for (i=0; i<col_index.size(); ++i ) ja.push_back( col_index(i) );
+  for (i=0; i<col_index.size(); ++i ) ja.push_back( col_index(i)-1 );
+  Nnze = aa.size();
 }
 
 /**
  * Prepares the sparse structure of a CSC matrix.
+ * The pattern is given with one based (Harwell-Boeing) indices.
  * @param row_index CSC row indices.
  * @param col_index CSC columns indices.
  */
-template <typename T> 
-    void Type_csc<T>::setSparsePattern( std::vector<size_type>& row_index, 
-                                        std::vector<size_type>& col_index 
-                                      )
+template <typename T, typename IndexType>
+    void Type_csc<T,IndexType>::setSparsePattern( std::vector<size_type>& row_index,
+                                                  std::vector<size_type>& col_index
+                                                )
 {
-  int i;
-  ia.clear();
-  ja.clear();
-  aa.clear();
-  ia = row_index;
-  for (i=0; i<row_index.size(); ++i ){
-    aa.push_back( T(0) );
-  }
-  ja = col_index;
+  size_type i;
+  ia.resize( row_index.size() );
+  ja.resize( col_index.size() );
+  aa.assign( row_index.size(), T(0) );
+  for (i=0; i<row_index.size(); ++i ) ia[i] = row_index[i]-1;
+  for (i=0; i<col_index.size(); ++i ) ja[i] = col_index[i]-1;
+  Nnze = aa.size();
 }
 };
 
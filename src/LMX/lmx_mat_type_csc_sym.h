@@ -0,0 +1,640 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXTYPE_CSC_SYM_H
+#define LMXTYPE_CSC_SYM_H
+
+#include <algorithm>
+#include "lmx_mat_data_mat.h"
+#include "lmx_mat_type_csc.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_type_csc_sym.h
+
+      \brief This file contains both the declaration and implementation for Type_csc_sym class member functions.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx {
+
+  /**
+    \class Type_csc_sym
+
+    \brief Symmetric matrix in Compressed Storage by Columns, lower triangle only.
+
+    Only the elements with row >= column are stored, using the same zero
+    based arrays as Type_csc: the elements of column j are
+    aa[ja[j]] ... aa[ja[j+1]-1], with their rows in ia[] in increasing order
+    (so the diagonal, when present, is the first element of the column).
+    Reading or writing an element of the upper triangle accesses its
+    symmetric one.
+
+    Additions to the strict upper triangle (addElement(), "+=" and "-=" on
+    Matrix elements) are discarded, so a full symmetric element matrix can be
+    assembled as in any other type without counting the off diagonal terms
+    twice. Operations whose result is not symmetric (equals() or multiply()
+    with non symmetric operands) keep only the lower triangle.
+
+    \param IndexType Integer type of ia[] and ja[], defaults to LMX_CSC_INDEX.
+
+    \author Daniel Iglesias Ib��ez
+  */
+template <typename T, typename IndexType> class Type_csc_sym : public Data_mat<T>
+{
+  // Public for the same reason as in Type_csc (lmx_mat_data_blas.h functions).
+public:
+  std::vector<T>     aa; /**< Matrix data contents. */
+  std::vector<IndexType> ia; /**< Row indexer. */
+  std::vector<IndexType> ja; /**< Column pointer (size Ncol+1). */
+  size_type Nnze; /**< Number of non-zero values. */
+  size_type Nrow; /**< Number of rows. */
+  size_type Ncol; /**< Number of columns. */
+
+private:
+  T zero;
+
+  size_type find( size_type, size_type ) const;
+
+  void check_square( size_type, size_type ) const;
+
+public:
+  Type_csc_sym();
+
+  Type_csc_sym(size_type rows, size_type columns);
+
+  ~Type_csc_sym();
+
+  void resize(size_type, size_type);
+
+  const T& readElement(const size_type& mrows, const size_type& ncolumns) const;
+
+  void writeElement(T value, size_type mrows, size_type ncolumns);
+
+  void addElement(T value, size_type mrows, size_type ncolumns);
+
+  T* create_element(size_type, size_type);
+
+  /** Method for knowing the number of data rows.
+   * \returns Number of rows.
+   */
+  size_type getRows() const
+  { return this->Nrow; }
+
+  /** Method for knowing the number of data columns.
+   * \returns Number of columns.
+   */
+  size_type getCols() const
+  { return this->Ncol; }
+
+  void equals(const Data<T>* matrix_in);
+
+  void add(const Data<T>* matrix_in_1);
+
+  void substract(const Data<T>* matrix_in_1);
+
+  void multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2);
+
+  void multiplyScalar(const T&);
+
+  void multiplyElements(const Data<T>* matrix_in);
+
+  void trn();
+
+  void cleanBelow(const double factor);
+
+  void read_mm_file(const char* input_file);
+
+  void read_hb_file(const char* input_file);
+
+  void write_hb_file(const char* input_file);
+
+  bool exists( size_type, size_type );
+
+  void setSparsePattern( std::vector<size_type>&, std::vector<size_type>& );
+
+  void expand( Type_csc<T,IndexType>& ) const;
+};
+
+
+/// Empty constructor.
+template <typename T, typename IndexType>
+    Type_csc_sym<T,IndexType>::Type_csc_sym() : Nnze(0), Nrow(0), Ncol(0)
+{
+  ja.push_back( 0 );
+  zero = 0;
+}
+
+/**
+ * Standard constructor.
+ * Creates a new object with parameter contents resized to (rows, columns) dimension.
+ * \param rows Rows of matrix.
+ * \param columns Columns of matrix, must be equal to rows.
+ */
+template <typename T, typename IndexType>
+    Type_csc_sym<T,IndexType>::Type_csc_sym(size_type rows, size_type columns)
+  : Data_mat<T>(), Nnze(0), Nrow(0), Ncol(0)
+{
+  ja.push_back( 0 );
+  this->resize(rows,columns);
+  zero = 0;
+}
+
+/// Destructor.
+template <typename T, typename IndexType>
+    Type_csc_sym<T,IndexType>::~Type_csc_sym()
+{
+}
+
+/**
+ * Throws a dimension_error if the dimensions given are not those of a square matrix.
+ * \param mrows Number of rows.
+ * \param ncolumns Number of columns.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::check_square( size_type mrows, size_type ncolumns ) const
+{
+  if( mrows != ncolumns ){
+    std::stringstream message;
+    message << "Symmetric sparse matrix (Type_csc_sym) must be square.\n"
+        << "Dimension requested: (" << mrows << "," << ncolumns << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+}
+
+/**
+ * Position of element (mrows, ncolumns) in aa[] and ia[], mrows >= ncolumns.
+ * Binary search over the (sorted) rows of the column.
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * \return Position of element if it exists, Nnze otherwise.
+ */
+template <typename T, typename IndexType>
+    size_type Type_csc_sym<T,IndexType>::find( size_type mrows, size_type ncolumns ) const
+{
+  typename std::vector<IndexType>::const_iterator first = ia.begin() + ja[ncolumns];
+  typename std::vector<IndexType>::const_iterator last = ia.begin() + ja[ncolumns+1];
+  typename std::vector<IndexType>::const_iterator it
+      = std::lower_bound(first, last, static_cast<IndexType>(mrows));
+  if ( it != last && static_cast<size_type>(*it) == mrows ) return it - ia.begin();
+  return Nnze;
+}
+
+/**
+ * Resize method.
+ * Changes the size of the sparse matrix, removing the elements that are left outside.
+ * \param mrows New value for rows of matrix.
+ * \param ncolumns New value for columns of matrix, must be equal to mrows.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::resize(size_type mrows, size_type ncolumns)
+{
+  check_square( mrows, ncolumns );
+
+  if( mrows < Nrow ){ // compact, dropping rows and columns >= mrows
+    size_type pos = 0;
+    size_type col_begin = 0;
+    for( size_type j=0 ; j < mrows ; ++j ){
+      for( size_type k=col_begin ; k < static_cast<size_type>(ja[j+1]) ; ++k ){
+        if( static_cast<size_type>(ia[k]) < mrows ){
+          ia[pos] = ia[k];
+          aa[pos] = aa[k];
+          ++pos;
+        }
+      }
+      col_begin = ja[j+1];
+      ja[j+1] = pos;
+    }
+    ja.resize(mrows+1);
+    aa.resize(pos);
+    ia.resize(pos);
+    Nnze = pos;
+  }
+  else if( mrows > Nrow ){
+    ja.resize(mrows+1, static_cast<IndexType>(Nnze) );
+  }
+  Nrow = mrows;
+  Ncol = ncolumns;
+}
+
+/**
+ * Read element method.
+ * Elements of the upper triangle are read from their symmetric position.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ * \return Value of the element in the position given by the parameters.
+ */
+template <typename T, typename IndexType>
+    const T& Type_csc_sym<T,IndexType>::readElement(const size_type& mrows, const size_type& ncolumns) const
+{
+  size_type pos = ( mrows < ncolumns ) ? this->find(ncolumns, mrows)
+                                       : this->find(mrows, ncolumns);
+  if( pos == Nnze ) return zero;
+  return aa[pos];
+}
+
+/**
+ * Write element method.
+ * Writes both the element and its symmetric one. Null values are only
+ * stored if the position already exists in the matrix.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ * \param value Numerical type value.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::writeElement(T value, size_type mrows, size_type ncolumns)
+{
+  if( mrows < ncolumns ) std::swap( mrows, ncolumns );
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos != Nnze ) aa[pos] = value;
+  else if( value != T(0) ) *(this->create_element(mrows, ncolumns) ) = value;
+}
+
+/**
+ * Add element method.
+ * Adds value to the element (mrows, ncolumns) of the lower triangle.
+ * Values given for the strict upper triangle are discarded, as they are
+ * expected to be added to the symmetric position too.
+ * \param value Numerical type value.
+ * \param mrows Row position in matrix.
+ * \param ncolumns Column position in matrix.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::addElement(T value, size_type mrows, size_type ncolumns)
+{
+  if( mrows < ncolumns ) return;
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos != Nnze ) aa[pos] += value;
+  else if( value != T(0) ) *(this->create_element(mrows, ncolumns) ) = value;
+}
+
+/**
+ * Create element method.
+ * Implements a method for creating a new data position in the lower triangle.
+ * \param mrows Row position in matrix, mrows >= ncolumns.
+ * \param ncolumns Column position in matrix.
+ * \return A pointer to the element in the position given by the parameters.
+ */
+template <typename T, typename IndexType>
+    T* Type_csc_sym<T,IndexType>::create_element( size_type mrows, size_type ncolumns)
+{
+  size_type pos = std::lower_bound( ia.begin() + ja[ncolumns],
+                                    ia.begin() + ja[ncolumns+1],
+                                    static_cast<IndexType>(mrows) ) - ia.begin();
+  if( pos < static_cast<size_type>(ja[ncolumns+1])
+      && static_cast<size_type>(ia[pos]) == mrows ) return &( aa[pos] );
+
+  aa.insert( aa.begin()+pos, T(0) );
+  ia.insert( ia.begin()+pos, static_cast<IndexType>(mrows) );
+  for( size_type j=ncolumns+1 ; j < Ncol+1 ; ++j ) ++ja[j];
+  ++Nnze;
+  return &( aa[pos] );
+}
+
+/**
+ * Copy method.
+ * Equals the data in the object's contents to the lower triangle of the input matrix parameter.
+ * \param matrix_in pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::equals(const Data<T>* matrix_in)
+{
+  const Type_csc_sym* sym_in = dynamic_cast<const Type_csc_sym*>(matrix_in);
+  const Type_csc<T,IndexType>* csc_in = dynamic_cast<const Type_csc<T,IndexType>*>(matrix_in);
+  if( sym_in ){
+    aa = sym_in->aa;
+    ia = sym_in->ia;
+    ja = sym_in->ja;
+    Nrow = sym_in->Nrow;
+    Ncol = sym_in->Ncol;
+    Nnze = sym_in->Nnze;
+  }
+  else if( csc_in ){ // filter the upper triangle out
+    check_square( csc_in->Nrow, csc_in->Ncol );
+    aa.clear();
+    ia.clear();
+    ja.assign(1, 0);
+    for( size_type j=0 ; j < csc_in->Ncol ; ++j ){
+      for( IndexType k=csc_in->ja[j] ; k < csc_in->ja[j+1] ; ++k ){
+        if( static_cast<size_type>(csc_in->ia[k]) >= j ){
+          aa.push_back( csc_in->aa[k] );
+          ia.push_back( csc_in->ia[k] );
+        }
+      }
+      ja.push_back( static_cast<IndexType>( aa.size() ) );
+    }
+    Nrow = csc_in->Nrow;
+    Ncol = csc_in->Ncol;
+    Nnze = aa.size();
+  }
+  else{ // Column by column, appending at the end
+    size_type rows = matrix_in->getRows();
+    size_type cols = matrix_in->getCols();
+    check_square( rows, cols );
+    T value;
+    aa.clear();
+    ia.clear();
+    ja.assign(1, 0);
+    for( size_type j=0 ; j < cols ; ++j ){
+      for( size_type i=j ; i < rows ; ++i ){
+        value = matrix_in->readElement(i,j);
+        if( value != T(0) ){
+          aa.push_back( value );
+          ia.push_back( static_cast<IndexType>(i) );
+        }
+      }
+      ja.push_back( static_cast<IndexType>( aa.size() ) );
+    }
+    Nrow = rows;
+    Ncol = cols;
+    Nnze = aa.size();
+  }
+}
+
+/**
+ * Add method.
+ * Adds the lower triangle of the input matrix parameter to the object's contents.
+ * Necessary for overloading the "+=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::add(const Data<T>* matrix_in_1)
+{
+  const Type_csc_sym* sym_in = dynamic_cast<const Type_csc_sym*>(matrix_in_1);
+  if( sym_in ){ // only the stored elements of the operand
+    for( size_type j=0 ; j < Ncol ; ++j ){
+      for( IndexType k=sym_in->ja[j] ; k < sym_in->ja[j+1] ; ++k ){
+        *(this->create_element( sym_in->ia[k] , j ) ) += sym_in->aa[k];
+      }
+    }
+  }
+  else{
+    for( size_type j=0 ; j < Ncol ; ++j ){
+      for( size_type i=j ; i < Nrow ; ++i ){
+        this->addElement( matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Substract method.
+ * Substracts the lower triangle of the input matrix parameter to the object's contents.
+ * Necessary for overloading the "-=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::substract(const Data<T>* matrix_in_1)
+{
+  const Type_csc_sym* sym_in = dynamic_cast<const Type_csc_sym*>(matrix_in_1);
+  if( sym_in ){ // only the stored elements of the operand
+    for( size_type j=0 ; j < Ncol ; ++j ){
+      for( IndexType k=sym_in->ja[j] ; k < sym_in->ja[j+1] ; ++k ){
+        *(this->create_element( sym_in->ia[k] , j ) ) -= sym_in->aa[k];
+      }
+    }
+  }
+  else{
+    for( size_type j=0 ; j < Ncol ; ++j ){
+      for( size_type i=j ; i < Nrow ; ++i ){
+        this->addElement( -matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Multiply method.
+ * Multiplies the input matrices and saves the lower triangle of the result
+ * into the object's contents.
+ * Necessary for overloading the "*" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ * \param matrix_in_2 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
+{
+// this = tril( matrix_in_1 * matrix_in_2 )
+  T val_mult;
+  size_type rows = matrix_in_1->getRows();
+  size_type cols = matrix_in_2->getCols();
+  check_square( rows, cols );
+
+  aa.clear();
+  ia.clear();
+  ja.assign(1, 0);
+  for( size_type j=0 ; j < cols ; ++j ){
+    for( size_type i=j ; i < rows ; ++i ){
+      val_mult = 0;
+      for( size_type k=0 ; k < matrix_in_1->getCols() ; ++k ){
+        val_mult += matrix_in_1->readElement( i , k ) * matrix_in_2->readElement( k , j );
+      }
+      if( val_mult != T(0) ){
+        aa.push_back( val_mult );
+        ia.push_back( static_cast<IndexType>(i) );
+      }
+    }
+    ja.push_back( static_cast<IndexType>( aa.size() ) );
+  }
+  Nrow = rows;
+  Ncol = cols;
+  Nnze = aa.size();
+}
+
+/**
+ * Multiply scalar method.
+ * Multiplies the object's matrix (contents) with a scalar.
+ * Necessary for overloading the "*" operator.
+ * \param scalar A scalar factor of template's class.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::multiplyScalar(const T& scalar)
+{
+  for( size_type k=0 ; k < Nnze ; ++k ) aa[k] *= scalar;
+}
+
+/**
+ * Method multiplying element-by-element of two matrices.
+ * One would be the object's contents and the other the parameter's contents.
+ * Only the stored elements are visited.
+ *
+ * \param matrix_in pointer to an object that belongs to a class derived from Data.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::multiplyElements(const Data<T>* matrix_in)
+{
+  for( size_type j=0 ; j < Ncol ; ++j ){
+    for( IndexType k=ja[j] ; k < ja[j+1] ; ++k ){
+      aa[k] *= matrix_in->readElement( ia[k] , j );
+    }
+  }
+}
+
+/**
+ * Traspose method.
+ * Nothing to do, the matrix is symmetric.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::trn()
+{
+}
+
+/**
+ * Clean below method.
+ * Makes equal to zero every element below given factor.
+ * \param factor Reference value for cleaning.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::cleanBelow(const double factor)
+{
+  for (size_type i=0; i<this->Nnze; ++i){
+    if (std::abs(this->aa[i]) < factor) this->aa[i] = static_cast<T>(0);
+  }
+}
+
+/**
+ * Read data in Matrix Market format method.
+ * The matrix is read as a Type_csc and its lower triangle is kept.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T, typename IndexType>
+void Type_csc_sym<T,IndexType>::read_mm_file(const char* input_file)
+{
+  Type_csc<T,IndexType> full;
+  full.read_mm_file(input_file);
+  this->equals(&full);
+}
+
+/**
+ * Read data in Harwell-Boeing format method.
+ * The matrix is read as a Type_csc and its lower triangle is kept.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::read_hb_file(const char* input_file)
+{
+  Type_csc<T,IndexType> full;
+  full.read_hb_file(input_file);
+  this->equals(&full);
+}
+
+/**
+ * Write data in Harwell-Boeing format method.
+ * Both triangles are written, see expand().
+ *
+ * \param input_file Name of the file to be written.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::write_hb_file(const char* input_file)
+{
+  Type_csc<T,IndexType> full;
+  this->expand(full);
+  full.write_hb_file(input_file);
+}
+
+/**
+ * Returns TRUE or FALSE depending of element existance.
+ *
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * @return TRUE if the element or its symmetric exists in internal storage structure.
+ */
+template <typename T, typename IndexType>
+    bool Type_csc_sym<T,IndexType>::exists( size_type mrows, size_type ncolumns )
+{
+  if( mrows < ncolumns ) std::swap( mrows, ncolumns );
+  return this->find(mrows, ncolumns) != Nnze;
+}
+
+/**
+ * Prepares the sparse structure of the matrix.
+ * The pattern is given in the same (one based, Harwell-Boeing) form used by
+ * Type_csc, and may describe the full matrix or only its lower triangle:
+ * the positions of the strict upper triangle are skipped.
+ * @param row_index CSC row indices.
+ * @param col_index CSC columns indices.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::setSparsePattern( std::vector<size_type>& row_index,
+                                                      std::vector<size_type>& col_index
+                                                    )
+{
+  size_type ncols = col_index.size() - 1;
+  ia.clear();
+  ja.assign(1, 0);
+  for( size_type j=0 ; j < ncols ; ++j ){
+    for( size_type k=col_index[j]-1 ; k < col_index[j+1]-1 ; ++k ){
+      if( row_index[k]-1 >= j ) ia.push_back( static_cast<IndexType>(row_index[k]-1) );
+    }
+    ja.push_back( static_cast<IndexType>( ia.size() ) );
+  }
+  Nnze = ia.size();
+  aa.assign( Nnze, T(0) );
+  Nrow = Ncol = std::max( Ncol, ncols );
+  ja.resize( Ncol+1, static_cast<IndexType>(Nnze) );
+}
+
+/**
+ * Builds the full (both triangles) Type_csc matrix.
+ * The columns are filled in increasing order, so the element (j,i) of the
+ * upper triangle is appended to column i before its lower elements and the
+ * rows of every column come out sorted.
+ * @param full Matrix to write to.
+ */
+template <typename T, typename IndexType>
+    void Type_csc_sym<T,IndexType>::expand( Type_csc<T,IndexType>& full ) const
+{
+  std::vector<IndexType> count( Ncol+1, 0 );
+  for( size_type j=0 ; j < Ncol ; ++j ){
+    count[j+1] += ja[j+1] - ja[j];
+    for( IndexType k=ja[j] ; k < ja[j+1] ; ++k )
+      if( static_cast<size_type>(ia[k]) != j ) ++count[ ia[k]+1 ];
+  }
+  for( size_type j=0 ; j < Ncol ; ++j ) count[j+1] += count[j];
+
+  full.Nrow = Nrow;
+  full.Ncol = Ncol;
+  full.Nnze = count[Ncol];
+  full.ja = count;
+  full.ia.resize( full.Nnze );
+  full.aa.resize( full.Nnze );
+
+  for( size_type j=0 ; j < Ncol ; ++j ){
+    for( IndexType k=ja[j] ; k < ja[j+1] ; ++k ){
+      size_type i = ia[k];
+      full.ia[ count[j] ] = static_cast<IndexType>(i);
+      full.aa[ count[j]++ ] = aa[k];
+      if( i != j ){
+        full.ia[ count[i] ] = static_cast<IndexType>(j);
+        full.aa[ count[i]++ ] = aa[k];
+      }
+    }
+  }
+}
+
+};
+
+
+#endif
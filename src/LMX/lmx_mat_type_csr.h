@@ -0,0 +1,649 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXTYPE_CSR_H
+#define LMXTYPE_CSR_H
+
+#include <algorithm>
+#include "lmx_mat_data_mat.h"
+#include "lmx_base_iohb.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_type_csr.h
+
+      \brief This file contains both the declaration and implementation for Type_csr class member functions.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx {
+
+  /**
+    \class Type_csr
+
+    \brief Compressed Storaged by Rows matrix.
+
+    Row oriented counterpart of Type_csc. All the indices are zero based: the
+    elements of row i are aa[ia[i]] ... aa[ia[i+1]-1], and their column
+    positions are stored in ja[] in increasing order. Each row of the
+    matrix-vector product only writes its own result, so it can be
+    computed in parallel without atomics.
+
+    \author Daniel Iglesias Ib��ez
+  */
+template <typename T> class Type_csr : public Data_mat<T>
+{
+  // Public for the same reason as in Type_csc (lmx_mat_data_blas.h functions).
+public:
+  std::vector<T>     aa; /**< Matrix data contents. */
+  std::vector<size_type> ia; /**< Row pointer (size Nrow+1). */
+  std::vector<size_type> ja; /**< Column indexer. */
+  size_type Nnze; /**< Number of non-zero values. */
+  size_type Nrow; /**< Number of rows. */
+  size_type Ncol; /**< Number of columns. */
+
+private:
+  T zero;
+
+  size_type find( size_type, size_type ) const;
+
+public:
+  Type_csr();
+
+  Type_csr(size_type rows, size_type columns);
+
+  ~Type_csr();
+
+  void resize(size_type, size_type);
+
+  const T& readElement(const size_type& mrows, const size_type& ncolumns) const;
+
+  void writeElement(T value, size_type mrows, size_type ncolumns);
+
+  T* create_element(size_type, size_type);
+
+  /** Method for knowing the number of data rows.
+   * \returns Number of rows.
+   */
+  size_type getRows() const
+  { return this->Nrow; }
+
+  /** Method for knowing the number of data columns.
+   * \returns Number of columns.
+   */
+  size_type getCols() const
+  { return this->Ncol; }
+
+  void equals(const Data<T>* matrix_in);
+
+  void add(const Data<T>* matrix_in_1);
+
+  void substract(const Data<T>* matrix_in_1);
+
+  void multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2);
+
+  void multiplyScalar(const T&);
+
+  void multiplyElements(const Data<T>* matrix_in);
+
+  void trn();
+
+  void cleanBelow(const double factor);
+
+  void read_mm_file(const char* input_file);
+
+  void read_hb_file(const char* input_file);
+
+  void write_hb_file(const char* input_file);
+
+  bool exists( size_type, size_type );
+
+  void setSparsePattern( std::vector<size_type>&, std::vector<size_type>& );
+};
+
+
+/// Empty constructor.
+template <typename T>
+    Type_csr<T>::Type_csr() : Nnze(0), Nrow(0), Ncol(0)
+{
+  ia.push_back( 0 );
+  zero = 0;
+}
+
+/**
+ * Standard constructor.
+ * Creates a new object with parameter contents resized to (rows, columns) dimension.
+ * \param rows Rows of CSR matrix.
+ * \param columns Columns of CSR matrix.
+ */
+template <typename T>
+    Type_csr<T>::Type_csr(size_type rows, size_type columns)
+  : Data_mat<T>(), Nnze(0), Nrow(0), Ncol(0)
+{
+  ia.push_back( 0 );
+  this->resize(rows,columns);
+  zero = 0;
+}
+
+/// Destructor.
+template <typename T>
+    Type_csr<T>::~Type_csr()
+{
+}
+
+/**
+ * Position of element (mrows, ncolumns) in aa[] and ja[].
+ * Binary search over the (sorted) columns of the row.
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * \return Position of element if it exists, Nnze otherwise.
+ */
+template <typename T>
+    size_type Type_csr<T>::find( size_type mrows, size_type ncolumns ) const
+{
+  typename std::vector<size_type>::const_iterator first = ja.begin() + ia[mrows];
+  typename std::vector<size_type>::const_iterator last = ja.begin() + ia[mrows+1];
+  typename std::vector<size_type>::const_iterator it = std::lower_bound(first, last, ncolumns);
+  if ( it != last && *it == ncolumns ) return it - ja.begin();
+  return Nnze;
+}
+
+/**
+ * Resize method.
+ * Changes the size of the sparse matrix, removing the elements that are left outside.
+ * \param mrows New value for rows of matrix.
+ * \param ncolumns New value for columns of matrix.
+ */
+template <typename T>
+    void Type_csr<T>::resize(size_type mrows, size_type ncolumns)
+{
+  if( ncolumns < Ncol ){ // compact, dropping columns >= ncolumns
+    size_type pos = 0;
+    size_type row_begin = 0;
+    for( size_type i=0 ; i < Nrow ; ++i ){
+      for( size_type k=row_begin ; k < ia[i+1] ; ++k ){
+        if( ja[k] < ncolumns ){
+          ja[pos] = ja[k];
+          aa[pos] = aa[k];
+          ++pos;
+        }
+      }
+      row_begin = ia[i+1];
+      ia[i+1] = pos;
+    }
+    aa.resize(pos);
+    ja.resize(pos);
+    Nnze = pos;
+  }
+  Ncol = ncolumns;
+
+  if( mrows < Nrow ){
+    Nnze = ia[mrows];
+    aa.resize(Nnze);
+    ja.resize(Nnze);
+    ia.resize(mrows+1);
+  }
+  else if( mrows > Nrow ){
+    ia.resize(mrows+1, Nnze);
+  }
+  Nrow = mrows;
+}
+
+/**
+ * Read element method.
+ * Implements a method for reading data of the CSR matrix.
+ * \param mrows Row position in CSR matrix.
+ * \param ncolumns Column position in CSR matrix.
+ * \return Value of the element in the position given by the parameters.
+ */
+template <typename T>
+    const T& Type_csr<T>::readElement(const size_type& mrows, const size_type& ncolumns) const
+{
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos == Nnze ) return zero;
+  return aa[pos];
+}
+
+/**
+ * Write element method.
+ * Implements a method for writing data on the CSR matrix. Null values are
+ * only stored if the position already exists in the matrix.
+ * \param mrows Row position in CSR matrix.
+ * \param ncolumns Column position in CSR matrix.
+ * \param value Numerical type value.
+ */
+template <typename T>
+    void Type_csr<T>::writeElement(T value, size_type mrows, size_type ncolumns)
+{
+  size_type pos = this->find(mrows, ncolumns);
+  if( pos != Nnze ) aa[pos] = value;
+  else if( value != T(0) ) *(this->create_element(mrows, ncolumns) ) = value;
+}
+
+/**
+ * Create element method.
+ * Implements a method for creating a new data position in matrix.
+ * \param mrows Row position in CSR matrix.
+ * \param ncolumns Column position in CSR matrix.
+ * \return A pointer to the element in the position given by the parameters.
+ */
+template <typename T>
+    T* Type_csr<T>::create_element( size_type mrows, size_type ncolumns)
+{
+  size_type pos = std::lower_bound( ja.begin() + ia[mrows],
+                                    ja.begin() + ia[mrows+1],
+                                    ncolumns ) - ja.begin();
+  if( pos < ia[mrows+1] && ja[pos] == ncolumns ) return &( aa[pos] );
+
+  aa.insert( aa.begin()+pos, T(0) );
+  ja.insert( ja.begin()+pos, ncolumns );
+  for( size_type i=mrows+1 ; i < Nrow+1 ; ++i ) ++ia[i];
+  ++Nnze;
+  return &( aa[pos] );
+}
+
+/**
+ * Copy method.
+ * Equals the data in the object's contents to those given by the input matrix parameter.
+ * \param matrix_in pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T>
+    void Type_csr<T>::equals(const Data<T>* matrix_in)
+{
+  const Type_csr* csr_in = dynamic_cast<const Type_csr*>(matrix_in);
+  if( csr_in ){
+    aa = csr_in->aa;
+    ia = csr_in->ia;
+    ja = csr_in->ja;
+    Nrow = csr_in->Nrow;
+    Ncol = csr_in->Ncol;
+    Nnze = csr_in->Nnze;
+  }
+  else{ // Row by row, appending at the end
+    size_type rows = matrix_in->getRows();
+    size_type cols = matrix_in->getCols();
+    T value;
+    aa.clear();
+    ja.clear();
+    ia.assign(1, 0);
+    for( size_type i=0 ; i < rows ; ++i ){
+      for( size_type j=0 ; j < cols ; ++j ){
+        value = matrix_in->readElement(i,j);
+        if( value != T(0) ){
+          aa.push_back( value );
+          ja.push_back( j );
+        }
+      }
+      ia.push_back( aa.size() );
+    }
+    Nrow = rows;
+    Ncol = cols;
+    Nnze = aa.size();
+  }
+}
+
+/**
+ * Add method.
+ * Adds the the input matrix parameter's elements to the object's contents.
+ * Necessary for overloading the "+=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T>
+    void Type_csr<T>::add(const Data<T>* matrix_in_1)
+{
+  const Type_csr* csr_in = dynamic_cast<const Type_csr*>(matrix_in_1);
+  if( csr_in ){ // only the stored elements of the operand
+    for( size_type i=0 ; i < Nrow ; ++i ){
+      for( size_type k=csr_in->ia[i] ; k < csr_in->ia[i+1] ; ++k ){
+        *(this->create_element( i , csr_in->ja[k] ) ) += csr_in->aa[k];
+      }
+    }
+  }
+  else{
+    for( size_type i=0 ; i < Nrow ; ++i ){
+      for( size_type j=0 ; j < Ncol ; ++j ){
+        this->writeElement( this->readElement( i , j ) + matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Substract method.
+ * Substracts the the input matrix parameter's elements to the object's contents.
+ * Necessary for overloading the "-=" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T>
+    void Type_csr<T>::substract(const Data<T>* matrix_in_1)
+{
+  const Type_csr* csr_in = dynamic_cast<const Type_csr*>(matrix_in_1);
+  if( csr_in ){ // only the stored elements of the operand
+    for( size_type i=0 ; i < Nrow ; ++i ){
+      for( size_type k=csr_in->ia[i] ; k < csr_in->ia[i+1] ; ++k ){
+        *(this->create_element( i , csr_in->ja[k] ) ) -= csr_in->aa[k];
+      }
+    }
+  }
+  else{
+    for( size_type i=0 ; i < Nrow ; ++i ){
+      for( size_type j=0 ; j < Ncol ; ++j ){
+        this->writeElement( this->readElement( i , j ) - matrix_in_1->readElement( i , j ) , i , j );
+      }
+    }
+  }
+}
+
+/**
+ * Multiply method.
+ * Multiplies the input matrices and saves the result into the object's contents.
+ * Necessary for overloading the "*" operator.
+ * \param matrix_in_1 pointer to an object that belongs to a class derived from Data_mat.
+ * \param matrix_in_2 pointer to an object that belongs to a class derived from Data_mat.
+ */
+template <typename T>
+    void Type_csr<T>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
+{
+// this = matrix_in_1 * matrix_in_2
+  T val_mult;
+  size_type rows = matrix_in_1->getRows();
+  size_type cols = matrix_in_2->getCols();
+
+  aa.clear();
+  ja.clear();
+  ia.assign(1, 0);
+  for( size_type i=0 ; i < rows ; ++i ){
+    for( size_type j=0 ; j < cols ; ++j ){
+      val_mult = 0;
+      for( size_type k=0 ; k < matrix_in_1->getCols() ; ++k ){
+        val_mult += matrix_in_1->readElement( i , k ) * matrix_in_2->readElement( k , j );
+      }
+      if( val_mult != T(0) ){
+        aa.push_back( val_mult );
+        ja.push_back( j );
+      }
+    }
+    ia.push_back( aa.size() );
+  }
+  Nrow = rows;
+  Ncol = cols;
+  Nnze = aa.size();
+}
+
+/**
+ * Multiply scalar method.
+ * Multiplies the object's matrix (contents) with a scalar.
+ * Necessary for overloading the "*" operator.
+ * \param scalar A scalar factor of template's class.
+ */
+template <typename T>
+    void Type_csr<T>::multiplyScalar(const T& scalar)
+{
+  for( size_type k=0 ; k < Nnze ; ++k ) aa[k] *= scalar;
+}
+
+/**
+ * Method multiplying element-by-element of two matrices.
+ * One would be the object's contents and the other the parameter's contents.
+ * Only the stored elements are visited.
+ *
+ * \param matrix_in pointer to an object that belongs to a class derived from Data.
+ */
+template <typename T>
+    void Type_csr<T>::multiplyElements(const Data<T>* matrix_in)
+{
+  for( size_type i=0 ; i < Nrow ; ++i ){
+    for( size_type k=ia[i] ; k < ia[i+1] ; ++k ){
+      aa[k] *= matrix_in->readElement( i , ja[k] );
+    }
+  }
+}
+
+/**
+ * Traspose method.
+ * Swaps elements with respect to the diagonal: A(i,j) = A(j,i).
+ * Uses a counting sort over the columns, so the cost is O(Nnze + Ncol).
+ */
+template <typename T>
+    void Type_csr<T>::trn()
+{
+  std::vector<size_type> ia_t( Ncol+1, 0 );
+  std::vector<size_type> ja_t( Nnze );
+  std::vector<T> aa_t( Nnze );
+
+  for( size_type k=0 ; k < Nnze ; ++k ) ++ia_t[ ja[k]+1 ];
+  for( size_type j=0 ; j < Ncol ; ++j ) ia_t[j+1] += ia_t[j];
+
+  std::vector<size_type> next( ia_t.begin(), ia_t.end()-1 );
+  for( size_type i=0 ; i < Nrow ; ++i ){
+    for( size_type k=ia[i] ; k < ia[i+1] ; ++k ){
+      size_type pos = next[ ja[k] ]++;
+      ja_t[pos] = i;
+      aa_t[pos] = aa[k];
+    }
+  }
+
+  ia.swap(ia_t);
+  ja.swap(ja_t);
+  aa.swap(aa_t);
+  std::swap(Nrow, Ncol);
+}
+
+/**
+ * Clean below method.
+ * Makes equal to zero every element below given factor.
+ * \param factor Reference value for cleaning.
+ */
+template <typename T>
+    void Type_csr<T>::cleanBelow(const double factor)
+{
+  for (size_type i=0; i<this->Nnze; ++i){
+    if (std::abs(this->aa[i]) < factor) this->aa[i] = static_cast<T>(0);
+  }
+}
+
+/**
+ * Read data in Matrix Market format method.
+ * Opens the file specified and reads the matrix's data in it,
+ * suposing it's stored in Matrix Market format.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T>
+#ifndef HAVE_GMM
+void Type_csr<T>::read_mm_file(const char*)
+#else
+void Type_csr<T>::read_mm_file(const char* input_file)
+#endif
+{
+#ifndef HAVE_GMM
+  std::stringstream message;
+  message
+      << "---------------------------------------------\n"
+      << "We are very very sorry but this feature (read_mm_file) requires at the moment the use of \nthe gmm++ library.\n"
+      << "If you really feel that it is important to have the Matrix Market file reading \nas a built in feature, you can post it into our web page:\n"
+      << "w3.mecanica.upm.es/lmx\n"
+      << "Thank you very much for your interest and help in setting our priorities in the \ndevelopment schedule.\n"
+      << "---------------------------------------------\n"
+      << "gmm++ not defined.\nYou must set \"#define HAVE_GMM\" in your file in order to use this library." << endl;
+  LMX_THROW(failure_error, message.str() );
+#else
+  gmm::csr_matrix<double> csrmat;
+  gmm::row_matrix< gmm::wsvector<double> > matrix_loaded;
+  gmm::MatrixMarket_load(input_file, matrix_loaded);
+  gmm::copy(matrix_loaded, csrmat);
+
+  Nrow = csrmat.nr;
+  Ncol = csrmat.nc;
+  ia.assign( csrmat.jc, csrmat.jc + Nrow+1 );
+  Nnze = ia[Nrow];
+  ja.assign( csrmat.ir, csrmat.ir + Nnze );
+  aa.assign( csrmat.pr, csrmat.pr + Nnze );
+#endif
+}
+
+/**
+ * Read data in Harwell-Boeing format method.
+ * Opens the file specified and reads the matrix's data in it,
+ * suposing it's stored in Harwell-Boeing format.
+ * The CSC arrays in the file are read as the transposed CSR matrix, then transposed.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T>
+    void Type_csr<T>::read_hb_file(const char* input_file)
+{
+  int M;
+  int N;
+  int nonzeros;
+  int *colptr;
+  int *rowind;
+  double *val;
+
+  HarwellBoeing_IO h(input_file);
+  h.read(M,N,nonzeros,colptr,rowind,val);
+
+  Nrow = N;
+  Ncol = M;
+  Nnze = nonzeros;
+
+  aa.clear();
+  ja.clear();
+  ia.clear();
+
+  for(int i = 0 ; i < nonzeros ; ++i){
+    aa.push_back(val[i]);
+    ja.push_back(rowind[i]-1);
+  }
+  for(int i = 0 ; i < N+1 ; ++i){
+    ia.push_back(colptr[i]-1);
+  }
+  this->trn();
+}
+
+/**
+ * Write data in Harwell-Boeing format method.
+ * Opens the file specified and writes the matrix's data in it.
+ *
+ * \param input_file Name of the file to be read.
+ */
+template <typename T>
+#ifndef HAVE_GMM
+    void Type_csr<T>::write_hb_file(const char*)
+#else
+    void Type_csr<T>::write_hb_file(const char* input_file)
+#endif
+{
+#ifndef HAVE_GMM
+  std::stringstream message;
+  message
+      << "---------------------------------------------\n"
+      << "We are very very sorry but this feature (write_hb_file) requires at the moment the use of \nthe gmm++ library.\n"
+      << "If you really feel that it is important to have the Matrix Market file reading \nas a built in feature, you can post it into our web page:\n"
+      << "w3.mecanica.upm.es/lmx\n"
+      << "Thank you very much for your interest and help in setting our priorities in the \ndevelopment schedule.\n"
+      << "---------------------------------------------\n"
+      << "gmm++ not defined.\nYou must set \"#define HAVE_GMM\" in your file in order to use this library." << endl;
+  LMX_THROW(failure_error, message.str() );
+#else
+  Type_csr<T> transposed;
+  transposed.equals(this);
+  transposed.trn(); // the rows of the transposed are the columns of this
+
+  typedef unsigned int IND_TYPE;
+  gmm::csc_matrix<T> cscmat;
+
+  if (cscmat.pr) { delete[] cscmat.pr; delete[] cscmat.ir; delete[] cscmat.jc; }
+
+  cscmat.nr = this->Nrow;
+  cscmat.nc = this->Ncol;
+
+  cscmat.jc = new IND_TYPE[cscmat.nc+1];
+  for (size_type j = 0; j<Ncol+1; ++j){
+    cscmat.jc[j] = transposed.ia[j];
+  }
+
+  cscmat.pr = new T[Nnze];
+  cscmat.ir = new IND_TYPE[Nnze];
+  for (size_type i = 0; i<Nnze; ++i){
+    cscmat.ir[i] = transposed.ja[i];
+    cscmat.pr[i] = transposed.aa[i];
+  }
+
+  gmm::Harwell_Boeing_save(input_file, cscmat);
+#endif
+}
+
+/**
+ * Returns TRUE or FALSE depending of element existance.
+ *
+ * \param mrows Row index.
+ * \param ncolumns Column index.
+ * @return TRUE if the element exists in internal storage structure.
+ */
+template <typename T>
+    bool Type_csr<T>::exists( size_type mrows, size_type ncolumns )
+{
+  return this->find(mrows, ncolumns) != Nnze;
+}
+
+/**
+ * Prepares the sparse structure of the matrix.
+ * The pattern is given in the same (one based, Harwell-Boeing) form used by
+ * Type_csc, so the same vectors can be passed to Matrix::sparsePattern
+ * whatever the sparse type selected.
+ * @param row_index CSC row indices.
+ * @param col_index CSC columns indices.
+ */
+template <typename T>
+    void Type_csr<T>::setSparsePattern( std::vector<size_type>& row_index,
+                                        std::vector<size_type>& col_index
+                                      )
+{
+  size_type ncols = col_index.size() - 1;
+  size_type nnze = row_index.size();
+  size_type nrows = Nrow;
+  for( size_type k=0 ; k < nnze ; ++k ) nrows = std::max( nrows, row_index[k] );
+
+  ia.assign( nrows+1, 0 );
+  ja.resize( nnze );
+  aa.assign( nnze, T(0) );
+
+  for( size_type k=0 ; k < nnze ; ++k ) ++ia[ row_index[k] ];
+  for( size_type i=0 ; i < nrows ; ++i ) ia[i+1] += ia[i];
+
+  std::vector<size_type> next( ia.begin(), ia.end()-1 );
+  for( size_type j=0 ; j < ncols ; ++j ){
+    for( size_type k=col_index[j]-1 ; k < col_index[j+1]-1 ; ++k ){
+      ja[ next[ row_index[k]-1 ]++ ] = j;
+    }
+  }
+  Nrow = nrows;
+  Ncol = std::max( Ncol, ncols );
+  Nnze = nnze;
+}
+
+};
+
+
+#endif
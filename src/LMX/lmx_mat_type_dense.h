@@ -0,0 +1,548 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXTYPE_DENSE_H
+#define LMXTYPE_DENSE_H
+
+#include <cstdlib>
+#include <new>
+#include "lmx_mat_data_mat.h"
+#include "lmx_mat_vector.h"
+#include "lmx_base_iohb.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_type_dense.h
+
+      \brief This file contains both the declaration and implementation for Type_dense (contiguous row-major dense matrix) class member functions.
+
+      \author Daniel Iglesias Ib��ez
+
+    */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+/**
+ * Alignment (in bytes) of the Type_dense buffer and of its rows.
+ * Can be overridden at compile time, must be a power of two.
+ */
+#ifndef LMX_DENSE_ALIGN
+#define LMX_DENSE_ALIGN 64
+#endif
+
+namespace lmx {
+
+    /**
+    \class aligned_allocator
+    \brief STL allocator returning LMX_DENSE_ALIGN aligned blocks.
+
+    Used by Type_dense so that the first element of the buffer (and, thanks to the leading dimension, of every row) starts on a cache line boundary.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <typename T> class aligned_allocator
+{
+public:
+  typedef T value_type;
+  typedef T* pointer;
+  typedef const T* const_pointer;
+  typedef T& reference;
+  typedef const T& const_reference;
+  typedef size_t size_type;
+  typedef std::ptrdiff_t difference_type;
+
+  template <typename U> struct rebind { typedef aligned_allocator<U> other; };
+
+  aligned_allocator() {}
+
+  aligned_allocator( const aligned_allocator& ) {}
+
+  template <typename U> aligned_allocator( const aligned_allocator<U>& ) {}
+
+  ~aligned_allocator() {}
+
+  pointer address( reference x ) const { return &x; }
+
+  const_pointer address( const_reference x ) const { return &x; }
+
+  size_type max_size() const { return size_type(-1) / sizeof(T); }
+
+  /** Allocates n elements. The real block is LMX_DENSE_ALIGN bytes longer
+   * and the offset to its start is stored just before the returned address. */
+  pointer allocate( size_type n, const void* = 0 )
+  {
+    if (n == 0) return 0;
+    std::size_t bytes = n * sizeof(T) + LMX_DENSE_ALIGN + sizeof(void*);
+    char* raw = static_cast<char*>( std::malloc(bytes) );
+    if (!raw) throw std::bad_alloc();
+    std::size_t addr = reinterpret_cast<std::size_t>( raw + sizeof(void*) );
+    addr = (addr + LMX_DENSE_ALIGN - 1) & ~(std::size_t)(LMX_DENSE_ALIGN - 1);
+    char* aligned = reinterpret_cast<char*>(addr);
+    reinterpret_cast<void**>(aligned)[-1] = raw;
+    return reinterpret_cast<pointer>(aligned);
+  }
+
+  void deallocate( pointer p, size_type )
+  {
+    if (p) std::free( reinterpret_cast<void**>(p)[-1] );
+  }
+
+  void construct( pointer p, const T& value ) { new( static_cast<void*>(p) ) T(value); }
+
+  void destroy( pointer p ) { p->~T(); }
+
+  bool operator == ( const aligned_allocator& ) const { return true; }
+
+  bool operator != ( const aligned_allocator& ) const { return false; }
+};
+
+
+    /**
+    \class Type_dense
+    \brief Template class Type_dense
+
+    This class implements the methods defined in virtual class data_mat for dense matrices stored in one contiguous, aligned, row-major buffer.
+
+    Element (i,j) is stored in contents[i*ld + j]. The leading dimension (ld) is the number of columns rounded up so that every row starts at an aligned address. Raw pointer and stride access is given by data_pointer() and getLeadingDim() so numerical kernels can run over the buffer without the virtual per-element calls.
+
+    @param contents Corresponds to an aligned std::vector<T> of rows*ld elements.
+
+    @author Daniel Iglesias Ib��ez.
+    */
+template <typename T> class Type_dense : public Data_mat<T>
+{
+private:
+  /** Matrix data contents */
+  size_type rows, cols, ld;
+  std::vector< T, aligned_allocator<T> > contents;
+
+  static size_type computeLeadingDim( size_type ncolumns );
+
+public:
+
+  friend void copy<>( const Type_dense<T>*, Type_csc<T>*);
+
+public:
+  /// Empty constructor.
+  Type_dense() : rows(0), cols(0), ld(0)
+  { }
+
+  Type_dense(size_type, size_type);
+
+  /// Destructor.
+  ~Type_dense()
+  { }
+
+  void resize(size_type, size_type);
+
+  /** Read element method.
+    * Implements a method for reading data of the dense matrix.
+    * \param mrows Row position in dense matrix.
+    * \param ncolumns Column position in dense matrix.
+    * \return Value of the element in the position given by the parameters. */
+  const T& readElement(const size_type& mrows, const size_type& ncolumns) const
+  { return contents[mrows*ld + ncolumns]; }
+
+  /** Write element method.
+    * Implements a method for writing data on the dense matrix.
+    * \param mrows Row position in dense matrix.
+    * \param ncolumns Column position in dense matrix.
+    * \param value Numerical type value. */
+  void writeElement(T value, size_type mrows, size_type ncolumns)
+  { contents[mrows*ld + ncolumns] = value; }
+
+  /** Method for knowing the number of data rows.
+   * \returns Number of rows.
+   */
+  size_type getRows() const
+  { return rows; }
+
+  /** Method for knowing the number of data columns.
+   * \returns Number of columns.
+   */
+  size_type getCols() const
+  { return cols; }
+
+  /** Method for knowing the distance (in elements) between the start of two consecutive rows.
+   * \returns Leading dimension of the buffer.
+   */
+  size_type getLeadingDim() const
+  { return ld; }
+
+  /** Data pointer method.
+   * Gives the address of element (0,0). Element (i,j) is at data_pointer()[i*getLeadingDim()+j].
+   * @return A pointer to the first element of the buffer.
+   */
+  T* data_pointer()
+  { return contents.empty() ? 0 : &contents[0]; }
+
+  /** Data pointer method (read only).
+   * @return A const pointer to the first element of the buffer.
+   */
+  const T* data_pointer() const
+  { return contents.empty() ? 0 : &contents[0]; }
+
+  void equals(const Data<T>* matrix_in);
+
+  void add(const Data<T>* matrix_in_1);
+
+  void substract(const Data<T>* matrix_in_1);
+
+  void multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2);
+
+  void multiplyScalar(const T& scalar);
+
+  void multiplyElements(const Data<T>* matrix_in);
+
+  void read_mm_file(const char* input_file);
+
+  void read_hb_file(const char* input_file);
+
+  void write_hb_file(const char* input_file);
+
+  void trn();
+
+  void cleanBelow(const double factor);
+
+  bool exists( size_type, size_type )
+  { return 1; }
+
+}; // class Type_dense definitions.
+
+  ////////////////////////////////////////////////// Implementing the methods defined previously:
+
+  /** Computes the leading dimension for a given number of columns,
+    * rounding it up to a multiple of the alignment when sizeof(T) allows it.
+    * \param ncolumns Number of columns of dense matrix. */
+  template <typename T>
+  size_type Type_dense<T>::computeLeadingDim( size_type ncolumns )
+  {
+    if ( sizeof(T) >= LMX_DENSE_ALIGN || LMX_DENSE_ALIGN % sizeof(T) != 0 )
+      return ncolumns;
+    size_type per_line = LMX_DENSE_ALIGN / sizeof(T);
+    return ( (ncolumns + per_line - 1) / per_line ) * per_line;
+  }
+
+  /** Standard constructor.
+    * Creates a new object with parameter contents resized to (rows, columns) dimension.
+    * \param rows_in Rows of dense matrix.
+    * \param columns_in Columns of dense matrix. */
+  template <typename T>
+  Type_dense<T>::Type_dense(size_type rows_in, size_type columns_in) :
+   Data_mat<T>(), rows(0), cols(0), ld(0)
+  { resize(rows_in, columns_in); }
+
+  /** Resize method.
+    * Changes the size of the contents parameter, keeping the values that fit in the new dimension.
+    * \param mrows New value for rows of dense matrix.
+    * \param ncolumns New value for columns of dense matrix. */
+  template <typename T>
+  void Type_dense<T>::resize(size_type mrows, size_type ncolumns)
+  {
+    if (mrows == rows && ncolumns == cols) return;
+
+    size_type new_ld = computeLeadingDim(ncolumns);
+    if (new_ld == ld){ // rows keep their place, just add or remove them
+      contents.resize( mrows*new_ld, T() );
+      // A previous shrink may have left values in the new columns:
+      size_type min_rows = std::min(rows, mrows);
+      for (size_type i=0; i<min_rows; ++i){
+        for (size_type j=cols; j<ncolumns; ++j){
+          contents[i*ld + j] = T();
+        }
+      }
+    }
+    else{
+      std::vector< T, aligned_allocator<T> > temp( mrows*new_ld, T() );
+      size_type min_rows = std::min(rows, mrows);
+      size_type min_cols = std::min(cols, ncolumns);
+      for (size_type i=0; i<min_rows; ++i){
+        for (size_type j=0; j<min_cols; ++j){
+          temp[i*new_ld + j] = contents[i*ld + j];
+        }
+      }
+      contents.swap(temp);
+    }
+    rows = mrows;
+    cols = ncolumns;
+    ld = new_ld;
+  }
+
+  /** Copy method.
+    * Equals the data in the object's contents to those given by the input matrix parameter.
+    * \param matrix_in pointer to an object that belongs to a class derived from Data. */
+  template <typename T>
+  void Type_dense<T>::equals(const Data<T>* matrix_in)
+  {
+    const Type_dense* dense_in = dynamic_cast<const Type_dense*>(matrix_in);
+    if (dense_in){
+      contents = dense_in->contents;
+      rows = dense_in->rows;
+      cols = dense_in->cols;
+      ld = dense_in->ld;
+    }
+    else{
+      this->resize( matrix_in->getRows(), matrix_in->getCols() );
+      for (size_type i=0; i<rows; ++i){
+        for (size_type j=0; j<cols; ++j){
+          contents[i*ld + j] = matrix_in->readElement(i,j);
+        }
+      }
+    }
+  }
+
+  /** Add method.
+    * Adds the the input matrix parameter's elements to the object's contents.
+    * Necessary for overloading the "+=" operator.
+    * \param matrix_in_1 pointer to an object that belongs to a class derived from Data. */
+  template <typename T>
+  void Type_dense<T>::add(const Data<T>* matrix_in_1)
+  {
+    const Type_dense* dense_in = dynamic_cast<const Type_dense*>(matrix_in_1);
+    if (dense_in && dense_in->ld == ld){
+      T* p = this->data_pointer();
+      const T* q = dense_in->data_pointer();
+      for (size_type k=0; k<rows*ld; ++k) p[k] += q[k];
+    }
+    else{
+      for (size_type i=0; i<rows; ++i){
+        for (size_type j=0; j<cols; ++j){
+          contents[i*ld + j] += matrix_in_1->readElement(i,j);
+        }
+      }
+    }
+  }
+
+  /** Substract method.
+    * Substracts the the input matrix parameter's elements to the object's contents.
+    * Necessary for overloading the "-=" operator.
+    * \param matrix_in_1 pointer to an object that belongs to a class derived from Data. */
+  template <typename T>
+  void Type_dense<T>::substract(const Data<T>* matrix_in_1)
+  {
+    const Type_dense* dense_in = dynamic_cast<const Type_dense*>(matrix_in_1);
+    if (dense_in && dense_in->ld == ld){
+      T* p = this->data_pointer();
+      const T* q = dense_in->data_pointer();
+      for (size_type k=0; k<rows*ld; ++k) p[k] -= q[k];
+    }
+    else{
+      for (size_type i=0; i<rows; ++i){
+        for (size_type j=0; j<cols; ++j){
+          contents[i*ld + j] -= matrix_in_1->readElement(i,j);
+        }
+      }
+    }
+  }
+
+  /** Multiply method.
+    * Multiplies the input matrices and saves the result into the object's contents.
+    * Necessary for overloading the "*" operator.
+    * \param matrix_in_1 pointer to an object that belongs to a class derived from Data.
+    * \param matrix_in_2 pointer to an object that belongs to a class derived from Data. */
+  template <typename T>
+  void Type_dense<T>::multiply(const Data<T>* matrix_in_1, const Data<T>* matrix_in_2)
+  {
+    // Emmit an error if called over self data...
+    if(this == matrix_in_1 || this == matrix_in_2){
+      std::stringstream message;
+      message << "Trying to multiply and save results on same data at the same time."
+          << endl << "  This cannot be done." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    mat_mat_mult( static_cast<const Data_mat<T>*>(matrix_in_1),
+                  static_cast<const Data_mat<T>*>(matrix_in_2),
+                  static_cast<Data_mat<T>*>(this) );
+  }
+
+  /** Multiply scalar method.
+    * Multiplies the object's matrix (contents) with a scalar.
+    * Necessary for overloading the "*" operator.
+    * \param scalar A scalar factor of template's class. */
+  template <typename T>
+  void Type_dense<T>::multiplyScalar(const T& scalar)
+  {
+    T* p = this->data_pointer();
+    for (size_type k=0; k<rows*ld; ++k) p[k] *= scalar;
+  }
+
+  /** Method multiplying element-by-element of two matrices. One would be the object's contents and the other the parameter's contents.
+    * \param matrix_in pointer to an object that belongs to a class derived from Data. */
+  template <typename T>
+  void Type_dense<T>::multiplyElements(const Data<T>* matrix_in)
+  {
+    const Type_dense* dense_in = dynamic_cast<const Type_dense*>(matrix_in);
+    if (dense_in && dense_in->ld == ld){
+      T* p = this->data_pointer();
+      const T* q = dense_in->data_pointer();
+      for (size_type k=0; k<rows*ld; ++k) p[k] *= q[k];
+    }
+    else{
+      for (size_type i=0; i<rows; ++i){
+        for (size_type j=0; j<cols; ++j)
+          contents[i*ld + j] *= matrix_in->readElement(i,j);
+      }
+    }
+  }
+
+  /** Read data in Matrix Market format method.
+   * Opens the file specified and reads the matrix's data in it,
+   * suposing it's stored in Matrix Market format.
+   * \param input_file Name of the file to be read.
+   *  */
+  template <typename T>
+#ifndef HAVE_GMM
+  void Type_dense<T>::read_mm_file(const char*)
+#else
+  void Type_dense<T>::read_mm_file(const char* input_file)
+#endif
+  {
+#ifndef HAVE_GMM
+    std::stringstream message;
+    message
+        << "---------------------------------------------\n"
+        << "We are very very sorry but this feature (read_mm_file) requires at the moment the use of \nthe gmm++ library.\n"
+        << "If you really feel that it is important to have the Matrix Market file reading \nas a built in feature, you can post it into our web page:\n"
+        << "w3.mecanica.upm.es/lmx\n"
+        << "Thank you very much for your interest and help in setting our priorities in the \ndevelopment schedule.\n"
+        << "---------------------------------------------\n"
+        << "gmm++ not defined.\nYou must set \"#define HAVE_GMM\" in your file in order to use this library." << endl;
+    LMX_THROW(failure_error, message.str() );
+#else
+    gmm::csc_matrix<double> cscmat;
+    gmm::col_matrix< gmm::wsvector<double> > matrix_loaded;
+    gmm::MatrixMarket_load(input_file, matrix_loaded);
+    gmm::copy(matrix_loaded, cscmat);
+
+    this->resize(cscmat.nr, cscmat.nc);
+
+    size_type elem_count=0;
+    for(size_type j = 0 ; j < cols ; ++j){
+      for(size_type m = cscmat.jc[j]; m < cscmat.jc[j+1]; ++m){
+        contents[ cscmat.ir[elem_count]*ld + j ] = cscmat.pr[elem_count];
+        ++elem_count;
+      }
+    }
+#endif
+  }
+
+  /** Read data in Harwell-Boeing format method.
+   * Opens the file specified and reads the matrix's data in it,
+   * suposing it's stored in Harwell-Boeing format.
+   *
+   * \param input_file Name of the file to be read.
+   */
+  template <typename T>
+  void Type_dense<T>::read_hb_file(const char* input_file)
+  {
+    int M;
+    int N;
+    int nonzeros;
+    int *colptr;
+    int *rowind;
+    double *val;
+
+    HarwellBoeing_IO h(input_file);
+    h.read(M,N,nonzeros,colptr,rowind,val);
+
+    this->resize(M,N);
+
+    size_type elem_count=0;
+    for(int j = 0 ; j < N ; ++j){
+      for(int m = colptr[j]; m < colptr[j+1]; ++m){
+        contents[ (rowind[elem_count]-1)*ld + j ] = val[elem_count];
+        ++elem_count;
+      }
+    }
+  }
+
+  /**
+   * Write data in Harwell-Boeing format method.
+   * Opens the file specified and writes the matrix's data in it.
+   *
+   * \param input_file Name of the file to be read.
+   */
+  template <typename T>
+#ifndef HAVE_GMM
+  void Type_dense<T>::write_hb_file(const char*)
+#else
+  void Type_dense<T>::write_hb_file(const char* input_file)
+#endif
+  {
+#ifndef HAVE_GMM
+    std::stringstream message;
+    message
+        << "---------------------------------------------\n"
+        << "We are very very sorry but this feature (write_hb_file) requires at the moment the use of \nthe gmm++ library.\n"
+        << "If you really feel that it is important to have the Matrix Market file reading \nas a built in feature, you can post it into our web page:\n"
+        << "w3.mecanica.upm.es/lmx\n"
+        << "Thank you very much for your interest and help in setting our priorities in the \ndevelopment schedule.\n"
+        << "---------------------------------------------\n"
+        << "gmm++ not defined.\nYou must set \"#define HAVE_GMM\" in your file in order to use this library." << endl;
+    LMX_THROW(failure_error, message.str() );
+#else
+    gmm::dense_matrix<T> gmm_dense_matrix( rows , cols );
+    gmm::csc_matrix<T> cscmat( rows , cols );
+
+    for (size_type i = 0; i<rows; ++i){
+      for (size_type j = 0; j<cols; ++j){
+        gmm_dense_matrix(i,j) = contents[i*ld + j];
+      }
+    }
+
+    gmm::copy( gmm_dense_matrix, cscmat );
+    gmm::Harwell_Boeing_save(input_file, cscmat);
+#endif
+  }
+
+  /** Traspose method.
+    * Swaps elements with respect to the diagonal: A(i,j) = A(j,i) */
+  template <typename T>
+  void Type_dense<T>::trn()
+  {
+    size_type new_ld = computeLeadingDim(rows);
+    std::vector< T, aligned_allocator<T> > temp( cols*new_ld, T() );
+    for (size_type i=0; i<rows; ++i){
+      for (size_type j=0; j<cols; ++j){
+        temp[j*new_ld + i] = contents[i*ld + j];
+      }
+    }
+    contents.swap(temp);
+    std::swap(rows, cols);
+    ld = new_ld;
+  }
+
+  /** Clean below method.
+    * Makes equal to zero every element below given factor.
+    * \param factor Reference value for cleaning. */
+  template <typename T>
+  void Type_dense<T>::cleanBelow(const double factor)
+  {
+    for (size_type i=0; i<rows; ++i){
+      for (size_type j=0; j<cols; ++j){
+        if ( std::abs( contents[i*ld + j] ) < std::abs( static_cast<T>(factor) ) )
+          contents[i*ld + j] = static_cast<T>(0);
+      }
+    }
+  }
+
+
+}; // namespace lmx
+
+
+#endif
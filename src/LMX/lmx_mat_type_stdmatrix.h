@@ -107,7 +107,17 @@ public:
       * Equals the data in the object's contents to those given by the input matrix parameter.
       * \param matrix_in pointer to an object that belongs to a class derived from Data. */
   void equals(const Data<T>* matrix_in)
-   { contents = static_cast<const Type_stdmatrix*>(matrix_in)-> contents; }
+  { const Type_stdmatrix* std_in = dynamic_cast<const Type_stdmatrix*>(matrix_in);
+    if (std_in) contents = std_in->contents;
+    else{
+      this->resize( matrix_in->getRows(), matrix_in->getCols() );
+      for (size_type i=0; i<rows; ++i){
+        for (size_type j=0; j<cols; ++j){
+          contents[i][j] = matrix_in->readElement(i,j);
+        }
+      }
+    }
+  }
   
     /** Add method.
       * Adds the the input matrix parameter's elements to the object's contents.
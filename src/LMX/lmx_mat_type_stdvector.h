@@ -234,7 +234,15 @@ public:
     return &(this->contents);
   }
 
-  friend void mat_vec_mult<>( const Type_csc<T>*,
+  /** Data pointer method (read only).
+   * @return A const pointer to the vector's contents (Type_stdVector).
+   */
+  const std::vector<T>* data_pointer() const
+  {
+    return &(this->contents);
+  }
+
+  friend void mat_vec_mult<>( const Type_csr<T>*,
                               const Type_stdVector<T>*,
                                     Type_stdVector<T>*);
 
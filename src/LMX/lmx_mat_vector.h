@@ -28,6 +28,7 @@
 // #include"lmx_base_selector.h"
 #include"lmx_mat_elem_ref.h"
 #include"lmx_mat_type_stdvector.h"
+#include"lmx_mat_vector_expr.h"
 
 //////////////////////////////////////////// Doxygen file documentation entry:
     /*!
@@ -44,7 +45,7 @@
 namespace lmx {
 
 class Selector;
-template <typename T> class Matrix;
+template <typename T, typename Storage> class Matrix;
 template <typename T> class DenseMatrix;
 template <typename T> class LinearSystem;
 
@@ -63,15 +64,17 @@ int getVectorType();
 
     \author Daniel Iglesias Ib��ez.
     */
-template <typename T> class Vector{
+template <typename T> class Vector<T, Data_vec<T> >{
 private:
   size_type elements;    /**< Number of rows in vector object. */
   Elem_ref<T>* reference; /**< Reference pointer to an element in type_matrix. */
   Data_vec<T>* type_vector; /**< Pointer to the container type. */
 
+  T* storage() const;
 
 public:
   friend class LinearSystem<T>;
+  friend class VectorLeaf<T>;
 
 public:
   Vector();
@@ -80,6 +83,8 @@ public:
 
   Vector(const Vector&);
 
+  template <typename E> Vector(const VectorExpr<T,E>&);
+
   ~Vector();
 
   /**
@@ -104,10 +109,16 @@ public:
 
   template <typename C> inline Vector<T>& operator = (const Vector<C>&);
 
+  template <typename E> inline Vector<T>& operator = (const VectorExpr<T,E>&);
+
   inline Vector& operator += (const Vector&);
 
+  template <typename E> inline Vector<T>& operator += (const VectorExpr<T,E>&);
+
   inline Vector& operator -= (const Vector&);
 
+  template <typename E> inline Vector<T>& operator -= (const VectorExpr<T,E>&);
+
   inline Vector& operator *= (const T&);
 
 //   inline Vector operator * (const Matrix<T>&) const;
@@ -136,6 +147,27 @@ public:
 
   inline T norm2 () const;
 
+  inline Vector& axpy(const T&, const Vector<T>&);
+
+  void gather(T*, const size_type*, size_type) const;
+
+  void scatter(const T*, const size_type*, size_type);
+
+  void scatterAdd(const T*, const size_type*, size_type);
+
+  /** Raw data access.
+   * \return Pointer to the first element if the elements are stored
+   * contiguously (Type_stdVector), 0 otherwise.
+   *  */
+  T* data_pointer()
+  { return this->storage(); }
+
+  /** Raw data access (read only).
+   * \return Const pointer to the first element, or 0 (see data_pointer()).
+   *  */
+  const T* data_pointer() const
+  { return this->storage(); }
+
  /** Function for reading a Vector object's element from it's known position.
    * \param m vec's position (row) for lookup.
    * \return The element.
@@ -180,34 +212,6 @@ public:
     this->type_vector->resize(this->elements, 1);
   }
 
-  /** Operator for adding two Vector objects.
-   * Performs typicar vector operation: A + B = C, where A, B & C are vectors. A is Vector *this.
-   * \param B Vector reference for second LHS term.
-   * \return The numeric result of the operation: C = A + B.
-      *  */
-  Vector operator + (const Vector<T>& B) const
-  {
-    if ( elements != B.size() )
-      LMX_THROW(dimension_error, "Vectors dimensions mismatch");
-    Vector<T> sum = *this;
-    sum += B;
-    return sum;
-  }
-
-  /** Operator for substracting two Vector objects.
-   * Performs typicar vector operation: A - B = C, where A, B & C are vectors. A is Vector *this.
-   * \param B Vector reference for second LHS term.
-   * \return The numeric result of the operation: C = A - B.
-   *  */
-  Vector operator - (const Vector<T>& B) const
-  {
-    if ( elements != B.size() )
-      LMX_THROW(dimension_error, "Vectors dimensions mismatch");
-    Vector<T> sum = *this;
-    sum -= B;
-    return sum;
-  }
-
   /** Operator for scalar product of two Vector objects.
    * Performs typical vector operation: A * B = c, where A & B are vectors and c is a scalar.
    * \param B Vector reference for second LHS term.
@@ -218,22 +222,7 @@ public:
     if ( elements != B.size() )
       LMX_THROW(dimension_error, "Vectors dimensions mismatch");
 
-    T scalar_product = 0;
-
-    for (size_type i=0; i<elements; ++i)
-      scalar_product += type_vector->readElement(i,0) * B.readElement(i);
-    return scalar_product;
-  }
-
-  /** Overload operator for multiplying a scalar and a Vector object.
-   * \param a scalar reference.
-   * \return A new Vector (mult = (*this) * a).
-   *  */
-  Vector operator * (const T& a) const
-  {
-    Vector<T> mult(*this);
-    mult.type_vector->multiplyScalar(a);
-    return mult;
+    return VectorLeaf<T>(*this) * VectorLeaf<T>(B);
   }
 
 
@@ -365,6 +354,38 @@ template <typename T>
 }
 
 
+/**
+ * Constructor from an expression (see lmx_mat_vector_expr.h).
+ * The expression is evaluated directly into the new Vector.
+ * \param expr Expression to evaluate.
+ */
+template <typename T>
+    template <typename E>
+    Vector<T>::Vector(const VectorExpr<T,E>& expr) : elements(expr.size())
+{
+  switch (getVectorType()) {
+    case 0 :
+      type_vector = new Type_stdVector< T >;
+      break;
+
+#ifdef HAVE_GMM
+    case 1 :
+      type_vector = new Type_gmmVector_sparse< T >;
+    break;
+#else
+    {
+        std::stringstream message;
+        message << "gmm++ not defined.\nYou must set \"#define HAVE_GMM\" in your file in order to use this library." << endl;
+        LMX_THROW(failure_error, message.str() );
+    }
+#endif
+  }
+  this->type_vector->resize(this->elements, 1);
+  this->reference = new Elem_ref<T>(this->type_vector);
+  *this = expr;
+}
+
+
 /**
  * Destructor.
  */
@@ -498,6 +519,44 @@ template <typename T>
   }
 }
 
+/**
+ * Contiguous storage of the elements.
+ * \return Pointer to the first element if the container is a Type_stdVector, 0 otherwise.
+ */
+template <typename T>
+    T* Vector<T>::storage() const
+{
+  if ( getVectorType() != 0 || this->elements == 0 ) return 0;
+  return &( *static_cast<Type_stdVector<T>*>(this->type_vector)->data_pointer() )[0];
+}
+
+/** Overload of equals operator for expressions.
+ * Evaluates the expression element by element in a single loop.
+ * \param expr Expression to equal to.
+ * \return A reference to the Vector object.
+ */
+template <typename T>
+    template <typename E>
+    Vector<T>& Vector<T>::operator = (const VectorExpr<T,E>& expr)
+{
+  if ( this->elements != expr.size() ){
+    std::stringstream message;
+    message << "Vectors dimensions mismatch. \n"
+        << "LHS vector dimension: (" << this->elements << ")" << endl
+        << "RHS vector dimension: (" << expr.size() << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  const E& e = expr.self();
+  T* y = this->storage();
+  if ( y ){
+    for (size_type i=0; i<this->elements; ++i) y[i] = e[i];
+  }
+  else{
+    for (size_type i=0; i<this->elements; ++i) this->writeElement( e[i], i );
+  }
+  return *this;
+}
+
 /** Overloaded operator for assigning the addition of elements
  *  between two Vector objects.
  * \param b Vector to equal to.
@@ -517,6 +576,17 @@ template <typename T>
   return *this;
 }
 
+/** Overloaded operator for adding an expression to the Vector.
+ * \param expr Expression to add.
+ * \return A reference to the Vector object.
+ */
+template <typename T>
+    template <typename E>
+    Vector<T>& Vector<T>::operator += (const VectorExpr<T,E>& expr)
+{
+  return *this = *this + expr;
+}
+
 /** Overloaded operator for assigning the substraction of elements
  * between two Vector objects.
  * \param b Vector to equal to.
@@ -536,6 +606,17 @@ template <typename T>
   return *this;
 }
 
+/** Overloaded operator for substracting an expression to the Vector.
+ * \param expr Expression to substract.
+ * \return A reference to the Vector object.
+ */
+template <typename T>
+    template <typename E>
+    Vector<T>& Vector<T>::operator -= (const VectorExpr<T,E>& expr)
+{
+  return *this = *this - expr;
+}
+
 /**
  * Scaling operator.
  *
@@ -675,6 +756,31 @@ template <typename T>
                      static_cast<const Type_stdVector<T>*>(b.type_vector),
                      static_cast<Type_stdVector<T>*>(this->type_vector) );
   }
+  else if (getMatrixType()==5 && getVectorType()==0) {
+    mat_vec_mult<T>( static_cast<const Type_csr<T>*>(A.type_matrix),
+                     static_cast<const Type_stdVector<T>*>(b.type_vector),
+                     static_cast<Type_stdVector<T>*>(this->type_vector) );
+  }
+  else if (getMatrixType()==6 && getVectorType()==0) {
+    mat_vec_mult<T>( static_cast<const Type_csc_sym<T>*>(A.type_matrix),
+                     static_cast<const Type_stdVector<T>*>(b.type_vector),
+                     static_cast<Type_stdVector<T>*>(this->type_vector) );
+  }
+  else if (getMatrixType()==7 && getVectorType()==0) {
+    mat_vec_mult( static_cast<const Type_bsr<T,2>*>(A.type_matrix),
+                  static_cast<const Type_stdVector<T>*>(b.type_vector),
+                  static_cast<Type_stdVector<T>*>(this->type_vector) );
+  }
+  else if (getMatrixType()==8 && getVectorType()==0) {
+    mat_vec_mult( static_cast<const Type_bsr<T,3>*>(A.type_matrix),
+                  static_cast<const Type_stdVector<T>*>(b.type_vector),
+                  static_cast<Type_stdVector<T>*>(this->type_vector) );
+  }
+  else if (getMatrixType()==9 && getVectorType()==0) {
+    mat_vec_mult( static_cast<const Type_bsr<T,6>*>(A.type_matrix),
+                  static_cast<const Type_stdVector<T>*>(b.type_vector),
+                  static_cast<Type_stdVector<T>*>(this->type_vector) );
+  }
 //   else if (getMatrixType()==1 && getVectorType()==2) {
 //     mat_vec_mult<T>( static_cast<const Type_csc<T>*>(A.type_matrix),
 //                      static_cast<const Type_cVector<T>*>(b.type_vector),
@@ -694,11 +800,7 @@ template <typename T>
   }
 #endif
   else {
-    for (size_type i=0; i<A.rows(); ++i){
-      this->operator ( )(i) = static_cast<T>(0);
-      for (size_type j=0; j<A.cols(); ++j)
-        this->operator ( )(i) += A.readElement(i,j) * b.readElement(j);
-    }
+    mat_vec_mult( A.type_matrix, b.type_vector, this->type_vector );
   }
 
   return *(this);
@@ -729,10 +831,22 @@ template <typename T>
 
   if( elements != A.rows() ) resize( A.rows() );
 
-  for (size_type i=0; i<A.rows(); ++i){
-    this->operator ( )(i) = static_cast<T>(0);
-    for (size_type j=0; j<A.cols(); ++j)
-      this->operator ( )(i) += A.readElement(i,j) * b.readElement(j);
+  const T* a = A.data_pointer();
+  const size_type ld = A.getLeadingDim();
+  const T* x = b.storage();
+  T* y = this->storage();
+  if ( x && y ){
+    T sum;
+    for (size_type i=0; i<A.rows(); ++i){
+      const T* row_i = a + i*ld;
+      sum = static_cast<T>(0);
+      for (size_type j=0; j<A.cols(); ++j)
+        sum += row_i[j] * x[j];
+      y[i] = sum;
+    }
+  }
+  else {
+    mat_vec_mult( A.type_matrix, b.type_vector, this->type_vector );
   }
 
   return *(this);
@@ -847,9 +961,14 @@ template <typename T>
     T Vector<T>::norm1 () const
 {
   T norm = 0;
-  for (size_type i=0; i<elements; ++i)
-    norm += std::abs(type_vector->readElement(i,0));
-
+  const T* x = this->storage();
+  if ( x ){
+    for (size_type i=0; i<elements; ++i) norm += std::abs(x[i]);
+  }
+  else{
+    for (size_type i=0; i<elements; ++i)
+      norm += std::abs(type_vector->readElement(i,0));
+  }
   return norm;
 }
 
@@ -858,10 +977,95 @@ template <typename T>
 template <typename T>
     T Vector<T>::norm2 () const
 {
-  T norm = 0;
-  for (size_type i=0; i<elements; ++i)
-    norm += type_vector->readElement(i,0) * type_vector->readElement(i,0);
-  return std::sqrt(norm);
+  return std::sqrt( VectorLeaf<T>(*this) * VectorLeaf<T>(*this) );
+}
+
+/**
+ * Scaled addition, y += alpha*x, where y is the object.
+ * Runs over the raw storage when both Vectors are contiguous, without
+ * temporaries.
+ * \param alpha Scaling factor.
+ * \param x Vector to scale and add.
+ * \return Reference to result.
+ */
+template <typename T> inline
+    Vector<T>& Vector<T>::axpy(const T& alpha, const Vector<T>& x)
+{
+  if ( this->elements != x.size() ){
+    std::stringstream message;
+    message << "Vectors dimensions mismatch. \n"
+        << "LHS vector dimension: (" << this->elements << ")" << endl
+        << "RHS vector dimension: (" << x.size() << ")" << endl;
+    LMX_THROW(dimension_error, message.str() );
+  }
+  T* py = this->storage();
+  const T* px = x.storage();
+  if ( py && px ){
+    for (size_type i=0; i<this->elements; ++i) py[i] += alpha * px[i];
+  }
+  else{
+    for (size_type i=0; i<this->elements; ++i)
+      this->type_vector->writeElement( this->type_vector->readElement(i,0)
+                                       + alpha * x.type_vector->readElement(i,0), i, 0 );
+  }
+  return *this;
+}
+
+/**
+ * Reads the elements in the given positions.
+ * values[k] = v(index[k]), k = 0..n-1.
+ * \param values Array of (at least) n elements where the values are written.
+ * \param index Positions to read.
+ * \param n Number of positions.
+ */
+template <typename T>
+    void Vector<T>::gather(T* values, const size_type* index, size_type n) const
+{
+  const T* x = this->storage();
+  if ( x ){
+    for (size_type k=0; k<n; ++k) values[k] = x[ index[k] ];
+  }
+  else{
+    for (size_type k=0; k<n; ++k) values[k] = type_vector->readElement(index[k],0);
+  }
+}
+
+/**
+ * Writes the values in the given positions.
+ * v(index[k]) = values[k], k = 0..n-1.
+ * \param values Array of n values.
+ * \param index Positions to write.
+ * \param n Number of positions.
+ */
+template <typename T>
+    void Vector<T>::scatter(const T* values, const size_type* index, size_type n)
+{
+  T* y = this->storage();
+  if ( y ){
+    for (size_type k=0; k<n; ++k) y[ index[k] ] = values[k];
+  }
+  else{
+    for (size_type k=0; k<n; ++k) type_vector->writeElement(values[k], index[k], 0);
+  }
+}
+
+/**
+ * Adds the values to the given positions, as in the assembly of element vectors.
+ * v(index[k]) += values[k], k = 0..n-1.
+ * \param values Array of n values.
+ * \param index Positions to add to.
+ * \param n Number of positions.
+ */
+template <typename T>
+    void Vector<T>::scatterAdd(const T* values, const size_type* index, size_type n)
+{
+  T* y = this->storage();
+  if ( y ){
+    for (size_type k=0; k<n; ++k) y[ index[k] ] += values[k];
+  }
+  else{
+    for (size_type k=0; k<n; ++k) type_vector->addElement(values[k], index[k], 0);
+  }
 }
 
 
@@ -913,20 +1117,6 @@ template <typename T>
   return c;
 }
 
-/**
- * Overload operator for multiplying a scalar and a Vector object.
- * \param a scalar reference.
- * \param B Vector reference for second LHS term.
- * \return A new Vector (mult = a*b).
- */
-template <typename T>
-    Vector<T> operator * (const T& a, const Vector<T>& B)
-{
-  Vector<T> mult(B);
-  mult *= a;
-  return mult;
-}
-
 /**
  * Overloaded operator that prints a Vector object into the output stream selected.
  * \param vec Vector reference to the object that is going to be printed.
@@ -947,6 +1137,18 @@ template <typename T>
   return os;
 }
 
+/**
+ * Overloaded operator that prints a Vector expression into the output stream selected.
+ * \param expr Expression to evaluate and print.
+ * \param os An output std stream.
+ * \return (\a os ) The stream that was passed as a parameter.
+ */
+template <typename T, typename E>
+    std::ostream& operator << (std::ostream& os, const VectorExpr<T,E>& expr)
+{
+  return os << Vector<T>(expr);
+}
+
 
 }; // namespace lmx
 
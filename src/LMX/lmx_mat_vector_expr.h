@@ -0,0 +1,315 @@
+/***************************************************************************
+ *   Copyright (C) 2005 by Daniel Iglesias                                 *
+ *   diglesiasib@mecanica.upm.es                                           *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU Library General Public License as       *
+ *   published by the Free Software Foundation; either version 2 of the    *
+ *   License, or (at your option) any later version.                       *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU Library General Public     *
+ *   License along with this program; if not, write to the                 *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+#ifndef LMXVECTOR_EXPR_H
+#define LMXVECTOR_EXPR_H
+
+#include <cmath>
+
+#include "lmx_except.h"
+
+//////////////////////////////////////////// Doxygen file documentation entry:
+    /*!
+      \file lmx_mat_vector_expr.h
+
+      \brief Expression templates for Vector arithmetic.
+
+      The operators +, - and scalar * between Vector objects do not compute
+      anything: they return light objects that describe the operation. The
+      whole expression is evaluated element by element, in a single loop and
+      without temporary vectors, when it is assigned to a Vector (operator =,
+      +=, -=, the Vector constructor or Configuration::setConf), or reduced
+      with the scalar product.
+
+      \author Daniel Iglesias Ib��ez
+
+     */
+//////////////////////////////////////////// Doxygen file documentation (end)
+
+
+namespace lmx {
+
+template <typename T, typename Storage> class Vector;
+
+  /**
+    \class VectorExpr
+    \brief Base of the Vector expressions (curiously recurring template).
+
+    Every expression E provides size() and operator[], which returns the
+    value of the i-th element of the expression. The read only members of
+    Vector (readElement(), norm1() and norm2()) are also available, so an
+    expression can be used where a temporary Vector was used before, e.g.
+    (a+b).norm2().
+
+    \author Daniel Iglesias Ib��ez
+   */
+template <typename T, typename E> class VectorExpr
+{
+public:
+  /** \returns The expression as its derived type. */
+  const E& self() const
+  { return static_cast<const E&>(*this); }
+
+  /** \returns Dimension of the expression. */
+  size_type size() const
+  { return self().size(); }
+
+  /** \returns Value of the i-th element of the expression. */
+  T operator[] ( size_type i ) const
+  { return self()[i]; }
+
+  /** \returns Value of the i-th element of the expression. */
+  T readElement( size_type i ) const
+  { return self()[i]; }
+
+  /** \returns First norm of the expression, computed in one loop. */
+  T norm1() const
+  {
+    T norm = 0;
+    for (size_type i=0; i<size(); ++i) norm += std::abs( self()[i] );
+    return norm;
+  }
+
+  /** \returns Second (euclidean) norm of the expression, computed in one loop. */
+  T norm2() const
+  {
+    T norm = 0;
+    for (size_type i=0; i<size(); ++i){
+      T value = self()[i];
+      norm += value * value;
+    }
+    return std::sqrt(norm);
+  }
+};
+
+  /**
+    \struct ScalarArg
+    \brief Non deduced scalar type of the products by a scalar.
+
+    The type of the scalar is taken from the Vector (or expression), so any
+    value convertible to it can be used, as in v * 2.
+   */
+template <typename T> struct ScalarArg
+{
+  typedef T type;
+};
+
+  /**
+    \class VectorLeaf
+    \brief A Vector as a term of an expression.
+
+    When the Vector stores its elements contiguously (Type_stdVector) they are
+    read through a plain pointer, so no virtual function is called inside the
+    evaluation loop. Otherwise the elements are read with readElement(), which
+    is only virtual for the run-time selected container (Data_vec).
+   */
+template <typename T, typename Storage = Data_vec<T> >
+    class VectorLeaf : public VectorExpr< T, VectorLeaf<T,Storage> >
+{
+  const Vector<T,Storage>* vec;
+  const T* data;
+  size_type elements;
+
+public:
+  /** Standard constructor.
+   * \param v Vector wrapped.
+   */
+  explicit VectorLeaf( const Vector<T,Storage>& v )
+    : vec(&v), data( v.storage() ), elements( v.size() )
+  {}
+
+  size_type size() const
+  { return elements; }
+
+  T operator[] ( size_type i ) const
+  { return data ? data[i] : vec->readElement(i); }
+};
+
+  /**
+    \class VectorSum
+    \brief Expression for the addition of two terms: A + B.
+   */
+template <typename T, typename A, typename B>
+    class VectorSum : public VectorExpr< T, VectorSum<T,A,B> >
+{
+  A a;
+  B b;
+
+public:
+  VectorSum( const A& a_in, const B& b_in ) : a(a_in), b(b_in)
+  {
+    if ( a.size() != b.size() )
+      LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  }
+
+  size_type size() const
+  { return a.size(); }
+
+  T operator[] ( size_type i ) const
+  { return a[i] + b[i]; }
+};
+
+  /**
+    \class VectorDifference
+    \brief Expression for the substraction of two terms: A - B.
+   */
+template <typename T, typename A, typename B>
+    class VectorDifference : public VectorExpr< T, VectorDifference<T,A,B> >
+{
+  A a;
+  B b;
+
+public:
+  VectorDifference( const A& a_in, const B& b_in ) : a(a_in), b(b_in)
+  {
+    if ( a.size() != b.size() )
+      LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  }
+
+  size_type size() const
+  { return a.size(); }
+
+  T operator[] ( size_type i ) const
+  { return a[i] - b[i]; }
+};
+
+  /**
+    \class VectorScaled
+    \brief Expression for the product of a scalar and a term: s * A.
+   */
+template <typename T, typename A>
+    class VectorScaled : public VectorExpr< T, VectorScaled<T,A> >
+{
+  T s;
+  A a;
+
+public:
+  VectorScaled( const T& s_in, const A& a_in ) : s(s_in), a(a_in)
+  {}
+
+  size_type size() const
+  { return a.size(); }
+
+  T operator[] ( size_type i ) const
+  { return s * a[i]; }
+};
+
+
+/////////////////////////////// Operators building the expressions:
+
+/** Addition of two Vector objects. */
+template <typename T, typename S1, typename S2> inline
+    VectorSum< T, VectorLeaf<T,S1>, VectorLeaf<T,S2> >
+    operator + ( const Vector<T,S1>& a, const Vector<T,S2>& b )
+{ return VectorSum< T, VectorLeaf<T,S1>, VectorLeaf<T,S2> >( VectorLeaf<T,S1>(a), VectorLeaf<T,S2>(b) ); }
+
+/** Addition of a Vector and an expression. */
+template <typename T, typename S, typename E> inline
+    VectorSum< T, VectorLeaf<T,S>, E >
+    operator + ( const Vector<T,S>& a, const VectorExpr<T,E>& b )
+{ return VectorSum< T, VectorLeaf<T,S>, E >( VectorLeaf<T,S>(a), b.self() ); }
+
+/** Addition of an expression and a Vector. */
+template <typename T, typename S, typename E> inline
+    VectorSum< T, E, VectorLeaf<T,S> >
+    operator + ( const VectorExpr<T,E>& a, const Vector<T,S>& b )
+{ return VectorSum< T, E, VectorLeaf<T,S> >( a.self(), VectorLeaf<T,S>(b) ); }
+
+/** Addition of two expressions. */
+template <typename T, typename E1, typename E2> inline
+    VectorSum< T, E1, E2 >
+    operator + ( const VectorExpr<T,E1>& a, const VectorExpr<T,E2>& b )
+{ return VectorSum< T, E1, E2 >( a.self(), b.self() ); }
+
+/** Substraction of two Vector objects. */
+template <typename T, typename S1, typename S2> inline
+    VectorDifference< T, VectorLeaf<T,S1>, VectorLeaf<T,S2> >
+    operator - ( const Vector<T,S1>& a, const Vector<T,S2>& b )
+{ return VectorDifference< T, VectorLeaf<T,S1>, VectorLeaf<T,S2> >( VectorLeaf<T,S1>(a), VectorLeaf<T,S2>(b) ); }
+
+/** Substraction of a Vector and an expression. */
+template <typename T, typename S, typename E> inline
+    VectorDifference< T, VectorLeaf<T,S>, E >
+    operator - ( const Vector<T,S>& a, const VectorExpr<T,E>& b )
+{ return VectorDifference< T, VectorLeaf<T,S>, E >( VectorLeaf<T,S>(a), b.self() ); }
+
+/** Substraction of an expression and a Vector. */
+template <typename T, typename S, typename E> inline
+    VectorDifference< T, E, VectorLeaf<T,S> >
+    operator - ( const VectorExpr<T,E>& a, const Vector<T,S>& b )
+{ return VectorDifference< T, E, VectorLeaf<T,S> >( a.self(), VectorLeaf<T,S>(b) ); }
+
+/** Substraction of two expressions. */
+template <typename T, typename E1, typename E2> inline
+    VectorDifference< T, E1, E2 >
+    operator - ( const VectorExpr<T,E1>& a, const VectorExpr<T,E2>& b )
+{ return VectorDifference< T, E1, E2 >( a.self(), b.self() ); }
+
+/** Product of a scalar and a Vector. */
+template <typename T, typename S> inline
+    VectorScaled< T, VectorLeaf<T,S> >
+    operator * ( const typename ScalarArg<T>::type& s, const Vector<T,S>& a )
+{ return VectorScaled< T, VectorLeaf<T,S> >( s, VectorLeaf<T,S>(a) ); }
+
+/** Product of a Vector and a scalar. */
+template <typename T, typename S> inline
+    VectorScaled< T, VectorLeaf<T,S> >
+    operator * ( const Vector<T,S>& a, const typename ScalarArg<T>::type& s )
+{ return VectorScaled< T, VectorLeaf<T,S> >( s, VectorLeaf<T,S>(a) ); }
+
+/** Product of a scalar and an expression. */
+template <typename T, typename E> inline
+    VectorScaled< T, E >
+    operator * ( const typename ScalarArg<T>::type& s, const VectorExpr<T,E>& a )
+{ return VectorScaled< T, E >( s, a.self() ); }
+
+/** Product of an expression and a scalar. */
+template <typename T, typename E> inline
+    VectorScaled< T, E >
+    operator * ( const VectorExpr<T,E>& a, const typename ScalarArg<T>::type& s )
+{ return VectorScaled< T, E >( s, a.self() ); }
+
+/** Scalar product of two expressions, computed in one loop. */
+template <typename T, typename E1, typename E2> inline
+    T operator * ( const VectorExpr<T,E1>& a, const VectorExpr<T,E2>& b )
+{
+  if ( a.size() != b.size() )
+    LMX_THROW(dimension_error, "Vectors dimensions mismatch");
+  const E1& x = a.self();
+  const E2& y = b.self();
+  T scalar_product = 0;
+  for (size_type i=0; i<x.size(); ++i)
+    scalar_product += x[i] * y[i];
+  return scalar_product;
+}
+
+/** Scalar product of a Vector and an expression. */
+template <typename T, typename S, typename E> inline
+    T operator * ( const Vector<T,S>& a, const VectorExpr<T,E>& b )
+{ return VectorLeaf<T,S>(a) * b; }
+
+/** Scalar product of an expression and a Vector. */
+template <typename T, typename S, typename E> inline
+    T operator * ( const VectorExpr<T,E>& a, const Vector<T,S>& b )
+{ return a * VectorLeaf<T,S>(b); }
+
+}; // namespace lmx
+
+
+#endif
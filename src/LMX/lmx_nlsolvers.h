@@ -22,6 +22,8 @@
 #define LMXNL_SOLVERS_H
 
 #include<iostream>
+#include<vector>
+#include<limits>
 
 
 //////////////////////////////////////////// Doxygen file documentation entry:
@@ -32,6 +34,10 @@
      *
      * Implements a typical residue "R(q) = 0" system and the methods for solving it.
      *
+     * The method is chosen with setNLSolverType():
+     * 0 = Newton-Raphson (default), 1 = modified Newton, 2 = Broyden,
+     * 3 = L-BFGS (symmetric Jacobians), 4 = Jacobian-free Newton-Krylov.
+     *
      * \author Daniel Iglesias Ib��ez
      */
 //////////////////////////////////////////// Doxygen file documentation (end)
@@ -40,8 +46,6 @@
 
 namespace lmx {
 
- static int nl_solver_type = 0; /**< This variable switches between different types of non-linear solvers. */
-
     /**
      * \class NLSolver
      * \brief Template class NLSolver.
@@ -49,6 +53,27 @@ namespace lmx {
      *
      * This class permits the creation of a non-linear solver object.
      *
+     * Modified Newton keeps the factorization of the Jacobian for
+     * several iterations (and solve() calls), rebuilding it every
+     * setJacobianRefresh() iterations or when the residue stalls.
+     * Broyden and L-BFGS only build the Jacobian at the first iteration
+     * of each solve() call; the following increments come from the
+     * factorized initial Jacobian and low-rank updates built with the
+     * last setQuasiNewtonMemory() steps. Broyden rebuilds the Jacobian when
+     * its memory is exhausted, while L-BFGS keeps a sliding window of the
+     * most recent pairs and drops the oldest one.
+     *
+     * The Jacobian-free Newton-Krylov method never builds jac_matrix (it is
+     * not even allocated). The increment is solved with restarted GMRES,
+     * approximating the Jacobian-vector products with finite differences of
+     * the residue, and optionally right-preconditioned with a user member
+     * function set with setPreconditioner().
+     *
+     * By default the full increment is taken. setLineSearch() enables an
+     * Armijo backtracking line search over || R ||^2 and setTrustRegion() a
+     * dogleg trust region built on the Jacobian. Both report the step
+     * length (fraction of the computed increment) of each iteration.
+     *
      * @author Daniel Iglesias Ib��ez.
      */
 
@@ -66,6 +91,22 @@ namespace lmx {
          , externalConvergence2(0)
          , externalConvergence3(0)
          , deltaInResidue(0)
+         , jac_refresh(5)
+         , jac_age(-1)
+         , stall_ratio(0.5)
+         , res_norm_old(0)
+         , qn_memory(10)
+         , globalization(0)
+         , ls_alpha(1E-4)
+         , max_trials(10)
+         , tr_radius_init(0)
+         , tr_radius(0)
+         , krylov_eta(1E-4)
+         , krylov_restart(30)
+         , krylov_max(0)
+         , prec(0)
+         , lin_prec(0)
+         , converged(0)
      /**
       * Empty constructor. 
       */
@@ -88,7 +129,6 @@ namespace lmx {
          q.resize(q_in.size());
          delta_q.resize(q_in.size());
          res_vector.resize(q_in.size());
-         jac_matrix.resize(q_in.size(), q_in.size());
          q = q_in;
        }
 
@@ -154,10 +194,89 @@ namespace lmx {
         */
       { conv3 = convergence_in; externalConvergence3 = 1; }
 
+      void setJacobianRefresh( int every, double stall = 0.5 )
+       /**
+        * Sets how often the Jacobian is rebuilt by the modified Newton method.
+        * @param every Number of iterations between Jacobian factorizations.
+        * @param stall Rebuild also if || RES || decreases less than this ratio.
+        */
+      { jac_refresh = every; stall_ratio = stall; }
+
+      void setQuasiNewtonMemory( int m )
+       /**
+        * Sets the number of stored steps for Broyden and L-BFGS methods.
+        * Broyden rebuilds the initial Jacobian when the memory is exhausted;
+        * L-BFGS drops its oldest pair instead.
+        * @param m Number of stored update pairs.
+        */
+      { qn_memory = m; }
+
+      void setLineSearch( double alpha = 1E-4, int max_backtracks = 10 )
+       /**
+        * Enables the backtracking line search. The step length l is reduced
+        * (quadratic interpolation, safeguarded in [0.1*l, 0.5*l]) until
+        * || R(q + l*Dq) ||^2 <= (1 - 2*alpha*l) * || R(q) ||^2.
+        * @param alpha Armijo sufficient decrease parameter.
+        * @param max_backtracks Maximum number of step reductions.
+        */
+      { globalization = 1; ls_alpha = alpha; max_trials = max_backtracks; }
+
+      void setTrustRegion( double radius = 0., int max_rejections = 10 )
+       /**
+        * Enables the dogleg trust region. The radius is adapted with the ratio
+        * between actual and predicted reduction of || R ||^2.
+        * @param radius Initial radius at each solve() call. If zero, the norm of
+        * the first increment is used.
+        * @param max_rejections Maximum number of rejected steps in each iteration.
+        */
+      { globalization = 2; tr_radius_init = radius; max_trials = max_rejections; }
+
+      void setKrylov( double eta, int restart = 30, int max_iter = 0 )
+       /**
+        * Sets the GMRES parameters of the Jacobian-free Newton-Krylov method.
+        * @param eta Relative tolerance of each linear solution (forcing term).
+        * @param restart Dimension of the Krylov subspace.
+        * @param max_iter Maximum number of GMRES iterations (0 = problem size + 20).
+        */
+      { krylov_eta = eta; krylov_restart = restart; krylov_max = max_iter; }
+
+      void setPreconditioner( void (Sys::*prec_in)(lmx::Vector<T>&, lmx::Vector<T>&) )
+       /**
+        * Defines the optional member function that applies an approximate
+        * inverse of the Jacobian, z = M^-1 * r, for the Jacobian-free
+        * Newton-Krylov method.
+        * @param prec_in Preconditioner member function, with (z, r) parameters.
+        */
+      { prec = prec_in; }
+
+      void setPreconditioner( LinearOperator<T>* prec_in )
+       /**
+        * Sets the preconditioner of the iterative linear solvers used for the
+        * increments (see setLinSolverType()), e.g. an AmgPrecond. Its update()
+        * function is called each time the Jacobian is assembled, so it can be
+        * kept between solve() calls. It is not deleted by the NLSolver.
+        * @param prec_in Preconditioner, or 0 for Jacobi.
+        */
+      { lin_prec = prec_in;
+        if (increment) increment->setPreconditioner(lin_prec);
+      }
+
+      void setFullStep( )
+       /**
+        * Disables the line search or trust region (default).
+        */
+      { globalization = 0; }
+
       bool convergence ( );
 
       void solve(int);
 
+      bool isConverged() const
+       /**
+        * @return TRUE if the last solve() call met the convergence criteria.
+        */
+        { return converged; }
+
       lmx::Vector<T>& getSolution()
        /**
         * Solution vector read-write access.
@@ -183,6 +302,65 @@ namespace lmx {
       bool externalConvergence2;
       bool externalConvergence3;
       bool deltaInResidue;
+      int jac_refresh; /**< Iterations between Jacobian updates in modified Newton. */
+      int jac_age; /**< Iterations since last Jacobian factorization (-1 if none). */
+      double stall_ratio; /**< Residue reduction that forces a Jacobian update. */
+      T res_norm_old; /**< Residue norm of previous iteration. */
+      int qn_memory; /**< Maximum number of stored quasi-Newton updates. */
+      std::vector< lmx::Vector<T> > steps; /**< Stored increments (s). */
+      std::vector< lmx::Vector<T> > res_diffs; /**< Stored residue differences (y). */
+      std::vector< T > steps_coef; /**< 1/(s*s) for Broyden, 1/(y*s) for L-BFGS. */
+      lmx::Vector<T> res_old; /**< Residue of previous iteration. */
+      int globalization; /**< 0 = full step, 1 = line search, 2 = trust region. */
+      T ls_alpha; /**< Armijo parameter. */
+      int max_trials; /**< Maximum backtracks or rejected steps per iteration. */
+      T tr_radius_init; /**< Trust region radius at the beginning of solve(). */
+      T tr_radius; /**< Current trust region radius. */
+      T step_length; /**< Fraction of the increment taken in last iteration. */
+      lmx::Vector<T> direction; /**< Increment computed by the selected method. */
+      lmx::Vector<T> trial; /**< Configuration change for trial residues. */
+      T krylov_eta; /**< GMRES relative tolerance in JFNK. */
+      int krylov_restart; /**< GMRES restart in JFNK. */
+      int krylov_max; /**< GMRES maximum iterations in JFNK. */
+      T fd_scale; /**< sqrt(eps)*(1 + || q ||) for the finite differences. */
+      lmx::Vector<T> probe; /**< Offset of the last finite difference evaluation. */
+      lmx::Vector<T> krylov_aux; /**< Work vector for the preconditioner. */
+      void (Sys::*prec)(lmx::Vector<T>&, lmx::Vector<T>&);
+      LinearOperator<T>* lin_prec; /**< Preconditioner of the linear increments. */
+      bool converged; /**< Convergence achieved in the last solve() call. */
+
+      /** Jacobian-vector product by finite differences of the residue. */
+      class JacobianOperator : public LinearOperator<T>{
+        public:
+          JacobianOperator( NLSolver* solver_in ) : solver(solver_in) {}
+          void apply( lmx::Vector<T>& y, const lmx::Vector<T>& v )
+          { solver->jacobianTimes( y, v ); }
+        private:
+          NLSolver* solver;
+      };
+
+      /** User supplied preconditioner for the Jacobian-free method. */
+      class PreconditionerOperator : public LinearOperator<T>{
+        public:
+          PreconditionerOperator( NLSolver* solver_in ) : solver(solver_in) {}
+          void apply( lmx::Vector<T>& z, const lmx::Vector<T>& r )
+          { solver->krylov_aux = r;
+            (solver->theSystem->*(solver->prec))( z, solver->krylov_aux ); }
+        private:
+          NLSolver* solver;
+      };
+
+      bool checkConvergence();
+      void newtonIncrement();
+      void modifiedNewtonIncrement( int );
+      void broydenIncrement( int );
+      void lbfgsIncrement( int );
+      void jacobianIncrement();
+      void trialResidue( lmx::Vector<T>& );
+      void lineSearchStep();
+      void trustRegionStep();
+      void jfnkIncrement();
+      void jacobianTimes( lmx::Vector<T>&, const lmx::Vector<T>& );
 
 
  };
@@ -205,6 +383,331 @@ namespace lmx {
     else { return 0; }
   }
 
+  template <typename Sys, class T>
+      bool NLSolver<Sys, T>::checkConvergence( )
+        /**
+         * Evaluates the external convergence function if set, or the internal one.
+         * @return TRUE if the iterations have converged.
+         */
+  {
+    if ( externalConvergence1 )
+      return (theSystem->*conv1)(res_vector);
+    else if ( externalConvergence2 )
+      return (theSystem->*conv2)(res_vector, q);
+    else if ( externalConvergence3 )
+      return (theSystem->*conv3)(res_vector, q, delta_q);
+    else
+      return this->convergence();
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::jacobianIncrement( )
+        /**
+         * Builds and factorizes the Jacobian, leaving the Newton increment in delta_q.
+         */
+  {
+    (theSystem->*jac)(jac_matrix, q);
+    increment->solveYourself();
+    jac_age = 0;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::newtonIncrement( )
+        /**
+         * Newton-Raphson increment: J(q) * Dq = -R(q).
+         */
+  {
+    jacobianIncrement();
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::modifiedNewtonIncrement( int iter )
+        /**
+         * Modified Newton increment. The factorized Jacobian is reused until
+         * it is jac_refresh iterations old or the residue norm is not reduced
+         * by stall_ratio. The age is kept between solve() calls.
+         * @param iter Current iteration.
+         */
+  {
+    T res_norm = res_vector.norm2();
+    if ( jac_age < 0 || jac_age >= jac_refresh
+         || ( iter > 0 && res_norm > stall_ratio * res_norm_old ) )
+      jacobianIncrement();
+    else
+      increment->solveYourself(true);
+    ++jac_age;
+    res_norm_old = res_norm;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::broydenIncrement( int iter )
+        /**
+         * Broyden's ("good") method applied in product form to the inverse of
+         * the initial Jacobian J0 (Kelley, 1995):
+         * z = J0^-1 * (-R), z += s_(j+1) * (s_j*z) / (s_j*s_j),
+         * s_new = z / (1 - s_n*z / (s_n*s_n)).
+         * @param iter Current iteration.
+         */
+  {
+    if ( iter > 0 && !steps.empty() && (int)steps.size() < qn_memory ){
+      increment->solveYourself(true);
+      size_type n = steps.size();
+      for ( size_type j = 0; j+1 < n; ++j )
+        delta_q.axpy( (steps[j] * delta_q) * steps_coef[j], steps[j+1] );
+      T denom = 1. - (steps[n-1] * delta_q) * steps_coef[n-1];
+      if ( std::abs(denom) > 1E-12 ){
+        delta_q *= 1. / denom;
+        steps.push_back( delta_q );
+        steps_coef.push_back( 1. / (delta_q * delta_q) );
+        return;
+      }
+    }
+    // First iteration, memory exhausted, breakdown or shortened step:
+    // restart from J(q).
+    jacobianIncrement();
+    steps.clear();
+    steps_coef.clear();
+    steps.push_back( delta_q );
+    steps_coef.push_back( 1. / (delta_q * delta_q) );
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::lbfgsIncrement( int iter )
+        /**
+         * Limited memory BFGS increment with the two-loop recursion, using the
+         * factorized initial Jacobian J0 as H0 = J0^-1. Only the last
+         * setQuasiNewtonMemory() pairs are kept (the oldest one is dropped when
+         * a new pair is stored), and pairs with y*s <= 0 are skipped. Only
+         * suitable for symmetric Jacobians.
+         * @param iter Current iteration.
+         */
+  {
+    if ( iter == 0 ){
+      jacobianIncrement();
+      steps.clear();
+      res_diffs.clear();
+      steps_coef.clear();
+      res_old.resize( res_vector.size() );
+      res_old = res_vector;
+      steps.push_back( delta_q ); // s of the pending pair
+      return;
+    }
+    // Complete the pending pair: y = R_new - R_old = res_old - res_vector.
+    lmx::Vector<T> y( res_old );
+    y -= res_vector;
+    T ys = y * steps.back();
+    if ( ys > 0. ){
+      res_diffs.push_back( y );
+      steps_coef.push_back( 1. / ys );
+      if ( (int)res_diffs.size() > qn_memory ){
+        steps.erase( steps.begin() );
+        res_diffs.erase( res_diffs.begin() );
+        steps_coef.erase( steps_coef.begin() );
+      }
+    }
+    else steps.pop_back();
+    res_old = res_vector;
+
+    size_type n = res_diffs.size();
+    std::vector<T> alpha( n );
+    lmx::Vector<T> r( res_vector );
+    for ( size_type j = n; j-- > 0; ){
+      alpha[j] = steps_coef[j] * ( steps[j] * r );
+      r.axpy( -alpha[j], res_diffs[j] );
+    }
+    // Apply H0 through the kept factorization (its RHS is res_vector):
+    res_vector = r;
+    increment->solveYourself(true);
+    res_vector = res_old;
+    for ( size_type j = 0; j < n; ++j ){
+      T beta = steps_coef[j] * ( res_diffs[j] * delta_q );
+      delta_q.axpy( alpha[j] - beta, steps[j] );
+    }
+    steps.push_back( delta_q );
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::trialResidue( lmx::Vector<T>& change )
+        /**
+         * Moves the configuration and evaluates the residue (stored as -R) there.
+         * @param change Configuration change from the last evaluated point.
+         */
+  {
+    q += change;
+    if (deltaInResidue) (theSystem->*res)(res_vector, change);
+    else                (theSystem->*res)(res_vector, q);
+    res_vector *= -1.;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::lineSearchStep( )
+        /**
+         * Backtracking (Armijo) line search along the increment in delta_q.
+         * On exit q, res_vector and delta_q correspond to the accepted step.
+         */
+  {
+    direction.resize( q.size() );
+    trial.resize( q.size() );
+    direction = delta_q;
+    T f0 = res_vector * res_vector;
+    T lambda = 1., lambda_old = 0.;
+    for ( int k = 0; ; ++k ){
+      trial = direction;
+      trial *= lambda - lambda_old;
+      trialResidue( trial );
+      T f = res_vector * res_vector;
+      if ( f <= (1. - 2.*ls_alpha*lambda) * f0 || k == max_trials ) break;
+      // Minimum of the quadratic model of || R ||^2 / 2 along the increment:
+      T lambda_new = f0*lambda*lambda / ( f - f0 + 2.*f0*lambda );
+      lambda_old = lambda;
+      if ( !(lambda_new > .1*lambda) ) lambda_new = .1*lambda;
+      else if ( lambda_new > .5*lambda ) lambda_new = .5*lambda;
+      lambda = lambda_new;
+    }
+    delta_q = direction;
+    delta_q *= lambda;
+    step_length = lambda;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::trustRegionStep( )
+        /**
+         * Dogleg trust region step between the Cauchy point of || R ||^2 and
+         * the increment in delta_q, using jac_matrix as local model.
+         * Rejected steps are undone and retried with a smaller radius.
+         * On exit q, res_vector and delta_q correspond to the accepted step.
+         */
+  {
+    if (getNLSolverType() == 4){
+      std::stringstream message;
+      message << "Error in NLSolver: trust region needs the Jacobian matrix, "
+          << "use setLineSearch() with the Jacobian-free method." << endl;
+      LMX_THROW(failure_error, message.str() );
+    }
+    size_type n = q.size();
+    direction.resize( n );
+    trial.resize( n );
+    res_old.resize( n );
+    direction = delta_q;
+    res_old = res_vector;
+    lmx::Vector<T> grad( n ), jac_grad( n );
+    grad.mult( transposed(jac_matrix), res_vector ); // descent: -J^T R
+    jac_grad.mult( jac_matrix, grad );
+    T f0 = res_vector * res_vector;
+    T newton_norm = direction.norm2();
+    T grad_norm = grad.norm2();
+    T cauchy_length = grad_norm*grad_norm / ( jac_grad * jac_grad );
+    if ( tr_radius <= 0. ) tr_radius = newton_norm;
+
+    for ( int k = 0; ; ++k ){
+      // Dogleg step in delta_q:
+      if ( newton_norm <= tr_radius )
+        delta_q = direction;
+      else if ( cauchy_length * grad_norm >= tr_radius ){
+        delta_q = grad;
+        delta_q *= tr_radius / grad_norm;
+      }
+      else{
+        // delta_q = s_c + tau*(s_n - s_c), with || delta_q || = radius
+        lmx::Vector<T> cauchy( grad );
+        cauchy *= cauchy_length;
+        trial = direction;
+        trial -= cauchy;
+        T a = trial * trial;
+        T b = 2. * ( cauchy * trial );
+        T c = cauchy * cauchy - tr_radius * tr_radius;
+        T tau = ( -b + std::sqrt( b*b - 4.*a*c ) ) / ( 2.*a );
+        delta_q = cauchy;
+        delta_q.axpy( tau, trial );
+      }
+      T step_norm = delta_q.norm2();
+      // Predicted || R + J*s ||^2 (R = -res_old):
+      trial.mult( jac_matrix, delta_q );
+      trial -= res_old;
+      T predicted = f0 - trial * trial;
+
+      trialResidue( delta_q );
+      T f = res_vector * res_vector;
+      T rho = ( predicted > 0. ) ? ( f0 - f ) / predicted : -1.;
+
+      if ( rho < .25 ) tr_radius = .25 * step_norm;
+      else if ( rho > .75 && step_norm >= .99 * tr_radius ) tr_radius *= 2.;
+
+      if ( rho > 1E-4 || k == max_trials ) break;
+      // Rejected: go back to the previous configuration.
+      trial = delta_q;
+      trial *= -1.;
+      if (deltaInResidue) trialResidue( trial );
+      else q += trial;
+      res_vector = res_old;
+    }
+    step_length = delta_q.norm2() / newton_norm;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::jacobianTimes( lmx::Vector<T>& y, const lmx::Vector<T>& v )
+        /**
+         * Forward difference approximation of the Jacobian-vector product,
+         * J*v = ( R(q + e*v) - R(q) ) / e, with e = sqrt(eps)*(1 + || q ||)/|| v ||.
+         * With deltaInResidue the system is moved from the last probe point,
+         * so it is left at q + e*v (jfnkIncrement() moves it back).
+         * @param y Result vector.
+         * @param v Vector to be multiplied.
+         */
+  {
+    T v_norm = v.norm2();
+    if ( v_norm == 0. ){
+      y.fillIdentity( 0. );
+      return;
+    }
+    T e = fd_scale / v_norm;
+    trial = v;
+    trial *= e;
+    if (deltaInResidue){
+      trial -= probe;
+      probe += trial;
+      (theSystem->*res)(y, trial);
+    }
+    else{
+      trial += q;
+      (theSystem->*res)(y, trial);
+    }
+    y += res_vector; // res_vector = -R(q)
+    y *= 1. / e;
+  }
+
+  template <typename Sys, class T>
+      void NLSolver<Sys, T>::jfnkIncrement( )
+        /**
+         * Jacobian-free Newton-Krylov increment: J(q) * Dq = -R(q) solved with
+         * GMRES using finite difference Jacobian-vector products.
+         */
+  {
+    size_type n = q.size();
+    trial.resize( n );
+    probe.resize( n );
+    probe.fillIdentity( 0. );
+    fd_scale = std::sqrt( std::numeric_limits<T>::epsilon() ) * ( 1. + q.norm2() );
+
+    JacobianOperator jacobian_op( this );
+    PreconditionerOperator prec_op( this );
+    Gmres<T> gmres( &jacobian_op, &res_vector );
+    gmres.setTolerance( krylov_eta );
+    gmres.setRestart( krylov_restart );
+    if ( krylov_max > 0 ) gmres.setMaxIterations( krylov_max );
+    if ( prec ){
+      krylov_aux.resize( n );
+      gmres.setPreconditioner( &prec_op );
+    }
+    delta_q = gmres.solve();
+
+    if ( deltaInResidue && probe.norm2() != 0. ){
+      // Move the system back to q:
+      probe *= -1.;
+      (theSystem->*res)(trial, probe);
+    }
+  }
+
   template <typename Sys, class T>
       void NLSolver<Sys, T>::solve(int max_iter = 100)
         /**
@@ -219,50 +722,84 @@ namespace lmx {
       LMX_THROW(dimension_error, message.str() );
     }
     
-    switch (nl_solver_type) {
-
-      case 0 : // select_nl_solver == 0 -> Newton's method
-        if (!increment)
-          increment = new lmx::LinearSystem<T>(jac_matrix, delta_q, res_vector);
-        cout << "     iter-NL\t  | RES |\t|| RES ||\t|| Dq ||" << endl;
-        cout.setf(std::ios::scientific, std::ios::floatfield);
-        cout.precision(3);
-
-        for(int i=0; i<max_iter; i++){
-          cout << "\t" << i << "\t";
-          if (deltaInResidue) (theSystem->*res)(res_vector, delta_q);
-          else                (theSystem->*res)(res_vector, q);
-          res_vector *= -1.;
-          cout << res_vector.norm1() << "\t" << res_vector.norm2() << "\t";
-
-          if ( externalConvergence1 ){
-            if ( (theSystem->*conv1)(res_vector) ){
-              std::cout << endl << endl;
-              break;
-            }
-          }
-          else if ( externalConvergence2 ){
-            if ( (theSystem->*conv2)(res_vector, q) ){
-              std::cout << endl << endl;
-              break;
-            }
-          }
-          else if ( externalConvergence3 ){
-            if ( (theSystem->*conv3)(res_vector, q, increment->getSolution()) ){
-              std::cout << endl << endl;
-              break;
-            }
-          }
-          else if (this->convergence() ){
-            std::cout << endl << endl;
-            break;
-          }
-          (theSystem->*jac)(jac_matrix, q);
-          q += increment->solveYourself();
-          std::cout << increment->getSolution().norm2() << endl;
-        }
-
+    if (getNLSolverType() != 4){
+      if (jac_matrix.rows() != q.size())
+        jac_matrix.resize(q.size(), q.size());
+      if (!increment){
+        increment = new lmx::LinearSystem<T>(jac_matrix, delta_q, res_vector);
+        increment->setPreconditioner(lin_prec);
+      }
+    }
+    cout << "     iter-NL\t  | RES |\t|| RES ||\t|| Dq ||";
+    if (globalization) cout << "\t  step";
+    cout << endl;
+    cout.setf(std::ios::scientific, std::ios::floatfield);
+    cout.precision(3);
+    tr_radius = tr_radius_init;
+    bool res_ready = 0; // residue already evaluated by line search or trust region
+    converged = 0;
+
+    for(int i=0; i<max_iter; i++){
+      cout << "\t" << i << "\t";
+      if (!res_ready){
+        if (deltaInResidue) (theSystem->*res)(res_vector, delta_q);
+        else                (theSystem->*res)(res_vector, q);
+        res_vector *= -1.;
+      }
+      res_ready = 0;
+      cout << res_vector.norm1() << "\t" << res_vector.norm2() << "\t";
+
+      if ( this->checkConvergence() ){
+        std::cout << endl << endl;
+        converged = 1;
         break;
+      }
+      switch (getNLSolverType()) {
+        case 0 : // Newton's method
+          newtonIncrement();
+          break;
+
+        case 1 : // Modified Newton
+          modifiedNewtonIncrement( i );
+          break;
+
+        case 2 : // Broyden
+          broydenIncrement( i );
+          break;
+
+        case 3 : // L-BFGS
+          lbfgsIncrement( i );
+          break;
+
+        case 4 : // Jacobian-free Newton-Krylov
+          jfnkIncrement();
+          break;
+
+        default :
+        {
+          std::stringstream message;
+          message << "Error in NLSolver: non-linear solver type " << getNLSolverType()
+              << " not implemented." << endl;
+          LMX_THROW(to_be_done_error, message.str() );
+        }
+      }
+      if (globalization == 0){
+        q += delta_q;
+        std::cout << delta_q.norm2() << endl;
+      }
+      else{
+        if (globalization == 1) lineSearchStep();
+        else                    trustRegionStep();
+        res_ready = 1;
+        // Quasi-Newton updates need the step actually taken:
+        if (step_length != 1.){
+          if (getNLSolverType() == 2)
+            steps.clear();
+          else if (getNLSolverType() == 3)
+            steps.back() = delta_q;
+        }
+        std::cout << delta_q.norm2() << "\t" << step_length << endl;
+      }
     }
     cout.unsetf(std::ios::floatfield);  }
 
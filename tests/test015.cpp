@@ -0,0 +1,60 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(4);
+  setVectorType(0);
+  setLinSolverType(0);
+
+  // Odd size so that rows are padded by the leading dimension:
+  Matrix<double> A(5,5);
+  Matrix<double> B(5,5);
+  Vector<double> b(5);
+
+  b.fillIdentity();
+  for (int i=0; i<5; ++i){
+    for (int j=0; j<=i; ++j){
+      A.writeElement(4.5+i-20./(j+1), i, j);
+      A.writeElement(A(i,j), j, i);
+    }
+    A(i,i) += 30.;
+  }
+  B.fillIdentity(2.);
+  B(0,4) = 1.;
+
+  cout << A << endl;
+  cout << "A+B = " << A+B << endl;
+  cout << "A*B = " << A*B << endl;
+
+  // Resizing keeps the contents:
+  B.resize(6,7);
+  cout << "B = " << B << endl;
+  B.transpose();
+  cout << "B^t = " << B << endl;
+
+  // Shrinking and growing again within the leading dimension clears the
+  // new columns:
+  Matrix<double> C(3,8);
+  for (int i=0; i<3; ++i)
+    for (int j=0; j<8; ++j)
+      C(i,j) = 1.;
+  C.resize(3,5);
+  C.resize(3,8);
+  cout << "C = " << C << endl;
+
+  // Raw access through DenseMatrix:
+  DenseMatrix<double> D(3,3);
+  D.fillIdentity(1.);
+  D.data_pointer()[D.getLeadingDim() + 2] = 7.;
+  cout << "D = " << D << endl;
+
+  LinearSystem<double> x(A,b);
+  x.solveYourself();
+
+  cout << x.getSolution();
+
+}
@@ -0,0 +1,62 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(5);
+  setVectorType(0);
+  setLinSolverType(2);
+
+  int size = 6;
+  Matrix<double> A(size,size);
+  Vector<double> b(size);
+  Vector<double> c(size);
+
+  for (int i=0; i<size; ++i){
+    A(i,i) = 4.;
+    if (i>0) A(i,i-1) = -1.;
+    if (i<size-1) A(i,i+1) = -1.;
+    b(i) = i+1;
+  }
+  A(0,size-1) = .5;
+  A(size-1,0) = .5;
+
+  cout << A << endl;
+  c.mult(A,b);
+  cout << "A*b = " << c << endl;
+
+  // Conversions between CSR and CSC storage:
+  Type_csr<double> csr;
+  Type_csc<double> csc(size,size);
+  for (int i=0; i<size; ++i)
+    for (int j=0; j<size; ++j)
+      csc.writeElement( (i+1)*(i==j) + .5*(j==i+2), i, j );
+  copy( &csc, &csr );
+  csr.trn();
+  copy( &csr, &csc );
+  for (int i=0; i<size; ++i){
+    for (int j=0; j<size; ++j)
+      cout << csc.readElement(i,j) << " ";
+    cout << endl;
+  }
+
+  LinearSystem<double> x(A,b);
+  x.solveYourself();
+
+  cout << x.getSolution();
+
+  // Direct solvers:
+  setLinSolverType(0);
+  LinearSystem<double> y(A,b);
+  y.solveYourself();
+  cout << y.getSolution();
+
+  setLinSolverType(1);
+  LinearSystem<double> z(A,b);
+  z.solveYourself();
+  cout << z.getSolution();
+
+}
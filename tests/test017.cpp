@@ -0,0 +1,49 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+
+  int size = 8;
+  Matrix<double> A(size,size);
+  Matrix<double> B(size,size);
+
+  // Staged assembly of 1D bar elements:
+  A.beginAssembly();
+  for (int e=0; e<size-1; ++e){
+    int dofs[2] = {e, e+1};
+    for (int a=0; a<2; ++a){
+      for (int b=0; b<2; ++b){
+        A(dofs[a],dofs[b]) += (a==b) ? 1. : -1.;
+      }
+    }
+  }
+  A(0,0) = 7.;
+  A(0,0) += 1.;
+  A(3,7) = 2.;
+  A(3,7) = 5.;
+  cout << "A(3,7) before endAssembly = " << A(3,7) << endl;
+  A.endAssembly();
+  cout << "A(3,7) after endAssembly = " << A(3,7) << endl;
+  cout << A << endl;
+
+  // Same matrix with direct insertion:
+  for (int e=0; e<size-1; ++e){
+    int dofs[2] = {e, e+1};
+    for (int a=0; a<2; ++a){
+      for (int b=0; b<2; ++b){
+        B(dofs[a],dofs[b]) += (a==b) ? 1. : -1.;
+      }
+    }
+  }
+  B(0,0) = 8.;
+  B(3,7) = 5.;
+  B -= A;
+  cout << "B-A = " << B << endl;
+
+}
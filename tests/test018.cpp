@@ -0,0 +1,72 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(6);
+  setVectorType(0);
+  setLinSolverType(2);
+
+  int size = 6;
+  Matrix<double> A(size,size);
+  Vector<double> b(size);
+  Vector<double> c(size);
+
+  // Pattern of a tridiagonal matrix (one based, both triangles):
+  std::vector<size_type> rows, cols;
+  cols.push_back(1);
+  for (int j=0; j<size; ++j){
+    for (int i=j-1; i<=j+1; ++i)
+      if (i>=0 && i<size) rows.push_back(i+1);
+    cols.push_back(rows.size()+1);
+  }
+  A.sparsePattern(rows, cols);
+
+  // Assembly of 2x2 element matrices, both triangles are added:
+  for (int e=0; e<size-1; ++e){
+    A(e,e) += 2.;
+    A(e,e+1) -= 1.;
+    A(e+1,e) -= 1.;
+    A(e+1,e+1) += 2.;
+    b(e) = e+1;
+  }
+  b(size-1) = size;
+
+  // The same assembly on a general sparse matrix:
+  Type_csc<double> B(size,size);
+  B.setSparsePattern(rows, cols);
+  for (int e=0; e<size-1; ++e){
+    B.addElement(2., e, e);
+    B.addElement(-1., e, e+1);
+    B.addElement(-1., e+1, e);
+    B.addElement(2., e+1, e+1);
+  }
+  bool same = true;
+  for (int i=0; i<size; ++i)
+    for (int j=0; j<size; ++j)
+      if (A.readElement(i,j) != B.readElement(i,j)) same = false;
+  cout << "Same assembly as Type_csc: " << (same ? "yes" : "no") << endl;
+
+  cout << A << endl;
+  c.mult(A,b);
+  cout << "A*b = " << c << endl;
+
+  // Writing on the upper triangle sets the symmetric element:
+  A(0,size-1) = .5;
+  cout << A(size-1,0) << endl;
+
+  LinearSystem<double> x(A,b);
+  x.solveYourself();
+
+  cout << x.getSolution();
+
+  setLinSolverType(0);
+  LinearSystem<double> y(A,b);
+  y.solveYourself();
+
+  cout << y.getSolution();
+
+}
@@ -0,0 +1,62 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(8); // Block sparse rows, 3x3 blocks
+  setVectorType(0);
+  setLinSolverType(2);
+
+  int nodes = 3;
+  int size = 3*nodes;
+  Matrix<double> A(size,size);
+  Vector<double> b(size);
+  Vector<double> c(size);
+
+  // Element pattern: node n is connected to nodes n-1 and n+1.
+  std::vector<size_type> rows, cols;
+  cols.push_back(1);
+  for (int j=0; j<size; ++j){
+    for (int i=0; i<size; ++i)
+      if (i/3 >= j/3-1 && i/3 <= j/3+1) rows.push_back(i+1);
+    cols.push_back(rows.size()+1);
+  }
+  A.sparsePattern(rows, cols);
+
+  for (int n=0; n<nodes; ++n){
+    for (int i=0; i<3; ++i){
+      A(3*n+i,3*n+i) = 4.;
+      A(3*n+i,3*n+(i+1)%3) = .5;
+      A(3*n+(i+1)%3,3*n+i) = .5;
+      if (n>0){
+        A(3*n+i,3*(n-1)+i) = -1.;
+        A(3*(n-1)+i,3*n+i) = -1.;
+      }
+    }
+  }
+  for (int i=0; i<size; ++i) b(i) = i+1;
+
+  cout << A << endl;
+  c.mult(A,b);
+  cout << "A*b = " << c << endl;
+
+  LinearSystem<double> x(A,b);
+  x.solveYourself();
+
+  cout << x.getSolution();
+
+  // Sparse LDL^T over the blocks:
+  setLinSolverType(0);
+  LinearSystem<double> y(A,b);
+  y.solveYourself();
+
+  cout << y.getSolution();
+
+  A(0,size-1) = 2.;
+  A.transpose();
+  cout << A(size-1,0) << " " << A(0,size-1) << endl;
+
+}
@@ -0,0 +1,48 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setVectorType(0);
+
+  int size = 4;
+  Vector<double> a(size);
+  Vector<double> b(size);
+  Vector<double> c(size);
+
+  for (int i=0; i<size; ++i){
+    a(i) = i+1;
+    b(i) = 10.*(i+1);
+  }
+
+  // Expressions are evaluated in one loop when assigned:
+  c = a + 0.5*b - a*2.;
+  cout << "c = " << c << endl;
+
+  c += b - a;
+  cout << "c += b - a: " << c << endl;
+
+  c -= 2.*(a + b);
+  cout << "c -= 2*(a+b): " << c << endl;
+
+  Vector<double> d = a - b + c;
+  cout << "d = " << d << endl;
+
+  cout << "(a+b)*(b-a) = " << (a+b)*(b-a) << endl;
+  cout << "a*b = " << a*b << endl;
+
+  cout << "a + b = " << a + b << endl;
+
+  // Scalars of other types and Vector members on expressions:
+  c = a*2 - 3*b;
+  cout << "a*2 - 3*b = " << c << endl;
+  cout << "|a+b| = " << (a+b).norm2() << ", |a-b|_1 = " << (a-b).norm1() << endl;
+
+  // Aliasing is allowed, as every element only depends on itself:
+  a = a + a;
+  cout << "a = a + a: " << a << endl;
+
+}
@@ -0,0 +1,64 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+typedef Matrix< double, Type_csr<double> > MatrixCsr;
+typedef Matrix< double, Type_dense<double> > MatrixDense;
+typedef Vector< double, Type_stdVector<double> > VectorStd;
+
+int main(int argc, char** argv){
+
+  // Run-time selected types are still available and independent:
+  setMatrixType(0);
+  setVectorType(0);
+
+  int size = 5;
+  MatrixCsr A(size,size);
+  MatrixDense B(size,size);
+  Matrix<double> C(size,size);
+  VectorStd b(size);
+  VectorStd c(size);
+  Vector<double> d(size);
+
+  for (int i=0; i<size; ++i){
+    A(i,i) = 4.;
+    if (i>0) A(i,i-1) = -1.;
+    if (i<size-1) A(i,i+1) = -1.;
+    b(i) = i+1;
+    d(i) = i+1;
+    C(i,i) = 2.;
+  }
+  B = A;
+
+  cout << A << endl;
+  c.mult(A,b);
+  cout << "Csr A*b = " << c << endl;
+
+  c.mult(B,b);
+  cout << "Dense A*b = " << c << endl;
+
+  cout << "C*d = " << C*d << endl;
+
+  // Expressions over static Vectors:
+  VectorStd e = A*b - 2.*b;
+  cout << "A*b - 2*b = " << e << endl;
+  e += b;
+  cout << "e += b: " << e << endl;
+  cout << "b*e = " << b*e << endl;
+  cout << "norm2(b) = " << b.norm2() << endl;
+
+  B *= 2.;
+  B += B;
+  B.transpose();
+  cout << "4*A^T = " << B << endl;
+
+  MatrixDense D(size,size);
+  D.mult(B,B);
+  cout << "16*A^T*A^T = " << D << endl;
+
+  A.fillIdentity(3.);
+  cout << "3*I = " << A << endl;
+
+}
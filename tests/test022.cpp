@@ -0,0 +1,62 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+template <typename M>
+    void assemble( int size )
+{
+  // Assembly of 2x2 bar elements with scatterAdd:
+  size_type dofs[2];
+  double k_elem[4] = { 1., -1., -1., 1. };
+  double f_elem[2] = { .5, .5 };
+
+  M K(size,size);
+  Vector<double> f(size);
+  for (int e=0; e<size-1; ++e){
+    dofs[0] = e;
+    dofs[1] = e+1;
+    K.scatterAdd( k_elem, dofs, 2, dofs, 2 );
+    f.scatterAdd( f_elem, dofs, 2 );
+  }
+  cout << "K = " << K << endl;
+  cout << "f = " << f << endl;
+
+  double k_read[4];
+  K.gather( k_read, dofs, 2, dofs, 2 );
+  cout << "K(2:3,2:3) = " << k_read[0] << " " << k_read[1] << " "
+       << k_read[2] << " " << k_read[3] << endl;
+
+  Vector<double> diag;
+  K.getDiagonal( diag );
+  cout << "diag(K) = " << diag << endl;
+
+  M K2(size,size);
+  K2.fillIdentity();
+  K2.axpy( 2., K );
+  cout << "I + 2K = " << K2 << endl;
+}
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+
+  int size = 4;
+  assemble< Matrix<double> >( size );
+  assemble< DenseMatrix<double> >( size );
+
+  Vector<double> a(size), b(size);
+  size_type index[2] = { 3, 1 };
+  double values[2] = { 10., 20. };
+  a.fillIdentity(1.);
+  a.scatter( values, index, 2 );
+  b.fillIdentity(2.);
+  b.axpy( -.5, a );
+  cout << "b - .5 a = " << b << endl;
+  b.gather( values, index, 2 );
+  cout << "b(3), b(1) = " << values[0] << " " << values[1] << endl;
+  cout << "raw b[3] = " << b.data_pointer()[3] << endl;
+
+}
@@ -0,0 +1,42 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(0);
+  setVectorType(0);
+  setLinSolverType(0);
+
+  int size = 4;
+  Matrix<double> A(size,size);
+  DenseMatrix<double> dA(size,size);
+  Vector<double> b(size);
+
+  for (int i=0; i<size; ++i){
+    A(i,i) = 4.;
+    if (i>0) A(i,i-1) = -1.;
+    if (i<size-1) A(i,i+1) = -2.;
+    b(i) = 1.;
+  }
+  dA = A;
+
+  LinearSystem<double> system(A,b);
+  LinearSystem<double> dense_system(dA,b);
+  cout << "x = " << system.solveYourself() << endl;
+
+  // Same matrix, new right hand sides: only the substitutions are done.
+  for (int step=1; step<3; ++step){
+    b(step) = 10.*step;
+    cout << "b = " << b << endl;
+    cout << "x (reused factors) = " << system.solveYourself(true) << endl;
+    cout << "x (dense, reused factors) = " << dense_system.solveYourself(step > 1) << endl;
+  }
+
+  // The matrix changes, so it is factorized again:
+  A(0,0) = 8.;
+  cout << "x (new factors) = " << system.solveYourself() << endl;
+
+}
@@ -0,0 +1,67 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+#include "LMX/lmx_nlsolvers.h"
+
+using namespace lmx;
+
+class MyExternalSystem{
+public:
+  MyExternalSystem(){}
+
+  ~MyExternalSystem(){}
+
+  void residuo(lmx::Vector<double>& res_in, lmx::Vector<double>& q_in){
+    // x_i^3 + x_i - 0.5*(x_(i-1) + x_(i+1)) = i^3
+    int n = q_in.size();
+    for (int i=0; i<n; ++i){
+      double x = q_in.readElement(i);
+      double r = x*x*x + x - std::pow(i+1.,3);
+      if (i>0) r -= 0.5*q_in.readElement(i-1);
+      if (i<n-1) r -= 0.5*q_in.readElement(i+1);
+      res_in.writeElement( r, i );
+    }
+  }
+
+  void jacobiano(lmx::Matrix<double>& jac_in, lmx::Vector<double>& q_in){
+    int n = q_in.size();
+    for (int i=0; i<n ; ++i){
+      jac_in.writeElement( 3.*q_in.readElement(i)*q_in.readElement(i) + 1., i, i);
+      if (i>0) jac_in.writeElement( -0.5, i, i-1);
+      if (i<n-1) jac_in.writeElement( -0.5, i, i+1);
+    }
+    ++jacobians;
+  }
+
+  int jacobians;
+};
+
+int main(int argc, char** argv){
+
+  setMatrixType(0);
+  setVectorType(0);
+  setLinSolverType(0);
+
+  Vector<double> b(4);
+  b.fillIdentity(2.);
+
+  MyExternalSystem theSystem;
+  lmx::NLSolver<MyExternalSystem> theSolver;
+  theSolver.setSystem( theSystem );
+  theSolver.setResidue( &MyExternalSystem::residuo );
+  theSolver.setJacobian( &MyExternalSystem::jacobiano );
+  theSolver.setConvergence( 1E-8 );
+  theSolver.setJacobianRefresh( 4, 0.5 );
+  theSolver.setQuasiNewtonMemory( 5 );
+
+  const char* names[] = { "Newton", "Modified Newton", "Broyden", "L-BFGS" };
+  for (int type=0; type<4; ++type){
+    setNLSolverType(type);
+    theSystem.jacobians = 0;
+    theSolver.setInitialConfiguration( b );
+    theSolver.solve( 100 );
+    cout << names[getNLSolverType()] << ": " << theSystem.jacobians
+         << " Jacobian evaluations." << endl;
+    cout << "Resultado: " << theSolver.getSolution() << endl;
+  }
+}
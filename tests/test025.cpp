@@ -0,0 +1,70 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+#include "LMX/lmx_nlsolvers.h"
+
+using namespace lmx;
+
+class MyExternalSystem{
+public:
+  MyExternalSystem(){}
+
+  ~MyExternalSystem(){}
+
+  void residuo(lmx::Vector<double>& res_in, lmx::Vector<double>& q_in){
+    // atan(x_i - i) + 0.1*(x_i - x_(i+1)) = 0.1*(i - (i+1))
+    int n = q_in.size();
+    for (int i=0; i<n; ++i){
+      double r = std::atan( q_in.readElement(i) - i );
+      if (i<n-1) r += 0.1*( q_in.readElement(i) - q_in.readElement(i+1) + 1. );
+      res_in.writeElement( r, i );
+    }
+  }
+
+  void jacobiano(lmx::Matrix<double>& jac_in, lmx::Vector<double>& q_in){
+    int n = q_in.size();
+    for (int i=0; i<n ; ++i){
+      double d = q_in.readElement(i) - i;
+      jac_in.writeElement( 1./(1.+d*d) + (i<n-1 ? 0.1 : 0.), i, i);
+      if (i<n-1) jac_in.writeElement( -0.1, i, i+1);
+    }
+  }
+};
+
+int main(int argc, char** argv){
+
+  setMatrixType(0);
+  setVectorType(0);
+  setLinSolverType(0);
+
+  Vector<double> b(3);
+  for (int i=0; i<3; ++i) b(i) = i + 3.;
+
+  MyExternalSystem theSystem;
+  lmx::NLSolver<MyExternalSystem> theSolver;
+  theSolver.setSystem( theSystem );
+  theSolver.setResidue( &MyExternalSystem::residuo );
+  theSolver.setJacobian( &MyExternalSystem::jacobiano );
+  theSolver.setConvergence( 1E-10 );
+
+  // Full Newton steps diverge from this initial guess:
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 5 );
+  cout << "Full step: " << theSolver.getSolution() << endl;
+
+  theSolver.setLineSearch( );
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 50 );
+  cout << "Line search: " << theSolver.getSolution() << endl;
+
+  theSolver.setTrustRegion( 1. );
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 50 );
+  cout << "Trust region: " << theSolver.getSolution() << endl;
+
+  setNLSolverType(2);
+  theSolver.setLineSearch( );
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 50 );
+  cout << "Broyden with line search: " << theSolver.getSolution() << endl;
+}
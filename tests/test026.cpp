@@ -0,0 +1,99 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+#include "LMX/lmx_nlsolvers.h"
+
+using namespace lmx;
+
+// -x_(i-1) + 2*x_i - x_(i+1) + h^2*x_i^3 = h^2*10, x_0 = x_n+1 = 0
+class MyExternalSystem{
+public:
+  MyExternalSystem(int n) : conf(n), h(1./(n+1)), evaluations(0) {}
+
+  ~MyExternalSystem(){}
+
+  void residuo(lmx::Vector<double>& res_in, lmx::Vector<double>& q_in){
+    int n = q_in.size();
+    for (int i=0; i<n; ++i){
+      double x = q_in.readElement(i);
+      double r = 2.*x + h*h*(x*x*x - 10.);
+      if (i>0) r -= q_in.readElement(i-1);
+      if (i<n-1) r -= q_in.readElement(i+1);
+      res_in.writeElement( r, i );
+    }
+    ++evaluations;
+  }
+
+  // Residue with increments of the configuration, as the integrators do:
+  void residuoDelta(lmx::Vector<double>& res_in, lmx::Vector<double>& delta_in){
+    conf += delta_in;
+    residuo( res_in, conf );
+  }
+
+  // Inverse of the linear part, tridiag(-1,2,-1) (Thomas algorithm):
+  void precond(lmx::Vector<double>& z_in, lmx::Vector<double>& r_in){
+    int n = r_in.size();
+    std::vector<double> c(n);
+    double d = 2.;
+    z_in.writeElement( r_in.readElement(0) / d, 0 );
+    for (int i=1; i<n; ++i){
+      c[i] = -1. / d;
+      d = 2. + c[i];
+      z_in.writeElement( ( r_in.readElement(i) + z_in.readElement(i-1) ) / d, i );
+    }
+    for (int i=n-2; i>=0; --i)
+      z_in.writeElement( z_in.readElement(i) - c[i+1]*z_in.readElement(i+1), i );
+  }
+
+  lmx::Vector<double> conf;
+  double h;
+  int evaluations;
+};
+
+int main(int argc, char** argv){
+
+  setMatrixType(0);
+  setVectorType(0);
+  setLinSolverType(0);
+  setNLSolverType(4);
+
+  int n = 20;
+  Vector<double> b(n);
+
+  MyExternalSystem theSystem(n);
+  lmx::NLSolver<MyExternalSystem> theSolver;
+  theSolver.setSystem( theSystem );
+  theSolver.setResidue( &MyExternalSystem::residuo );
+  theSolver.setConvergence( 1E-8 );
+  theSolver.setKrylov( 1E-6, 10 );
+
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 20 );
+  cout << "JFNK, GMRES(10): " << theSystem.evaluations << " residue evaluations." << endl;
+  Vector<double> sol( theSolver.getSolution() );
+  cout << "Resultado: " << sol << endl;
+
+  theSystem.evaluations = 0;
+  theSolver.setPreconditioner( &MyExternalSystem::precond );
+  theSolver.setInitialConfiguration( b );
+  theSolver.solve( 20 );
+  cout << "Preconditioned: " << theSystem.evaluations << " residue evaluations." << endl;
+  Vector<double> diff( sol );
+  diff -= theSolver.getSolution();
+  cout << "Difference: " << (diff.norm2() < 1E-8) << endl;
+
+  lmx::NLSolver<MyExternalSystem> theDeltaSolver;
+  theDeltaSolver.setSystem( theSystem );
+  theDeltaSolver.setDeltaInResidue( );
+  theDeltaSolver.setResidue( &MyExternalSystem::residuoDelta );
+  theDeltaSolver.setConvergence( 1E-8 );
+  theDeltaSolver.setLineSearch( );
+  theDeltaSolver.setInitialConfiguration( b );
+  theDeltaSolver.solve( 20 );
+  diff = sol;
+  diff -= theDeltaSolver.getSolution();
+  cout << "Delta in residue, difference: " << (diff.norm2() < 1E-8) << endl;
+  diff = theDeltaSolver.getSolution();
+  diff -= theSystem.conf;
+  cout << "System configuration, difference: " << (diff.norm2() < 1E-12) << endl;
+}
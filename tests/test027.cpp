@@ -0,0 +1,57 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(0);
+  setVectorType(0);
+
+  // Non-symmetric convection-diffusion operator:
+  int size = 30;
+  Matrix<double> A(size,size);
+  Vector<double> b(size), x(size), x_ref(size), diff(size);
+  for (int i=0; i<size; ++i){
+    A(i,i) = 2. + 0.1*i;
+    if (i>0) A(i,i-1) = -1.6;
+    if (i<size-1) A(i,i+1) = -0.4;
+    b(i) = 1.;
+  }
+
+  LinearSystem<double> theLSolver( A, x, b );
+
+  setLinSolverType(0);
+  x_ref = theLSolver.solveYourself();
+
+  setLinSolverType(3);
+  theLSolver.solveYourself();
+  diff.subs( x, x_ref );
+  cout << "GMRES error: " << ( diff.norm2() < 1E-4 ) << endl;
+
+  setLinSolverType(4);
+  theLSolver.solveYourself();
+  diff.subs( x, x_ref );
+  cout << "BiCGStab error: " << ( diff.norm2() < 1E-4 ) << endl;
+
+  // Direct use of the classes, with the same preconditioner:
+  JacobiPrecond<double> jacobi( &A );
+  MatrixOperator<double> A_op( &A );
+
+  Gmres<double> gmres( &A_op, &b );
+  gmres.setPreconditioner( &jacobi );
+  gmres.setRestart( 10 );
+  gmres.setTolerance( 1E-10 );
+  diff.subs( gmres.solve(), x_ref );
+  cout << "GMRES(10) error: " << ( diff.norm2() < 1E-8 ) << endl;
+  cout << "GMRES(10) residual: " << ( gmres.getResidual() < 1E-10 )
+       << ", iterations: " << gmres.getIterations() << endl;
+
+  BiCGStab<double> bicgstab( &A_op, &b );
+  bicgstab.setPreconditioner( &jacobi );
+  bicgstab.setTolerance( 1E-10 );
+  diff.subs( bicgstab.solve(), x_ref );
+  cout << "BiCGStab error: " << ( diff.norm2() < 1E-8 )
+       << ", iterations: " << bicgstab.getIterations() << endl;
+}
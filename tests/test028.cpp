@@ -0,0 +1,92 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+
+  // 2D Laplacian on a m x m grid, with anisotropy (poorly conditioned):
+  int m = 20;
+  int size = m*m;
+  Matrix<double> A(size,size);
+  Vector<double> b(size), x(size), x_ref(size), diff(size);
+  A.beginAssembly();
+  for (int i=0; i<m; ++i){
+    for (int j=0; j<m; ++j){
+      int k = i*m + j;
+      A(k,k) += 2. + 200.;
+      if (j>0) A(k,k-1) += -1.;
+      if (j<m-1) A(k,k+1) += -1.;
+      if (i>0) A(k,k-m) += -100.;
+      if (i<m-1) A(k,k+m) += -100.;
+      b(k) = 1.;
+    }
+  }
+  A.endAssembly();
+
+  {
+    Cg<double> cg( &A, &b );
+    cg.setTolerance( 1E-8 );
+    x_ref = cg.solve( 0 );
+    cout << "No preconditioner, iterations: " << cg.getIterations() << endl;
+  }
+  {
+    JacobiPrecond<double> P( &A );
+    Cg<double> cg( &A, &b );
+    cg.setPreconditioner( &P );
+    cg.setTolerance( 1E-8 );
+    diff.subs( cg.solve( 0 ), x_ref );
+    cout << "Jacobi, iterations: " << cg.getIterations()
+         << ", error: " << (diff.norm2() < 1E-4) << endl;
+  }
+  {
+    BlockJacobiPrecond<double> P( &A, 2*m );
+    Cg<double> cg( &A, &b );
+    cg.setPreconditioner( &P );
+    cg.setTolerance( 1E-8 );
+    diff.subs( cg.solve( 0 ), x_ref );
+    cout << "Block-Jacobi, iterations: " << cg.getIterations()
+         << ", error: " << (diff.norm2() < 1E-4) << endl;
+  }
+  {
+    SSORPrecond<double> P( &A, 1.5 );
+    Cg<double> cg( &A, &b );
+    cg.setPreconditioner( &P );
+    cg.setTolerance( 1E-8 );
+    diff.subs( cg.solve( 0 ), x_ref );
+    cout << "SSOR, iterations: " << cg.getIterations()
+         << ", error: " << (diff.norm2() < 1E-4) << endl;
+  }
+  {
+    IC0Precond<double> P( &A );
+    Cg<double> cg( &A, &b );
+    cg.setPreconditioner( &P );
+    cg.setTolerance( 1E-8 );
+    diff.subs( cg.solve( 0 ), x_ref );
+    cout << "IC(0), iterations: " << cg.getIterations()
+         << ", error: " << (diff.norm2() < 1E-4) << endl;
+  }
+
+  // Non-symmetric: convection term, solved with ILU(0) in LinearSystem.
+  for (int k=1; k<size; ++k){
+    A(k,k-1) += -50.;
+    A(k-1,k) += 50.;
+  }
+  LinearSystem<double> theLSolver( A, x, b );
+  ILU0Precond<double> P( &A );
+  theLSolver.setPreconditioner( &P );
+  setLinSolverType(3);
+  theLSolver.solveYourself();
+  diff.mult( A, x );
+  diff -= b;
+  cout << "GMRES with ILU(0), residual: " << (diff.norm2() < 1E-4) << endl;
+  setLinSolverType(4);
+  theLSolver.solveYourself();
+  diff.mult( A, x );
+  diff -= b;
+  cout << "BiCGStab with ILU(0), residual: " << (diff.norm2() < 1E-4) << endl;
+}
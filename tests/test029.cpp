@@ -0,0 +1,142 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+#include "LMX/lmx_diff_problem_second.h"
+
+using namespace lmx;
+
+// 2D Laplacian on a m x m grid with Dirichlet boundaries:
+void poisson( Matrix<double>& A, int m )
+{
+  A.beginAssembly();
+  for (int i=0; i<m; ++i){
+    for (int j=0; j<m; ++j){
+      int k = i*m + j;
+      A(k,k) += 4.;
+      if (j>0) A(k,k-1) += -1.;
+      if (j<m-1) A(k,k+1) += -1.;
+      if (i>0) A(k,k-m) += -1.;
+      if (i<m-1) A(k,k+m) += -1.;
+    }
+  }
+  A.endAssembly();
+}
+
+// System: qddot + K*q = f, with K the 2D Laplacian.
+class WaveSystem{
+  public:
+    WaveSystem( int m ) : K(m*m, m*m)
+    { poisson( K, m ); }
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       const lmx::Vector<double>& qdot,
+                       lmx::Vector<double>& qddot,
+                       double time
+                     )
+    {
+      qddot.mult( K, q );
+      qddot *= -1.;
+      qddot(0) += 1.;
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    const lmx::Vector<double>& qddot,
+                    double time
+                  )
+    {
+      residue.mult( K, q );
+      residue += qddot;
+      residue(0) -= 1.;
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double partial_qdot,
+                    double partial_qddot,
+                    double time
+                  )
+    {
+      tangent = K;
+      for (size_type i=0; i < K.rows(); ++i)
+        tangent(i,i) += partial_qddot;
+    }
+
+  private:
+    lmx::Matrix<double> K;
+};
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+
+  // Iteration counts of Cg with IC(0) and with AMG as the mesh is refined:
+  for (int m=16; m<=64; m*=2){
+    int size = m*m;
+    Matrix<double> A(size,size);
+    Vector<double> b(size);
+    poisson( A, m );
+    b.fillIdentity( 1. );
+
+    IC0Precond<double> P_ic( &A );
+    Cg<double> cg_ic( &A, &b );
+    cg_ic.setPreconditioner( &P_ic );
+    cg_ic.setTolerance( 1E-8 );
+    cg_ic.solve( 0 );
+
+    AmgPrecond<double> P_amg( &A );
+    Cg<double> cg_amg( &A, &b );
+    cg_amg.setPreconditioner( &P_amg );
+    cg_amg.setTolerance( 1E-8 );
+    cg_amg.solve( 0 );
+
+    cout << "m = " << m << ", levels:";
+    for (size_type l=0; l < P_amg.getLevels(); ++l)
+      cout << " " << P_amg.getLevelSize(l);
+    cout << ", IC(0) iterations: " << cg_ic.getIterations()
+         << ", AMG iterations: " << cg_amg.getIterations() << endl;
+  }
+
+  // Standalone AMG solver, with lazy setup:
+  {
+    int m = 32;
+    Matrix<double> A(m*m,m*m);
+    Vector<double> b(m*m), x(m*m), r(m*m);
+    poisson( A, m );
+    b.fillIdentity( 1. );
+    AmgPrecond<double> amg;
+    amg.update( &A );
+    amg.setTolerance( 1E-8 );
+    amg.solve( x, b );
+    r.mult( A, x );
+    r -= b;
+    cout << "Standalone AMG, cycles: " << amg.getIterations()
+         << ", converged: " << (r.norm2() / b.norm2() < 1E-8) << endl;
+  }
+
+  // Hierarchy kept between the time steps of an implicit integration:
+  {
+    setLinSolverType( 2 );
+    int m = 16;
+    WaveSystem theSystem( m );
+    AmgPrecond<double> amg;
+    DiffProblemSecond< WaveSystem > theProblem;
+    Vector<double> q0(m*m), qdot0(m*m);
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "NEWMARK", .25, .5 );
+    theProblem.setInitialConfiguration( q0, qdot0 );
+    theProblem.setTimeParameters( 0, 3., 1. );
+    theProblem.setEvaluation( &WaveSystem::myEvaluation );
+    theProblem.setResidue( &WaveSystem::myResidue );
+    theProblem.setJacobian( &WaveSystem::myTangent );
+    theProblem.setConvergence( 1E-8 );
+    theProblem.setPreconditioner( &amg );
+    theProblem.solve();
+    cout << "Implicit integration with AMG, levels: " << amg.getLevels() << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+// 2D Laplacian on a m x m grid with a diagonal shift:
+void poisson( Matrix<double>& A, int m, double shift )
+{
+  A.beginAssembly();
+  for (int i=0; i<m; ++i){
+    for (int j=0; j<m; ++j){
+      int k = i*m + j;
+      A(k,k) += 4. + shift;
+      if (j>0) A(k,k-1) += -1.;
+      if (j<m-1) A(k,k+1) += -1.;
+      if (i>0) A(k,k-m) += -1.;
+      if (i<m-1) A(k,k+m) += -1.;
+    }
+  }
+  A.endAssembly();
+}
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+
+  int m = 40;
+  int size = m*m;
+  Matrix<double> A(size,size);
+  Vector<double> b(size), x(size), r(size);
+  poisson( A, m, 0. );
+  for (int k=0; k<size; ++k) b(k) = 1. + k%7;
+
+  // Fill of the factor with natural and minimum degree orderings:
+  {
+    Ldlt<double> natural;
+    natural.setOrdering( 0 );
+    natural.factorize( &A );
+    Ldlt<double> amd( &A );
+    amd.factorize( &A );
+    amd.solve( x, b );
+    r.mult( A, x );
+    r -= b;
+    cout << "Natural order, nnz(L): " << natural.getFactorNonZeros() << endl;
+    cout << "Minimum degree, nnz(L) smaller: "
+         << (amd.getFactorNonZeros() < natural.getFactorNonZeros() / 2)
+         << ", residual: " << (r.norm2() < 1E-10) << endl;
+  }
+
+  // Direct solver of LinearSystem (type 0) for CSC matrices:
+  setLinSolverType(0);
+  LinearSystem<double> theLSolver( A, x, b );
+  theLSolver.solveYourself();
+  r.mult( A, x );
+  r -= b;
+  cout << "LinearSystem, residual: " << (r.norm2() < 1E-10) << endl;
+
+  // Same factors, new right hand side:
+  for (int k=0; k<size; ++k) b(k) = 2. - k%3;
+  theLSolver.solveYourself( true );
+  r.mult( A, x );
+  r -= b;
+  cout << "Reused factorization, residual: " << (r.norm2() < 1E-10) << endl;
+
+  // New values, same pattern (the analysis is kept):
+  poisson( A, m, 1. );
+  theLSolver.solveYourself();
+  r.mult( A, x );
+  r -= b;
+  cout << "Refactorized, residual: " << (r.norm2() < 1E-10) << endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,79 @@
+// #define HAVE_GMM
+
+#include "LMX/lmx.h"
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(4);
+  setVectorType(0);
+
+  // Non-symmetric matrix with null diagonal terms (needs row interchanges),
+  // larger than one panel of the blocked factorization:
+  int n = 150;
+  int nrhs = 3;
+  DenseMatrix<double> A(n,n), B(n,nrhs);
+  unsigned int seed = 12345;
+  for (int i=0; i<n; ++i){
+    for (int j=0; j<n; ++j){
+      seed = 1103515245u*seed + 12345u;
+      A(i,j) = (i == j) ? 0. : ((seed >> 16) % 1000) / 1000. - 0.5;
+    }
+    A(i,(i+1)%n) += 10.;
+    for (int l=0; l<nrhs; ++l) B(i,l) = 1. + i%(l+2);
+  }
+
+  // Block of right hand sides with a single factorization:
+  Gauss<double> G( &A );
+  DenseMatrix<double>& X = G.solve( B );
+  cout << "Factorized: " << G.isFactorized() << endl;
+  double err_block = 0.;
+  for (int l=0; l<nrhs; ++l){
+    for (int i=0; i<n; ++i){
+      double r = -B(i,l);
+      for (int j=0; j<n; ++j) r += A(i,j) * X(j,l);
+      err_block += r*r;
+    }
+  }
+  cout << "Block of " << nrhs << " right hand sides, residual: " << (err_block < 1E-18) << endl;
+
+  // Same factors, one right hand side at a time:
+  Vector<double> b(n), r(n);
+  double diff = 0.;
+  for (int l=0; l<nrhs; ++l){
+    for (int i=0; i<n; ++i) b(i) = B(i,l);
+    Vector<double>& x = G.solve( b );
+    for (int i=0; i<n; ++i) diff += std::abs( x(i) - X(i,l) );
+  }
+  cout << "Single right hand sides equal to block: " << (diff < 1E-12) << endl;
+
+  // Gauss through LinearSystem with a Matrix (type 0):
+  setMatrixType(0);
+  Matrix<double> M(n,n);
+  Vector<double> x(n);
+  for (int i=0; i<n; ++i)
+    for (int j=0; j<n; ++j)
+      M(i,j) = A(i,j);
+  setLinSolverType(1);
+  LinearSystem<double> theLSolver( M, x, b );
+  theLSolver.solveYourself();
+  r.mult( M, x );
+  r -= b;
+  cout << "LinearSystem, residual: " << (r.norm2() < 1E-9) << endl;
+
+  // Singular matrix:
+  DenseMatrix<double> S(3,3);
+  S(0,0) = 1.; S(0,1) = 2.;
+  S(1,0) = 2.; S(1,1) = 4.;
+  S(2,2) = 1.;
+  Gauss<double> GS( &S );
+  try{
+    GS.factorize();
+  }
+  catch( ... ){
+    cout << "Singular matrix detected." << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include"LMX/lmx_diff_problem_first.h"
+#include"LMX/lmx_diff_problem_second.h"
+
+using namespace std;
+
+// Front: qdot = -l*(q - g) + gdot, with solution q = g = tanh( k*(t-1) )
+class FrontSystem{
+  public:
+    FrontSystem() : k(20.), l(10.) {}
+
+    double g( double time )
+    { return std::tanh( k * (time - 1.) ); }
+
+    double gdot( double time )
+    { return k * ( 1. - g(time)*g(time) ); }
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       lmx::Vector<double>& qdot,
+                       double time
+                     )
+    {
+      qdot(0) = -l * ( q.readElement(0) - g(time) ) + gdot(time);
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double time
+                  )
+    {
+      residue(0) = qdot.readElement(0) + l * ( q.readElement(0) - g(time) ) - gdot(time);
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    double partial_qdot,
+                    double time
+                  )
+    {
+      tangent(0,0) = partial_qdot + l;
+    }
+
+    void stepDone( ) {}
+
+  private:
+    double k;
+    double l;
+};
+
+// Oscillator: qddot + q = 0
+class OscillatorSystem{
+  public:
+    void myEvaluation( const lmx::Vector<double>& q,
+                       const lmx::Vector<double>& qdot,
+                       lmx::Vector<double>& qddot,
+                       double time
+                     )
+    {
+      qddot(0) = -q.readElement(0);
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    const lmx::Vector<double>& qddot,
+                    double time
+                  )
+    {
+      residue(0) = qddot.readElement(0) + q.readElement(0);
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double partial_qdot,
+                    double partial_qddot,
+                    double time
+                  )
+    {
+      tangent(0,0) = partial_qddot + 1.;
+    }
+};
+
+int main(int argc, char** argv)
+{
+  lmx::setMatrixType( 0 );
+  lmx::setVectorType( 0 );
+  lmx::setLinSolverType( 0 );
+
+  std::vector<double> results;
+  std::vector<int> accepted, rejected;
+  // The step by step output of the solver is not compared:
+  std::ostringstream solver_output;
+  std::streambuf* cout_buffer = cout.rdbuf( solver_output.rdbuf() );
+
+  // Implicit Euler with fixed and adaptive step:
+  for ( int adaptive = 0; adaptive < 2; ++adaptive ){
+    lmx::DiffProblemFirst< FrontSystem > theProblem;
+    FrontSystem theSystem;
+    lmx::Vector<double> q0(1);
+    q0(0) = std::tanh( -20. );
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "BDF-1" );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 2, 0.01 );
+    if ( adaptive ) theProblem.setAdaptiveTimeStep( 1E-3, 1E-3, 1E-4, 0.5 );
+    theProblem.setEvaluation( &FrontSystem::myEvaluation );
+    theProblem.setResidue( &FrontSystem::myResidue );
+    theProblem.setJacobian( &FrontSystem::myTangent );
+    theProblem.setStepTriggered( &FrontSystem::stepDone );
+    theProblem.solve();
+    results.push_back( theProblem.getConfiguration( 0 ).readElement(0) );
+    accepted.push_back( adaptive ? theProblem.getAcceptedSteps() : 200 );
+    rejected.push_back( theProblem.getRejectedSteps() );
+  }
+
+  // Trapezoidal rule (Adams-Moulton 2), adaptive with its own estimate:
+  {
+    lmx::DiffProblemFirst< FrontSystem > theProblem;
+    FrontSystem theSystem;
+    lmx::Vector<double> q0(1);
+    q0(0) = std::tanh( -20. );
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "AM-2" );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 2, 0.01 );
+    theProblem.setAdaptiveTimeStep( 1E-3, 1E-3, 1E-4, 0.5 );
+    theProblem.setEvaluation( &FrontSystem::myEvaluation );
+    theProblem.setResidue( &FrontSystem::myResidue );
+    theProblem.setJacobian( &FrontSystem::myTangent );
+    theProblem.setStepTriggered( &FrontSystem::stepDone );
+    theProblem.solve();
+    results.push_back( theProblem.getConfiguration( 0 ).readElement(0) );
+    accepted.push_back( theProblem.getAcceptedSteps() );
+    rejected.push_back( theProblem.getRejectedSteps() );
+  }
+
+  // Explicit Euler, adaptive:
+  {
+    lmx::DiffProblemFirst< FrontSystem > theProblem;
+    FrontSystem theSystem;
+    lmx::Vector<double> q0(1);
+    q0(0) = std::tanh( -20. );
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "AB-1" );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 2, 0.01 );
+    theProblem.setAdaptiveTimeStep( 1E-3, 1E-3, 1E-4, 0.5 );
+    theProblem.setEvaluation( &FrontSystem::myEvaluation );
+    theProblem.setStepTriggered( &FrontSystem::stepDone );
+    theProblem.solve();
+    results.push_back( theProblem.getConfiguration( 0 ).readElement(0) );
+    accepted.push_back( theProblem.getAcceptedSteps() );
+    rejected.push_back( theProblem.getRejectedSteps() );
+  }
+
+  // Newmark trapezoidal rule, adaptive:
+  {
+    lmx::DiffProblemSecond< OscillatorSystem > theProblem;
+    OscillatorSystem theSystem;
+    lmx::Vector<double> q0(1), qdot0(1);
+    q0(0) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "NEWMARK", .25, .5 );
+    theProblem.setInitialConfiguration( q0, qdot0 );
+    theProblem.setTimeParameters( 0, 10, 0.01 );
+    theProblem.setAdaptiveTimeStep( 1E-4, 1E-4, 1E-4, 1. );
+    theProblem.setEvaluation( &OscillatorSystem::myEvaluation );
+    theProblem.setResidue( &OscillatorSystem::myResidue );
+    theProblem.setJacobian( &OscillatorSystem::myTangent );
+    theProblem.setConvergence( 1E-10 );
+    theProblem.solve();
+    results.push_back( theProblem.getConfiguration( 0 ).readElement(0) );
+    accepted.push_back( theProblem.getAcceptedSteps() );
+    rejected.push_back( theProblem.getRejectedSteps() );
+  }
+
+  cout.rdbuf( cout_buffer );
+  cout.unsetf( std::ios::floatfield );
+  cout.precision( 6 );
+  const char* names[] = { "BDF-1 fixed", "BDF-1 adaptive", "AM-2 adaptive", "AB-1 adaptive", "NEWMARK adaptive" };
+  double exact[] = { std::tanh( 20. ), std::tanh( 20. ), std::tanh( 20. ), std::tanh( 20. ), std::cos( 10. ) };
+  for ( int i = 0; i < 5; ++i ){
+    cout << names[i] << ": steps = " << accepted[i]
+         << ", rejected = " << rejected[i]
+         << ", error at tf = " << ( std::abs( results[i] - exact[i] ) < 1E-2 ? "< 1E-2" : "LARGE" )
+         << endl;
+  }
+  cout << "Adaptive BDF-1 uses fewer steps: " << ( accepted[1] < accepted[0] ? "yes" : "no" ) << endl;
+  cout << "Adaptive AM-2 rejects steps at the front: " << ( rejected[2] > 0 ? "yes" : "no" ) << endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,134 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include"LMX/lmx_diff_problem_first.h"
+
+using namespace std;
+
+// Stiff system with a fast transient and a slow decay:
+// qdot_0 = -1000*(q_0 - cos(t)) - sin(t),  q_0 -> cos(t)
+// qdot_1 = -0.5*q_1,                        q_1 = exp(-0.5*t)
+class StiffSystem{
+  public:
+    void myEvaluation( const lmx::Vector<double>& q,
+                       lmx::Vector<double>& qdot,
+                       double time
+                     )
+    {
+      qdot(0) = -1000. * ( q.readElement(0) - std::cos(time) ) - std::sin(time);
+      qdot(1) = -0.5 * q.readElement(1);
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double time
+                  )
+    {
+      residue(0) = qdot.readElement(0) + 1000. * ( q.readElement(0) - std::cos(time) ) + std::sin(time);
+      residue(1) = qdot.readElement(1) + 0.5 * q.readElement(1);
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    double partial_qdot,
+                    double time
+                  )
+    {
+      tangent(0,0) = partial_qdot + 1000.;
+      tangent(1,1) = partial_qdot + 0.5;
+    }
+};
+
+int main(int argc, char** argv)
+{
+  lmx::setMatrixType( 0 );
+  lmx::setVectorType( 0 );
+  lmx::setLinSolverType( 0 );
+
+  const char* names[] = { "BDF-1", "BDF-2", "BDF" };
+  int steps[3];
+  bool accurate[3];
+  // The step by step output of the solver is not compared:
+  std::ostringstream solver_output;
+  std::streambuf* cout_buffer = cout.rdbuf( solver_output.rdbuf() );
+
+  for ( int i = 0; i < 3; ++i ){
+    lmx::DiffProblemFirst< StiffSystem > theProblem;
+    StiffSystem theSystem;
+    lmx::Vector<double> q0(2);
+    q0(0) = 2.;
+    q0(1) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( (char*)names[i] );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 10, 1E-4 );
+    theProblem.setAdaptiveTimeStep( 1E-4, 1E-5, 1E-6, 1. );
+    theProblem.setEvaluation( &StiffSystem::myEvaluation );
+    theProblem.setResidue( &StiffSystem::myResidue );
+    theProblem.setJacobian( &StiffSystem::myTangent );
+    theProblem.solve();
+    steps[i] = theProblem.getAcceptedSteps() + theProblem.getRejectedSteps();
+    accurate[i] = std::abs( theProblem.getConfiguration( 0 ).readElement(0) - std::cos(10.) ) < 1E-3
+               && std::abs( theProblem.getConfiguration( 0 ).readElement(1) - std::exp(-5.) ) < 1E-3;
+  }
+
+  // Without the adaptive time step, variable order BDF is the fifth order one:
+  double q_fixed[2][2];
+  const char* fixed_names[] = { "BDF-5", "BDF" };
+  for ( int i = 0; i < 2; ++i ){
+    lmx::DiffProblemFirst< StiffSystem > theProblem;
+    StiffSystem theSystem;
+    lmx::Vector<double> q0(2);
+    q0(0) = 2.;
+    q0(1) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( (char*)fixed_names[i] );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 1, 1E-2 );
+    theProblem.setEvaluation( &StiffSystem::myEvaluation );
+    theProblem.setResidue( &StiffSystem::myResidue );
+    theProblem.setJacobian( &StiffSystem::myTangent );
+    theProblem.solve();
+    q_fixed[i][0] = theProblem.getConfiguration( 0 ).readElement(0);
+    q_fixed[i][1] = theProblem.getConfiguration( 0 ).readElement(1);
+  }
+  cout.rdbuf( cout_buffer );
+
+  for ( int i = 0; i < 3; ++i )
+    cout << names[i] << " adaptive: solution at tf "
+         << ( accurate[i] ? "within 1E-3" : "WRONG" ) << endl;
+  cout << "Variable order BDF takes fewer steps than BDF-1: "
+       << ( steps[2] < steps[0] ? "yes" : "no" ) << endl;
+  cout << "Variable order BDF takes fewer steps than BDF-2: "
+       << ( steps[2] < steps[1] ? "yes" : "no" ) << endl;
+  cout << "Steps (BDF-1, BDF-2, BDF): " << steps[0] << " " << steps[1] << " " << steps[2] << endl;
+  cout << "Variable order BDF with fixed time step equals BDF-5: "
+       << ( std::abs( q_fixed[1][0] - q_fixed[0][0] ) < 1E-10
+            && std::abs( q_fixed[1][1] - q_fixed[0][1] ) < 1E-10 ? "yes" : "no" ) << endl;
+  cout << "BDF-5 fixed step: solution at tf "
+       << ( std::abs( q_fixed[0][0] - std::cos(1.) ) < 1E-4
+            && std::abs( q_fixed[0][1] - std::exp(-0.5) ) < 1E-4 ? "within 1E-4" : "WRONG" ) << endl;
+
+  return EXIT_SUCCESS;
+}
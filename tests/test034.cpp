@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include"LMX/lmx_diff_problem_second.h"
+
+using namespace std;
+
+// Two decoupled oscillators, qddot + K*q = 0, with frequencies 1 and 1000:
+class TwoModeSystem{
+  public:
+    TwoModeSystem()
+    {
+      k[0] = 1.;
+      k[1] = 1E6;
+    }
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       const lmx::Vector<double>& qdot,
+                       lmx::Vector<double>& qddot,
+                       double time
+                     )
+    {
+      for ( int i = 0; i < 2; ++i )
+        qddot(i) = -k[i] * q.readElement(i);
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    const lmx::Vector<double>& qddot,
+                    double time
+                  )
+    {
+      for ( int i = 0; i < 2; ++i )
+        residue(i) = qddot.readElement(i) + k[i] * q.readElement(i);
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double partial_qdot,
+                    double partial_qddot,
+                    double time
+                  )
+    {
+      for ( int i = 0; i < 2; ++i )
+        tangent(i,i) = partial_qddot + k[i];
+    }
+
+  private:
+    double k[2];
+};
+
+int main(int argc, char** argv)
+{
+  lmx::setMatrixType( 0 );
+  lmx::setVectorType( 0 );
+  lmx::setLinSolverType( 0 );
+
+  const char* names[] = { "NEWMARK", "GENERALIZED-ALPHA", "HHT" };
+  double rho[] = { 1., 0.5, 0.8 };
+  double low_error[3], high_amplitude[3];
+
+  for ( int i = 0; i < 3; ++i ){
+    lmx::DiffProblemSecond< TwoModeSystem > theProblem;
+    TwoModeSystem theSystem;
+    lmx::Vector<double> q0(2), qdot0(2);
+    q0(0) = 1.;
+    q0(1) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    if ( i == 0 ) theProblem.setIntegrator( (char*)names[i], .25, .5 );
+    else theProblem.setIntegrator( (char*)names[i], rho[i] );
+    theProblem.setInitialConfiguration( q0, qdot0 );
+    theProblem.setTimeParameters( 0, 2, 0.1 );
+    theProblem.setEvaluation( &TwoModeSystem::myEvaluation );
+    theProblem.setResidue( &TwoModeSystem::myResidue );
+    theProblem.setJacobian( &TwoModeSystem::myTangent );
+    theProblem.setConvergence( 1E-8 );
+    theProblem.solve();
+    low_error[i] = std::abs( theProblem.getConfiguration( 0 ).readElement(0) - std::cos(2.) );
+    high_amplitude[i] = std::abs( theProblem.getConfiguration( 0 ).readElement(1) );
+  }
+
+  cout.precision( 2 );
+  for ( int i = 0; i < 3; ++i ){
+    cout.unsetf( std::ios::floatfield );
+    cout << names[i] << " (rho_inf = " << rho[i] << "): low mode error = ";
+    cout.setf( std::ios::scientific, std::ios::floatfield );
+    cout << low_error[i] << ", high mode amplitude = " << high_amplitude[i] << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,125 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include"LMX/lmx_diff_problem_first.h"
+#include"LMX/lmx_diff_problem_second.h"
+
+using namespace std;
+
+// Rotation: qdot_0 = -q_1, qdot_1 = q_0, with solution (cos(t), sin(t))
+class RotationSystem{
+  public:
+    RotationSystem() : evaluations(0) {}
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       lmx::Vector<double>& qdot,
+                       double time
+                     )
+    {
+      ++evaluations;
+      qdot(0) = -q.readElement(1);
+      qdot(1) = q.readElement(0);
+    }
+
+    void stepDone( ) {}
+
+    int evaluations;
+};
+
+// Oscillator: qddot + q = 0
+class OscillatorSystem{
+  public:
+    OscillatorSystem() : evaluations(0) {}
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       const lmx::Vector<double>& qdot,
+                       lmx::Vector<double>& qddot,
+                       double time
+                     )
+    {
+      ++evaluations;
+      qddot(0) = -q.readElement(0);
+    }
+
+    int evaluations;
+};
+
+int main(int argc, char** argv)
+{
+  // The step by step output of the solver is not compared:
+  std::ostringstream solver_output;
+  std::streambuf* cout_buffer = cout.rdbuf();
+
+  lmx::setMatrixType( 0 );
+  lmx::setVectorType( 0 );
+
+  const char* names[] = { "AB-4", "RK4", "BS32", "DP54" };
+  cout.setf( std::ios::scientific, std::ios::floatfield );
+  cout.precision( 1 );
+  double tf = 10.;
+
+  for ( int i = 0; i < 4; ++i ){
+    lmx::DiffProblemFirst< RotationSystem > theProblem;
+    RotationSystem theSystem;
+    lmx::Vector<double> q0(2);
+    q0(0) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( (char*)names[i] );
+    cout.rdbuf( solver_output.rdbuf() );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, tf, i < 2 ? 0.01 : 0.1 );
+    if ( i >= 2 ) theProblem.setAdaptiveTimeStep( 1E-7, 1E-7, 1E-5, 1. );
+    theProblem.setEvaluation( &RotationSystem::myEvaluation );
+    theProblem.setStepTriggered( &RotationSystem::stepDone );
+    theProblem.solve();
+    cout.rdbuf( cout_buffer );
+    double error = std::sqrt( std::pow( theProblem.getConfiguration( 0 ).readElement(0) - std::cos(tf), 2 )
+                            + std::pow( theProblem.getConfiguration( 0 ).readElement(1) - std::sin(tf), 2 ) );
+    cout << names[i] << ( i < 2 ? " fixed" : " adaptive" ) << ": evaluations = "
+         << theSystem.evaluations << ", error = " << error;
+    if ( i >= 2 ) cout << ", rejected steps = " << theProblem.getRejectedSteps();
+    cout << endl;
+  }
+
+  {
+    lmx::DiffProblemSecond< OscillatorSystem > theProblem;
+    OscillatorSystem theSystem;
+    lmx::Vector<double> q0(1), qdot0(1);
+    q0(0) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( "DP54" );
+    cout.rdbuf( solver_output.rdbuf() );
+    theProblem.setInitialConfiguration( q0, qdot0 );
+    theProblem.setTimeParameters( 0, tf, 0.1 );
+    theProblem.setAdaptiveTimeStep( 1E-7, 1E-7, 1E-5, 1. );
+    theProblem.setEvaluation( &OscillatorSystem::myEvaluation );
+    theProblem.solve();
+    cout.rdbuf( cout_buffer );
+    double error = std::abs( theProblem.getConfiguration( 0 ).readElement(0) - std::cos(tf) )
+                 + std::abs( theProblem.getConfiguration( 1 ).readElement(0) + std::sin(tf) );
+    cout << "DP54 adaptive, second order system: evaluations = "
+         << theSystem.evaluations << ", error = " << error << endl;
+  }
+
+  return EXIT_SUCCESS;
+}
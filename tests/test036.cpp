@@ -0,0 +1,159 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include"LMX/lmx_diff_problem_first.h"
+
+using namespace std;
+
+// Stiff system with a fast transient and a slow decay:
+// qdot_0 = -l*(q_0 - cos(t)) - sin(t),  q_0 -> cos(t)
+// qdot_1 = -0.5*q_1,                     q_1 = exp(-0.5*t)
+// with l = 1000, or l = 1 to check the order of the methods.
+class StiffSystem{
+  public:
+    StiffSystem( double l = 1000. ) : lambda(l), evaluations(0), jacobians(0) {}
+
+    void myEvaluation( const lmx::Vector<double>& q,
+                       lmx::Vector<double>& qdot,
+                       double time
+                     )
+    {
+      ++evaluations;
+      qdot(0) = -lambda * ( q.readElement(0) - std::cos(time) ) - std::sin(time);
+      qdot(1) = -0.5 * q.readElement(1);
+    }
+
+    void myResidue( lmx::Vector<double>& residue,
+                    const lmx::Vector<double>& q,
+                    const lmx::Vector<double>& qdot,
+                    double time
+                  )
+    {
+      ++evaluations;
+      residue(0) = qdot.readElement(0) + lambda * ( q.readElement(0) - std::cos(time) ) + std::sin(time);
+      residue(1) = qdot.readElement(1) + 0.5 * q.readElement(1);
+    }
+
+    void myTangent( lmx::Matrix<double>& tangent,
+                    const lmx::Vector<double>& q,
+                    double partial_qdot,
+                    double time
+                  )
+    {
+      ++jacobians;
+      tangent(0,0) = partial_qdot + lambda;
+      tangent(1,1) = partial_qdot + 0.5;
+    }
+
+    void stepDone( ) {}
+
+    double lambda;
+    int evaluations;
+    int jacobians;
+};
+
+double finalError( lmx::DiffProblemFirst< StiffSystem >& theProblem, double tf )
+{
+  return std::max( std::abs( theProblem.getConfiguration( 0 ).readElement(0) - std::cos(tf) ),
+                   std::abs( theProblem.getConfiguration( 0 ).readElement(1) - std::exp(-.5*tf) ) );
+}
+
+int main(int argc, char** argv)
+{
+  // The step by step output of the solver is not compared:
+  std::ostringstream solver_output;
+  std::streambuf* cout_buffer = cout.rdbuf();
+
+  lmx::setMatrixType( 0 );
+  lmx::setVectorType( 0 );
+  lmx::setLinSolverType( 0 );
+
+  // Convergence order with fixed steps, non stiff:
+  const char* fixed[] = { "ROS2", "ROS3", "RODAS3" };
+  for ( int i = 0; i < 3; ++i ){
+    double error[2];
+    for ( int j = 0; j < 2; ++j ){
+      lmx::DiffProblemFirst< StiffSystem > theProblem;
+      StiffSystem theSystem( 1. );
+      lmx::Vector<double> q0(2);
+      q0(0) = 1.;
+      q0(1) = 1.;
+      theProblem.setDiffSystem( theSystem );
+      theProblem.setIntegrator( (char*)fixed[i] );
+      cout.rdbuf( solver_output.rdbuf() );
+      theProblem.setInitialConfiguration( q0 );
+      theProblem.setTimeParameters( 0, 2, j ? 0.025 : 0.05 );
+      theProblem.setEvaluation( &StiffSystem::myEvaluation );
+      theProblem.setJacobian( &StiffSystem::myTangent );
+      theProblem.setStepTriggered( &StiffSystem::stepDone );
+      theProblem.solve();
+      cout.rdbuf( cout_buffer );
+      error[j] = finalError( theProblem, 2. );
+    }
+    cout << fixed[i] << " fixed step: observed order "
+         << (int)( std::log( error[0] / error[1] ) / std::log( 2. ) + 0.5 ) << endl;
+  }
+
+  // Adaptive integration through the transient, against BDF with Newton:
+  const char* names[] = { "ROS2", "ROS3", "RODAS3", "BDF" };
+  int steps[4], evaluations[4], jacobians[4];
+  bool accurate[4];
+
+  for ( int i = 0; i < 4; ++i ){
+    lmx::DiffProblemFirst< StiffSystem > theProblem;
+    StiffSystem theSystem;
+    lmx::Vector<double> q0(2);
+    q0(0) = 2.;
+    q0(1) = 1.;
+    theProblem.setDiffSystem( theSystem );
+    theProblem.setIntegrator( (char*)names[i] );
+    cout.rdbuf( solver_output.rdbuf() );
+    theProblem.setInitialConfiguration( q0 );
+    theProblem.setTimeParameters( 0, 10, 1E-4 );
+    theProblem.setAdaptiveTimeStep( 1E-4, 1E-5, 1E-6, 1. );
+    theProblem.setEvaluation( &StiffSystem::myEvaluation );
+    theProblem.setResidue( &StiffSystem::myResidue );
+    theProblem.setJacobian( &StiffSystem::myTangent );
+    theProblem.setStepTriggered( &StiffSystem::stepDone );
+    theProblem.solve();
+    cout.rdbuf( cout_buffer );
+    steps[i] = theProblem.getAcceptedSteps() + theProblem.getRejectedSteps();
+    evaluations[i] = theSystem.evaluations;
+    jacobians[i] = theSystem.jacobians;
+    accurate[i] = finalError( theProblem, 10. ) < 1E-3;
+  }
+
+  for ( int i = 0; i < 4; ++i )
+    cout << names[i] << " adaptive: solution at tf "
+         << ( accurate[i] ? "within 1E-3" : "WRONG" ) << endl;
+  for ( int i = 0; i < 3; ++i )
+    cout << names[i] << ": one Jacobian per step: "
+         << ( jacobians[i] == steps[i] ? "yes" : "no" ) << endl;
+  cout << "RODAS3 takes fewer steps than ROS2: "
+       << ( steps[2] < steps[0] ? "yes" : "no" ) << endl;
+  for ( int i = 0; i < 4; ++i )
+    cout << names[i] << " steps, evaluations, Jacobians: "
+         << steps[i] << " " << evaluations[i] << " " << jacobians[i] << endl;
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+#include"LMX/lmx.h"
+#include<vector>
+
+using namespace std;
+using namespace lmx;
+
+// Reference product, C = A*B with leading dimensions.
+template <typename T>
+void naiveGemm( size_t m, size_t n, size_t k,
+                const T* a, size_t lda, const T* b, size_t ldb,
+                T* c, size_t ldc )
+{
+  for (size_t i=0; i<m; ++i)
+    for (size_t j=0; j<n; ++j){
+      T sum = 0;
+      for (size_t p=0; p<k; ++p) sum += a[i*lda+p] * b[p*ldb+j];
+      c[i*ldc+j] = sum;
+    }
+}
+
+// Compares dense_gemm with the reference product, with padded leading
+// dimensions so the edges of the tiles and of the cache blocks are used.
+template <typename T>
+double gemmError( size_t m, size_t n, size_t k )
+{
+  size_t lda = k+3, ldb = n+5, ldc = n+1;
+  std::vector<T> a( m*lda ), b( k*ldb ), c( m*ldc, T(-1) ), r( m*ldc, T(-1) );
+  for (size_t i=0; i<a.size(); ++i) a[i] = T( (i*7) % 13 ) / 13 - T(.5);
+  for (size_t i=0; i<b.size(); ++i) b[i] = T( (i*5) % 11 ) / 11 - T(.5);
+  dense_gemm( m, n, k, &a[0], lda, &b[0], ldb, &c[0], ldc );
+  naiveGemm( m, n, k, &a[0], lda, &b[0], ldb, &r[0], ldc );
+  double error = 0.;
+  for (size_t i=0; i<m; ++i)
+    for (size_t j=0; j<n; ++j)
+      error = std::max( error, (double)std::abs( c[i*ldc+j] - r[i*ldc+j] ) );
+  return error;
+}
+
+int main(int argc, char** argv)
+{
+  // Sizes that are not multiples of the register tiles (4 x 4, 4 x 8 and
+  // 4 x 16) nor of the cache blocks (96 rows, 256 terms):
+  size_t sizes[][3] = { {1,1,1}, {3,5,7}, {5,17,3}, {9,33,2},
+                        {37,29,301}, {101,67,259}, {197,131,513} };
+  for (int s=0; s<7; ++s){
+    size_t m = sizes[s][0], n = sizes[s][1], k = sizes[s][2];
+    cout << "GEMM (" << m << "x" << k << ")*(" << k << "x" << n << "): double "
+         << ( gemmError<double>( m, n, k ) < 1E-10 ? "OK" : "WRONG" ) << ", float "
+         << ( gemmError<float>( m, n, k ) < 1E-3 ? "OK" : "WRONG" ) << endl;
+  }
+
+  // Through Matrix::mult with the contiguous dense type:
+  setMatrixType(4);
+  size_t m = 23, n = 19, k = 11;
+  Matrix<double> A(m,k), B(k,n), C(m,n);
+  for (size_t i=0; i<m; ++i)
+    for (size_t j=0; j<k; ++j) A(i,j) = double(i) - double(2*j) / 3.;
+  for (size_t i=0; i<k; ++i)
+    for (size_t j=0; j<n; ++j) B(i,j) = double(i+j) / 7.;
+  C.mult(A,B);
+  double error = 0.;
+  for (size_t i=0; i<m; ++i)
+    for (size_t j=0; j<n; ++j){
+      double sum = 0.;
+      for (size_t p=0; p<k; ++p) sum += A.readElement(i,p) * B.readElement(p,j);
+      error = std::max( error, std::abs( C.readElement(i,j) - sum ) );
+    }
+  cout << "Matrix::mult (" << m << "x" << k << ")*(" << k << "x" << n << "): "
+       << ( error < 1E-10 ? "OK" : "WRONG" ) << endl;
+
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright (C) 2007 by Daniel Iglesias   *
+ *   daniel@extremo   *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+// #define HAVE_GMM
+
+// 64 bit indices for the compressed column storage:
+#define LMX_CSC_INDEX long long
+
+#include "LMX/lmx.h"
+#include <cstdio>
+#include <fstream>
+
+using namespace lmx;
+
+int main(int argc, char** argv){
+
+  setMatrixType(1);
+  setVectorType(0);
+  setLinSolverType(2);
+
+  int size = 4;
+  cout << "Index size: " << sizeof( Type_csc<double>().ja[0] ) << endl;
+
+  // Pattern of a tridiagonal matrix (one based):
+  std::vector<size_type> rows, cols;
+  cols.push_back(1);
+  for (int j=0; j<size; ++j){
+    for (int i=j-1; i<=j+1; ++i)
+      if (i>=0 && i<size) rows.push_back(i+1);
+    cols.push_back(rows.size()+1);
+  }
+
+  // setSparsePattern stores the pattern zero based:
+  Type_csc<double, long long> pattern(size,size);
+  pattern.setSparsePattern(rows, cols);
+  bool zero_based = pattern.ia.size() == rows.size() && pattern.ja.size() == cols.size();
+  for (size_type k=0; zero_based && k<rows.size(); ++k)
+    if (pattern.ia[k] != (long long)rows[k]-1) zero_based = false;
+  for (size_type k=0; zero_based && k<cols.size(); ++k)
+    if (pattern.ja[k] != (long long)cols[k]-1) zero_based = false;
+  cout << "setSparsePattern zero based: " << (zero_based ? "yes" : "no") << endl;
+
+  // Assembly, product and solutions:
+  Matrix<double> A(size,size);
+  Vector<double> b(size);
+  Vector<double> c(size);
+  A.sparsePattern(rows, cols);
+  for (int i=0; i<size; ++i){
+    A(i,i) += 4.;
+    if (i>0) A(i,i-1) -= 1.;
+    if (i<size-1) A(i,i+1) -= 1.;
+    b(i) = i+1;
+  }
+  cout << A << endl;
+  c.mult(A,b);
+  cout << "A*b = " << c << endl;
+
+  LinearSystem<double> x(A,b);
+  x.solveYourself();
+  cout << x.getSolution();
+
+  setLinSolverType(0);
+  LinearSystem<double> y(A,b);
+  y.solveYourself();
+  cout << y.getSolution();
+
+  // The same matrix read from a Harwell-Boeing file (one based):
+  {
+    std::ofstream hb("test038.hb");
+    hb << "Tridiagonal test matrix                                                 TEST038 \n"
+       << "             4             1             1             2             0\n"
+       << "RUA                        4             4            10             0\n"
+       << "(5I4)           (10I4)          (5E16.8)                                \n"
+       << "   1   3   6   9  11\n"
+       << "   1   2   1   2   3   2   3   4   3   4\n"
+       << "  4.00000000E+00 -1.00000000E+00 -1.00000000E+00  4.00000000E+00 -1.00000000E+00\n"
+       << " -1.00000000E+00  4.00000000E+00 -1.00000000E+00 -1.00000000E+00  4.00000000E+00\n";
+  }
+  Type_csc<double, long long> read;
+  read.read_hb_file("test038.hb");
+  std::remove("test038.hb");
+  bool same = read.getRows() == (size_type)size && read.getCols() == (size_type)size;
+  for (size_type k=0; same && k<rows.size(); ++k)
+    if (read.ia[k] != (long long)rows[k]-1) same = false;
+  for (int i=0; same && i<size; ++i)
+    for (int j=0; j<size; ++j)
+      if (read.readElement(i,j) != A.readElement(i,j)) same = false;
+  cout << "Harwell-Boeing file read zero based: " << (same ? "yes" : "no") << endl;
+
+}